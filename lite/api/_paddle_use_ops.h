@@ -41,6 +41,7 @@ USE_LITE_OP(fusion_elementwise_add_activation)
 USE_LITE_OP(fusion_elementwise_mul_activation)
 USE_LITE_OP(fusion_elementwise_max_activation)
 USE_LITE_OP(fusion_elementwise_div_activation)
+USE_LITE_OP(fusion_elementwise_chain)
 USE_LITE_OP(square)
 USE_LITE_OP(softmax)
 USE_LITE_OP(dropout)
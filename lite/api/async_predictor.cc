@@ -0,0 +1,141 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/api/async_predictor.h"
+#include <exception>
+#include <utility>
+#include "lite/utils/cp_logging.h"
+
+namespace paddle {
+namespace lite_api {
+
+AsyncPredictor::AsyncPredictor(
+    std::shared_ptr<PaddlePredictor> predictor,
+    int num_workers,
+    const std::vector<PrecisionType>& output_precisions)
+    : output_precisions_(output_precisions) {
+  CHECK(predictor);
+  CHECK_GT(num_workers, 0);
+  predictors_.push_back(predictor);
+  for (int i = 1; i < num_workers; ++i) {
+    predictors_.push_back(predictor->Clone());
+    CHECK(predictors_.back()) << "The predictor can not be cloned";
+  }
+  for (auto& worker_predictor : predictors_) {
+    workers_.emplace_back(&AsyncPredictor::Loop, this, worker_predictor.get());
+  }
+}
+
+AsyncPredictor::~AsyncPredictor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+std::future<void> AsyncPredictor::RunAsync(Task task) {
+  auto done = std::make_shared<std::promise<void>>();
+  auto future = done->get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back([task, done](PaddlePredictor* predictor) {
+      try {
+        task(predictor);
+        done->set_value();
+      } catch (...) {
+        done->set_exception(std::current_exception());
+      }
+    });
+  }
+  cv_.notify_one();
+  return future;
+}
+
+void AsyncPredictor::RunAsync(BatchTensors inputs, Callback done) {
+  // The inputs are moved into the task, which is copyable as std::function
+  // requires, so they are held by a shared_ptr.
+  auto shared_inputs = std::make_shared<BatchTensors>(std::move(inputs));
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back([this, shared_inputs, done](PaddlePredictor* predictor) {
+      done(Run(*shared_inputs, predictor));
+    });
+  }
+  cv_.notify_one();
+}
+
+std::future<BatchTensors> AsyncPredictor::RunAsync(BatchTensors inputs) {
+  auto outputs = std::make_shared<std::promise<BatchTensors>>();
+  auto future = outputs->get_future();
+  auto shared_inputs = std::make_shared<BatchTensors>(std::move(inputs));
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(
+        [this, shared_inputs, outputs](PaddlePredictor* predictor) {
+          try {
+            outputs->set_value(Run(*shared_inputs, predictor));
+          } catch (...) {
+            outputs->set_exception(std::current_exception());
+          }
+        });
+  }
+  cv_.notify_one();
+  return future;
+}
+
+void AsyncPredictor::Loop(PaddlePredictor* predictor) {
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) return;
+      task = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    // The failed tasks with a callback are dropped, the worker goes on with
+    // the next ones.
+    try {
+      task(predictor);
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "An async task failed: " << e.what();
+    } catch (...) {
+      LOG(ERROR) << "An async task failed";
+    }
+  }
+}
+
+BatchTensors AsyncPredictor::Run(const BatchTensors& inputs,
+                                 PaddlePredictor* predictor) {
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    inputs[i].CopyTo(predictor->GetInput(i).get());
+  }
+  predictor->Run();
+  BatchTensors outputs(predictor->GetOutputNames().size());
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    auto output = predictor->GetOutput(i);
+    PrecisionType precision = i < output_precisions_.size()
+                                  ? output_precisions_[i]
+                                  : output->precision();
+    outputs[i].CopyFrom(*output, precision);
+  }
+  return outputs;
+}
+
+}  // namespace lite_api
+}  // namespace paddle
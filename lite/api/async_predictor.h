@@ -0,0 +1,78 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+ * This file implements AsyncPredictor, which runs the requests on a pool of
+ * workers, each owning a clone of a PaddlePredictor. The callers are not
+ * blocked by the forward pass, so that they can prepare the following
+ * requests or post-process the previous outputs meanwhile.
+ */
+#pragma once
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+#include "lite/api/batching_predictor.h"
+#include "lite/api/paddle_api.h"
+
+namespace paddle {
+namespace lite_api {
+
+class LITE_API AsyncPredictor {
+ public:
+  using Task = std::function<void(PaddlePredictor*)>;
+  using Callback = std::function<void(BatchTensors)>;
+
+  /// The first worker runs `predictor`, the others run clones of it, which
+  /// share its weights.
+  AsyncPredictor(std::shared_ptr<PaddlePredictor> predictor,
+                 int num_workers,
+                 const std::vector<PrecisionType>& output_precisions = {});
+  /// Runs the pending requests before returning.
+  ~AsyncPredictor();
+
+  /// Feed `inputs`, in the order of `GetInputNames()`, to an idle worker and
+  /// run it. The outputs are fetched with the precisions given, their own
+  /// for the ones not listed. The future gets the exception of a failed run.
+  std::future<BatchTensors> RunAsync(BatchTensors inputs);
+  /// The same, but `done` is called with the outputs on the worker thread. A
+  /// failed run is logged and `done` is not called.
+  void RunAsync(BatchTensors inputs, Callback done);
+  /// Run `task` with the predictor of an idle worker, e.g. to feed from and
+  /// fetch to the buffers of the caller without copying them twice. The
+  /// future gets the exception thrown by `task`.
+  std::future<void> RunAsync(Task task);
+
+  int num_workers() const { return static_cast<int>(workers_.size()); }
+
+ private:
+  void Loop(PaddlePredictor* predictor);
+  BatchTensors Run(const BatchTensors& inputs, PaddlePredictor* predictor);
+
+  std::vector<std::shared_ptr<PaddlePredictor>> predictors_;
+  std::vector<PrecisionType> output_precisions_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Task> queue_;
+  bool stop_{false};
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace lite_api
+}  // namespace paddle
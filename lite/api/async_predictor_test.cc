@@ -0,0 +1,168 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/api/async_predictor.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "lite/core/tensor.h"
+
+namespace paddle {
+namespace lite_api {
+
+// y = x + 1 of the precision of x, the clones count the runs together. A
+// negative x fails.
+class AddOnePredictor : public PaddlePredictor {
+ public:
+  explicit AddOnePredictor(std::shared_ptr<std::atomic<int>> runs)
+      : runs_(runs) {}
+
+  std::unique_ptr<Tensor> GetInput(int i) override {
+    return std::unique_ptr<Tensor>(new Tensor(&x_));
+  }
+  std::unique_ptr<const Tensor> GetOutput(int i) const override {
+    return std::unique_ptr<const Tensor>(new Tensor(&y_));
+  }
+  void Run() override {
+    ++*runs_;
+    y_.Resize(x_.dims());
+    if (x_.precision() == PrecisionType::kInt64) {
+      AddOne<int64_t>();
+    } else {
+      AddOne<float>();
+    }
+  }
+  std::shared_ptr<PaddlePredictor> Clone() override {
+    return std::make_shared<AddOnePredictor>(runs_);
+  }
+  std::string GetVersion() const override { return ""; }
+  std::vector<std::string> GetInputNames() override { return {"x"}; }
+  std::vector<std::string> GetOutputNames() override { return {"y"}; }
+  std::unique_ptr<Tensor> GetInputByName(const std::string& name) override {
+    return GetInput(0);
+  }
+  std::unique_ptr<const Tensor> GetTensor(
+      const std::string& name) const override {
+    return nullptr;
+  }
+
+ private:
+  template <typename T>
+  void AddOne() {
+    auto* x = x_.data<T>();
+    auto* y = y_.mutable_data<T>();
+    for (int64_t i = 0; i < x_.numel(); ++i) {
+      if (x[i] < 0) throw std::invalid_argument("negative input");
+      y[i] = x[i] + 1;
+    }
+  }
+
+  std::shared_ptr<std::atomic<int>> runs_;
+  lite::Tensor x_;
+  lite::Tensor y_;
+};
+
+BatchTensors MakeInput(float value) {
+  std::vector<float> data(8, value);
+  BatchTensors inputs(1);
+  inputs[0].Assign(PrecisionType::kFloat, {2, 4}, data.data());
+  return inputs;
+}
+
+TEST(AsyncPredictor, run_async) {
+  auto runs = std::make_shared<std::atomic<int>>(0);
+  AsyncPredictor predictor(std::make_shared<AddOnePredictor>(runs), 3);
+  EXPECT_EQ(predictor.num_workers(), 3);
+
+  const int kRequests = 64;
+  std::vector<std::future<BatchTensors>> futures;
+  for (int i = 0; i < kRequests; ++i) {
+    futures.push_back(predictor.RunAsync(MakeInput(i)));
+  }
+  for (int i = 0; i < kRequests; ++i) {
+    auto outputs = futures[i].get();
+    ASSERT_EQ(outputs.size(), 1);
+    ASSERT_EQ(outputs[0].shape, shape_t({2, 4}));
+    for (int j = 0; j < 8; ++j) {
+      EXPECT_EQ(outputs[0].data<float>()[j], i + 1);
+    }
+  }
+  EXPECT_EQ(*runs, kRequests);
+}
+
+TEST(AsyncPredictor, callback) {
+  auto runs = std::make_shared<std::atomic<int>>(0);
+  std::atomic<int> sum(0);
+  {
+    AsyncPredictor predictor(std::make_shared<AddOnePredictor>(runs), 2);
+    for (int i = 0; i < 10; ++i) {
+      predictor.RunAsync(MakeInput(i), [&sum](BatchTensors outputs) {
+        sum += static_cast<int>(outputs[0].data<float>()[0]);
+      });
+    }
+    // Feed and fetch in place with the predictor of a worker.
+    float y = 0;
+    predictor
+        .RunAsync([&y](PaddlePredictor* p) {
+          auto x = p->GetInput(0);
+          x->Resize({1});
+          x->mutable_data<float>()[0] = 41;
+          p->Run();
+          y = p->GetOutput(0)->data<float>()[0];
+        })
+        .wait();
+    EXPECT_EQ(y, 42);
+  }
+  // The pending callbacks are done before the predictor is destroyed.
+  EXPECT_EQ(sum, 55);
+  EXPECT_EQ(*runs, 11);
+}
+
+TEST(AsyncPredictor, output_precision) {
+  auto runs = std::make_shared<std::atomic<int>>(0);
+  AsyncPredictor predictor(std::make_shared<AddOnePredictor>(runs), 1);
+  std::vector<int64_t> data{1, 2, 3};
+  BatchTensors inputs(1);
+  inputs[0].Assign(PrecisionType::kInt64, {3, 1}, data.data());
+  // The precision of the output is not given, it is fetched as int64.
+  auto outputs = predictor.RunAsync(std::move(inputs)).get();
+  ASSERT_EQ(outputs[0].precision, PrecisionType::kInt64);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(outputs[0].data<int64_t>()[i], data[i] + 1);
+  }
+}
+
+TEST(AsyncPredictor, failure) {
+  auto runs = std::make_shared<std::atomic<int>>(0);
+  std::atomic<int> callbacks(0);
+  AsyncPredictor predictor(std::make_shared<AddOnePredictor>(runs), 1);
+  auto failed = predictor.RunAsync(MakeInput(-1));
+  EXPECT_THROW(failed.get(), std::invalid_argument);
+  predictor.RunAsync(MakeInput(-1),
+                     [&callbacks](BatchTensors outputs) { ++callbacks; });
+  auto task = predictor.RunAsync(
+      [](PaddlePredictor* p) { throw std::runtime_error("task failed"); });
+  EXPECT_THROW(task.get(), std::runtime_error);
+
+  // The worker goes on after the failures.
+  auto outputs = predictor.RunAsync(MakeInput(1)).get();
+  EXPECT_EQ(outputs[0].data<float>()[0], 2);
+  EXPECT_EQ(callbacks, 0);
+  EXPECT_EQ(*runs, 3);
+}
+
+}  // namespace lite_api
+}  // namespace paddle
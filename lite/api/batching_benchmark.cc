@@ -0,0 +1,165 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A local load generator for the BatchingPredictor. Every client sends its
+// requests one after another, and the number of clients is swept to report
+// the throughput against the p50/p99 latency, batched and not batched.
+
+#include <gflags/gflags.h>
+#include <algorithm>
+#include <cstdio>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "lite/api/batching_predictor.h"
+#include "lite/api/paddle_api.h"
+#include "lite/api/paddle_use_kernels.h"
+#include "lite/api/paddle_use_ops.h"
+#include "lite/api/paddle_use_passes.h"
+#include "lite/api/test_helper.h"
+#include "lite/core/profile/runtime_profiler.h"
+#include "lite/utils/cp_logging.h"
+#include "lite/utils/string.h"
+
+DEFINE_string(input_shape,
+              "1,100",
+              "the shape of the input of a request, separated by comma");
+DEFINE_int32(seq_len,
+             0,
+             "if positive, every request is a sequence of seq_len rows of the "
+             "input shape, fed with LoD");
+DEFINE_string(clients, "1,2,4,8,16,32", "the numbers of concurrent clients");
+DEFINE_int32(requests, 200, "the requests sent by every client");
+DEFINE_int32(max_batch_size, 16, "the max samples merged in a run");
+DEFINE_int32(batch_timeout_us, 1000, "the max wait of a request for others");
+
+namespace paddle {
+namespace lite_api {
+
+struct LoadResult {
+  double throughput{0.};
+  double p50_us{0.};
+  double p99_us{0.};
+  double avg_batch{0.};
+};
+
+LoadResult RunLoad(std::shared_ptr<PaddlePredictor> predictor,
+                   const BatchingConfig& config,
+                   const BatchTensors& request,
+                   int clients) {
+  BatchingPredictor batching(predictor, config);
+  lite::profile::LatencyHistogram latency;
+  std::mutex latency_mutex;
+  std::vector<std::thread> threads;
+  auto start = lite::GetCurrentUS();
+  for (int c = 0; c < clients; ++c) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < FLAGS_requests; ++i) {
+        auto begin = lite::GetCurrentUS();
+        batching.Run(request);
+        auto end = lite::GetCurrentUS();
+        std::lock_guard<std::mutex> lock(latency_mutex);
+        latency.Add(end - begin);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto end = lite::GetCurrentUS();
+
+  LoadResult result;
+  result.p50_us = latency.Percentile(50);
+  result.p99_us = latency.Percentile(99);
+  result.throughput = 1e6 * clients * FLAGS_requests / (end - start);
+  result.avg_batch = static_cast<double>(batching.samples()) /
+                     std::max<int64_t>(1, batching.runs());
+  return result;
+}
+
+void Run(const shape_t& sample_shape) {
+  CxxConfig config;
+  config.set_model_dir(FLAGS_model_dir);
+  config.set_threads(FLAGS_threads);
+  config.set_valid_places({Place{TARGET(kX86), PRECISION(kFloat)},
+                           Place{TARGET(kARM), PRECISION(kFloat)},
+                           Place{TARGET(kHost), PRECISION(kFloat)}});
+  auto predictor = CreatePaddlePredictor(config);
+
+  BatchTensors request(1);
+  shape_t shape = sample_shape;
+  lod_t lod;
+  if (FLAGS_seq_len > 0) {
+    shape[0] *= FLAGS_seq_len;
+    lod.push_back({0, static_cast<uint64_t>(shape[0])});
+  }
+  int64_t numel = 1;
+  for (auto dim : shape) numel *= dim;
+  std::vector<float> data(numel, 1.f);
+  request[0].Assign(PrecisionType::kFloat, shape, data.data(), lod);
+
+  for (int i = 0; i < FLAGS_warmup; ++i) {
+    BatchingPredictor(predictor, BatchingConfig()).Run(request);
+  }
+
+  BatchingConfig batched;
+  batched.max_batch_size = FLAGS_max_batch_size;
+  batched.batch_timeout_us = FLAGS_batch_timeout_us;
+  BatchingConfig unbatched;
+  unbatched.max_batch_size = 1;
+  unbatched.batch_timeout_us = 0;
+
+  printf("%-10s %8s %14s %12s %12s %10s\n",
+         "mode",
+         "clients",
+         "throughput/s",
+         "p50(ms)",
+         "p99(ms)",
+         "avg_batch");
+  for (auto& clients : lite::Split(FLAGS_clients, ",")) {
+    int n = std::stoi(clients);
+    for (auto* mode : {"unbatched", "batched"}) {
+      auto result = RunLoad(predictor,
+                            std::string(mode) == "batched" ? batched
+                                                           : unbatched,
+                            request,
+                            n);
+      printf("%-10s %8d %14.1f %12.3f %12.3f %10.2f\n",
+             mode,
+             n,
+             result.throughput,
+             result.p50_us / 1000.,
+             result.p99_us / 1000.,
+             result.avg_batch);
+    }
+  }
+}
+
+}  // namespace lite_api
+}  // namespace paddle
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  if (FLAGS_model_dir == "") {
+    LOG(INFO) << "usage: --model_dir /path/to/your/model --input_shape 1,100";
+    exit(0);
+  }
+  paddle::lite_api::shape_t shape;
+  for (auto& dim : paddle::lite::Split(FLAGS_input_shape, ",")) {
+    shape.push_back(std::stoll(dim));
+  }
+  paddle::lite_api::Run(shape);
+  return 0;
+}
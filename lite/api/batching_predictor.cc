@@ -0,0 +1,406 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/api/batching_predictor.h"
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "lite/utils/cp_logging.h"
+
+namespace paddle {
+namespace lite_api {
+
+namespace {
+int64_t RowNumel(const shape_t& shape) {
+  int64_t numel = 1;
+  for (size_t i = 1; i < shape.size(); ++i) {
+    numel *= shape[i];
+  }
+  return numel;
+}
+
+const void* TensorData(const Tensor& tensor, PrecisionType precision) {
+  switch (precision) {
+    case PrecisionType::kFloat:
+      return tensor.data<float>();
+    case PrecisionType::kInt8:
+      return tensor.data<int8_t>();
+    case PrecisionType::kInt32:
+      return tensor.data<int32_t>();
+    case PrecisionType::kInt64:
+      return tensor.data<int64_t>();
+    default:
+      LOG(FATAL) << "Unsupported precision " << PrecisionToStr(precision);
+  }
+  return nullptr;
+}
+
+void* TensorMutableData(Tensor* tensor, PrecisionType precision) {
+  switch (precision) {
+    case PrecisionType::kFloat:
+      return tensor->mutable_data<float>();
+    case PrecisionType::kInt8:
+      return tensor->mutable_data<int8_t>();
+    case PrecisionType::kInt32:
+      return tensor->mutable_data<int>();
+    case PrecisionType::kInt64:
+      return tensor->mutable_data<int64_t>();
+    default:
+      LOG(FATAL) << "Unsupported precision " << PrecisionToStr(precision);
+  }
+  return nullptr;
+}
+
+bool SupportedPrecision(PrecisionType precision) {
+  return precision == PrecisionType::kFloat ||
+         precision == PrecisionType::kInt8 ||
+         precision == PrecisionType::kInt32 ||
+         precision == PrecisionType::kInt64;
+}
+
+std::exception_ptr Error(const std::string& message) {
+  return std::make_exception_ptr(std::runtime_error(message));
+}
+
+// Why the inputs of a request can not be run, or an empty string.
+std::string CheckInputs(const BatchTensors& inputs, size_t num_inputs) {
+  std::stringstream ss;
+  if (inputs.size() != num_inputs) {
+    ss << "Expect an input per feed, " << num_inputs << " inputs, got "
+       << inputs.size();
+    return ss.str();
+  }
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    auto& input = inputs[i];
+    if (!SupportedPrecision(input.precision)) {
+      ss << "Unsupported precision " << PrecisionToStr(input.precision)
+         << " of the input " << i;
+    } else if (input.shape.empty()) {
+      ss << "The input " << i << " should have a batch dim";
+    } else if (input.buffer.size() !=
+               static_cast<size_t>(input.numel()) *
+                   PrecisionTypeLength(input.precision)) {
+      ss << "The input " << i << " has " << input.buffer.size()
+         << " bytes for " << input.numel() << " elements";
+    } else if (!input.lod.empty() &&
+               (input.lod[0].empty() ||
+                input.lod.back().back() !=
+                    static_cast<uint64_t>(input.shape[0]))) {
+      ss << "The LoD of the input " << i << " does not cover the rows";
+    }
+    if (!ss.str().empty()) return ss.str();
+  }
+  return "";
+}
+
+// The requests can be merged if all their inputs match but the first dim.
+bool Mergeable(const BatchTensors& a, const BatchTensors& b) {
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].precision != b[i].precision ||
+        a[i].shape.size() != b[i].shape.size() ||
+        a[i].lod.size() != b[i].lod.size()) {
+      return false;
+    }
+    for (size_t j = 1; j < a[i].shape.size(); ++j) {
+      if (a[i].shape[j] != b[i].shape[j]) return false;
+    }
+  }
+  return true;
+}
+
+// Append `lod` after `merged`, each level shifted by the size of the same
+// level merged so far.
+void AppendLoD(const lod_t& lod, lod_t* merged) {
+  if (merged->empty()) merged->assign(lod.size(), {0});
+  for (size_t level = 0; level < lod.size(); ++level) {
+    auto& offsets = (*merged)[level];
+    uint64_t base = offsets.back();
+    for (size_t i = 1; i < lod[level].size(); ++i) {
+      offsets.push_back(base + lod[level][i]);
+    }
+  }
+}
+
+// The LoD of the top level sequences [begin, end), rebased to 0. The rows
+// they cover are returned in [row_begin, row_end). False if `lod` does not
+// cover the sequences.
+bool SliceLoD(const lod_t& lod,
+              uint64_t begin,
+              uint64_t end,
+              lod_t* sliced,
+              uint64_t* row_begin,
+              uint64_t* row_end) {
+  sliced->assign(lod.size(), {});
+  for (size_t level = 0; level < lod.size(); ++level) {
+    auto& offsets = lod[level];
+    if (end >= offsets.size()) return false;
+    for (uint64_t i = begin; i <= end; ++i) {
+      (*sliced)[level].push_back(offsets[i] - offsets[begin]);
+    }
+    begin = offsets[begin];
+    end = offsets[end];
+  }
+  *row_begin = begin;
+  *row_end = end;
+  return true;
+}
+}  // namespace
+
+void BatchTensor::Assign(PrecisionType precision,
+                         const shape_t& shape,
+                         const void* data,
+                         const lod_t& lod) {
+  this->precision = precision;
+  this->shape = shape;
+  this->lod = lod;
+  const char* bytes = static_cast<const char*>(data);
+  buffer.assign(bytes, bytes + numel() * PrecisionTypeLength(precision));
+}
+
+int64_t BatchTensor::numel() const {
+  return shape.empty() ? 0 : shape[0] * RowNumel(shape);
+}
+
+void BatchTensor::CopyTo(Tensor* tensor) const {
+  tensor->Resize(shape);
+  void* data = TensorMutableData(tensor, precision);
+  std::memcpy(data, buffer.data(), buffer.size());
+  tensor->SetLoD(lod);
+}
+
+void BatchTensor::CopyFrom(const Tensor& tensor, PrecisionType precision) {
+  Assign(
+      precision, tensor.shape(), TensorData(tensor, precision), tensor.lod());
+}
+
+BatchingPredictor::BatchingPredictor(std::shared_ptr<PaddlePredictor> predictor,
+                                     const BatchingConfig& config)
+    : predictor_(std::move(predictor)), config_(config) {
+  CHECK(predictor_);
+  CHECK_GT(config_.max_batch_size, 0);
+  for (auto precision : config_.output_precisions) {
+    CHECK(SupportedPrecision(precision))
+        << "Unsupported output precision " << PrecisionToStr(precision);
+  }
+  num_inputs_ = predictor_->GetInputNames().size();
+  num_outputs_ = predictor_->GetOutputNames().size();
+  worker_ = std::thread(&BatchingPredictor::Loop, this);
+}
+
+BatchingPredictor::~BatchingPredictor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+std::future<BatchTensors> BatchingPredictor::Submit(BatchTensors inputs) {
+  std::unique_ptr<Request> request(new Request);
+  auto outputs = request->outputs.get_future();
+  std::string error = CheckInputs(inputs, num_inputs_);
+  if (!error.empty()) {
+    request->outputs.set_exception(Error(error));
+    return outputs;
+  }
+  // The samples are the top level sequences of the first input with LoD, or
+  // the rows otherwise.
+  request->rows = inputs[0].shape[0];
+  request->samples = request->rows;
+  for (auto& input : inputs) {
+    if (!input.lod.empty()) {
+      request->samples = input.lod[0].size() - 1;
+      break;
+    }
+  }
+  request->inputs = std::move(inputs);
+  request->arrival = clock_t::now();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(request));
+  }
+  cv_.notify_one();
+  return outputs;
+}
+
+void BatchingPredictor::Loop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) return;
+
+    // Wait for more requests until the batch is full or the oldest request
+    // times out. Only the requests that can be merged with the oldest one
+    // count, the others lead the following batches.
+    auto deadline = queue_.front()->arrival +
+                    std::chrono::microseconds(config_.batch_timeout_us);
+    auto gathered = [this] {
+      int64_t samples = 0;
+      for (auto& request : queue_) {
+        if (!Mergeable(queue_.front()->inputs, request->inputs)) break;
+        samples += request->samples;
+        if (samples >= config_.max_batch_size) return true;
+      }
+      return false;
+    };
+    while (!stop_ && !gathered() &&
+           cv_.wait_until(lock, deadline) != std::cv_status::timeout) {
+    }
+
+    Batch batch;
+    int64_t samples = 0;
+    while (!queue_.empty()) {
+      auto& request = queue_.front();
+      if (!batch.empty() &&
+          (samples + request->samples > config_.max_batch_size ||
+           !Mergeable(batch.front()->inputs, request->inputs))) {
+        break;
+      }
+      samples += request->samples;
+      batch.push_back(std::move(request));
+      queue_.pop_front();
+    }
+    lock.unlock();
+    RunBatch(&batch);
+    lock.lock();
+  }
+}
+
+void BatchingPredictor::RunBatch(Batch* batch) {
+  // The requests of a batch which can not run get the error instead of their
+  // outputs, and the batching thread goes on with the next batch.
+  auto fail = [batch](const std::exception_ptr& error) {
+    for (auto& request : *batch) {
+      request->outputs.set_exception(error);
+    }
+  };
+
+  int64_t rows = 0;
+  int64_t samples = 0;
+  for (auto& request : *batch) {
+    rows += request->rows;
+    samples += request->samples;
+  }
+
+  try {
+    // Gather the inputs along the first dim and merge their LoD.
+    for (size_t i = 0; i < num_inputs_; ++i) {
+      auto& first = batch->front()->inputs[i];
+      auto input = predictor_->GetInput(i);
+      shape_t shape = first.shape;
+      shape[0] = 0;
+      for (auto& request : *batch) {
+        shape[0] += request->inputs[i].shape[0];
+      }
+      input->Resize(shape);
+      auto* dst =
+          static_cast<char*>(TensorMutableData(input.get(), first.precision));
+      lod_t lod;
+      for (auto& request : *batch) {
+        auto& x = request->inputs[i];
+        std::memcpy(dst, x.buffer.data(), x.buffer.size());
+        dst += x.buffer.size();
+        if (!x.lod.empty()) AppendLoD(x.lod, &lod);
+      }
+      input->SetLoD(lod);
+    }
+
+    predictor_->Run();
+  } catch (...) {
+    fail(std::current_exception());
+    return;
+  }
+  ++runs_;
+  samples_ += samples;
+
+  std::vector<BatchTensors> outputs(batch->size(), BatchTensors(num_outputs_));
+  for (size_t i = 0; i < num_outputs_; ++i) {
+    auto output = predictor_->GetOutput(i);
+    PrecisionType precision = i < config_.output_precisions.size()
+                                  ? config_.output_precisions[i]
+                                  : PrecisionType::kFloat;
+    shape_t shape = output->shape();
+    lod_t lod = output->lod();
+    std::stringstream error;
+    if (shape.empty()) {
+      error << "The output " << i << " has no batch dim";
+      fail(Error(error.str()));
+      return;
+    }
+    // An output of another precision than the one given would be scattered
+    // with the wrong row size.
+    size_t numel = shape[0] * RowNumel(shape);
+    if (output->memory_size() != numel * PrecisionTypeLength(precision)) {
+      error << "The output " << i << " has " << output->memory_size()
+            << " bytes for " << numel << " elements, its precision is not "
+            << PrecisionToStr(precision) << ", set output_precisions";
+      fail(Error(error.str()));
+      return;
+    }
+    auto* src = static_cast<const char*>(TensorData(*output, precision));
+    size_t row_bytes = RowNumel(shape) * PrecisionTypeLength(precision);
+
+    bool by_lod = !lod.empty() &&
+                  lod[0].size() == static_cast<size_t>(samples) + 1;
+    bool by_rows = !by_lod && shape[0] == rows;
+    bool by_samples = !by_lod && !by_rows && shape[0] == samples;
+    if (!by_lod && !by_rows && !by_samples) {
+      error << "Can not scatter the output " << i << " of " << shape[0]
+            << " rows to " << batch->size() << " requests";
+      fail(Error(error.str()));
+      return;
+    }
+
+    uint64_t sample_begin = 0;
+    uint64_t row_begin = 0;
+    for (size_t r = 0; r < batch->size(); ++r) {
+      auto& request = (*batch)[r];
+      auto& y = outputs[r][i];
+      uint64_t begin = row_begin;
+      uint64_t end = 0;
+      if (by_lod) {
+        if (!SliceLoD(lod,
+                      sample_begin,
+                      sample_begin + request->samples,
+                      &y.lod,
+                      &begin,
+                      &end) ||
+            end < begin || end > static_cast<uint64_t>(shape[0])) {
+          error << "The LoD of the output " << i << " does not cover its "
+                << shape[0] << " rows";
+          fail(Error(error.str()));
+          return;
+        }
+      } else {
+        end = begin + (by_rows ? request->rows : request->samples);
+      }
+      y.precision = precision;
+      y.shape = shape;
+      y.shape[0] = end - begin;
+      y.buffer.assign(src + begin * row_bytes, src + end * row_bytes);
+      sample_begin += request->samples;
+      row_begin = end;
+    }
+  }
+
+  for (size_t r = 0; r < batch->size(); ++r) {
+    (*batch)[r]->outputs.set_value(std::move(outputs[r]));
+  }
+}
+
+}  // namespace lite_api
+}  // namespace paddle
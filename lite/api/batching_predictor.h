@@ -0,0 +1,139 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+ * This file implements BatchingPredictor, a dynamic batching layer on top of
+ * PaddlePredictor for serving many concurrent small requests. The requests are
+ * queued, merged along the batch dimension until `max_batch_size` samples are
+ * gathered or the oldest one has waited `batch_timeout_us`, run once, and the
+ * outputs are scattered back to the callers.
+ */
+#pragma once
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+#include "lite/api/paddle_api.h"
+
+namespace paddle {
+namespace lite_api {
+
+/// A host tensor owned by a request or a response of the BatchingPredictor.
+struct LITE_API BatchTensor {
+  shape_t shape;
+  lod_t lod;
+  PrecisionType precision{PrecisionType::kFloat};
+  std::vector<char> buffer;
+
+  void Assign(PrecisionType precision,
+              const shape_t& shape,
+              const void* data,
+              const lod_t& lod = lod_t());
+
+  template <typename T>
+  const T* data() const {
+    return reinterpret_cast<const T*>(buffer.data());
+  }
+  template <typename T>
+  T* mutable_data() {
+    return reinterpret_cast<T*>(buffer.data());
+  }
+  int64_t numel() const;
+
+  /// Feed to or fetch from a tensor of a predictor. The precision of the
+  /// tensor fetched is given, it is unknown if the tensor was not written by
+  /// a typed mutable_data.
+  void CopyTo(Tensor* tensor) const;
+  void CopyFrom(const Tensor& tensor, PrecisionType precision);
+};
+
+using BatchTensors = std::vector<BatchTensor>;
+
+struct LITE_API BatchingConfig {
+  /// The maximum samples merged in a run. A sample is a row of the inputs, or
+  /// a top level sequence if an input has LoD. A larger request runs alone.
+  int max_batch_size{16};
+  /// How long the oldest request waits for others before the batch runs.
+  int64_t batch_timeout_us{1000};
+  /// The precisions of the outputs by index, kFloat for the ones not listed.
+  /// A batch the outputs of which are of another precision fails.
+  std::vector<PrecisionType> output_precisions;
+};
+
+/// All the requests share a predictor, which is only run by the batching
+/// thread. The inputs of a request are in the order of `GetInputNames()`, and
+/// the requests are merged only if their inputs have the same precisions, the
+/// same LoD levels and the same dims but the first one.
+///
+/// Every output is scattered back in one of the ways below, the first one
+/// that matches the merged batch:
+/// - by the top level sequences of the output LoD;
+/// - by the rows of the inputs, if the output has as many rows;
+/// - by the samples, if the output has a row per sample, e.g. a sequence pool.
+class LITE_API BatchingPredictor {
+ public:
+  BatchingPredictor(std::shared_ptr<PaddlePredictor> predictor,
+                    const BatchingConfig& config);
+  /// Runs the pending requests before returning.
+  ~BatchingPredictor();
+
+  /// The future holds a std::runtime_error, and the batching thread goes on,
+  /// if the inputs are malformed, or if the batch of the request can not run
+  /// or its outputs can not be scattered. All the requests of such a batch
+  /// fail.
+  std::future<BatchTensors> Submit(BatchTensors inputs);
+  /// Submit and wait for the outputs, throws as the future.
+  BatchTensors Run(BatchTensors inputs) { return Submit(inputs).get(); }
+
+  /// The runs of the predictor and the samples they took, e.g. for the
+  /// average batch size.
+  int64_t runs() const { return runs_; }
+  int64_t samples() const { return samples_; }
+
+ private:
+  using clock_t = std::chrono::steady_clock;
+
+  struct Request {
+    BatchTensors inputs;
+    int64_t rows{0};
+    int64_t samples{0};
+    std::promise<BatchTensors> outputs;
+    clock_t::time_point arrival;
+  };
+  using Batch = std::vector<std::unique_ptr<Request>>;
+
+  void Loop();
+  void RunBatch(Batch* batch);
+
+  std::shared_ptr<PaddlePredictor> predictor_;
+  BatchingConfig config_;
+  size_t num_inputs_{0};
+  size_t num_outputs_{0};
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::unique_ptr<Request>> queue_;
+  bool stop_{false};
+  std::atomic<int64_t> runs_{0};
+  std::atomic<int64_t> samples_{0};
+  std::thread worker_;
+};
+
+}  // namespace lite_api
+}  // namespace paddle
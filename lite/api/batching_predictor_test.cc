@@ -0,0 +1,192 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/api/batching_predictor.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "lite/core/tensor.h"
+
+namespace paddle {
+namespace lite_api {
+
+// y = 2 * x keeps the rows and the LoD of x, and sum holds the sum of every
+// top level sequence of x, or of every row if x has no LoD.
+class DoublePredictor : public PaddlePredictor {
+ public:
+  std::unique_ptr<Tensor> GetInput(int i) override {
+    return std::unique_ptr<Tensor>(new Tensor(&x_));
+  }
+  std::unique_ptr<const Tensor> GetOutput(int i) const override {
+    return std::unique_ptr<const Tensor>(new Tensor(i ? &sum_ : &y_));
+  }
+  void Run() override {
+    ++runs;
+    int64_t rows = x_.dims()[0];
+    int64_t width = x_.numel() / rows;
+    y_.Resize(x_.dims());
+    y_.set_lod(x_.lod());
+    auto* x = x_.data<float>();
+    auto* y = y_.mutable_data<float>();
+    for (int64_t i = 0; i < x_.numel(); ++i) {
+      y[i] = 2 * x[i];
+    }
+    std::vector<uint64_t> offsets;
+    if (x_.lod().empty()) {
+      for (int64_t i = 0; i <= rows; ++i) offsets.push_back(i);
+    } else {
+      offsets = x_.lod()[0];
+    }
+    sum_.Resize({static_cast<int64_t>(offsets.size()) - 1, 1});
+    auto* sum = sum_.mutable_data<float>();
+    for (size_t s = 0; s + 1 < offsets.size(); ++s) {
+      sum[s] = 0;
+      for (uint64_t i = offsets[s] * width; i < offsets[s + 1] * width; ++i) {
+        sum[s] += x[i];
+      }
+    }
+  }
+  std::shared_ptr<PaddlePredictor> Clone() override { return nullptr; }
+  std::string GetVersion() const override { return ""; }
+  std::vector<std::string> GetInputNames() override { return {"x"}; }
+  std::vector<std::string> GetOutputNames() override { return {"y", "sum"}; }
+  std::unique_ptr<Tensor> GetInputByName(const std::string& name) override {
+    return GetInput(0);
+  }
+  std::unique_ptr<const Tensor> GetTensor(
+      const std::string& name) const override {
+    return nullptr;
+  }
+
+  int runs{0};
+
+ private:
+  lite::Tensor x_;
+  lite::Tensor y_;
+  lite::Tensor sum_;
+};
+
+BatchTensors MakeInput(const shape_t& shape, float start, const lod_t& lod) {
+  std::vector<float> data(shape[0] * shape[1]);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = start + i;
+  }
+  BatchTensors inputs(1);
+  inputs[0].Assign(PrecisionType::kFloat, shape, data.data(), lod);
+  return inputs;
+}
+
+TEST(BatchingPredictor, rows) {
+  auto predictor = std::make_shared<DoublePredictor>();
+  BatchingConfig config;
+  config.max_batch_size = 4;
+  // Long enough for all the requests to be queued.
+  config.batch_timeout_us = 1000000;
+  std::vector<std::future<BatchTensors>> results;
+  {
+    BatchingPredictor batching(predictor, config);
+    // The first two requests fill a batch, the third one times out alone
+    // when the batching predictor is destroyed.
+    results.push_back(batching.Submit(MakeInput({1, 3}, 0, {})));
+    results.push_back(batching.Submit(MakeInput({3, 3}, 100, {})));
+    results.push_back(batching.Submit(MakeInput({2, 3}, 200, {})));
+    results[0].wait();
+    EXPECT_EQ(batching.runs(), 1);
+  }
+  EXPECT_EQ(predictor->runs, 2);
+
+  std::vector<int64_t> rows({1, 3, 2});
+  std::vector<float> starts({0, 100, 200});
+  for (size_t r = 0; r < results.size(); ++r) {
+    auto outputs = results[r].get();
+    ASSERT_EQ(outputs.size(), 2);
+    ASSERT_EQ(outputs[0].shape, shape_t({rows[r], 3}));
+    ASSERT_EQ(outputs[1].shape, shape_t({rows[r], 1}));
+    for (int64_t i = 0; i < rows[r] * 3; ++i) {
+      EXPECT_EQ(outputs[0].data<float>()[i], 2 * (starts[r] + i));
+    }
+    for (int64_t i = 0; i < rows[r]; ++i) {
+      EXPECT_EQ(outputs[1].data<float>()[i], 3 * (starts[r] + 3 * i) + 3);
+    }
+  }
+}
+
+TEST(BatchingPredictor, lod) {
+  auto predictor = std::make_shared<DoublePredictor>();
+  BatchingConfig config;
+  config.max_batch_size = 3;
+  config.batch_timeout_us = 1000000;
+  BatchingPredictor batching(predictor, config);
+  // Two sequences of 1 and 2 rows, then a sequence of 3 rows.
+  auto first = batching.Submit(MakeInput({3, 2}, 0, {{0, 1, 3}}));
+  auto second = batching.Submit(MakeInput({3, 2}, 10, {{0, 3}}));
+
+  auto y = first.get();
+  EXPECT_EQ(predictor->runs, 1);
+  EXPECT_EQ(batching.samples(), 3);
+  ASSERT_EQ(y[0].shape, shape_t({3, 2}));
+  ASSERT_EQ(y[0].lod, lod_t({{0, 1, 3}}));
+  // The sums have a row per sequence.
+  ASSERT_EQ(y[1].shape, shape_t({2, 1}));
+  EXPECT_EQ(y[1].data<float>()[0], 0 + 1);
+  EXPECT_EQ(y[1].data<float>()[1], 2 + 3 + 4 + 5);
+
+  y = second.get();
+  ASSERT_EQ(y[0].shape, shape_t({3, 2}));
+  ASSERT_EQ(y[0].lod, lod_t({{0, 3}}));
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(y[0].data<float>()[i], 2 * (10 + i));
+  }
+  ASSERT_EQ(y[1].shape, shape_t({1, 1}));
+  EXPECT_EQ(y[1].data<float>()[0], 10 * 6 + 15);
+}
+
+TEST(BatchingPredictor, errors) {
+  auto predictor = std::make_shared<DoublePredictor>();
+  BatchingConfig config;
+  config.max_batch_size = 4;
+  config.batch_timeout_us = 0;
+  BatchingPredictor batching(predictor, config);
+
+  // A malformed request fails alone.
+  auto input = MakeInput({2, 3}, 0, {});
+  input[0].buffer.resize(5);
+  EXPECT_THROW(batching.Run(input), std::runtime_error);
+  EXPECT_THROW(batching.Run(MakeInput({2, 3}, 0, {{0, 1}})),
+               std::runtime_error);
+  EXPECT_THROW(batching.Run(BatchTensors(2)), std::runtime_error);
+  EXPECT_EQ(predictor->runs, 0);
+
+  // The batching thread goes on after it.
+  auto y = batching.Run(MakeInput({2, 3}, 0, {}));
+  ASSERT_EQ(y[0].shape, shape_t({2, 3}));
+  EXPECT_EQ(y[0].data<float>()[5], 10);
+}
+
+TEST(BatchingPredictor, output_precision) {
+  auto predictor = std::make_shared<DoublePredictor>();
+  BatchingConfig config;
+  config.batch_timeout_us = 0;
+  // The outputs are float, their rows would be scattered as int64 ones.
+  config.output_precisions = {PrecisionType::kInt64};
+  BatchingPredictor batching(predictor, config);
+  EXPECT_THROW(batching.Run(MakeInput({2, 3}, 0, {})), std::runtime_error);
+  EXPECT_EQ(predictor->runs, 1);
+  EXPECT_THROW(batching.Run(MakeInput({1, 3}, 0, {})), std::runtime_error);
+  EXPECT_EQ(predictor->runs, 2);
+}
+
+}  // namespace lite_api
+}  // namespace paddle
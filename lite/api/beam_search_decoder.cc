@@ -0,0 +1,116 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/api/beam_search_decoder.h"
+#include <algorithm>
+#include "lite/backends/x86/math/beam_search_decoder.h"
+#include "lite/backends/x86/thread_pool.h"
+#include "lite/utils/cp_logging.h"
+
+namespace paddle {
+namespace lite_api {
+
+struct BeamSearchDecoder::Impl {
+  explicit Impl(const BeamSearchConfig& config)
+      : config(config),
+        decoder(config.max_batch,
+                config.beam_size,
+                config.vocab_size,
+                config.max_steps,
+                config.end_id) {
+    if (config.threads > 1) {
+      pool.reset(new lite::x86::ThreadPool(config.threads));
+      decoder.SetThreadPool(pool.get());
+    }
+  }
+
+  int rows() const { return decoder.batch() * decoder.beam_size(); }
+
+  const BeamSearchConfig config;
+  std::unique_ptr<lite::x86::ThreadPool> pool;
+  lite::x86::math::BeamSearchDecoder decoder;
+};
+
+// The sizes are checked by the decoder of the math library.
+BeamSearchDecoder::BeamSearchDecoder(const BeamSearchConfig& config) {
+  CHECK(config.end_id >= 0 && config.end_id < config.vocab_size)
+      << "end_id " << config.end_id << " out of the vocabulary";
+  impl_.reset(new Impl(config));
+}
+
+BeamSearchDecoder::~BeamSearchDecoder() = default;
+
+void BeamSearchDecoder::Start(int batch) { impl_->decoder.Start(batch); }
+
+void BeamSearchDecoder::Step(const Tensor& logits) {
+  auto shape = logits.shape();
+  CHECK(!shape.empty() && shape.back() == impl_->config.vocab_size)
+      << "the logits should have " << impl_->config.vocab_size << " columns";
+  int64_t rows = 1;
+  for (size_t i = 0; i + 1 < shape.size(); ++i) rows *= shape[i];
+  CHECK_EQ(rows, impl_->rows()) << "the logits should have batch * beam_size "
+                                   "rows";
+  Step(logits.data<float>());
+}
+
+void BeamSearchDecoder::Step(const float* logits) {
+  impl_->decoder.Step(logits);
+}
+
+int BeamSearchDecoder::batch() const { return impl_->decoder.batch(); }
+
+int BeamSearchDecoder::step() const { return impl_->decoder.step(); }
+
+bool BeamSearchDecoder::done(int request) const {
+  CHECK(request >= 0 && request < batch());
+  return impl_->decoder.done(request);
+}
+
+bool BeamSearchDecoder::finished() const { return impl_->decoder.finished(); }
+
+const int64_t* BeamSearchDecoder::ids() const {
+  return impl_->decoder.ids();
+}
+
+const int* BeamSearchDecoder::parents() const {
+  return impl_->decoder.parents();
+}
+
+const float* BeamSearchDecoder::scores() const {
+  return impl_->decoder.scores();
+}
+
+void BeamSearchDecoder::GetIds(Tensor* ids) const {
+  const int rows = impl_->rows();
+  ids->Resize({rows, 1});
+  std::copy(this->ids(), this->ids() + rows, ids->mutable_data<int64_t>());
+}
+
+void BeamSearchDecoder::GetParents(Tensor* parents) const {
+  const int rows = impl_->rows();
+  parents->Resize({rows});
+  std::copy(
+      this->parents(), this->parents() + rows, parents->mutable_data<int>());
+}
+
+void BeamSearchDecoder::GetResult(
+    int request,
+    std::vector<std::vector<int64_t>>* sentences,
+    std::vector<float>* sentence_scores) const {
+  CHECK(request >= 0 && request < batch());
+  impl_->decoder.GetResult(request, sentences, sentence_scores);
+}
+
+}  // namespace lite_api
+}  // namespace paddle
@@ -0,0 +1,97 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+ * This file implements BeamSearchDecoder, a beam search over the logits of a
+ * decoder predictor run step by step, for the models whose decoder is
+ * exported without its while loop. The caller runs the predictor on the
+ * words and the state selected by the last step, and gives its logits to the
+ * next step, until all the requests are done.
+ */
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "lite/api/paddle_api.h"
+
+namespace paddle {
+namespace lite_api {
+
+struct LITE_API BeamSearchConfig {
+  /// The requests decoded together, all the state is allocated for them once.
+  int max_batch{1};
+  int beam_size{4};
+  int vocab_size{0};
+  /// The steps after which the beams that did not end are cut.
+  int max_steps{32};
+  int end_id{0};
+  /// The threads the rows of the logits are scored on.
+  int threads{1};
+};
+
+/// The beams of request r are the rows r * beam_size to (r + 1) * beam_size
+/// of the logits, at the first step only their first row is read. A beam
+/// ending with `end_id` keeps its score, and a request whose beams all ended
+/// is done, its rows are skipped.
+///
+/// A decoding loop:
+///
+///   decoder.Start(batch);
+///   while (!decoder.finished()) {
+///     // feed the words of decoder.GetIds(), gather the state by the rows of
+///     // decoder.GetParents(), then run the predictor
+///     decoder.Step(*predictor->GetOutput(0));
+///   }
+///   decoder.GetResult(request, &sentences, &scores);
+class LITE_API BeamSearchDecoder {
+ public:
+  explicit BeamSearchDecoder(const BeamSearchConfig& config);
+  ~BeamSearchDecoder();
+
+  /// Start the decoding of `batch` requests, up to max_batch.
+  void Start(int batch);
+  /// The logits are [batch * beam_size, vocab_size] floats.
+  void Step(const Tensor& logits);
+  void Step(const float* logits);
+
+  int batch() const;
+  int step() const;
+  bool done(int request) const;
+  /// Whether all the requests are done or max_steps are run.
+  bool finished() const;
+
+  /// The words selected by the last step, and the rows of their parent beams
+  /// in its logits, batch * beam_size values sorted by score in each request.
+  const int64_t* ids() const;
+  const int* parents() const;
+  const float* scores() const;
+  /// Copy them to the tensors fed to the next step, the ids as
+  /// [batch * beam_size, 1] int64 and the parents as [batch * beam_size]
+  /// int32.
+  void GetIds(Tensor* ids) const;
+  void GetParents(Tensor* parents) const;
+
+  /// The beam_size sequences of `request` sorted by score, up to their first
+  /// end_id included.
+  void GetResult(int request,
+                 std::vector<std::vector<int64_t>>* sentences,
+                 std::vector<float>* sentence_scores) const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace lite_api
+}  // namespace paddle
@@ -0,0 +1,108 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/api/beam_search_decoder.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+#include "lite/backends/x86/math/beam_search_decoder.h"
+#include "lite/core/tensor.h"
+
+namespace paddle {
+namespace lite_api {
+
+// The logits of a toy decoder, which depend on the request of the row, the
+// step, the last word and a state summing the words of the beam, gathered
+// by the parents as a decoder state.
+void FakeLogits(int beam_size,
+                int step,
+                const lite::Tensor& ids,
+                const std::vector<int64_t>& state,
+                int vocab,
+                lite::Tensor* logits) {
+  const int rows = static_cast<int>(state.size());
+  logits->Resize({rows, vocab});
+  auto* y = logits->mutable_data<float>();
+  for (int row = 0; row < rows; ++row) {
+    int64_t last_id = step > 0 ? ids.data<int64_t>()[row] : -1;
+    uint32_t seed = static_cast<uint32_t>(row / beam_size * 7919 +
+                                          step * 104729 + last_id * 15485863 +
+                                          state[row] * 31 + 1);
+    for (int i = 0; i < vocab; ++i) {
+      seed = seed * 1664525u + 1013904223u;
+      y[row * vocab + i] = static_cast<float>((seed >> 8) % 384) / 64.f - 3.f;
+    }
+    y[row * vocab] += 0.5f * step;
+  }
+}
+
+TEST(BeamSearchDecoder, decode) {
+  const int batch = 3;
+  const int vocab = 40;
+  for (int beam_size : {1, 3}) {
+    for (int threads : {1, 2}) {
+      BeamSearchConfig config;
+      config.max_batch = 4;
+      config.beam_size = beam_size;
+      config.vocab_size = vocab;
+      config.max_steps = 10;
+      config.threads = threads;
+      BeamSearchDecoder decoder(config);
+      lite::x86::math::BeamSearchDecoder expected(config.max_batch,
+                                                  beam_size,
+                                                  vocab,
+                                                  config.max_steps,
+                                                  config.end_id);
+
+      lite::Tensor ids, parents, logits;
+      Tensor ids_api(&ids), parents_api(&parents), logits_api(&logits);
+      std::vector<int64_t> state(batch * beam_size, 0);
+      decoder.Start(batch);
+      expected.Start(batch);
+      while (!decoder.finished()) {
+        FakeLogits(beam_size, decoder.step(), ids, state, vocab, &logits);
+        decoder.Step(logits_api);
+        expected.Step(logits.data<float>());
+        ASSERT_EQ(decoder.step(), expected.step());
+        ASSERT_EQ(decoder.finished(), expected.finished());
+
+        decoder.GetIds(&ids_api);
+        decoder.GetParents(&parents_api);
+        ASSERT_EQ(ids_api.shape(), shape_t({batch * beam_size, 1}));
+        ASSERT_EQ(parents_api.shape(), shape_t({batch * beam_size}));
+        std::vector<int64_t> next_state(state.size());
+        for (size_t row = 0; row < state.size(); ++row) {
+          EXPECT_EQ(ids.data<int64_t>()[row], expected.ids()[row]);
+          EXPECT_EQ(parents.data<int>()[row], expected.parents()[row]);
+          next_state[row] =
+              state[parents.data<int>()[row]] + ids.data<int64_t>()[row];
+        }
+        state.swap(next_state);
+      }
+
+      std::vector<std::vector<int64_t>> sentences, expected_sentences;
+      std::vector<float> scores, expected_scores;
+      for (int r = 0; r < batch; ++r) {
+        decoder.GetResult(r, &sentences, &scores);
+        expected.GetResult(r, &expected_sentences, &expected_scores);
+        EXPECT_EQ(sentences, expected_sentences);
+        EXPECT_EQ(scores, expected_scores);
+        EXPECT_EQ(decoder.done(r), expected.done(r));
+      }
+    }
+  }
+}
+
+}  // namespace lite_api
+}  // namespace paddle
@@ -13,17 +13,124 @@
 // limitations under the License.
 
 #include "lite/api/cxx_api.h"
+#include <dirent.h>
+#include <unistd.h>
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <memory>
 #include <set>
 #include <string>
 #include <utility>
 #include <vector>
+#include "lite/core/version.h"
 #include "lite/utils/io.h"
 
 namespace paddle {
 namespace lite {
 
+namespace {
+
+// FNV-1a over 64-bit words, to name the entries of the optimized model cache.
+// It is not meant to resist collisions made on purpose.
+class ModelHasher {
+ public:
+  void Update(const char* data, size_t size) {
+    const uint64_t prime = 0x100000001b3ULL;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+      uint64_t word;
+      std::memcpy(&word, data + i, sizeof(word));
+      hash_ = (hash_ ^ word) * prime;
+    }
+    for (; i < size; ++i) {
+      hash_ = (hash_ ^ static_cast<unsigned char>(data[i])) * prime;
+    }
+    hash_ = (hash_ ^ size) * prime;
+  }
+  void Update(const std::string& x) { Update(x.data(), x.size()); }
+
+  bool UpdateFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    std::vector<char> buffer(1 << 20);
+    while (file) {
+      file.read(buffer.data(), buffer.size());
+      Update(buffer.data(), static_cast<size_t>(file.gcount()));
+    }
+    return true;
+  }
+
+  std::string HexDigest() const {
+    char digest[17];
+    snprintf(digest, sizeof(digest), "%016llx",
+             static_cast<unsigned long long>(hash_));  // NOLINT
+    return digest;
+  }
+
+ private:
+  uint64_t hash_{0xcbf29ce484222325ULL};
+};
+
+// The files of a model directory saved uncombined, sorted by name.
+std::vector<std::string> ListModelFiles(const std::string& dir) {
+  std::vector<std::string> files;
+  DIR* dir_fd = opendir(dir.c_str());
+  if (!dir_fd) return files;
+  while (dirent* dp = readdir(dir_fd)) {
+    std::string name(dp->d_name);
+    if (name[0] == '.' || IsDir(dir + "/" + name)) continue;
+    files.push_back(name);
+  }
+  closedir(dir_fd);
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+// The name of the cache entry of the model optimized with `config`, or an
+// empty string if the model files can not be read.
+std::string OptimizedModelKey(const lite_api::CxxConfig& config,
+                              const std::vector<Place>& valid_places) {
+  ModelHasher hasher;
+  hasher.Update(version());
+  for (auto& place : valid_places) {
+    hasher.Update(place.DebugString());
+  }
+  hasher.Update(config.memory_arena() ? "arena" : "no_arena");
+  hasher.Update(config.fuse_elementwise_chain() ? "chain" : "no_chain");
+  // The kernels picked by latency are measured with the threads, and on ARM
+  // on the cores bound by the power mode, of the predictor.
+  hasher.Update(std::to_string(config.threads()));
+#ifdef LITE_WITH_ARM
+  hasher.Update(std::to_string(static_cast<int>(config.power_mode())));
+#endif
+  for (auto& item : config.kernel_pick_input_shapes()) {
+    hasher.Update(item.first);
+    hasher.Update(reinterpret_cast<const char*>(item.second.data()),
+                  item.second.size() * sizeof(item.second[0]));
+  }
+  if (config.model_from_memory()) {
+    hasher.Update(config.model_file());
+    hasher.Update(config.param_file());
+  } else if (!config.model_file().empty() && !config.param_file().empty()) {
+    if (!hasher.UpdateFile(config.model_file()) ||
+        !hasher.UpdateFile(config.param_file())) {
+      return "";
+    }
+  } else {
+    auto files = ListModelFiles(config.model_dir());
+    if (files.empty()) return "";
+    for (auto& file : files) {
+      hasher.Update(file);
+      if (!hasher.UpdateFile(config.model_dir() + "/" + file)) return "";
+    }
+  }
+  return hasher.HexDigest();
+}
+
+}  // namespace
+
 void Predictor::SaveModel(const std::string &dir,
                           lite_api::LiteModelType model_type,
                           bool record_info) {
@@ -184,6 +291,16 @@ const lite::Tensor *Predictor::GetOutput(size_t offset) const {
   return out_var->GetMutable<lite::Tensor>();
 }
 
+void Predictor::BindOutputBuffer(size_t offset, void *data, size_t size) {
+  CHECK(output_names_.size() > offset)
+      << "The network has " << output_names_.size() << " outputs"
+      << ", the offset should be less than this.";
+  if (!program_generated_) {
+    GenRuntimeProgram();
+  }
+  program_->BindOutputBuffer(output_names_[offset], data, size);
+}
+
 std::vector<const lite::Tensor *> Predictor::GetOutputs() const {
   std::vector<const lite::Tensor *> outputs;
   size_t out_size = output_names_.size();
@@ -209,6 +326,36 @@ void Predictor::Build(const lite_api::CxxConfig &config,
   const std::string &param_file = config.param_file();
   const bool model_from_memory = config.model_from_memory();
   LOG(INFO) << "load from memory " << model_from_memory;
+  threads_ = config.threads();
+  optimizer_.SetLatencyPickInputShapes(config.kernel_pick_input_shapes());
+  optimizer_.SetMemoryPlannedAtRuntime(config.memory_arena());
+  optimizer_.SetFuseElementwiseChain(config.fuse_elementwise_chain());
+  memory_arena_ = config.memory_arena();
+  optimized_model_cache_hit_ = false;
+
+  // The NPU and XPU programs are generated for the shapes of the inputs set
+  // after Build, they are not cached.
+  bool cacheable = !config.optimized_model_cache_dir().empty() &&
+                   passes.empty() &&
+                   std::none_of(valid_places.begin(),
+                                valid_places.end(),
+                                [](const Place& place) {
+                                  return place.target == TARGET(kNPU) ||
+                                         place.target == TARGET(kXPU);
+                                });
+  std::string cache_path;
+  if (cacheable) {
+    std::string key = OptimizedModelKey(config, valid_places);
+    if (!key.empty()) {
+      cache_path = config.optimized_model_cache_dir() + "/" + key;
+    }
+  }
+  if (!cache_path.empty() && IsFileExists(cache_path + "/__model__.nb")) {
+    LOG(INFO) << "Load the optimized model from " << cache_path;
+    BuildFromOptimizedModel(cache_path);
+    optimized_model_cache_hit_ = true;
+    return;
+  }
 
   Build(model_path,
         model_file,
@@ -217,6 +364,47 @@ void Predictor::Build(const lite_api::CxxConfig &config,
         passes,
         model_type,
         model_from_memory);
+  if (!cache_path.empty()) {
+    SaveOptimizedModelCache(cache_path);
+  }
+}
+
+void Predictor::BuildFromOptimizedModel(const std::string &model_dir) {
+  LoadModelNaive(model_dir, scope_.get(), &program_desc_);
+  Program program(program_desc_, scope_, {});
+  program_.reset(new RuntimeProgram(&program));
+  exec_scope_ = program_->exec_scope();
+#ifdef LITE_WITH_X86
+  PrepareX86ThreadPool();
+#endif
+#ifndef LITE_WITH_FPGA
+  if (memory_arena_) program_->EnableMemoryPlanner();
+#endif
+  program_generated_ = true;
+  PrepareFeedFetch();
+}
+
+void Predictor::SaveOptimizedModelCache(const std::string &model_dir) {
+  auto pos = model_dir.find_last_of('/');
+  std::string cache_dir = model_dir.substr(0, pos);
+  MkDirRecur(cache_dir);
+  if (access(cache_dir.c_str(), W_OK) != 0) {
+    LOG(WARNING) << "The optimized model cache " << cache_dir
+                 << " is not writable";
+    return;
+  }
+  // Save to a directory of this process first, so that the processes
+  // starting together never load an entry partly written.
+  std::string tmp_dir = model_dir + ".tmp." + std::to_string(getpid());
+  SaveModel(tmp_dir, lite_api::LiteModelType::kNaiveBuffer);
+  if (rename(tmp_dir.c_str(), model_dir.c_str()) != 0) {
+    // Saved by another process in the meantime.
+    std::remove((tmp_dir + "/__model__.nb").c_str());
+    std::remove((tmp_dir + "/param.nb").c_str());
+    rmdir(tmp_dir.c_str());
+    return;
+  }
+  LOG(INFO) << "Save the optimized model to " << model_dir;
 }
 void Predictor::Build(const std::string &model_path,
                       const std::string &model_file,
@@ -259,7 +447,9 @@ void Predictor::Build(const cpp::ProgramDesc &desc,
   inner_places.emplace_back(TARGET(kHost), PRECISION(kAny), DATALAYOUT(kAny));
   inner_places.emplace_back(
       TARGET(kHost), PRECISION(kFloat), DATALAYOUT(kNCHW));
-  Program program(desc, scope_, inner_places);
+  // The while and conditional_block ops refer to the sub-blocks of the desc
+  // the program is built from, which should be kept.
+  Program program(program_desc_, scope_, inner_places);
 
   core::KernelPickFactor factor;
   factor.ConsiderTarget();
@@ -267,6 +457,7 @@ void Predictor::Build(const cpp::ProgramDesc &desc,
   factor.ConsiderDataLayout();
 
   optimizer_.Run(std::move(program), inner_places, factor, passes);
+  optimizer_.OptimizeSubBlocks(&program_desc_);
   exec_scope_ = optimizer_.exec_scope();
   PrepareFeedFetch();
 }
@@ -274,9 +465,76 @@ void Predictor::Build(const cpp::ProgramDesc &desc,
 void Predictor::GenRuntimeProgram() {
   program_ = optimizer_.GenRuntimeProgram();
   CHECK_EQ(exec_scope_, program_->exec_scope());
+#ifdef LITE_WITH_X86
+  PrepareX86ThreadPool();
+#endif
+#ifndef LITE_WITH_FPGA
+  if (memory_arena_) program_->EnableMemoryPlanner();
+#endif
   program_generated_ = true;
 }
 
+#ifdef LITE_WITH_X86
+void Predictor::PrepareX86ThreadPool() {
+  // A single thread runs the kernels inline, no pool is needed.
+  if (threads_ <= 1) {
+    x86_thread_pool_.reset();
+    return;
+  }
+  if (!x86_thread_pool_ || x86_thread_pool_->num_threads() != threads_) {
+    x86_thread_pool_ = std::make_shared<x86::ThreadPool>(threads_);
+  }
+  program_->SetX86ThreadPool(x86_thread_pool_);
+}
+#endif
+
+std::shared_ptr<Predictor> Predictor::Clone() {
+  // The persistables are shared and the program of the clone is created in the
+  // root scope, which is not thread safe.
+  std::lock_guard<std::mutex> lock(*clone_mutex_);
+  if (!program_generated_) {
+    GenRuntimeProgram();
+  }
+  // Record the picked kernels and the vars created by the passes, so that the
+  // clone can rebuild the same instructions without running the optimizer.
+  cpp::ProgramDesc desc = program_desc_;
+  program_->SaveOpInfosToProgram(&desc);
+  program_->UpdateVarsOfProgram(&desc);
+
+  // Some passes create persistable vars in the exec scope (e.g. the NPU model
+  // data), share them through the root scope to make them visible to clones.
+  auto *exec_scope = program_->exec_scope();
+  for (const auto &name : exec_scope->LocalVarNames()) {
+    auto *var = exec_scope->FindLocalVar(name);
+    if (!var->IsType<lite::Tensor>()) continue;
+    const auto &tensor = var->Get<lite::Tensor>();
+    if (!tensor.persistable() || scope_->FindLocalVar(name)) continue;
+    auto *shared = scope_->Var(name)->GetMutable<lite::Tensor>();
+    shared->ShareDataWith(tensor);
+    shared->set_persistable(true);
+    shared->set_precision(tensor.precision());
+  }
+
+  auto predictor = std::make_shared<Predictor>(scope_);
+  predictor->clone_mutex_ = clone_mutex_;
+  predictor->program_desc_ = desc;
+  Program program(predictor->program_desc_, scope_, {});
+  predictor->program_.reset(new RuntimeProgram(&program));
+  predictor->exec_scope_ = predictor->program_->exec_scope();
+  predictor->program_generated_ = true;
+  predictor->input_names_ = input_names_;
+  predictor->output_names_ = output_names_;
+  predictor->threads_ = threads_;
+#ifdef LITE_WITH_X86
+  predictor->PrepareX86ThreadPool();
+#endif
+  predictor->memory_arena_ = memory_arena_;
+#ifndef LITE_WITH_FPGA
+  if (memory_arena_) predictor->program_->EnableMemoryPlanner();
+#endif
+  return predictor;
+}
+
 const lite::Tensor *Predictor::GetTensor(const std::string &name) const {
   auto *var = exec_scope_->FindVar(name);
   return &var->Get<lite::Tensor>();
@@ -47,7 +47,9 @@ class LITE_API Predictor {
   explicit Predictor(const std::shared_ptr<lite::Scope>& root_scope)
       : scope_(root_scope) {}
 
-  // Build from a model, with places set for hardware config.
+  // Build from a model, with places set for hardware config. With the
+  // optimized model cache of `config` set, the model optimized at a former
+  // start is loaded if found, or the optimized model is saved there.
   void Build(
       const lite_api::CxxConfig& config,
       const std::vector<Place>& valid_places,
@@ -69,6 +71,36 @@ class LITE_API Predictor {
 
   void GenRuntimeProgram();
 
+  // Whether the last Build loaded the model from the optimized model cache.
+  bool optimized_model_cache_hit() const { return optimized_model_cache_hit_; }
+
+  // Set the number of threads the kernels of this predictor may use, it takes
+  // effect on the runtime program generated afterwards.
+  void SetThreads(int threads) { threads_ = threads; }
+  int threads() const { return threads_; }
+
+  // Create a predictor which shares the weights in the root scope and the
+  // optimized runtime program layout of this one. The clone skips the MIR
+  // passes, only the exec scope, kernel contexts and activations are new.
+  std::shared_ptr<Predictor> Clone();
+
+  // Switch the runtime profiler of the program, see RuntimeProgram.
+  void EnableRuntimeProfiler(bool enable) {
+    if (!program_generated_) {
+      GenRuntimeProgram();
+    }
+    program_->EnableRuntimeProfiler(enable);
+  }
+  const profile::RuntimeProfiler* runtime_profiler() const {
+    return program_ ? program_->runtime_profiler() : nullptr;
+  }
+  uint64_t last_run_host_allocs() const {
+    return program_ ? program_->last_run_host_allocs() : 0;
+  }
+  size_t last_run_output_copies() const {
+    return program_ ? program_->last_run_output_copies() : 0;
+  }
+
   // Run the predictor for a single batch of data.
   void Run() {
     if (!program_generated_) {
@@ -88,6 +120,9 @@ class LITE_API Predictor {
 
   // Get offset-th col of fetch results.
   const lite::Tensor* GetOutput(size_t offset) const;
+  // Let the offset-th output be written in the memory of the caller, see
+  // RuntimeProgram::BindOutputBuffer.
+  void BindOutputBuffer(size_t offset, void* data, size_t size);
   std::vector<const lite::Tensor*> GetOutputs() const;
 
   const cpp::ProgramDesc& program_desc() const;
@@ -111,6 +146,12 @@ class LITE_API Predictor {
 #endif
 
  private:
+  // Load a model saved by SaveModel in kNaiveBuffer and create the runtime
+  // program from the kernels it records, without the MIR passes.
+  void BuildFromOptimizedModel(const std::string& model_dir);
+  // Save the optimized model as the cache entry `model_dir`, see Build.
+  void SaveOptimizedModelCache(const std::string& model_dir);
+
   Optimizer optimizer_;
   cpp::ProgramDesc program_desc_;
   std::shared_ptr<Scope> scope_;
@@ -119,11 +160,26 @@ class LITE_API Predictor {
   bool program_generated_{false};
   std::vector<std::string> input_names_;
   std::vector<std::string> output_names_;
+  int threads_{1};
+  bool memory_arena_{false};
+  bool optimized_model_cache_hit_{false};
+  // Shared by a predictor and all its clones, it serializes the cloning which
+  // writes the shared root scope.
+  std::shared_ptr<std::mutex> clone_mutex_{std::make_shared<std::mutex>()};
+
+#ifdef LITE_WITH_X86
+  // Every predictor, including the clones, owns its thread pool so that
+  // several predictors running concurrently do not share workers.
+  void PrepareX86ThreadPool();
+  std::shared_ptr<x86::ThreadPool> x86_thread_pool_;
+#endif
 };
 
 class CxxPaddleApiImpl : public lite_api::PaddlePredictor {
  public:
-  CxxPaddleApiImpl() {}
+  CxxPaddleApiImpl() : raw_predictor_(std::make_shared<Predictor>()) {}
+  explicit CxxPaddleApiImpl(const std::shared_ptr<Predictor>& raw_predictor)
+      : raw_predictor_(raw_predictor) {}
 
   /// Create a new predictor from a config.
   void Init(const lite_api::CxxConfig& config);
@@ -154,8 +210,18 @@ class CxxPaddleApiImpl : public lite_api::PaddlePredictor {
       lite_api::LiteModelType model_type = lite_api::LiteModelType::kProtobuf,
       bool record_info = false) override;
 
+  void EnableProfiler(bool enable) override;
+  std::string GetProfileJson() const override;
+  std::string GetProfileChromeTrace() const override;
+
+  void ShareExternalOutputMemory(int i,
+                                 void* data,
+                                 size_t memory_size) override;
+
+  lite_api::HostMemoryStats GetHostMemoryStats() const override;
+
  private:
-  Predictor raw_predictor_;
+  std::shared_ptr<Predictor> raw_predictor_;
   lite_api::CxxConfig config_;
   std::mutex mutex_;
 };
@@ -20,6 +20,10 @@
 #include "lite/core/device_info.h"
 #include "lite/core/version.h"
 
+#if defined(LITE_WITH_X86) && defined(PADDLE_WITH_MKLML)
+#include "lite/backends/x86/mklml.h"
+#endif
+
 namespace paddle {
 namespace lite {
 
@@ -29,63 +33,97 @@ void CxxPaddleApiImpl::Init(const lite_api::CxxConfig &config) {
   Env<TARGET(kCUDA)>::Init();
 #endif
   auto places = config.valid_places();
-  raw_predictor_.Build(config, places);
+  raw_predictor_->Build(config, places);
 
   mode_ = config.power_mode();
   threads_ = config.threads();
 }
 
 std::unique_ptr<lite_api::Tensor> CxxPaddleApiImpl::GetInput(int i) {
-  auto *x = raw_predictor_.GetInput(i);
+  auto *x = raw_predictor_->GetInput(i);
   return std::unique_ptr<lite_api::Tensor>(new lite_api::Tensor(x));
 }
 
 std::unique_ptr<const lite_api::Tensor> CxxPaddleApiImpl::GetOutput(
     int i) const {
-  const auto *x = raw_predictor_.GetOutput(i);
+  const auto *x = raw_predictor_->GetOutput(i);
   return std::unique_ptr<lite_api::Tensor>(new lite_api::Tensor(x));
 }
 
 std::vector<std::string> CxxPaddleApiImpl::GetInputNames() {
-  return raw_predictor_.GetInputNames();
+  return raw_predictor_->GetInputNames();
 }
 
 std::vector<std::string> CxxPaddleApiImpl::GetOutputNames() {
-  return raw_predictor_.GetOutputNames();
+  return raw_predictor_->GetOutputNames();
 }
 
 void CxxPaddleApiImpl::Run() {
 #ifdef LITE_WITH_ARM
   lite::DeviceInfo::Global().SetRunMode(mode_, threads_);
 #endif
-  raw_predictor_.Run();
+#if defined(LITE_WITH_X86) && defined(PADDLE_WITH_MKLML)
+  // Limit the MKL calls made from this thread to the predictor's threads.
+  lite::x86::MKL_Set_Num_Threads_Local(threads_);
+#endif
+  raw_predictor_->Run();
 }
 
 std::shared_ptr<lite_api::PaddlePredictor> CxxPaddleApiImpl::Clone() {
   std::lock_guard<std::mutex> lock(mutex_);
-  auto predictor = std::make_shared<lite::CxxPaddleApiImpl>();
-  predictor->Init(config_);
+  auto predictor =
+      std::make_shared<lite::CxxPaddleApiImpl>(raw_predictor_->Clone());
+  predictor->config_ = config_;
+  predictor->mode_ = mode_;
+  predictor->threads_ = threads_;
   return predictor;
 }
 
 std::string CxxPaddleApiImpl::GetVersion() const { return version(); }
 
+void CxxPaddleApiImpl::EnableProfiler(bool enable) {
+  raw_predictor_->EnableRuntimeProfiler(enable);
+}
+
+std::string CxxPaddleApiImpl::GetProfileJson() const {
+  auto* profiler = raw_predictor_->runtime_profiler();
+  return profiler ? profiler->ToJson() : profile::RuntimeProfiler().ToJson();
+}
+
+std::string CxxPaddleApiImpl::GetProfileChromeTrace() const {
+  auto* profiler = raw_predictor_->runtime_profiler();
+  return profiler ? profiler->ToChromeTrace()
+                  : profile::RuntimeProfiler().ToChromeTrace();
+}
+
+void CxxPaddleApiImpl::ShareExternalOutputMemory(int i,
+                                                 void *data,
+                                                 size_t memory_size) {
+  raw_predictor_->BindOutputBuffer(i, data, memory_size);
+}
+
+lite_api::HostMemoryStats CxxPaddleApiImpl::GetHostMemoryStats() const {
+  auto stats = lite_api::PaddlePredictor::GetHostMemoryStats();
+  stats.allocs_last_run = raw_predictor_->last_run_host_allocs();
+  return stats;
+}
+
 std::unique_ptr<const lite_api::Tensor> CxxPaddleApiImpl::GetTensor(
     const std::string &name) const {
-  auto *x = raw_predictor_.GetTensor(name);
+  auto *x = raw_predictor_->GetTensor(name);
   return std::unique_ptr<const lite_api::Tensor>(new lite_api::Tensor(x));
 }
 
 std::unique_ptr<lite_api::Tensor> CxxPaddleApiImpl::GetInputByName(
     const std::string &name) {
   return std::unique_ptr<lite_api::Tensor>(
-      new lite_api::Tensor(raw_predictor_.GetInputByName(name)));
+      new lite_api::Tensor(raw_predictor_->GetInputByName(name)));
 }
 
 void CxxPaddleApiImpl::SaveOptimizedModel(const std::string &model_dir,
                                           lite_api::LiteModelType model_type,
                                           bool record_info) {
-  raw_predictor_.SaveModel(model_dir, model_type, record_info);
+  raw_predictor_->SaveModel(model_dir, model_type, record_info);
 }
 
 }  // namespace lite
@@ -15,6 +15,9 @@
 #include "lite/api/cxx_api.h"
 #include <gflags/gflags.h>
 #include <gtest/gtest.h>
+#include <cstdlib>
+#include <memory>
+#include <thread>  // NOLINT
 #include <vector>
 #include "lite/api/lite_api_test_helper.h"
 #include "lite/api/paddle_use_kernels.h"
@@ -22,6 +25,7 @@
 #include "lite/api/paddle_use_passes.h"
 #include "lite/core/op_registry.h"
 #include "lite/core/tensor.h"
+#include "lite/utils/string.h"
 
 // For training.
 DEFINE_string(startup_program_path, "", "");
@@ -53,6 +57,267 @@ TEST(CXXApi, save_model) {
                       lite_api::LiteModelType::kNaiveBuffer);
 }
 
+TEST(CXXApi, clone) {
+  lite::Predictor predictor;
+  std::vector<Place> valid_places({Place{TARGET(kX86), PRECISION(kFloat)}});
+  predictor.Build(FLAGS_model_dir, "", "", valid_places);
+  auto cloned = predictor.Clone();
+
+  auto feed = [](lite::Predictor* p) {
+    auto* input_tensor = p->GetInput(0);
+    input_tensor->Resize(DDim(std::vector<DDim::value_type>({100, 100})));
+    auto* data = input_tensor->mutable_data<float>();
+    for (int i = 0; i < 100 * 100; i++) {
+      data[i] = i;
+    }
+  };
+  feed(&predictor);
+  feed(cloned.get());
+  // The inputs and outputs live in different exec scopes.
+  EXPECT_NE(predictor.GetInput(0), cloned->GetInput(0));
+  predictor.Run();
+  cloned->Run();
+
+  // The weights are shared instead of copied.
+  cpp::ProgramDesc desc = predictor.program_desc();
+  auto& block = *desc.GetBlock<cpp::BlockDesc>(0);
+  for (size_t i = 0; i < block.VarsSize(); ++i) {
+    auto& var = *block.GetVar<cpp::VarDesc>(i);
+    if (!var.Persistable() || var.Name() == "feed" || var.Name() == "fetch")
+      continue;
+    EXPECT_EQ(predictor.GetTensor(var.Name())->raw_data(),
+              cloned->GetTensor(var.Name())->raw_data());
+  }
+
+  auto* out = predictor.GetOutput(0);
+  auto* cloned_out = cloned->GetOutput(0);
+  ASSERT_EQ(out->dims(), cloned_out->dims());
+  for (int i = 0; i < out->dims().production(); i++) {
+    EXPECT_NEAR(out->data<float>()[i], cloned_out->data<float>()[i], 1e-6);
+  }
+}
+
+TEST(CXXApi, clone_concurrently) {
+  lite::Predictor predictor;
+  std::vector<Place> valid_places({Place{TARGET(kX86), PRECISION(kFloat)}});
+  predictor.Build(FLAGS_model_dir, "", "", valid_places);
+  auto source = predictor.Clone();
+
+  auto run = [](lite::Predictor* p) {
+    auto* input_tensor = p->GetInput(0);
+    input_tensor->Resize(DDim(std::vector<DDim::value_type>({100, 100})));
+    auto* data = input_tensor->mutable_data<float>();
+    for (int i = 0; i < 100 * 100; i++) {
+      data[i] = i;
+    }
+    p->Run();
+  };
+  run(&predictor);
+
+  // Half of the threads clone the predictor, the others its clone, which
+  // share the root scope and the lock.
+  const int kThreads = 8;
+  std::vector<std::shared_ptr<lite::Predictor>> clones(kThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&, i] {
+      clones[i] = i % 2 ? source->Clone() : predictor.Clone();
+      run(clones[i].get());
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  auto* out = predictor.GetOutput(0);
+  for (auto& cloned : clones) {
+    auto* cloned_out = cloned->GetOutput(0);
+    ASSERT_EQ(out->dims(), cloned_out->dims());
+    for (int i = 0; i < out->dims().production(); i++) {
+      EXPECT_NEAR(out->data<float>()[i], cloned_out->data<float>()[i], 1e-6);
+    }
+  }
+}
+
+TEST(CXXApi, latency_kernel_pick) {
+  std::vector<Place> valid_places({Place{TARGET(kX86), PRECISION(kFloat)},
+                                   Place{TARGET(kHost), PRECISION(kFloat)}});
+  lite_api::CxxConfig config;
+  config.set_model_dir(FLAGS_model_dir);
+  config.set_kernel_pick_input_shapes({{"a", {100, 100}}});
+
+  lite::Predictor predictor;
+  predictor.Build(config, valid_places);
+  lite::Predictor static_predictor;
+  static_predictor.Build(FLAGS_model_dir, "", "", valid_places);
+
+  auto run = [](lite::Predictor* p) {
+    auto* input_tensor = p->GetInput(0);
+    input_tensor->Resize(DDim(std::vector<DDim::value_type>({100, 100})));
+    auto* data = input_tensor->mutable_data<float>();
+    for (int i = 0; i < 100 * 100; i++) {
+      data[i] = i;
+    }
+    p->Run();
+  };
+  run(&predictor);
+  run(&static_predictor);
+
+  auto* out = predictor.GetOutput(0);
+  auto* static_out = static_predictor.GetOutput(0);
+  ASSERT_EQ(out->dims(), static_out->dims());
+  for (int i = 0; i < out->dims().production(); i++) {
+    EXPECT_NEAR(out->data<float>()[i], static_out->data<float>()[i], 1e-3);
+  }
+}
+
+TEST(CXXApi, optimized_model_cache) {
+  std::vector<Place> valid_places({Place{TARGET(kX86), PRECISION(kFloat)},
+                                   Place{TARGET(kHost), PRECISION(kFloat)}});
+  // A new cache for every run, the first Build should miss it.
+  char cache_dir[] = "/tmp/lite_optimized_model_cache.XXXXXX";
+  ASSERT_TRUE(mkdtemp(cache_dir));
+  lite_api::CxxConfig config;
+  config.set_model_dir(FLAGS_model_dir);
+  config.set_optimized_model_cache_dir(cache_dir);
+
+  lite::Predictor first;
+  first.Build(config, valid_places);
+  EXPECT_FALSE(first.optimized_model_cache_hit());
+  lite::Predictor cached;
+  cached.Build(config, valid_places);
+  EXPECT_TRUE(cached.optimized_model_cache_hit());
+
+  auto run = [](lite::Predictor* p) {
+    auto* input_tensor = p->GetInput(0);
+    input_tensor->Resize(DDim(std::vector<DDim::value_type>({100, 100})));
+    auto* data = input_tensor->mutable_data<float>();
+    for (int i = 0; i < 100 * 100; i++) {
+      data[i] = i;
+    }
+    p->Run();
+  };
+  run(&first);
+  run(&cached);
+
+  auto* out = first.GetOutput(0);
+  auto* cached_out = cached.GetOutput(0);
+  ASSERT_EQ(out->dims(), cached_out->dims());
+  for (int i = 0; i < out->dims().production(); i++) {
+    EXPECT_NEAR(out->data<float>()[i], cached_out->data<float>()[i], 1e-5);
+  }
+
+  // Another number of threads may pick other kernels, it is another entry.
+  config.set_threads(2);
+  lite::Predictor threaded;
+  threaded.Build(config, valid_places);
+  EXPECT_FALSE(threaded.optimized_model_cache_hit());
+
+  EXPECT_EQ(system(string_format("rm -rf %s", cache_dir).c_str()), 0);
+}
+
+TEST(CXXApi, reuse_shapes) {
+  std::vector<Place> valid_places({Place{TARGET(kX86), PRECISION(kFloat)}});
+  lite::Predictor predictor;
+  predictor.Build(FLAGS_model_dir, "", "", valid_places);
+
+  auto run = [](lite::Predictor* p, int64_t batch_size) {
+    auto* input_tensor = p->GetInput(0);
+    input_tensor->Resize(
+        DDim(std::vector<DDim::value_type>({batch_size, 100})));
+    auto* data = input_tensor->mutable_data<float>();
+    for (int i = 0; i < batch_size * 100; i++) {
+      data[i] = i % 100;
+    }
+    p->Run();
+  };
+  // The second run reuses the shapes of the first one, the third run changes
+  // the feed shape and infers the shapes again.
+  for (int64_t batch_size : {100, 100, 20}) {
+    run(&predictor, batch_size);
+    lite::Predictor fresh_predictor;
+    fresh_predictor.Build(FLAGS_model_dir, "", "", valid_places);
+    run(&fresh_predictor, batch_size);
+
+    auto* out = predictor.GetOutput(0);
+    auto* fresh_out = fresh_predictor.GetOutput(0);
+    ASSERT_EQ(out->dims(), fresh_out->dims());
+    ASSERT_EQ(out->dims()[0], batch_size);
+    for (int i = 0; i < out->dims().production(); i++) {
+      EXPECT_NEAR(out->data<float>()[i], fresh_out->data<float>()[i], 1e-6);
+    }
+  }
+}
+
+TEST(CXXApi, runtime_profiler) {
+  lite::Predictor predictor;
+  std::vector<Place> valid_places({Place{TARGET(kX86), PRECISION(kFloat)}});
+  predictor.Build(FLAGS_model_dir, "", "", valid_places);
+  EXPECT_EQ(predictor.runtime_profiler(), nullptr);
+
+  predictor.EnableRuntimeProfiler(true);
+  for (int i = 0; i < 3; i++) {
+    auto* input_tensor = predictor.GetInput(0);
+    input_tensor->Resize(DDim(std::vector<DDim::value_type>({100, 100})));
+    auto* data = input_tensor->mutable_data<float>();
+    for (int j = 0; j < 100 * 100; j++) {
+      data[j] = j;
+    }
+    predictor.Run();
+  }
+  predictor.EnableRuntimeProfiler(false);
+  predictor.Run();
+
+  auto* profiler = predictor.runtime_profiler();
+  ASSERT_TRUE(profiler);
+  EXPECT_EQ(profiler->runs(), 3);
+  ASSERT_FALSE(profiler->ops().empty());
+  for (auto& op : profiler->ops()) {
+    EXPECT_EQ(op.latency.count(), 3);
+    EXPECT_GT(op.bytes, 0);
+  }
+  LOG(INFO) << profiler->ToJson();
+}
+
+TEST(CXXApi, external_memory) {
+  std::vector<Place> valid_places({Place{TARGET(kX86), PRECISION(kFloat)}});
+  lite::Predictor predictor;
+  predictor.Build(FLAGS_model_dir, "", "", valid_places);
+  lite::Predictor copy_predictor;
+  copy_predictor.Build(FLAGS_model_dir, "", "", valid_places);
+
+  // The input and the output live in the memory of the caller.
+  std::vector<float> input(100 * 100);
+  std::vector<float> output(100 * 500);
+  auto* input_tensor = predictor.GetInput(0);
+  input_tensor->Resize(DDim(std::vector<DDim::value_type>({100, 100})));
+  input_tensor->ResetBuffer(
+      std::make_shared<Buffer>(
+          input.data(), TARGET(kHost), input.size() * sizeof(float)),
+      input.size() * sizeof(float));
+  predictor.BindOutputBuffer(
+      0, output.data(), output.size() * sizeof(float));
+
+  auto* copy_input = copy_predictor.GetInput(0);
+  copy_input->Resize(DDim(std::vector<DDim::value_type>({100, 100})));
+  for (int run = 0; run < 2; ++run) {
+    auto* copy_data = copy_input->mutable_data<float>();
+    for (int i = 0; i < 100 * 100; i++) {
+      input[i] = copy_data[i] = (i + run) % 100;
+    }
+    predictor.Run();
+    copy_predictor.Run();
+
+    auto* out = predictor.GetOutput(0);
+    auto* copy_out = copy_predictor.GetOutput(0);
+    ASSERT_EQ(out->dims(), copy_out->dims());
+    // The output is written in place, not copied back after the run.
+    EXPECT_EQ(predictor.last_run_output_copies(), 0u);
+    EXPECT_EQ(out->raw_data(), output.data());
+    for (int i = 0; i < copy_out->dims().production(); i++) {
+      EXPECT_NEAR(output[i], copy_out->data<float>()[i], 1e-6);
+    }
+  }
+}
+
 /*TEST(CXXTrainer, train) {
   Place place({TARGET(kHost), PRECISION(kFloat), DATALAYOUT(kNCHW)});
   std::vector<Place> valid_places({place});
@@ -22,7 +22,8 @@ void LightPredictor::Build(const std::string& model_dir,
                            const std::string& model_buffer,
                            const std::string& param_buffer,
                            lite_api::LiteModelType model_type,
-                           bool model_from_memory) {
+                           bool model_from_memory,
+                           bool use_mmap) {
   switch (model_type) {
 #ifndef LITE_ON_TINY_PUBLISH
     case lite_api::LiteModelType::kProtobuf:
@@ -34,7 +35,8 @@ void LightPredictor::Build(const std::string& model_dir,
         LoadModelNaiveFromMemory(
             model_buffer, param_buffer, scope_.get(), &cpp_program_desc_);
       } else {
-        LoadModelNaive(model_dir, scope_.get(), &cpp_program_desc_);
+        LoadModelNaive(
+            model_dir, scope_.get(), &cpp_program_desc_, true, use_mmap);
       }
       break;
     }
@@ -80,6 +82,13 @@ const Tensor* LightPredictor::GetOutput(size_t offset) {
                  << " in exec_scope";
   return out_var->GetMutable<lite::Tensor>();
 }
+
+void LightPredictor::BindOutputBuffer(size_t offset, void* data, size_t size) {
+  CHECK(output_names_.size() > offset)
+      << "The network has " << output_names_.size() << " outputs"
+      << ", the offset should be less than this.";
+  program_->BindOutputBuffer(output_names_[offset], data, size);
+}
 // get inputs names
 std::vector<std::string> LightPredictor::GetInputNames() {
   return input_names_;
@@ -114,34 +123,24 @@ void LightPredictor::PrepareFeedFetch() {
 }
 
 void LightPredictor::BuildRuntimeProgram(const cpp::ProgramDesc& prog) {
-  std::vector<Instruction> insts;
   // 1. Create op first
   Program program(prog, scope_, {});
 
-  // 2. Create Instructs
-
-  // Create the kernels of the target places, and filter out the specific
-  // kernel with the target alias.
-  for (auto& op : program.ops()) {
-    auto kernel_type = op->op_info()->GetAttr<std::string>(kKernelTypeAttr);
-    std::string op_type, alias;
-    Place place;
-    KernelBase::ParseKernelType(kernel_type, &op_type, &alias, &place);
-    auto kernels = op->CreateKernels({place});
-    // filter out a kernel
-    auto it = std::find_if(
-        kernels.begin(), kernels.end(), [&](std::unique_ptr<KernelBase>& it) {
-          return it->alias() == alias;
-        });
-    CHECK(it != kernels.end());
-    (*it)->SetContext(ContextScheduler::Global().NewContext((*it)->target()));
-
-    insts.emplace_back(op, std::move(*it));
-  }
-  program_.reset(new RuntimeProgram(std::move(insts)));
+  // 2. Create Instructs with the kernels recorded in the optimized model.
+  program_.reset(new RuntimeProgram(&program));
+}
 
-  CHECK(program.exec_scope());
-  program_->set_exec_scope(program.exec_scope());
+std::unique_ptr<LightPredictor> LightPredictor::Clone() const {
+  // The clone shares `scope_`, so the weights are loaded only once, while the
+  // activations live in the new exec scope created by `BuildRuntimeProgram`.
+  std::unique_ptr<LightPredictor> predictor(new LightPredictor(scope_));
+  predictor->cpp_program_desc_ = cpp_program_desc_;
+  predictor->BuildRuntimeProgram(predictor->cpp_program_desc_);
+  predictor->PrepareFeedFetch();
+#ifndef LITE_WITH_FPGA
+  if (memory_arena_) predictor->EnableMemoryPlanner();
+#endif
+  return predictor;
 }
 
 }  // namespace lite
@@ -20,6 +20,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>  //NOLINT
 #include <string>
 #include <utility>
 #include <vector>
@@ -44,19 +45,54 @@ class LITE_API LightPredictor {
       const std::string& model_buffer = "",
       const std::string& param_buffer = "",
       bool model_from_memory = false,
-      lite_api::LiteModelType model_type = lite_api::LiteModelType::kProtobuf) {
+      lite_api::LiteModelType model_type = lite_api::LiteModelType::kProtobuf,
+      bool use_mmap = false) {
     scope_ = std::make_shared<Scope>();
-    Build(model_dir, model_buffer, param_buffer, model_type, model_from_memory);
+    Build(model_dir,
+          model_buffer,
+          param_buffer,
+          model_type,
+          model_from_memory,
+          use_mmap);
   }
 
   void Run() { program_->Run(); }
 
+  // Switch the runtime profiler of the program, see RuntimeProgram.
+  void EnableRuntimeProfiler(bool enable) {
+    program_->EnableRuntimeProfiler(enable);
+  }
+  const profile::RuntimeProfiler* runtime_profiler() const {
+    return program_->runtime_profiler();
+  }
+  uint64_t last_run_host_allocs() const {
+    return program_->last_run_host_allocs();
+  }
+  size_t last_run_output_copies() const {
+    return program_->last_run_output_copies();
+  }
+
+#ifndef LITE_WITH_FPGA
+  // Place the activations in one arena, see RuntimeProgram.
+  void EnableMemoryPlanner() {
+    memory_arena_ = true;
+    program_->EnableMemoryPlanner();
+  }
+#endif
+
+  // Create a predictor which shares the weights and the runtime program layout
+  // of this one, only the exec scope and the kernel contexts are new.
+  std::unique_ptr<LightPredictor> Clone() const;
+
   // Get offset-th col of feed inputs.
   Tensor* GetInput(size_t offset);
   // get input by name.
   Tensor* GetInputByName(const std::string& name);
   // Get offset-th col of fetch outputs.
   const Tensor* GetOutput(size_t offset);
+  // Let the offset-th output be written in the memory of the caller, see
+  // RuntimeProgram::BindOutputBuffer.
+  void BindOutputBuffer(size_t offset, void* data, size_t size);
 
   const lite::Tensor* GetTensor(const std::string& name) const {
     auto* var = program_->exec_scope()->FindVar(name);
@@ -69,18 +105,23 @@ class LITE_API LightPredictor {
   void PrepareFeedFetch();
 
  private:
+  explicit LightPredictor(const std::shared_ptr<Scope>& root_scope)
+      : scope_(root_scope) {}
+
   void Build(
       const std::string& model_dir,
       const std::string& model_buffer,
       const std::string& param_buffer,
       lite_api::LiteModelType model_type = lite_api::LiteModelType::kProtobuf,
-      bool model_from_memory = false);
+      bool model_from_memory = false,
+      bool use_mmap = false);
 
   void BuildRuntimeProgram(const cpp::ProgramDesc& prog);
 
  private:
   std::shared_ptr<Scope> scope_;
   std::unique_ptr<RuntimeProgram> program_;
+  bool memory_arena_{false};
   cpp::ProgramDesc cpp_program_desc_;
   std::vector<std::string> input_names_;
   std::vector<std::string> output_names_;
@@ -89,6 +130,8 @@ class LITE_API LightPredictor {
 class LightPredictorImpl : public lite_api::PaddlePredictor {
  public:
   LightPredictorImpl() = default;
+  explicit LightPredictorImpl(std::unique_ptr<lite::LightPredictor>&& predictor)
+      : raw_predictor_(std::move(predictor)) {}
 
   std::unique_ptr<lite_api::Tensor> GetInput(int i) override;
 
@@ -108,10 +151,21 @@ class LightPredictorImpl : public lite_api::PaddlePredictor {
   std::unique_ptr<lite_api::Tensor> GetInputByName(
       const std::string& name) override;
 
+  void EnableProfiler(bool enable) override;
+  std::string GetProfileJson() const override;
+  std::string GetProfileChromeTrace() const override;
+
+  void ShareExternalOutputMemory(int i,
+                                 void* data,
+                                 size_t memory_size) override;
+
+  lite_api::HostMemoryStats GetHostMemoryStats() const override;
+
   void Init(const lite_api::MobileConfig& config);
 
  private:
   std::unique_ptr<lite::LightPredictor> raw_predictor_;
+  std::mutex mutex_;
 };
 
 }  // namespace lite
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include "lite/api/light_api.h"
+#include <memory>
+#include <mutex>  //NOLINT
 #include <string>
 #include "lite/api/paddle_api.h"
 #include "lite/core/version.h"
@@ -28,7 +30,11 @@ void LightPredictorImpl::Init(const lite_api::MobileConfig& config) {
                          config.model_buffer(),
                          config.param_buffer(),
                          config.model_from_memory(),
-                         lite_api::LiteModelType::kNaiveBuffer));
+                         lite_api::LiteModelType::kNaiveBuffer,
+                         config.use_mmap()));
+#ifndef LITE_WITH_FPGA
+  if (config.memory_arena()) raw_predictor_->EnableMemoryPlanner();
+#endif
 
   mode_ = config.power_mode();
   threads_ = config.threads();
@@ -53,11 +59,43 @@ void LightPredictorImpl::Run() {
 }
 
 std::shared_ptr<lite_api::PaddlePredictor> LightPredictorImpl::Clone() {
-  LOG(FATAL) << "The Clone API is not supported in LigthPredictor";
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto predictor =
+      std::make_shared<lite::LightPredictorImpl>(raw_predictor_->Clone());
+  predictor->mode_ = mode_;
+  predictor->threads_ = threads_;
+  return predictor;
 }
 
 std::string LightPredictorImpl::GetVersion() const { return lite::version(); }
 
+void LightPredictorImpl::EnableProfiler(bool enable) {
+  raw_predictor_->EnableRuntimeProfiler(enable);
+}
+
+std::string LightPredictorImpl::GetProfileJson() const {
+  auto* profiler = raw_predictor_->runtime_profiler();
+  return profiler ? profiler->ToJson() : profile::RuntimeProfiler().ToJson();
+}
+
+std::string LightPredictorImpl::GetProfileChromeTrace() const {
+  auto* profiler = raw_predictor_->runtime_profiler();
+  return profiler ? profiler->ToChromeTrace()
+                  : profile::RuntimeProfiler().ToChromeTrace();
+}
+
+void LightPredictorImpl::ShareExternalOutputMemory(int i,
+                                                   void* data,
+                                                   size_t memory_size) {
+  raw_predictor_->BindOutputBuffer(i, data, memory_size);
+}
+
+lite_api::HostMemoryStats LightPredictorImpl::GetHostMemoryStats() const {
+  auto stats = lite_api::PaddlePredictor::GetHostMemoryStats();
+  stats.allocs_last_run = raw_predictor_->last_run_host_allocs();
+  return stats;
+}
+
 std::unique_ptr<const lite_api::Tensor> LightPredictorImpl::GetTensor(
     const std::string& name) const {
   return std::unique_ptr<const lite_api::Tensor>(
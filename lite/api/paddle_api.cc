@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "lite/api/paddle_api.h"
+#include "lite/backends/host/allocator.h"
 #include "lite/core/device_info.h"
 #include "lite/core/target_wrapper.h"
 #include "lite/core/tensor.h"
@@ -149,10 +150,33 @@ PrecisionType Tensor::precision() const {
   return precision;
 }
 
+size_t Tensor::memory_size() const {
+  return ctensor(raw_tensor_)->memory_size();
+}
+
 lod_t Tensor::lod() const { return ctensor(raw_tensor_)->lod(); }
 
 void Tensor::SetLoD(const lod_t &lod) { tensor(raw_tensor_)->set_lod(lod); }
 
+void Tensor::ShareExternalMemory(void *data,
+                                 size_t memory_size,
+                                 TargetType target) {
+  auto *x = tensor(raw_tensor_);
+  // The precision of a feed is not known before the run, which checks the
+  // size again with the precision the kernels read.
+  auto precision = x->precision();
+  size_t element_size =
+      precision == PrecisionType::kUnk || precision == PrecisionType::kAny
+          ? 1
+          : PrecisionTypeLength(precision);
+  CHECK_GE(memory_size, x->dims().production() * element_size)
+      << "The external memory of " << memory_size
+      << " bytes is smaller than the tensor of dims " << x->dims()
+      << ", call Resize first";
+  auto buffer = std::make_shared<lite::Buffer>(data, target, memory_size);
+  x->ResetBuffer(buffer, memory_size);
+}
+
 void PaddlePredictor::SaveOptimizedModel(const std::string &model_dir,
                                          LiteModelType model_type,
                                          bool record_info) {
@@ -160,6 +184,44 @@ void PaddlePredictor::SaveOptimizedModel(const std::string &model_dir,
       << "The SaveOptimizedModel API is only supported by CxxConfig predictor.";
 }
 
+void PaddlePredictor::EnableProfiler(bool enable) {
+  LOG(FATAL) << "The profiler is not supported by this predictor.";
+}
+
+std::string PaddlePredictor::GetProfileJson() const {
+  LOG(FATAL) << "The profiler is not supported by this predictor.";
+  return "";
+}
+
+std::string PaddlePredictor::GetProfileChromeTrace() const {
+  LOG(FATAL) << "The profiler is not supported by this predictor.";
+  return "";
+}
+
+void PaddlePredictor::ShareExternalOutputMemory(int i,
+                                                void *data,
+                                                size_t memory_size) {
+  LOG(FATAL) << "The external output memory is not supported by this "
+                "predictor.";
+}
+
+HostMemoryStats PaddlePredictor::GetHostMemoryStats() const {
+  auto stats = lite::host::GetStats();
+  HostMemoryStats res;
+  res.bytes_in_use = stats.bytes_in_use;
+  res.peak_bytes_in_use = stats.peak_bytes_in_use;
+  res.bytes_cached = stats.bytes_cached;
+  res.num_allocs = stats.num_allocs;
+  res.num_frees = stats.num_frees;
+  return res;
+}
+
+void SetHostMemoryZeroFill(bool zero_fill) {
+  lite::host::SetZeroFill(zero_fill);
+}
+
+void ReleaseHostMemoryCache() { lite::host::ReleaseCache(); }
+
 template <typename ConfigT>
 std::shared_ptr<PaddlePredictor> CreatePaddlePredictor(const ConfigT &) {
   return std::shared_ptr<PaddlePredictor>();
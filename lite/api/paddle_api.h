@@ -19,6 +19,7 @@
 
 #ifndef PADDLE_LITE_API_H_  // NOLINT
 #define PADDLE_LITE_API_H_
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -54,6 +55,9 @@ struct LITE_API Tensor {
   shape_t shape() const;
   TargetType target() const;
   PrecisionType precision() const;
+  /// The bytes of the data, as allocated for the current shape by the last
+  /// `mutable_data`, or given to `ShareExternalMemory`.
+  size_t memory_size() const;
 
   // LoD of the tensor
   lod_t lod() const;
@@ -61,10 +65,39 @@ struct LITE_API Tensor {
   // Set LoD of the tensor
   void SetLoD(const lod_t& lod);
 
+  /// Use the `memory_size` bytes at `data`, owned by the caller, as the data
+  /// of the tensor instead of copying them, e.g. to feed an input. Call
+  /// `Resize` first: the memory is checked against the dims here, and
+  /// against the precision the kernels read at every run. The memory should
+  /// stay valid while the predictor uses it, and be aligned for the kernels,
+  /// 64 bytes as the allocations of Lite.
+  void ShareExternalMemory(void* data,
+                           size_t memory_size,
+                           TargetType target = TargetType::kHost);
+
  private:
   void* raw_tensor_;
 };
 
+/// The host memory allocated by Lite in the process, see
+/// lite/backends/host/allocator.h.
+struct LITE_API HostMemoryStats {
+  /// The bytes of the live allocations, and their maximum.
+  int64_t bytes_in_use{0};
+  int64_t peak_bytes_in_use{0};
+  /// The bytes freed but kept for later allocations.
+  int64_t bytes_cached{0};
+  int64_t num_allocs{0};
+  int64_t num_frees{0};
+  /// The allocations made by the last Run of the predictor on its thread.
+  int64_t allocs_last_run{0};
+};
+
+/// Zero-fill the host memory allocated by Lite, off by default.
+LITE_API void SetHostMemoryZeroFill(bool zero_fill);
+/// Give the host memory kept for later allocations back to the system.
+LITE_API void ReleaseHostMemoryCache();
+
 /// The PaddlePredictor defines the basic interfaces for different kinds of
 /// predictors.
 class LITE_API PaddlePredictor {
@@ -101,6 +134,28 @@ class LITE_API PaddlePredictor {
       LiteModelType model_type = LiteModelType::kProtobuf,
       bool record_info = false);
 
+  /// Start or stop recording the latency, the input shapes, the bytes and the
+  /// FLOPs of every op at the following runs. The records are kept across the
+  /// runs until the predictor is destroyed.
+  virtual void EnableProfiler(bool enable);
+  /// Export the records as JSON, with the p50/p99 latency of every op.
+  virtual std::string GetProfileJson() const;
+  /// Export the last launches of the ops in the Chrome trace event format,
+  /// which can be loaded in chrome://tracing.
+  virtual std::string GetProfileChromeTrace() const;
+
+  /// Let the i-th output be written in the `memory_size` bytes at `data`,
+  /// owned by the caller, so that it is not copied out after the runs. The
+  /// outputs not written in place by their kernels are copied there after
+  /// each run. The memory should stay valid while the predictor runs.
+  virtual void ShareExternalOutputMemory(int i,
+                                         void* data,
+                                         size_t memory_size);
+
+  /// The host memory counters of the process, with the allocations of the
+  /// last run of this predictor.
+  virtual HostMemoryStats GetHostMemoryStats() const;
+
   virtual ~PaddlePredictor() = default;
 
  protected:
@@ -113,6 +168,7 @@ class LITE_API ConfigBase {
   std::string model_dir_;
   int threads_{1};
   PowerMode mode_{LITE_POWER_NO_BIND};
+  bool memory_arena_{false};
 
  public:
   explicit ConfigBase(PowerMode mode = LITE_POWER_NO_BIND, int threads = 1);
@@ -125,6 +181,10 @@ class LITE_API ConfigBase {
   // set Thread
   void set_threads(int threads);
   int threads() const { return threads_; }
+  // Place the activations in one arena planned by their sizes and lifetimes,
+  // instead of reusing them by name. Only the outputs stay valid after Run.
+  void set_memory_arena(bool x) { memory_arena_ = x; }
+  bool memory_arena() const { return memory_arena_; }
 };
 
 /// CxxConfig is the config for the Full feature predictor.
@@ -133,6 +193,9 @@ class LITE_API CxxConfig : public ConfigBase {
   std::string model_file_;
   std::string param_file_;
   bool model_from_memory_{false};
+  std::map<std::string, shape_t> kernel_pick_input_shapes_;
+  std::string optimized_model_cache_dir_;
+  bool fuse_elementwise_chain_{false};
 
  public:
   void set_valid_places(const std::vector<Place>& x) { valid_places_ = x; }
@@ -151,6 +214,35 @@ class LITE_API CxxConfig : public ConfigBase {
   std::string model_file() const { return model_file_; }
   std::string param_file() const { return param_file_; }
   bool model_from_memory() const { return model_from_memory_; }
+
+  // Pick the kernels by measuring them on the inputs of these shapes when
+  // optimizing the model, the keys are the input names.
+  void set_kernel_pick_input_shapes(
+      const std::map<std::string, shape_t>& shapes) {
+    kernel_pick_input_shapes_ = shapes;
+  }
+  const std::map<std::string, shape_t>& kernel_pick_input_shapes() const {
+    return kernel_pick_input_shapes_;
+  }
+
+  // Keep the optimized model in this directory, under a hash of the model,
+  // the params, the valid places, the optimization options and the library
+  // version, and load it instead of optimizing the model at the next starts.
+  // Off if empty.
+  void set_optimized_model_cache_dir(const std::string& dir) {
+    optimized_model_cache_dir_ = dir;
+  }
+  const std::string& optimized_model_cache_dir() const {
+    return optimized_model_cache_dir_;
+  }
+
+  // Experimental, off by default. On x86, fuse the chains of elementwise ops,
+  // activations, scales and float casts into fusion_elementwise_chain ops,
+  // each running as one loop over the data. The kernel generated with Xbyak
+  // for these loops has not been validated on AVX2 machines yet, the builds
+  // without Xbyak run the reference kernel.
+  void set_fuse_elementwise_chain(bool x) { fuse_elementwise_chain_ = x; }
+  bool fuse_elementwise_chain() const { return fuse_elementwise_chain_; }
 };
 
 /// MobileConfig is the config for the light weight predictor, it will skip
@@ -159,6 +251,7 @@ class LITE_API MobileConfig : public ConfigBase {
   std::string model_buffer_;
   std::string param_buffer_;
   bool model_from_memory_{false};
+  bool use_mmap_{false};
 
  public:
   void set_model_buffer(const char* model_buffer,
@@ -170,6 +263,12 @@ class LITE_API MobileConfig : public ConfigBase {
     model_from_memory_ = true;
   }
 
+  // Map the model files into memory instead of reading them, the weights
+  // refer to the mapping directly, so the page cache can be shared by the
+  // processes loading the same model.
+  void set_use_mmap(bool x) { use_mmap_ = x; }
+  bool use_mmap() const { return use_mmap_; }
+
   bool model_from_memory() const { return model_from_memory_; }
   const std::string& model_buffer() const { return model_buffer_; }
   const std::string& param_buffer() const { return param_buffer_; }
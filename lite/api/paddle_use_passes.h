@@ -26,6 +26,9 @@ USE_MIR_PASS(generate_npu_program_pass);
 #ifdef LITE_WITH_XPU
 USE_MIR_PASS(generate_xpu_program_pass);
 #endif
+#ifdef LITE_WITH_X86
+USE_MIR_PASS(x86_elementwise_chain_fuse_pass);
+#endif
 
 USE_MIR_PASS(io_copy_kernel_pick_pass);
 USE_MIR_PASS(argument_type_display_pass);
@@ -37,6 +40,7 @@ USE_MIR_PASS(lite_fc_fuse_pass);
 USE_MIR_PASS(lite_shuffle_channel_fuse_pass);
 USE_MIR_PASS(lite_transpose_softmax_transpose_fuse_pass);
 USE_MIR_PASS(lite_interpolate_fuse_pass);
+USE_MIR_PASS(lite_embedding_seq_pool_fuse_pass);
 USE_MIR_PASS(identity_scale_eliminate_pass);
 USE_MIR_PASS(lite_conv_elementwise_fuse_pass);
 USE_MIR_PASS(lite_conv_activation_fuse_pass);
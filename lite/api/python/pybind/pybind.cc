@@ -102,7 +102,13 @@ void BindLiteCxxConfig(py::module *m) {
       .def("param_file", &CxxConfig::param_file)
       .def("set_valid_places", &CxxConfig::set_valid_places)
       .def("set_model_buffer", &CxxConfig::set_model_buffer)
-      .def("model_from_memory", &CxxConfig::model_from_memory);
+      .def("model_from_memory", &CxxConfig::model_from_memory)
+      .def("set_memory_arena", &CxxConfig::set_memory_arena)
+      .def("memory_arena", &CxxConfig::memory_arena)
+      .def("set_optimized_model_cache_dir",
+           &CxxConfig::set_optimized_model_cache_dir)
+      .def("optimized_model_cache_dir",
+           &CxxConfig::optimized_model_cache_dir);
 #ifdef LITE_WITH_ARM
   cxx_config.def("set_threads", &CxxConfig::set_threads)
       .def("threads", &CxxConfig::threads)
@@ -119,7 +125,11 @@ void BindLiteMobileConfig(py::module *m) {
       .def("set_model_dir", &MobileConfig::set_model_dir)
       .def("model_dir", &MobileConfig::model_dir)
       .def("set_model_buffer", &MobileConfig::set_model_buffer)
-      .def("model_from_memory", &MobileConfig::model_from_memory);
+      .def("model_from_memory", &MobileConfig::model_from_memory)
+      .def("set_use_mmap", &MobileConfig::set_use_mmap)
+      .def("use_mmap", &MobileConfig::use_mmap)
+      .def("set_memory_arena", &MobileConfig::set_memory_arena)
+      .def("memory_arena", &MobileConfig::memory_arena);
 #ifdef LITE_WITH_ARM
   mobile_config.def("set_threads", &MobileConfig::set_threads)
       .def("threads", &MobileConfig::threads)
@@ -220,15 +230,58 @@ void BindLiteTensor(py::module *m) {
       py::arg("data"),                                                   \
       py::arg("type") = TargetType::kHost);
 
+// The numpy arrays sharing the memory of the tensor. The array holds the
+// tensor object, which holds the predictor it comes from (see keep_alive in
+// get_input and get_output), so the predictor and its scope outlive the
+// array. The tensor object is only a handle though, the array still points
+// to the memory the tensor had when the view was made: a resize, or a run
+// reallocating the tensor, e.g. for a new input shape, invalidates it, and
+// the view has to be taken again. The predictors do not record the
+// precisions of the activations, so every precision has its own accessors
+// like the copying ones above.
+//   <name>_view: a view of the data, e.g. of the outputs after run.
+//   mutable_<name>_view: allocate the data on host in the shape set by
+//     resize and return a view, e.g. to fill the inputs in place.
+// The setters also take contiguous arrays, copied once without a list.
+#define DO_NUMPY_ONCE(data_type__, name__)                                \
+  tensor.def(#name__ "_view", [](py::object self) {                       \
+    auto &x = self.cast<Tensor &>();                                      \
+    return py::array_t<data_type__>(                                      \
+        x.shape(), x.data<data_type__>(), self);                          \
+  });                                                                     \
+  tensor.def("mutable_" #name__ "_view", [](py::object self) {            \
+    auto &x = self.cast<Tensor &>();                                      \
+    return py::array_t<data_type__>(                                      \
+        x.shape(), x.mutable_data<data_type__>(), self);                  \
+  });                                                                     \
+  tensor.def(                                                             \
+      "set_" #name__ "_data",                                             \
+      [=](Tensor &self,                                                   \
+          py::array_t<data_type__, py::array::c_style> data,              \
+          TargetType type) {                                              \
+        CHECK(type == TargetType::kHost || type == TargetType::kARM)      \
+            << "Only the host tensors are set from an array";             \
+        CHECK_EQ(data.size(), data_size_func(self.shape()))               \
+            << "You should call resize with the size of the array first"; \
+        std::memcpy(self.mutable_data<data_type__>(),                     \
+                    data.data(),                                          \
+                    data.size() * sizeof(data_type__));                   \
+      },                                                                  \
+      py::arg("data"),                                                    \
+      py::arg("type") = TargetType::kHost);
+
 #define DATA_GETTER_SETTER_ONCE(data_type__, name__) \
+  DO_NUMPY_ONCE(data_type__, name__)                 \
   DO_SETTER_ONCE(data_type__, set_##name__##_data)   \
   DO_GETTER_ONCE(data_type__, name__##_data)
 
   DATA_GETTER_SETTER_ONCE(int8_t, int8);
   DATA_GETTER_SETTER_ONCE(int32_t, int32);
   DATA_GETTER_SETTER_ONCE(float, float);
+  DO_NUMPY_ONCE(int64_t, int64);
 #undef DO_GETTER_ONCE
 #undef DO_SETTER_ONCE
+#undef DO_NUMPY_ONCE
 #undef DATA_GETTER_SETTER_ONCE
 }
 
@@ -236,10 +289,15 @@ void BindLiteTensor(py::module *m) {
 void BindLiteCxxPredictor(py::module *m) {
   py::class_<CxxPaddleApiImpl>(*m, "CxxPredictor")
       .def(py::init<>())
-      .def("get_input", &CxxPaddleApiImpl::GetInput)
-      .def("get_output", &CxxPaddleApiImpl::GetOutput)
-      .def("run", &CxxPaddleApiImpl::Run)
+      .def("get_input", &CxxPaddleApiImpl::GetInput, py::keep_alive<0, 1>())
+      .def("get_output", &CxxPaddleApiImpl::GetOutput, py::keep_alive<0, 1>())
+      .def("run",
+           &CxxPaddleApiImpl::Run,
+           py::call_guard<py::gil_scoped_release>())
       .def("get_version", &CxxPaddleApiImpl::GetVersion)
+      .def("enable_profiler", &CxxPaddleApiImpl::EnableProfiler)
+      .def("get_profile_json", &CxxPaddleApiImpl::GetProfileJson)
+      .def("get_profile_chrome_trace", &CxxPaddleApiImpl::GetProfileChromeTrace)
       .def("save_optimized_model",
            [](CxxPaddleApiImpl &self, const std::string &output_dir) {
              self.SaveOptimizedModel(output_dir,
@@ -251,10 +309,16 @@ void BindLiteCxxPredictor(py::module *m) {
 void BindLiteLightPredictor(py::module *m) {
   py::class_<LightPredictorImpl>(*m, "LightPredictor")
       .def(py::init<>())
-      .def("get_input", &LightPredictorImpl::GetInput)
-      .def("get_output", &LightPredictorImpl::GetOutput)
-      .def("run", &LightPredictorImpl::Run)
-      .def("get_version", &LightPredictorImpl::GetVersion);
+      .def("get_input", &LightPredictorImpl::GetInput, py::keep_alive<0, 1>())
+      .def("get_output", &LightPredictorImpl::GetOutput, py::keep_alive<0, 1>())
+      .def("run",
+           &LightPredictorImpl::Run,
+           py::call_guard<py::gil_scoped_release>())
+      .def("get_version", &LightPredictorImpl::GetVersion)
+      .def("enable_profiler", &LightPredictorImpl::EnableProfiler)
+      .def("get_profile_json", &LightPredictorImpl::GetProfileJson)
+      .def("get_profile_chrome_trace",
+           &LightPredictorImpl::GetProfileChromeTrace);
 }
 
 }  // namespace pybind
@@ -0,0 +1,294 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/host/allocator.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace paddle {
+namespace lite {
+namespace host {
+
+void* SystemAllocator::Allocate(size_t size) {
+  size_t offset = sizeof(void*) + kMallocAlign - 1;
+  char* p = static_cast<char*>(malloc(offset + size));
+  if (!p) {
+    return nullptr;
+  }
+  void* r = reinterpret_cast<void*>(reinterpret_cast<size_t>(p + offset) &
+                                    (~(kMallocAlign - 1)));
+  static_cast<void**>(r)[-1] = p;
+  return r;
+}
+
+void SystemAllocator::Free(void* ptr, size_t size) {
+  if (ptr) {
+    free(static_cast<void**>(ptr)[-1]);
+  }
+}
+
+constexpr int CachingAllocator::kMaxCachedShift;
+constexpr size_t CachingAllocator::kMaxCachedSize;
+constexpr size_t CachingAllocator::kMaxThreadCachedSize;
+constexpr int CachingAllocator::kThreadCacheBlocks;
+constexpr int CachingAllocator::kNumClasses;
+
+int CachingAllocator::SizeClass(size_t size, size_t* class_size) {
+  if (size <= kMallocAlign) {
+    if (class_size) *class_size = kMallocAlign;
+    return 0;
+  }
+  // 2^p < size <= 2^(p + 1), with p >= 6 as kMallocAlign is 64.
+  int p = 6;
+  while ((size_t(1) << (p + 1)) < size) ++p;
+  size_t step = size_t(1) << (p - 2);
+  size_t k = (size - (size_t(1) << p) + step - 1) / step;
+  if (class_size) *class_size = (size_t(1) << p) + k * step;
+  return (p - 6) * 4 + static_cast<int>(k);
+}
+
+size_t CachingAllocator::ClassSize(int size_class) {
+  if (size_class == 0) return kMallocAlign;
+  int p = 6 + (size_class - 1) / 4;
+  size_t k = (size_class - 1) % 4 + 1;
+  return (size_t(1) << p) + k * (size_t(1) << (p - 2));
+}
+
+// The blocks kept by a thread, given to the shared free lists when the
+// thread exits.
+struct CachingAllocator::ThreadCache {
+  CachingAllocator* owner{nullptr};
+  std::vector<std::vector<void*>> blocks;
+
+  ~ThreadCache() {
+    if (!owner) return;
+    std::lock_guard<std::mutex> lock(owner->mutex_);
+    for (size_t c = 0; c < blocks.size(); ++c) {
+      auto& list = owner->free_lists_[c];
+      list.insert(list.end(), blocks[c].begin(), blocks[c].end());
+    }
+  }
+};
+
+CachingAllocator::CachingAllocator(size_t max_cached_bytes)
+    : max_cached_bytes_(max_cached_bytes), free_lists_(kNumClasses) {}
+
+CachingAllocator::~CachingAllocator() {
+  ReleaseCache();
+  auto* cache = LocalCache();
+  if (cache) cache->owner = nullptr;
+}
+
+// A thread caches the blocks of the first CachingAllocator it uses, the
+// process has a single one unless SetAllocator is called.
+CachingAllocator::ThreadCache* CachingAllocator::LocalCache() {
+  static thread_local ThreadCache cache;
+  if (!cache.owner) {
+    cache.owner = this;
+    cache.blocks.resize(kNumClasses);
+  }
+  return cache.owner == this ? &cache : nullptr;
+}
+
+void* CachingAllocator::Allocate(size_t size) {
+  if (size > kMaxCachedSize) {
+    return system_.Allocate(size);
+  }
+  size_t class_size = 0;
+  int c = SizeClass(size, &class_size);
+  if (class_size <= kMaxThreadCachedSize) {
+    auto* cache = LocalCache();
+    if (cache && !cache->blocks[c].empty()) {
+      void* ptr = cache->blocks[c].back();
+      cache->blocks[c].pop_back();
+      cached_bytes_ -= class_size;
+      return ptr;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& list = free_lists_[c];
+    if (!list.empty()) {
+      void* ptr = list.back();
+      list.pop_back();
+      cached_bytes_ -= class_size;
+      return ptr;
+    }
+  }
+  return system_.Allocate(class_size);
+}
+
+void CachingAllocator::Free(void* ptr, size_t size) {
+  if (!ptr) return;
+  if (size > kMaxCachedSize) {
+    system_.Free(ptr, size);
+    return;
+  }
+  size_t class_size = 0;
+  int c = SizeClass(size, &class_size);
+  if (cached_bytes_.load() + class_size > max_cached_bytes_) {
+    system_.Free(ptr, class_size);
+    return;
+  }
+  cached_bytes_ += class_size;
+  if (class_size <= kMaxThreadCachedSize) {
+    auto* cache = LocalCache();
+    if (cache && cache->blocks[c].size() < kThreadCacheBlocks) {
+      cache->blocks[c].push_back(ptr);
+      return;
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_lists_[c].push_back(ptr);
+}
+
+// The blocks kept by the other threads stay there until they exit.
+void CachingAllocator::ReleaseCache() {
+  auto* cache = LocalCache();
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (int c = 0; c < kNumClasses; ++c) {
+    std::vector<void*> blocks;
+    blocks.swap(free_lists_[c]);
+    if (cache) {
+      blocks.insert(blocks.end(),
+                    cache->blocks[c].begin(),
+                    cache->blocks[c].end());
+      cache->blocks[c].clear();
+    }
+    for (void* ptr : blocks) {
+      system_.Free(ptr, 0);
+    }
+    cached_bytes_ -= blocks.size() * ClassSize(c);
+  }
+}
+
+namespace {
+
+// Every allocation is preceded by a header of kMallocAlign bytes, so that
+// Free finds the allocator and the size of the block.
+struct Header {
+  Allocator* allocator;
+  size_t size;
+};
+static_assert(sizeof(Header) <= kMallocAlign, "header too large");
+
+struct State {
+  std::mutex mutex;
+  // The allocators set so far, kept alive for the memory they allocated.
+  std::vector<std::shared_ptr<Allocator>> allocators;
+  std::atomic<Allocator*> current{nullptr};
+  std::atomic<bool> zero_fill{false};
+  std::atomic<size_t> bytes_in_use{0};
+  std::atomic<size_t> peak_bytes_in_use{0};
+  std::atomic<uint64_t> num_allocs{0};
+  std::atomic<uint64_t> num_frees{0};
+
+  State() {
+    allocators.emplace_back(new CachingAllocator);
+    current = allocators.back().get();
+  }
+};
+
+// Never destroyed, the tensors of static objects are freed after main.
+State& GetState() {
+  static State* state = new State;
+  return *state;
+}
+
+thread_local uint64_t thread_alloc_count = 0;
+
+}  // namespace
+
+void SetAllocator(const std::shared_ptr<Allocator>& allocator) {
+  auto& state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.allocators.push_back(allocator);
+  state.current = allocator.get();
+}
+
+Allocator* GetAllocator() { return GetState().current.load(); }
+
+void SetZeroFill(bool zero_fill) { GetState().zero_fill = zero_fill; }
+bool zero_fill() { return GetState().zero_fill.load(); }
+
+void* Malloc(size_t size) {
+  auto& state = GetState();
+  Allocator* allocator = state.current.load();
+  char* block = static_cast<char*>(allocator->Allocate(kMallocAlign + size));
+  if (!block) {
+    return nullptr;
+  }
+  auto* header = reinterpret_cast<Header*>(block);
+  header->allocator = allocator;
+  header->size = size;
+  void* ptr = block + kMallocAlign;
+  if (state.zero_fill.load(std::memory_order_relaxed)) {
+    memset(ptr, 0, size);
+  }
+
+  size_t in_use = state.bytes_in_use.fetch_add(size) + size;
+  size_t peak = state.peak_bytes_in_use.load();
+  while (in_use > peak &&
+         !state.peak_bytes_in_use.compare_exchange_weak(peak, in_use)) {
+  }
+  ++state.num_allocs;
+  ++thread_alloc_count;
+  return ptr;
+}
+
+void Free(void* ptr) {
+  if (!ptr) return;
+  auto& state = GetState();
+  char* block = static_cast<char*>(ptr) - kMallocAlign;
+  auto* header = reinterpret_cast<Header*>(block);
+  size_t size = header->size;
+  header->allocator->Free(block, kMallocAlign + size);
+  state.bytes_in_use -= size;
+  ++state.num_frees;
+}
+
+AllocatorStats GetStats() {
+  auto& state = GetState();
+  AllocatorStats stats;
+  stats.bytes_in_use = state.bytes_in_use.load();
+  stats.peak_bytes_in_use = state.peak_bytes_in_use.load();
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    for (auto& allocator : state.allocators) {
+      stats.bytes_cached += allocator->cached_bytes();
+    }
+  }
+  stats.num_allocs = state.num_allocs.load();
+  stats.num_frees = state.num_frees.load();
+  return stats;
+}
+
+void ResetPeakBytes() {
+  auto& state = GetState();
+  state.peak_bytes_in_use = state.bytes_in_use.load();
+}
+
+uint64_t ThreadAllocCount() { return thread_alloc_count; }
+
+void ReleaseCache() {
+  auto& state = GetState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  for (auto& allocator : state.allocators) {
+    allocator->ReleaseCache();
+  }
+}
+
+}  // namespace host
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,137 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace lite {
+namespace host {
+
+// The alignment of the host allocations, for the vector loads of the kernels.
+constexpr size_t kMallocAlign = 64;
+
+/*
+ * The source of the host memory behind TargetWrapper<kHost>::Malloc, and so
+ * behind TargetMalloc for the host, X86 and ARM targets.
+ *
+ * Allocate returns `size` bytes aligned to kMallocAlign, and Free gets back
+ * the same pointer and size. The memory is not zero-filled. The allocators
+ * are called from any thread.
+ */
+class Allocator {
+ public:
+  virtual ~Allocator() = default;
+
+  virtual void* Allocate(size_t size) = 0;
+  virtual void Free(void* ptr, size_t size) = 0;
+
+  // The bytes freed but kept for later allocations.
+  virtual size_t cached_bytes() const { return 0; }
+  // Give the kept memory back to the system.
+  virtual void ReleaseCache() {}
+};
+
+// Aligned malloc and free, without any caching.
+class SystemAllocator : public Allocator {
+ public:
+  void* Allocate(size_t size) override;
+  void Free(void* ptr, size_t size) override;
+};
+
+/*
+ * Keeps the freed blocks for the next allocations of the same size class,
+ * so the tensors reallocated at every run, e.g. the workspaces of the
+ * kernels or the activations of a new input shape, do not go back to
+ * malloc.
+ *
+ * There are four size classes per power of two, a block wastes at most a
+ * quarter of its size. Every thread keeps a few blocks of the classes up to
+ * kMaxThreadCachedSize without locking, the other freed blocks go to the
+ * shared free lists. The blocks larger than kMaxCachedSize, or freed when
+ * `max_cached_bytes` are already cached, are given back to the system.
+ */
+class CachingAllocator : public Allocator {
+ public:
+  static constexpr int kMaxCachedShift = 28;
+  static constexpr size_t kMaxCachedSize = size_t(1) << kMaxCachedShift;
+  static constexpr size_t kMaxThreadCachedSize = size_t(1) << 20;
+  static constexpr int kThreadCacheBlocks = 4;
+  // 64 bytes, then four classes per power of two up to kMaxCachedSize.
+  static constexpr int kNumClasses = (kMaxCachedShift - 6) * 4 + 1;
+
+  explicit CachingAllocator(size_t max_cached_bytes = size_t(1) << 30);
+  ~CachingAllocator() override;
+
+  void* Allocate(size_t size) override;
+  void Free(void* ptr, size_t size) override;
+  size_t cached_bytes() const override { return cached_bytes_.load(); }
+  void ReleaseCache() override;
+
+  // The index of the class of `size`, and its block size in `class_size`.
+  static int SizeClass(size_t size, size_t* class_size);
+  static size_t ClassSize(int size_class);
+
+ private:
+  struct ThreadCache;
+  ThreadCache* LocalCache();
+
+  const size_t max_cached_bytes_;
+  SystemAllocator system_;
+  std::atomic<size_t> cached_bytes_{0};
+  std::mutex mutex_;
+  std::vector<std::vector<void*>> free_lists_;
+};
+
+struct AllocatorStats {
+  // The bytes asked for by the live allocations, and their maximum.
+  size_t bytes_in_use{0};
+  size_t peak_bytes_in_use{0};
+  // The bytes kept by the allocator for later allocations.
+  size_t bytes_cached{0};
+  uint64_t num_allocs{0};
+  uint64_t num_frees{0};
+};
+
+// Use `allocator` for the following host allocations. The memory allocated
+// before is still freed by the allocator it came from, which is kept alive
+// for it. The default is a CachingAllocator.
+void SetAllocator(const std::shared_ptr<Allocator>& allocator);
+Allocator* GetAllocator();
+
+// Whether the host allocations are zero-filled, off by default.
+void SetZeroFill(bool zero_fill);
+bool zero_fill();
+
+void* Malloc(size_t size);
+void Free(void* ptr);
+
+AllocatorStats GetStats();
+// Start the peak of bytes_in_use again from the current bytes in use.
+void ResetPeakBytes();
+// The number of host allocations made by the calling thread so far, the
+// difference around a run gives the allocations of the run.
+uint64_t ThreadAllocCount();
+// Give the memory cached by the allocators back to the system.
+void ReleaseCache();
+
+}  // namespace host
+}  // namespace lite
+}  // namespace paddle
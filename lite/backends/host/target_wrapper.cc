@@ -12,32 +12,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include "lite/core/target_wrapper.h"
 #include <cstring>
 #include <memory>
+#include "lite/backends/host/allocator.h"
+#include "lite/core/target_wrapper.h"
 
 namespace paddle {
 namespace lite {
 
-const int MALLOC_ALIGN = 64;
-
+// The memory comes from host::Malloc, see lite/backends/host/allocator.h.
 void* TargetWrapper<TARGET(kHost)>::Malloc(size_t size) {
-  size_t offset = sizeof(void*) + MALLOC_ALIGN - 1;
-  char* p = static_cast<char*>(malloc(offset + size));
-  if (!p) {
-    return nullptr;
-  }
-  void* r = reinterpret_cast<void*>(reinterpret_cast<size_t>(p + offset) &
-                                    (~(MALLOC_ALIGN - 1)));
-  static_cast<void**>(r)[-1] = p;
-  memset(r, 0, size);
-  return r;
-}
-void TargetWrapper<TARGET(kHost)>::Free(void* ptr) {
-  if (ptr) {
-    free(static_cast<void**>(ptr)[-1]);
-  }
+  return host::Malloc(size);
 }
+void TargetWrapper<TARGET(kHost)>::Free(void* ptr) { host::Free(ptr); }
 void TargetWrapper<TARGET(kHost)>::MemcpySync(void* dst,
                                               const void* src,
                                               size_t size,
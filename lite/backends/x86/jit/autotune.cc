@@ -0,0 +1,186 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "lite/backends/x86/jit/autotune.h"
+#if !defined(_WIN32) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>  // NOLINT
+#include "lite/backends/x86/cpu_info.h"
+#include "lite/utils/cp_logging.h"
+
+DEFINE_bool(jit_autotune,
+            false,
+            "Whether to benchmark all the implementations of a jit kernel "
+            "the first time an attr is seen, and use the fastest one");
+DEFINE_string(jit_autotune_file,
+              "",
+              "The file the jit autotune table is loaded from at the start, "
+              "and saved to at the exit");
+
+namespace paddle {
+namespace lite {
+namespace jit {
+
+namespace {
+
+const char kMachinePrefix[] = "# machine: ";
+
+std::string CpuBrand() {
+#if !defined(_WIN32) && (defined(__x86_64__) || defined(__i386__))
+  unsigned int regs[12];
+  if (__get_cpuid_max(0x80000000, nullptr) < 0x80000004) return "unknown";
+  for (unsigned int i = 0; i < 3; ++i) {
+    __get_cpuid(0x80000002 + i,
+                &regs[i * 4],
+                &regs[i * 4 + 1],
+                &regs[i * 4 + 2],
+                &regs[i * 4 + 3]);
+  }
+  std::string brand(reinterpret_cast<const char*>(regs), sizeof(regs));
+  brand = brand.substr(0, strnlen(brand.c_str(), sizeof(regs)));
+  size_t begin = brand.find_first_not_of(' ');
+  size_t end = brand.find_last_not_of(' ');
+  return begin == std::string::npos ? "unknown"
+                                    : brand.substr(begin, end - begin + 1);
+#else
+  return "unknown";
+#endif
+}
+
+// Saves the table at the exit if a file is given.
+class AutotuneSaver {
+ public:
+  ~AutotuneSaver() {
+    if (!FLAGS_jit_autotune_file.empty() && AutotuneTable::Global().size()) {
+      AutotuneTable::Global().Save(FLAGS_jit_autotune_file);
+    }
+  }
+};
+
+}  // namespace
+
+std::string AutotuneMachine() {
+  static const std::string machine = [] {
+    std::ostringstream os;
+    os << CpuBrand() << ";isa";
+    const std::pair<x86::cpu_isa_t, const char*> isas[] = {
+        {x86::sse42, "sse42"},
+        {x86::avx, "avx"},
+        {x86::avx2, "avx2"},
+        {x86::avx512f, "avx512f"},
+        {x86::avx512_core, "avx512_core"},
+        {x86::avx512_core_vnni, "avx512_core_vnni"}};
+    for (auto& isa : isas) {
+      if (x86::MayIUse(isa.first)) os << " " << isa.second;
+    }
+    os << ";threads " << std::thread::hardware_concurrency();
+    return os.str();
+  }();
+  return machine;
+}
+
+AutotuneTable::AutotuneTable() : enabled_(FLAGS_jit_autotune) {
+  if (!FLAGS_jit_autotune_file.empty()) {
+    Load(FLAGS_jit_autotune_file);
+  }
+}
+
+AutotuneTable& AutotuneTable::Global() {
+  static AutotuneTable table;
+  static AutotuneSaver saver;
+  return table;
+}
+
+bool AutotuneTable::Find(KernelType type,
+                         int64_t key,
+                         std::string* impl) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = impls_.find(std::make_pair(static_cast<int>(type), key));
+  if (it == impls_.end()) return false;
+  *impl = it->second;
+  return true;
+}
+
+void AutotuneTable::Insert(KernelType type,
+                           int64_t key,
+                           const std::string& impl) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  impls_.emplace(std::make_pair(static_cast<int>(type), key), impl);
+}
+
+size_t AutotuneTable::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return impls_.size();
+}
+
+void AutotuneTable::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  impls_.clear();
+}
+
+// The file starts with the machine, followed by a line per entry:
+//   <kernel type> <attr key> <impl type>
+bool AutotuneTable::Load(const std::string& path) {
+  std::ifstream fin(path);
+  if (!fin.is_open()) {
+    LOG(WARNING) << "Can not open the jit autotune table " << path;
+    return false;
+  }
+  std::string line;
+  std::getline(fin, line);
+  if (line != kMachinePrefix + AutotuneMachine()) {
+    LOG(WARNING) << "The jit autotune table " << path
+                 << " is tuned on another machine, ignore it";
+    return false;
+  }
+  std::map<std::pair<int, int64_t>, std::string> impls;
+  int type;
+  int64_t key;
+  std::string impl;
+  while (fin >> type >> key >> impl) {
+    impls[std::make_pair(type, key)] = impl;
+  }
+  if (!fin.eof()) {
+    LOG(WARNING) << "The jit autotune table " << path << " is corrupted";
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& entry : impls) {
+    impls_[entry.first] = entry.second;
+  }
+  return true;
+}
+
+bool AutotuneTable::Save(const std::string& path) const {
+  std::ofstream fout(path);
+  if (!fout.is_open()) {
+    LOG(WARNING) << "Can not write the jit autotune table " << path;
+    return false;
+  }
+  fout << kMachinePrefix << AutotuneMachine() << "\n";
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& entry : impls_) {
+    fout << entry.first.first << " " << entry.first.second << " "
+         << entry.second << "\n";
+  }
+  return fout.good();
+}
+
+}  // namespace jit
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,219 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include <gflags/gflags.h>
+#include <chrono>  // NOLINT
+#include <map>
+#include <mutex>  // NOLINT
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lite/backends/x86/jit/kernel_base.h"
+
+DECLARE_bool(jit_autotune);
+DECLARE_string(jit_autotune_file);
+
+namespace paddle {
+namespace lite {
+namespace jit {
+
+// The implementations picked by benchmarking the candidates on this machine,
+// by kernel type and attr key. The table can be saved and loaded again to skip
+// the benchmarks, it is only loaded on a machine with the same CPU.
+class AutotuneTable {
+ public:
+  static AutotuneTable& Global();
+
+  // Whether KernelFuncs benchmark the candidates instead of taking the first
+  // one, tuned offline. Enabled by --jit_autotune, or below.
+  bool enabled() const { return enabled_; }
+  void set_enabled(bool enabled) { enabled_ = enabled; }
+
+  bool Find(KernelType type, int64_t key, std::string* impl) const;
+  void Insert(KernelType type, int64_t key, const std::string& impl);
+  size_t size() const;
+  void Clear();
+
+  // Load or save the table as text, return false on an IO error, or if the
+  // table was tuned on another CPU.
+  bool Load(const std::string& path);
+  bool Save(const std::string& path) const;
+
+ private:
+  AutotuneTable();
+
+  bool enabled_{false};
+  mutable std::mutex mutex_;
+  std::map<std::pair<int, int64_t>, std::string> impls_;
+};
+
+// The CPU the table is tuned on, i.e. its brand and instruction sets.
+std::string AutotuneMachine();
+
+namespace autotune {
+
+const int kWarmup = 2;
+const int kRounds = 3;
+const int kRepeat = 20;
+
+// The average latency in microseconds of `run` over the best round.
+template <typename Run>
+double TimeIt(Run run) {
+  using clock_t = std::chrono::steady_clock;
+  for (int i = 0; i < kWarmup; ++i) {
+    run();
+  }
+  double best = -1.;
+  for (int round = 0; round < kRounds; ++round) {
+    auto begin = clock_t::now();
+    for (int i = 0; i < kRepeat; ++i) {
+      run();
+    }
+    std::chrono::duration<double, std::micro> lap = clock_t::now() - begin;
+    if (best < 0 || lap.count() < best) best = lap.count();
+  }
+  return best / kRepeat;
+}
+
+template <typename T>
+std::vector<T> RandomData(size_t n, T lower = -1, T upper = 1) {
+  std::mt19937 rng(100);
+  std::uniform_real_distribution<double> dist(lower, upper);
+  std::vector<T> data(n);
+  for (auto& x : data) {
+    x = static_cast<T>(dist(rng));
+  }
+  return data;
+}
+
+// Benchmark a candidate on random data shaped by its attr, the kernels not
+// listed below return a negative latency and are not tuned.
+template <typename T, typename Func, typename Attr>
+double Benchmark(Func func, const Attr& attr) {
+  return -1.;
+}
+
+// VMul, VAdd, VAddRelu, VSub, VScal, VAddBias.
+template <typename T>
+double Benchmark(void (*func)(const T*, const T*, T*, int), const int& n) {
+  auto x = RandomData<T>(n);
+  auto y = RandomData<T>(n);
+  std::vector<T> z(n);
+  return TimeIt([&] { func(x.data(), y.data(), z.data(), n); });
+}
+
+// VRelu, VIdentity, VSquare, VExp, VSigmoid, VTanh, VCopy, HMax, HSum.
+template <typename T>
+double Benchmark(void (*func)(const T*, T*, int), const int& n) {
+  auto x = RandomData<T>(n);
+  std::vector<T> y(n);
+  return TimeIt([&] { func(x.data(), y.data(), n); });
+}
+
+// Softmax of a row.
+template <typename T>
+double Benchmark(void (*func)(const T*, T*, int, int, int), const int& n) {
+  auto x = RandomData<T>(n);
+  std::vector<T> y(n);
+  return TimeIt([&] { func(x.data(), y.data(), n, 1, 1); });
+}
+
+// LayerNorm of a few rows of `right` columns.
+template <typename T>
+double Benchmark(
+    void (*func)(T*, T*, T*, T*, const T*, const T*, int, const float, int),
+    const int& right) {
+  const int height = 8;
+  auto x = RandomData<T>(height * right);
+  auto scale = RandomData<T>(right);
+  auto bias = RandomData<T>(right);
+  std::vector<T> out(height * right);
+  std::vector<T> mean(height);
+  std::vector<T> var(height);
+  return TimeIt([&] {
+    func(x.data(),
+         out.data(),
+         mean.data(),
+         var.data(),
+         scale.data(),
+         bias.data(),
+         height,
+         1e-5f,
+         right);
+  });
+}
+
+// SeqPool of a sequence of a few rows.
+template <typename T>
+double Benchmark(void (*func)(const T*, T*, const seq_pool_attr_t*),
+                 const seq_pool_attr_t& attr) {
+  seq_pool_attr_t bench_attr(attr.w, attr.type);
+  bench_attr.h = 16;
+  auto x = RandomData<T>(bench_attr.h * attr.w);
+  std::vector<T> y(attr.w);
+  return TimeIt([&] { func(x.data(), y.data(), &bench_attr); });
+}
+
+// GRUH1, GRUHtPart1, GRUHtPart2.
+template <typename T>
+double Benchmark(void (*func)(gru_t*, const gru_attr_t*),
+                 const gru_attr_t& attr) {
+  auto gates = RandomData<T>(3 * attr.d);
+  auto ht_1 = RandomData<T>(attr.d);
+  std::vector<T> ht(attr.d);
+  // The kernels update the gates in place, the benchmark restarts from the
+  // same ones every time to keep the values in range.
+  auto bench_gates = gates;
+  gru_t step;
+  step.gates = bench_gates.data();
+  step.ht_1 = ht_1.data();
+  step.ht = ht.data();
+  return TimeIt([&] {
+    std::copy(gates.begin(), gates.end(), bench_gates.begin());
+    func(&step, &attr);
+  });
+}
+
+// LSTMCtHt, LSTMC1H1.
+template <typename T>
+double Benchmark(void (*func)(lstm_t*, const lstm_attr_t*),
+                 const lstm_attr_t& attr) {
+  auto gates = RandomData<T>(4 * attr.d);
+  auto ct_1 = RandomData<T>(attr.d);
+  auto wp = RandomData<T>(3 * attr.d);
+  std::vector<T> ct(attr.d);
+  std::vector<T> ht(attr.d);
+  std::vector<T> checked(2 * attr.d);
+  auto bench_gates = gates;
+  lstm_t step;
+  step.gates = bench_gates.data();
+  step.ct_1 = ct_1.data();
+  step.ct = ct.data();
+  step.ht = ht.data();
+  step.wp = wp.data();
+  step.checked = checked.data();
+  return TimeIt([&] {
+    std::copy(gates.begin(), gates.end(), bench_gates.begin());
+    func(&step, &attr);
+  });
+}
+
+}  // namespace autotune
+
+}  // namespace jit
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,281 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/jit/gen/elementwise_chain.h"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include "lite/backends/x86/jit/registry.h"
+#include "lite/utils/paddle_enforce.h"
+
+namespace paddle {
+namespace lite {
+namespace jit {
+namespace gen {
+
+ElementwiseChainJitCode::ElementwiseChainJitCode(
+    const elementwise_chain_attr_t& attr, size_t code_size, void* code_ptr)
+    : VActFunc(code_size, code_ptr), attr_(attr) {
+  const int num_steps = static_cast<int>(attr_.steps.size());
+  consts_.resize(2 * num_steps + 1);
+  for (int s = 0; s < num_steps; ++s) {
+    consts_[2 * s] = attr_.steps[s].alpha;
+    consts_[2 * s + 1] = attr_.steps[s].beta;
+  }
+  const uint32_t abs_mask = 0x7fffffff;
+  std::memcpy(&consts_[2 * num_steps], &abs_mask, sizeof(float));
+
+  // The value of a step is in jmm 0 for the next step, it is only kept on the
+  // stack for the steps after.
+  slots_.assign(attr_.num_inputs + num_steps, -1);
+  for (int s = 0; s < num_steps; ++s) {
+    for (int v : {attr_.steps[s].a, attr_.steps[s].b}) {
+      if (v >= attr_.num_inputs && v < attr_.num_inputs + s - 1 &&
+          slots_[v] < 0) {
+        slots_[v] = num_slots_++;
+      }
+    }
+  }
+  this->genCode();
+}
+
+template <typename JMM>
+void ElementwiseChainJitCode::loadValue(JMM& dst, int value) {  // NOLINT
+  constexpr bool is_ymm = std::is_same<JMM, ymm_t>::value;
+  if (value < attr_.num_inputs) {
+    mov(reg_ptr, qword[param_inputs + value * sizeof(float*)]);
+    if (attr_.scalar_inputs[value]) {
+      vbroadcastss(dst, ptr[reg_ptr]);
+    } else if (is_ymm) {
+      vmovups(dst, ptr[reg_ptr + reg_i * sizeof(float)]);
+    } else {
+      vmovss(dst, ptr[reg_ptr + reg_i * sizeof(float)]);
+    }
+    return;
+  }
+  PADDLE_ENFORCE_GE(slots_[value], 0);
+  auto addr = ptr[rsp + slots_[value] * YMM_FLOAT_BLOCK * sizeof(float)];
+  if (is_ymm) {
+    vmovups(dst, addr);
+  } else {
+    vmovss(dst, addr);
+  }
+}
+
+template <typename JMM>
+void ElementwiseChainJitCode::storeValue(const Xbyak::Address& addr,
+                                         JMM& src) {  // NOLINT
+  if (std::is_same<JMM, ymm_t>::value) {
+    vmovups(addr, src);
+  } else {
+    vmovss(addr, src);
+  }
+}
+
+template <typename JMM>
+void ElementwiseChainJitCode::genStep(const elementwise_chain_step_t& step,
+                                      int step_idx) {
+  JMM jmm_a = JMM(0);
+  JMM jmm_b = JMM(1);
+  JMM jmm_tmp = JMM(2);
+  JMM jmm_mask = JMM(3);
+  const bool binary = step.b >= 0;
+  if (binary && step.b == cur_value_) {
+    vmovaps(jmm_b, jmm_a);
+  }
+  if (step.a != cur_value_) {
+    loadValue<JMM>(jmm_a, step.a);
+  }
+  if (binary && step.b != cur_value_) {
+    if (step.b == step.a) {
+      vmovaps(jmm_b, jmm_a);
+    } else {
+      loadValue<JMM>(jmm_b, step.b);
+    }
+  }
+
+  const size_t alpha_offset = 2 * step_idx * sizeof(float);
+  const size_t beta_offset = alpha_offset + sizeof(float);
+  const size_t abs_offset = 2 * attr_.steps.size() * sizeof(float);
+  switch (step.op) {
+    case kChainAdd:
+      vaddps(jmm_a, jmm_a, jmm_b);
+      break;
+    case kChainSub:
+      vsubps(jmm_a, jmm_a, jmm_b);
+      break;
+    case kChainMul:
+      vmulps(jmm_a, jmm_a, jmm_b);
+      break;
+    case kChainDiv:
+      vdivps(jmm_a, jmm_a, jmm_b);
+      break;
+    case kChainMax:
+      vmaxps(jmm_a, jmm_a, jmm_b);
+      break;
+    case kChainMin:
+      vminps(jmm_a, jmm_a, jmm_b);
+      break;
+    case kChainRelu:
+      relu_jmm<JMM>(jmm_a, jmm_a, 15);
+      break;
+    case kChainClip:
+      relu_jmm<JMM>(jmm_a, jmm_a, 15);
+      vbroadcastss(jmm_tmp, ptr[reg_consts + alpha_offset]);
+      vminps(jmm_a, jmm_a, jmm_tmp);
+      break;
+    case kChainLeakyRelu:
+      vbroadcastss(jmm_tmp, ptr[reg_consts + alpha_offset]);
+      vmulps(jmm_tmp, jmm_a, jmm_tmp);
+      vxorps(jmm_mask, jmm_mask, jmm_mask);
+      vcmpgtps(jmm_mask, jmm_a, jmm_mask);
+      vblendvps(jmm_a, jmm_tmp, jmm_a, jmm_mask);
+      break;
+    case kChainSigmoid:
+      sigmoid_jmm<JMM>(jmm_a, jmm_a, 11, 12, 13, 14, 15);
+      break;
+    case kChainTanh:
+      tanh_jmm<JMM>(jmm_a, jmm_a, 11, 12, 13, 14, 15);
+      break;
+    case kChainExp:
+      exp_jmm<JMM>(jmm_a, jmm_a, 11, 12, 13, 14, 15);
+      break;
+    case kChainSquare:
+      square_jmm<JMM>(jmm_a, jmm_a);
+      break;
+    case kChainSqrt:
+      vsqrtps(jmm_a, jmm_a);
+      break;
+    case kChainAbs:
+      vbroadcastss(jmm_tmp, ptr[reg_consts + abs_offset]);
+      vandps(jmm_a, jmm_a, jmm_tmp);
+      break;
+    case kChainScale:
+      vbroadcastss(jmm_tmp, ptr[reg_consts + alpha_offset]);
+      vmulps(jmm_a, jmm_a, jmm_tmp);
+      vbroadcastss(jmm_tmp, ptr[reg_consts + beta_offset]);
+      vaddps(jmm_a, jmm_a, jmm_tmp);
+      break;
+    case kChainIdentity:
+      break;
+    default:
+      LOG(FATAL) << "Unsupported elementwise chain op " << step.op;
+  }
+
+  cur_value_ = attr_.num_inputs + step_idx;
+  for (size_t k = 0; k < attr_.outputs.size(); ++k) {
+    if (attr_.outputs[k] == cur_value_) {
+      mov(reg_ptr, qword[param_outputs + k * sizeof(float*)]);
+      storeValue<JMM>(ptr[reg_ptr + reg_i * sizeof(float)], jmm_a);
+    }
+  }
+  if (slots_[cur_value_] >= 0) {
+    storeValue<JMM>(
+        ptr[rsp + slots_[cur_value_] * YMM_FLOAT_BLOCK * sizeof(float)],
+        jmm_a);
+  }
+}
+
+template <typename JMM>
+void ElementwiseChainJitCode::genBlock() {
+  cur_value_ = -1;
+  for (size_t s = 0; s < attr_.steps.size(); ++s) {
+    genStep<JMM>(attr_.steps[s], static_cast<int>(s));
+  }
+}
+
+void ElementwiseChainJitCode::genCode() {
+  const size_t slots_size = num_slots_ * YMM_FLOAT_BLOCK * sizeof(float);
+  mov(reg_consts, reinterpret_cast<size_t>(consts_.data()));
+  movsxd(param_n, param_n.cvt32());
+  xor_(reg_i, reg_i);
+  if (slots_size > 0) {
+    sub(rsp, slots_size);
+  }
+
+  Label l_block, l_rest, l_end;
+  L(l_block);
+  mov(reg_end, reg_i);
+  add(reg_end, YMM_FLOAT_BLOCK);
+  cmp(reg_end, param_n);
+  jg(l_rest, T_NEAR);
+  genBlock<ymm_t>();
+  mov(reg_i, reg_end);
+  jmp(l_block, T_NEAR);
+
+  L(l_rest);
+  cmp(reg_i, param_n);
+  jge(l_end, T_NEAR);
+  genBlock<xmm_t>();
+  add(reg_i, 1);
+  jmp(l_rest, T_NEAR);
+
+  L(l_end);
+  if (slots_size > 0) {
+    add(rsp, slots_size);
+  }
+  ret();
+}
+
+class ElementwiseChainCreator
+    : public JitCodeCreator<elementwise_chain_attr_t> {
+ public:
+  bool CanBeUsed(const elementwise_chain_attr_t& attr) const override {
+    const int num_inputs = attr.num_inputs;
+    const int num_steps = static_cast<int>(attr.steps.size());
+    if (!x86::MayIUse(x86::avx) || num_inputs < 1 || num_steps < 1 ||
+        num_inputs + num_steps > kElementwiseChainMaxValues ||
+        static_cast<int>(attr.scalar_inputs.size()) != num_inputs) {
+      return false;
+    }
+    for (int s = 0; s < num_steps; ++s) {
+      const auto& step = attr.steps[s];
+      if (step.a < 0 || step.a >= num_inputs + s ||
+          step.b >= num_inputs + s) {
+        return false;
+      }
+      // Without avx2, exp goes through the global g_tmp_mem, which is not
+      // safe to use from the threads running the chain.
+      if ((step.op == kChainExp || step.op == kChainSigmoid ||
+           step.op == kChainTanh) &&
+          !x86::MayIUse(x86::avx2)) {
+        return false;
+      }
+    }
+    for (int v : attr.outputs) {
+      if (v < num_inputs || v >= num_inputs + num_steps) return false;
+    }
+    return true;
+  }
+  size_t CodeSize(const elementwise_chain_attr_t& attr) const override {
+    return 1024 +
+           (attr.steps.size() * 768 +
+            (attr.num_inputs + attr.outputs.size()) * 32) *
+               2;
+  }
+  std::unique_ptr<GenBase> CreateJitCode(
+      const elementwise_chain_attr_t& attr) const override {
+    return make_unique<ElementwiseChainJitCode>(attr, CodeSize(attr));
+  }
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace lite
+}  // namespace paddle
+
+namespace gen = paddle::lite::jit::gen;
+
+REGISTER_JITKERNEL_GEN(kElementwiseChain, gen::ElementwiseChainCreator);
@@ -0,0 +1,70 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "lite/backends/x86/jit/gen/act.h"
+
+namespace paddle {
+namespace lite {
+namespace jit {
+namespace gen {
+
+// Runs all the steps of a chain on 8 elements at a time in ymm registers,
+// then on the rest one at a time, so every input is read and every output is
+// written once. The current value is kept in jmm 0, the values used later
+// again are spilled to the stack, 11~15 are used by the activations.
+class ElementwiseChainJitCode : public VActFunc {
+ public:
+  explicit ElementwiseChainJitCode(const elementwise_chain_attr_t& attr,
+                                   size_t code_size,
+                                   void* code_ptr = nullptr);
+
+  DECLARE_JIT_CODE(ElementwiseChainJitCode);
+  void genCode() override;
+
+ private:
+  template <typename JMM>
+  void genStep(const elementwise_chain_step_t& step, int step_idx);
+  template <typename JMM>
+  void genBlock();
+  template <typename JMM>
+  void loadValue(JMM& dst, int value);  // NOLINT
+  template <typename JMM>
+  void storeValue(const Xbyak::Address& addr, JMM& src);  // NOLINT
+
+  elementwise_chain_attr_t attr_;
+  // alpha and beta of every step, then the mask of abs.
+  std::vector<float> consts_;
+  // The stack slot of every value, -1 if the value is not kept.
+  std::vector<int> slots_;
+  int num_slots_{0};
+  int cur_value_{-1};
+
+  reg64_t param_inputs{abi_param1};
+  reg64_t param_outputs{abi_param2};
+  reg64_t param_n{abi_param3};
+
+  reg64_t reg_i{r8};
+  reg64_t reg_ptr{r9};
+  reg64_t reg_consts{r10};
+  reg64_t reg_end{r11};
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace lite
+}  // namespace paddle
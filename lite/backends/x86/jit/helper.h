@@ -19,6 +19,7 @@
 #include <unordered_map>
 #include <utility>  // for std::move
 #include <vector>
+#include "lite/backends/x86/jit/autotune.h"
 #include "lite/backends/x86/jit/gen_base.h"
 #include "lite/backends/x86/jit/kernel_base.h"
 #include "lite/backends/x86/jit/kernel_key.h"
@@ -29,6 +30,11 @@ namespace paddle {
 namespace lite {
 namespace jit {
 
+const char* to_string(KernelType kt);
+const char* to_string(SeqPoolType kt);
+
+KernelType to_kerneltype(const std::string& act);
+
 template <typename KernelTuple, typename PlaceType>
 inline typename std::enable_if<
     std::is_same<typename KernelTuple::data_type, float>::value,
@@ -173,6 +179,48 @@ typename KernelTuple::func_type GetDefaultBestFunc(
   return funcs[0];
 }
 
+// Benchmark all the candidates the first time an attr is seen, and return the
+// fastest one on this machine from then on. The kernels which can not be
+// benchmarked get the default best one.
+template <typename KernelTuple, typename PlaceType = lite::fluid::CPUPlace>
+typename KernelTuple::func_type GetAutotunedFunc(
+    const typename KernelTuple::attr_type& attr) {
+  using T = typename KernelTuple::data_type;
+  auto funcs = GetAllCandidateFuncsWithTypes<KernelTuple, PlaceType>(attr);
+  PADDLE_ENFORCE_GE(funcs.size(), 1UL);
+  if (funcs.size() == 1) {
+    return funcs[0].second;
+  }
+  auto& table = AutotuneTable::Global();
+  int64_t key = JitCodeKey<typename KernelTuple::attr_type>(attr);
+  std::string impl;
+  if (!table.Find(KernelTuple::kernel_type, key, &impl)) {
+    double best = -1.;
+    for (auto& func : funcs) {
+      double latency = autotune::Benchmark<T>(func.second, attr);
+      if (latency < 0) {
+        return funcs[0].second;
+      }
+      VLOG(4) << to_string(KernelTuple::kernel_type) << " " << func.first
+              << ": " << latency << " us";
+      if (best < 0 || latency < best) {
+        best = latency;
+        impl = func.first;
+      }
+    }
+    VLOG(3) << "Autotune " << to_string(KernelTuple::kernel_type) << " with "
+            << attr << ": " << impl;
+    table.Insert(KernelTuple::kernel_type, key, impl);
+  }
+  for (auto& func : funcs) {
+    if (func.first == impl) {
+      return func.second;
+    }
+  }
+  // Tuned with an implementation which can not be used any more.
+  return funcs[0].second;
+}
+
 template <typename KernelTuple, typename PlaceType>
 class KernelFuncs {
  public:
@@ -190,8 +238,11 @@ class KernelFuncs {
     if (Has(key)) {
       return funcs_.at(key);
     }
-    // If do not have this attr in cache then get the default best
-    auto func = GetDefaultBestFunc<KernelTuple, PlaceType>(attr);
+    // If do not have this attr in cache then get the default best, or the
+    // autotuned one
+    auto func = AutotuneTable::Global().enabled()
+                    ? GetAutotunedFunc<KernelTuple, PlaceType>(attr)
+                    : GetDefaultBestFunc<KernelTuple, PlaceType>(attr);
     Insert(key, func);
     return func;
   }
@@ -211,11 +262,6 @@ class KernelFuncs {
   std::unordered_map<int64_t, typename KernelTuple::func_type> funcs_;
 };
 
-const char* to_string(KernelType kt);
-const char* to_string(SeqPoolType kt);
-
-KernelType to_kerneltype(const std::string& act);
-
 inline std::ostream& operator<<(std::ostream& os, const lstm_attr_t& attr) {
   os << "dim_size[" << attr.d << "],act_gate[" << to_string(attr.act_gate)
      << "],act_cand[" << to_string(attr.act_cand) << "],act_cell["
@@ -258,6 +304,17 @@ inline std::ostream& operator<<(std::ostream& os, const matmul_attr_t& attr) {
   return os;
 }
 
+inline std::ostream& operator<<(std::ostream& os,
+                                const elementwise_chain_attr_t& attr) {
+  os << "num_inputs[" << attr.num_inputs << "],steps[";
+  for (auto& step : attr.steps) {
+    os << "(" << static_cast<int>(step.op) << "," << step.a << "," << step.b
+       << ")";
+  }
+  os << "],num_outputs[" << attr.outputs.size() << "]";
+  return os;
+}
+
 // expose the method to pack matmul weight
 template <typename T>
 void pack_weights(const T* src, T* dst, int n, int k);
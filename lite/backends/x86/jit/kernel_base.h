@@ -14,6 +14,7 @@
 
 #pragma once
 #include <cstdint>
+#include <vector>
 #include "lite/backends/x86/jit/macro.h"
 
 namespace paddle {
@@ -54,6 +55,7 @@ typedef enum {
   kVSquare,
   kVSub,
   kVTanh,
+  kElementwiseChain,
 } KernelType;
 
 typedef enum {
@@ -328,6 +330,67 @@ struct NCHW16CMulNCTuple {
   typedef void (*func_type)(const T*, const T*, T*, int, int);
 };
 
+typedef enum {
+  kChainAdd = 0,
+  kChainSub,
+  kChainMul,
+  kChainDiv,
+  kChainMax,
+  kChainMin,
+  kChainRelu,
+  kChainClip,       // min(max(a, 0), alpha)
+  kChainLeakyRelu,  // a > 0 ? a : alpha * a
+  kChainSigmoid,
+  kChainTanh,
+  kChainExp,
+  kChainSquare,
+  kChainSqrt,
+  kChainAbs,
+  kChainScale,  // alpha * a + beta
+  kChainIdentity,
+} ElementwiseChainOp;
+
+// The most values of a chain, its inputs and its steps.
+constexpr int kElementwiseChainMaxValues = 64;
+
+// A step of an elementwise chain computes value = op(a, b), a and b being the
+// indices of earlier values, b is -1 for the unary ops.
+typedef struct elementwise_chain_step_s {
+  ElementwiseChainOp op;
+  int a, b;
+  float alpha, beta;
+  elementwise_chain_step_s() = default;
+  elementwise_chain_step_s(ElementwiseChainOp step_op,
+                           int a_,
+                           int b_ = -1,
+                           float alpha_ = 0.f,
+                           float beta_ = 0.f)
+      : op(step_op), a(a_), b(b_), alpha(alpha_), beta(beta_) {}
+} elementwise_chain_step_t;
+
+// The values of a chain are its num_inputs inputs, then the results of its
+// steps. An input is read at every element, unless it is a scalar input read
+// at its first element only. The outputs are written with the values of
+// their indices.
+typedef struct elementwise_chain_attr_s {
+  int num_inputs{0};
+  std::vector<int> scalar_inputs;
+  std::vector<elementwise_chain_step_t> steps;
+  std::vector<int> outputs;
+} elementwise_chain_attr_t;
+
+// inputs, outputs, n, attr
+template <typename T>
+struct ElementwiseChainTuple {
+  static constexpr KernelType kernel_type = kElementwiseChain;
+  typedef T data_type;
+  typedef elementwise_chain_attr_t attr_type;
+  typedef void (*func_type)(const T* const*,
+                            T* const*,
+                            int,
+                            const elementwise_chain_attr_t*);
+};
+
 // Just for adding to kernel pool without template
 class Kernel {
  public:
@@ -14,6 +14,8 @@
 
 #include "lite/backends/x86/jit/kernel_key.h"
 #include <xxhash.h>  // XXH64: 13.8 GB/s
+#include <cstring>
+#include <vector>
 #include "lite/utils/paddle_enforce.h"
 
 namespace paddle {
@@ -66,6 +68,24 @@ int64_t JitCodeKey<sgd_attr_t>(const sgd_attr_t& attr) {
   return attr.grad_width;
 }
 
+template <>
+int64_t JitCodeKey<elementwise_chain_attr_t>(
+    const elementwise_chain_attr_t& attr) {
+  std::vector<int> keys{attr.num_inputs};
+  keys.insert(
+      keys.end(), attr.scalar_inputs.begin(), attr.scalar_inputs.end());
+  for (auto& step : attr.steps) {
+    int alpha, beta;
+    std::memcpy(&alpha, &step.alpha, sizeof(int));
+    std::memcpy(&beta, &step.beta, sizeof(int));
+    keys.insert(keys.end(),
+                {static_cast<int>(step.op), step.a, step.b, alpha, beta});
+  }
+  keys.push_back(-1);
+  keys.insert(keys.end(), attr.outputs.begin(), attr.outputs.end());
+  return XXH64(keys.data(), sizeof(int) * keys.size(), 0);
+}
+
 }  // namespace jit
 }  // namespace lite
 }  // namespace paddle
@@ -541,6 +541,88 @@ void Sgd(const T* lr,
   }
 }
 
+// Runs the steps of a chain on every element, see elementwise_chain_attr_t.
+template <typename T>
+void ElementwiseChain(const T* const* inputs,
+                      T* const* outputs,
+                      int n,
+                      const lite::jit::elementwise_chain_attr_t* attr) {
+  const int num_inputs = attr->num_inputs;
+  const int num_steps = static_cast<int>(attr->steps.size());
+  PADDLE_ENFORCE_LE(num_inputs + num_steps, kElementwiseChainMaxValues);
+  T values[kElementwiseChainMaxValues];
+  for (int i = 0; i < n; ++i) {
+    for (int k = 0; k < num_inputs; ++k) {
+      values[k] = attr->scalar_inputs[k] ? inputs[k][0] : inputs[k][i];
+    }
+    for (int s = 0; s < num_steps; ++s) {
+      const auto& step = attr->steps[s];
+      const T a = values[step.a];
+      const T b = step.b >= 0 ? values[step.b] : static_cast<T>(0);
+      const T alpha = static_cast<T>(step.alpha);
+      T y = a;
+      switch (step.op) {
+        case kChainAdd:
+          y = a + b;
+          break;
+        case kChainSub:
+          y = a - b;
+          break;
+        case kChainMul:
+          y = a * b;
+          break;
+        case kChainDiv:
+          y = a / b;
+          break;
+        case kChainMax:
+          y = a > b ? a : b;
+          break;
+        case kChainMin:
+          y = a < b ? a : b;
+          break;
+        case kChainRelu:
+          y = a > 0 ? a : 0;
+          break;
+        case kChainClip:
+          y = a > 0 ? (a < alpha ? a : alpha) : 0;
+          break;
+        case kChainLeakyRelu:
+          y = a > 0 ? a : alpha * a;
+          break;
+        case kChainSigmoid:
+          VSigmoid(&a, &y, 1);
+          break;
+        case kChainTanh:
+          VTanh(&a, &y, 1);
+          break;
+        case kChainExp:
+          y = std::exp(a);
+          break;
+        case kChainSquare:
+          y = a * a;
+          break;
+        case kChainSqrt:
+          y = std::sqrt(a);
+          break;
+        case kChainAbs:
+          y = std::abs(a);
+          break;
+        case kChainScale:
+          y = alpha * a + static_cast<T>(step.beta);
+          break;
+        case kChainIdentity:
+          break;
+        default:
+          LOG(FATAL) << "Unsupported elementwise chain op " << step.op;
+      }
+      values[num_inputs + s] = y;
+    }
+    for (size_t k = 0; k < attr->outputs.size(); ++k) {
+      outputs[k][i] = values[attr->outputs[k]];
+    }
+  }
+}
+
 #define DECLARE_REFER_KERNEL(name)                                     \
   template <typename T>                                                \
   class name##Kernel : public lite::jit::ReferKernel<name##Tuple<T>> { \
@@ -594,6 +676,7 @@ DECLARE_REFER_KERNEL(Softmax);
 DECLARE_REFER_KERNEL(EmbSeqPool);
 DECLARE_REFER_KERNEL(Sgd);
 DECLARE_REFER_KERNEL(VBroadcast);
+DECLARE_REFER_KERNEL(ElementwiseChain);
 
 #undef DECLARE_REFER_KERNEL
 
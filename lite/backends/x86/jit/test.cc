@@ -16,6 +16,8 @@ limitations under the License. */
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <random>
 #include <string>
@@ -1037,7 +1039,7 @@ TEST(JITKernel_pool, jitcreator) {
 #if defined(_WIN32) || defined(__APPLE__) || defined(__OSX__)
   EXPECT_EQ(jitcreators.size(), 0UL);
 #else
-  EXPECT_EQ(jitcreators.size(), 25UL);
+  EXPECT_EQ(jitcreators.size(), 26UL);
 #endif
 }
 
@@ -1153,6 +1155,60 @@ TEST(JITKernel_helper, GetAllCandidateFuncs) {
   }
 }
 
+TEST(JITKernel_helper, GetAutotunedFunc) {
+  auto& table = jit::AutotuneTable::Global();
+  table.Clear();
+  const int d = 100;
+  std::vector<float> x(d), y(d), ztgt(d), zref(d);
+  RandomVec<float>(d, x.data());
+  RandomVec<float>(d, y.data());
+  auto ref = jit::GetReferFunc<jit::VAddTuple<float>>();
+  auto tgt = jit::GetAutotunedFunc<jit::VAddTuple<float>, CPUPlace>(d);
+  ref(x.data(), y.data(), zref.data(), d);
+  tgt(x.data(), y.data(), ztgt.data(), d);
+  ExpectEQ<float>(ztgt.data(), zref.data(), d);
+  // The winner is tuned once and looked up from then on.
+  auto funcs =
+      jit::GetAllCandidateFuncsWithTypes<jit::VAddTuple<float>, CPUPlace>(d);
+  EXPECT_EQ(table.size(), funcs.size() > 1 ? 1UL : 0UL);
+  EXPECT_TRUE(tgt ==
+              (jit::GetAutotunedFunc<jit::VAddTuple<float>, CPUPlace>(d)));
+
+  // The kernels which can not be benchmarked get the default best one.
+  jit::matmul_attr_t attr(3, 4, 5);
+  EXPECT_TRUE((jit::GetAutotunedFunc<jit::MatMulTuple<float>, CPUPlace>(
+                  attr)) ==
+              (jit::GetDefaultBestFunc<jit::MatMulTuple<float>, CPUPlace>(
+                  attr)));
+}
+
+TEST(JITKernel_helper, AutotuneTable) {
+  auto& table = jit::AutotuneTable::Global();
+  table.Clear();
+  table.Insert(jit::kVAdd, 8, "Refer");
+  table.Insert(jit::kSeqPool, -123456789012345LL, "JitCode");
+  const std::string path = "jit_autotune_test.txt";
+  ASSERT_TRUE(table.Save(path));
+
+  table.Clear();
+  ASSERT_TRUE(table.Load(path));
+  EXPECT_EQ(table.size(), 2UL);
+  std::string impl;
+  ASSERT_TRUE(table.Find(jit::kSeqPool, -123456789012345LL, &impl));
+  EXPECT_EQ(impl, "JitCode");
+  EXPECT_FALSE(table.Find(jit::kVAdd, 9, &impl));
+
+  // A table tuned on another machine is ignored.
+  {
+    std::ofstream fout(path);
+    fout << "# machine: another cpu\n" << jit::kVAdd << " 9 Refer\n";
+  }
+  EXPECT_FALSE(table.Load(path));
+  EXPECT_FALSE(table.Find(jit::kVAdd, 9, &impl));
+  table.Clear();
+  std::remove(path.c_str());
+}
+
 TEST(JITKernel_helper, pack_weights) {
   const int N = 8 * 60, K = 2;
   float src[K][N], yref[K][N], y[K * N];
@@ -0,0 +1,80 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <immintrin.h>
+
+// The AVX2 code of the x86 math functions is compiled for it whatever the
+// flags of the build, and only runs if MayIUse(avx2).
+#if defined(__GNUC__) || defined(__clang__)
+#define X86_MATH_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define X86_MATH_WITH_AVX2
+#endif
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+#ifdef X86_MATH_WITH_AVX2
+// exp(x) for x <= 0, as 2^k * exp(r) with r = x - k * ln(2) in
+// [-ln(2) / 2, ln(2) / 2] and exp(r) by its polynomial of degree 7 of Cephes.
+// x is clamped at the smallest normal result.
+X86_MATH_TARGET_AVX2
+inline __m256 ExpAvx2(__m256 x) {
+  const __m256 ln2_hi = _mm256_set1_ps(0.693359375f);
+  const __m256 ln2_lo = _mm256_set1_ps(-2.12194440e-4f);
+  x = _mm256_max_ps(x, _mm256_set1_ps(-87.3365448f));
+  __m256 k = _mm256_floor_ps(
+      _mm256_fmadd_ps(x, _mm256_set1_ps(1.44269504f), _mm256_set1_ps(0.5f)));
+  __m256 r = _mm256_fnmadd_ps(k, ln2_hi, x);
+  r = _mm256_fnmadd_ps(k, ln2_lo, r);
+  __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+  p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), r);
+  p = _mm256_add_ps(p, _mm256_set1_ps(1.f));
+  __m256i e = _mm256_add_epi32(_mm256_cvtps_epi32(k), _mm256_set1_epi32(127));
+  return _mm256_mul_ps(p, _mm256_castsi256_ps(_mm256_slli_epi32(e, 23)));
+}
+
+// The maximum of the 8 lanes of x.
+X86_MATH_TARGET_AVX2
+inline float ReduceMaxAvx2(__m256 x) {
+  __m128 max4 =
+      _mm_max_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+  max4 = _mm_max_ps(max4, _mm_movehl_ps(max4, max4));
+  max4 = _mm_max_ss(max4, _mm_movehdup_ps(max4));
+  return _mm_cvtss_f32(max4);
+}
+
+// The sum of the 8 lanes of x.
+X86_MATH_TARGET_AVX2
+inline float ReduceSumAvx2(__m256 x) {
+  __m128 sum4 =
+      _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+  sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+  sum4 = _mm_add_ss(sum4, _mm_movehdup_ps(sum4));
+  return _mm_cvtss_f32(sum4);
+}
+#endif  // X86_MATH_WITH_AVX2
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
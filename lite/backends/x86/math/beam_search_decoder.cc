@@ -0,0 +1,301 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/math/beam_search_decoder.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "lite/backends/x86/cpu_info.h"
+#include "lite/backends/x86/math/avx2_exp.h"
+#include "lite/utils/cp_logging.h"
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+namespace {
+
+// Insert `value` into the `*size` values of `top` sorted in descending order,
+// which keeps at most k of them. The equal values keep their order.
+inline void InsertTop(
+    float value, int id, int k, int* size, float* top, int* top_ids) {
+  int i = *size < k ? (*size)++ : k - 1;
+  for (; i > 0 && top[i - 1] < value; --i) {
+    top[i] = top[i - 1];
+    top_ids[i] = top_ids[i - 1];
+  }
+  top[i] = value;
+  top_ids[i] = id;
+}
+
+void LogSoftmaxTopkRef(
+    const float* x, int n, int k, float* top_scores, int* top_ids) {
+  const float max = *std::max_element(x, x + n);
+  int size = 0;
+  float sum = 0.f;
+  for (int i = 0; i < n; ++i) {
+    sum += std::exp(x[i] - max);
+    if (size < k || x[i] > top_scores[k - 1]) {
+      InsertTop(x[i], i, k, &size, top_scores, top_ids);
+    }
+  }
+  const float lse = max + std::log(sum);
+  for (int i = 0; i < k; ++i) {
+    top_scores[i] -= lse;
+  }
+}
+
+#ifdef X86_MATH_WITH_AVX2
+// The vocabulary is much larger than k, most blocks of 8 values have none
+// above the k-th largest value so far and only add to the sum of exp.
+X86_MATH_TARGET_AVX2
+void LogSoftmaxTopkAvx2(
+    const float* x, int n, int k, float* top_scores, int* top_ids) {
+  const int n8 = n / 8 * 8;
+  __m256 vmax = _mm256_set1_ps(-FLT_MAX);
+  for (int i = 0; i < n8; i += 8) {
+    vmax = _mm256_max_ps(vmax, _mm256_loadu_ps(x + i));
+  }
+  float max = ReduceMaxAvx2(vmax);
+  for (int i = n8; i < n; ++i) {
+    max = std::max(max, x[i]);
+  }
+
+  int size = 0;
+  float sum = 0.f;
+  int i = 0;
+  for (; i < k; ++i) {
+    sum += std::exp(x[i] - max);
+    InsertTop(x[i], i, k, &size, top_scores, top_ids);
+  }
+  vmax = _mm256_set1_ps(max);
+  __m256 vsum = _mm256_setzero_ps();
+  __m256 vmin = _mm256_set1_ps(top_scores[k - 1]);
+  for (; i + 8 <= n; i += 8) {
+    __m256 v = _mm256_loadu_ps(x + i);
+    vsum = _mm256_add_ps(vsum, ExpAvx2(_mm256_sub_ps(v, vmax)));
+    int mask = _mm256_movemask_ps(_mm256_cmp_ps(v, vmin, _CMP_GT_OQ));
+    if (!mask) continue;
+    for (; mask; mask &= mask - 1) {
+      int j = i + __builtin_ctz(mask);
+      if (x[j] > top_scores[k - 1]) {
+        InsertTop(x[j], j, k, &size, top_scores, top_ids);
+      }
+    }
+    vmin = _mm256_set1_ps(top_scores[k - 1]);
+  }
+  sum += ReduceSumAvx2(vsum);
+  for (; i < n; ++i) {
+    sum += std::exp(x[i] - max);
+    if (x[i] > top_scores[k - 1]) {
+      InsertTop(x[i], i, k, &size, top_scores, top_ids);
+    }
+  }
+
+  const float lse = max + std::log(sum);
+  for (int j = 0; j < k; ++j) {
+    top_scores[j] -= lse;
+  }
+}
+#endif  // X86_MATH_WITH_AVX2
+
+using LogSoftmaxTopkFunc = void (*)(const float*, int, int, float*, int*);
+
+LogSoftmaxTopkFunc SelectLogSoftmaxTopk() {
+#ifdef X86_MATH_WITH_AVX2
+  if (MayIUse(avx2)) return LogSoftmaxTopkAvx2;
+#endif
+  return LogSoftmaxTopkRef;
+}
+
+}  // namespace
+
+void log_softmax_topk(
+    const float* x, int n, int k, float* top_scores, int* top_ids) {
+  static const LogSoftmaxTopkFunc func = SelectLogSoftmaxTopk();
+  CHECK(k > 0 && k <= n) << "k " << k << " out of [1, " << n << "]";
+  func(x, n, k, top_scores, top_ids);
+}
+
+BeamSearchDecoder::BeamSearchDecoder(
+    int max_batch, int beam_size, int vocab_size, int max_steps, int end_id)
+    : max_batch_(max_batch),
+      beam_size_(beam_size),
+      vocab_size_(vocab_size),
+      max_steps_(max_steps),
+      end_id_(end_id) {
+  CHECK_GT(max_batch, 0);
+  CHECK_GT(max_steps, 0);
+  CHECK(beam_size > 0 && beam_size <= vocab_size)
+      << "beam_size " << beam_size << " out of [1, " << vocab_size << "]";
+  const size_t rows = static_cast<size_t>(max_batch) * beam_size;
+  scores_.resize(rows);
+  next_scores_.resize(rows);
+  candidate_scores_.resize(rows * beam_size);
+  candidate_ids_.resize(rows * beam_size);
+  step_ids_.resize(rows * max_steps);
+  step_parents_.resize(rows * max_steps);
+  request_done_.resize(max_batch);
+}
+
+void BeamSearchDecoder::Start(int batch) {
+  CHECK(batch > 0 && batch <= max_batch_)
+      << "batch " << batch << " out of [1, " << max_batch_ << "]";
+  batch_ = batch;
+  step_ = 0;
+  std::fill(scores_.begin(), scores_.end(), 0.f);
+  std::fill(request_done_.begin(), request_done_.end(), 0);
+}
+
+bool BeamSearchDecoder::finished() const {
+  if (step_ >= max_steps_) return true;
+  return std::all_of(request_done_.begin(),
+                     request_done_.begin() + batch_,
+                     [](char done) { return done != 0; });
+}
+
+const int64_t* BeamSearchDecoder::ids() const {
+  CHECK_GT(step_, 0) << "no step is run";
+  return step_ids_.data() +
+         static_cast<size_t>(step_ - 1) * batch_ * beam_size_;
+}
+
+const int* BeamSearchDecoder::parents() const {
+  CHECK_GT(step_, 0) << "no step is run";
+  return step_parents_.data() +
+         static_cast<size_t>(step_ - 1) * batch_ * beam_size_;
+}
+
+void BeamSearchDecoder::Step(const float* logits) {
+  CHECK(batch_ > 0) << "Start is not called";
+  CHECK(!finished()) << "the decoding is finished";
+  const int64_t rows = static_cast<int64_t>(batch_) * beam_size_;
+  if (pool_ && pool_->num_threads() > 1) {
+    pool_->ParallelFor(rows, [&](int64_t begin, int64_t end) {
+      SelectRows(begin, end, logits);
+    });
+  } else {
+    SelectRows(0, rows, logits);
+  }
+  for (int r = 0; r < batch_; ++r) {
+    SelectBeams(r);
+  }
+  // Both hold max_batch * beam_size scores, this does not allocate.
+  scores_.swap(next_scores_);
+  ++step_;
+}
+
+void BeamSearchDecoder::SelectRows(int64_t begin,
+                                   int64_t end,
+                                   const float* logits) {
+  const size_t stride = static_cast<size_t>(batch_) * beam_size_;
+  const int64_t* last_ids =
+      step_ > 0 ? step_ids_.data() + (step_ - 1) * stride : nullptr;
+  for (int64_t row = begin; row < end; ++row) {
+    const int r = static_cast<int>(row / beam_size_);
+    const int b = static_cast<int>(row % beam_size_);
+    if (request_done_[r] || (step_ == 0 && b > 0) ||
+        (last_ids && last_ids[row] == end_id_)) {
+      continue;
+    }
+    log_softmax_topk(logits + row * vocab_size_,
+                     vocab_size_,
+                     beam_size_,
+                     candidate_scores_.data() + row * beam_size_,
+                     candidate_ids_.data() + row * beam_size_);
+  }
+}
+
+void BeamSearchDecoder::SelectBeams(int request) {
+  const int k = beam_size_;
+  const size_t stride = static_cast<size_t>(batch_) * k;
+  const int base = request * k;
+  float* top = next_scores_.data() + base;
+  int64_t* out_ids = step_ids_.data() + step_ * stride + base;
+  int* out_parents = step_parents_.data() + step_ * stride + base;
+  if (request_done_[request]) {
+    for (int b = 0; b < k; ++b) {
+      top[b] = scores_[base + b];
+      out_ids[b] = end_id_;
+      out_parents[b] = base + b;
+    }
+    return;
+  }
+
+  const int64_t* last_ids =
+      step_ > 0 ? step_ids_.data() + (step_ - 1) * stride : nullptr;
+  int size = 0;
+  auto insert = [&](float score, int parent, int64_t id) {
+    int i = size < k ? size++ : k - 1;
+    for (; i > 0 && top[i - 1] < score; --i) {
+      top[i] = top[i - 1];
+      out_ids[i] = out_ids[i - 1];
+      out_parents[i] = out_parents[i - 1];
+    }
+    top[i] = score;
+    out_ids[i] = id;
+    out_parents[i] = parent;
+  };
+  // The candidates of a beam are sorted, the first one not better than the
+  // k-th best sequence ends the beam.
+  const int beams = step_ == 0 ? 1 : k;
+  for (int b = 0; b < beams; ++b) {
+    const int row = base + b;
+    if (last_ids && last_ids[row] == end_id_) {
+      if (size < k || scores_[row] > top[k - 1]) {
+        insert(scores_[row], row, end_id_);
+      }
+      continue;
+    }
+    const float* scores = candidate_scores_.data() + row * k;
+    const int* ids = candidate_ids_.data() + row * k;
+    for (int j = 0; j < k; ++j) {
+      const float score = scores_[row] + scores[j];
+      if (size == k && score <= top[k - 1]) break;
+      insert(score, row, ids[j]);
+    }
+  }
+  CHECK_EQ(size, k);
+  request_done_[request] = std::all_of(
+      out_ids, out_ids + k, [&](int64_t id) { return id == end_id_; });
+}
+
+void BeamSearchDecoder::GetResult(int request,
+                                  std::vector<std::vector<int64_t>>* sentences,
+                                  std::vector<float>* sentence_scores) const {
+  CHECK_GT(step_, 0) << "no step is run";
+  const size_t stride = static_cast<size_t>(batch_) * beam_size_;
+  sentences->assign(beam_size_, {});
+  sentence_scores->assign(beam_size_, 0.f);
+  for (int b = 0; b < beam_size_; ++b) {
+    auto& sentence = (*sentences)[b];
+    int row = request * beam_size_ + b;
+    (*sentence_scores)[b] = scores_[row];
+    for (int t = step_ - 1; t >= 0; --t) {
+      sentence.push_back(step_ids_[t * stride + row]);
+      row = step_parents_[t * stride + row];
+    }
+    std::reverse(sentence.begin(), sentence.end());
+    auto end = std::find(sentence.begin(), sentence.end(), end_id_);
+    if (end != sentence.end()) {
+      sentence.erase(end + 1, sentence.end());
+    }
+  }
+}
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
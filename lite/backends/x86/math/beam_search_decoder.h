@@ -0,0 +1,113 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "lite/backends/x86/thread_pool.h"
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// The k largest values of log_softmax(x) over the n values of x, in
+// descending order, and their indices in `top_ids`. The log-sum-exp and the
+// selection are done in the same pass over x, which only inserts the values
+// above the current k-th largest one. It runs with AVX2 if the CPU has it.
+void log_softmax_topk(
+    const float* x, int n, int k, float* top_scores, int* top_ids);
+
+/*
+ * A beam search over the logits of a decoder, for the models that run their
+ * decoder step by step instead of in a while op.
+ *
+ * The decoder keeps `beam_size` beams for each of the `batch` requests
+ * started together, all the state is allocated by the constructor for
+ * `max_batch` requests of `max_steps` steps. A step:
+ *
+ *  - takes the logits of the batch * beam_size beams, the row of beam b of
+ *    request r is r * beam_size + b. At the first step only beam 0 of each
+ *    request is read, the others are copies of it.
+ *  - scores the words of every beam with log_softmax_topk, and keeps the
+ *    beam_size best sequences of each request.
+ *  - gives the selected words in ids() and the rows of their parent beams in
+ *    parents(), to gather the decoder state for the next step.
+ *
+ * A beam ending with `end_id` keeps its score and only extends with end_id.
+ * A request whose beams all ended is done, its rows are skipped.
+ */
+class BeamSearchDecoder {
+ public:
+  BeamSearchDecoder(
+      int max_batch, int beam_size, int vocab_size, int max_steps, int end_id);
+
+  // The rows of the logits are split over the threads of `pool`.
+  void SetThreadPool(ThreadPool* pool) { pool_ = pool; }
+
+  // Start the decoding of `batch` requests, without any allocation.
+  void Start(int batch);
+  // The logits are [batch * beam_size, vocab_size].
+  void Step(const float* logits);
+
+  int batch() const { return batch_; }
+  int beam_size() const { return beam_size_; }
+  int step() const { return step_; }
+  bool done(int request) const { return request_done_[request] != 0; }
+  // Whether all the requests are done or max_steps are run.
+  bool finished() const;
+
+  // The words selected by the last step, their parent rows and the scores of
+  // the beams, batch * beam_size values sorted by score in each request.
+  const int64_t* ids() const;
+  const int* parents() const;
+  const float* scores() const { return scores_.data(); }
+
+  // The beam_size sequences of `request` sorted by score, up to their first
+  // end_id included.
+  void GetResult(int request,
+                 std::vector<std::vector<int64_t>>* sentences,
+                 std::vector<float>* sentence_scores) const;
+
+ private:
+  void SelectRows(int64_t begin, int64_t end, const float* logits);
+  void SelectBeams(int request);
+
+  const int max_batch_;
+  const int beam_size_;
+  const int vocab_size_;
+  const int max_steps_;
+  const int end_id_;
+  ThreadPool* pool_{nullptr};
+
+  int batch_{0};
+  int step_{0};
+  // [max_batch * beam_size], the accumulated log probabilities.
+  std::vector<float> scores_;
+  std::vector<float> next_scores_;
+  // [max_batch * beam_size * beam_size], the best words of every beam.
+  std::vector<float> candidate_scores_;
+  std::vector<int> candidate_ids_;
+  // [max_steps * max_batch * beam_size], the words and the parent beams of
+  // each step.
+  std::vector<int64_t> step_ids_;
+  std::vector<int> step_parents_;
+  std::vector<char> request_done_;
+};
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -79,6 +79,36 @@ extern MatDescriptor CreateMatrixDescriptor(const lite::DDimLite& tensor_dim,
                                             int num_flatten_cols,
                                             bool trans);
 
+/**
+ * Keep the BLAS calls of the current thread single-threaded while in scope,
+ * if `enable`, e.g. for the GEMMs run on the threads of a split loop, which
+ * would oversubscribe the cores otherwise.
+ */
+class ScopedSingleThreadedBlas {
+ public:
+  explicit ScopedSingleThreadedBlas(bool enable) {
+#ifdef PADDLE_WITH_MKLML
+    if (enable) {
+      enabled_ = true;
+      threads_ = lite::x86::MKL_Set_Num_Threads_Local(1);
+    }
+#endif
+  }
+  ~ScopedSingleThreadedBlas() {
+#ifdef PADDLE_WITH_MKLML
+    if (enabled_) {
+      lite::x86::MKL_Set_Num_Threads_Local(threads_);
+    }
+#endif
+  }
+
+ private:
+#ifdef PADDLE_WITH_MKLML
+  bool enabled_{false};
+  int threads_{0};
+#endif
+};
+
 template <lite::TargetType Target>
 class Blas {
  public:
@@ -256,6 +286,27 @@ class Blas {
                    int64_t strideA,
                    int64_t strideB) const;
 
+  // The same, with the leading dimensions and the stride of C given, e.g. for
+  // submatrices of a larger one.
+  template <typename T>
+  void BatchedGEMM(CBLAS_TRANSPOSE transA,
+                   CBLAS_TRANSPOSE transB,
+                   int M,
+                   int N,
+                   int K,
+                   T alpha,
+                   const T* A,
+                   int lda,
+                   int64_t strideA,
+                   const T* B,
+                   int ldb,
+                   int64_t strideB,
+                   T beta,
+                   T* C,
+                   int ldc,
+                   int64_t strideC,
+                   int batchCount) const;
+
   template <typename T>
   void MatMul(const lite::TensorLite& mat_a,
               const MatDescriptor& dim_a,
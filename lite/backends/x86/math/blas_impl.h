@@ -679,6 +679,70 @@ void Blas<lite::TargetType::kX86>::BatchedGEMM(CBLAS_TRANSPOSE transA,
 #endif
 }
 
+template <>
+template <typename T>
+void Blas<lite::TargetType::kX86>::BatchedGEMM(CBLAS_TRANSPOSE transA,
+                                               CBLAS_TRANSPOSE transB,
+                                               int M,
+                                               int N,
+                                               int K,
+                                               T alpha,
+                                               const T *A,
+                                               int lda,
+                                               int64_t strideA,
+                                               const T *B,
+                                               int ldb,
+                                               int64_t strideB,
+                                               T beta,
+                                               T *C,
+                                               int ldc,
+                                               int64_t strideC,
+                                               int batchCount) const {
+#ifdef PADDLE_WITH_MKLML
+  auto a_array = std::vector<const T *>(batchCount);
+  auto b_array = std::vector<const T *>(batchCount);
+  auto c_array = std::vector<T *>(batchCount);
+  for (int k = 0; k < batchCount; ++k) {
+    a_array[k] = &A[k * strideA];
+    b_array[k] = &B[k * strideB];
+    c_array[k] = &C[k * strideC];
+  }
+
+  CBlas<T>::GEMM_BATCH(CblasRowMajor,
+                       &transA,
+                       &transB,
+                       &M,
+                       &N,
+                       &K,
+                       &alpha,
+                       a_array.data(),
+                       &lda,
+                       b_array.data(),
+                       &ldb,
+                       &beta,
+                       c_array.data(),
+                       &ldc,
+                       1 /* group_count */,
+                       &batchCount);
+#else
+  for (int k = 0; k < batchCount; ++k) {
+    this->template GEMM<T>(transA,
+                           transB,
+                           M,
+                           N,
+                           K,
+                           alpha,
+                           &A[k * strideA],
+                           lda,
+                           &B[k * strideB],
+                           ldb,
+                           beta,
+                           &C[k * strideC],
+                           ldc);
+  }
+#endif
+}
+
 template <lite::TargetType Target>
 template <typename T>
 void Blas<Target>::MatMul(
@@ -0,0 +1,320 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/math/gemm_int8.h"
+#include <immintrin.h>
+#include <algorithm>
+#include "lite/backends/x86/cpu_info.h"
+
+// The SIMD kernels are compiled for their instruction sets whatever the flags
+// of the build, and only run if the CPU has them.
+#if defined(__GNUC__) || defined(__clang__)
+#define GEMM_INT8_TARGET(isa) __attribute__((target(isa)))
+#define GEMM_INT8_WITH_AVX2
+#if (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 8) || \
+    (defined(__clang__) && __clang_major__ >= 6)
+#define GEMM_INT8_WITH_VNNI
+#endif
+#endif
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+namespace {
+
+// The rows of A in a block of the loops, which are reused from the cache
+// while the columns of B sweep over them.
+const int kBlockBytes = 32 * 1024;
+
+inline int BlockRows(int K) {
+  return std::max(1, kBlockBytes / std::max(K, 1));
+}
+
+int32_t DotRef(const int8_t* a, const int8_t* b, int k) {
+  int32_t sum = 0;
+  for (int i = 0; i < k; ++i) {
+    sum += static_cast<int32_t>(a[i]) * static_cast<int32_t>(b[i]);
+  }
+  return sum;
+}
+
+void GemmRef(int M,
+             int N,
+             int K,
+             const int8_t* A,
+             int lda,
+             const int8_t* B,
+             int ldb,
+             int32_t* C,
+             int ldc) {
+  for (int m = 0; m < M; ++m) {
+    for (int n = 0; n < N; ++n) {
+      C[m * ldc + n] = DotRef(A + m * lda, B + n * ldb, K);
+    }
+  }
+}
+
+#ifdef GEMM_INT8_WITH_AVX2
+// The products of a and b are taken as |a| * (b * sign(a)), the unsigned by
+// signed products of the integer dot product instructions. Neither |a| <= 128
+// nor |b| <= 127 overflow the 16 bits sums of pairs of AVX2.
+GEMM_INT8_TARGET("avx2")
+inline __m256i DotAvx2(__m256i acc, __m256i a, __m256i b) {
+  const __m256i ones = _mm256_set1_epi16(1);
+  __m256i products =
+      _mm256_maddubs_epi16(_mm256_abs_epi8(a), _mm256_sign_epi8(b, a));
+  return _mm256_add_epi32(acc, _mm256_madd_epi16(products, ones));
+}
+
+// The sums of the lanes of the 4 accumulators.
+GEMM_INT8_TARGET("avx2")
+inline __m128i Reduce4(__m256i acc0, __m256i acc1, __m256i acc2, __m256i acc3) {
+  __m256i sum = _mm256_hadd_epi32(_mm256_hadd_epi32(acc0, acc1),
+                                  _mm256_hadd_epi32(acc2, acc3));
+  return _mm_add_epi32(_mm256_castsi256_si128(sum),
+                       _mm256_extracti128_si256(sum, 1));
+}
+
+GEMM_INT8_TARGET("avx2")
+inline int32_t Reduce1(__m256i acc) {
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                              _mm256_extracti128_si256(acc, 1));
+  sum = _mm_hadd_epi32(sum, sum);
+  sum = _mm_hadd_epi32(sum, sum);
+  return _mm_cvtsi128_si32(sum);
+}
+
+// The loops of the SIMD kernels: a row of A by 4 rows of B at a time, the
+// 32 bytes steps of K accumulated by DOT.
+#define GEMM_S8S8_LOOPS(DOT)                                                 \
+  const int k32 = K / 32 * 32;                                               \
+  const int block = BlockRows(K);                                            \
+  for (int m0 = 0; m0 < M; m0 += block) {                                    \
+    const int m1 = std::min(M, m0 + block);                                  \
+    int n = 0;                                                               \
+    for (; n + 4 <= N; n += 4) {                                             \
+      const int8_t* b0 = B + n * ldb;                                        \
+      const int8_t* b1 = b0 + ldb;                                           \
+      const int8_t* b2 = b1 + ldb;                                           \
+      const int8_t* b3 = b2 + ldb;                                           \
+      for (int m = m0; m < m1; ++m) {                                        \
+        const int8_t* a = A + m * lda;                                       \
+        __m256i acc0 = _mm256_setzero_si256();                               \
+        __m256i acc1 = _mm256_setzero_si256();                               \
+        __m256i acc2 = _mm256_setzero_si256();                               \
+        __m256i acc3 = _mm256_setzero_si256();                               \
+        for (int k = 0; k < k32; k += 32) {                                  \
+          __m256i va = _mm256_loadu_si256(                                   \
+              reinterpret_cast<const __m256i*>(a + k));                      \
+          acc0 = DOT(acc0,                                                   \
+                     va,                                                     \
+                     _mm256_loadu_si256(                                     \
+                         reinterpret_cast<const __m256i*>(b0 + k)));         \
+          acc1 = DOT(acc1,                                                   \
+                     va,                                                     \
+                     _mm256_loadu_si256(                                     \
+                         reinterpret_cast<const __m256i*>(b1 + k)));         \
+          acc2 = DOT(acc2,                                                   \
+                     va,                                                     \
+                     _mm256_loadu_si256(                                     \
+                         reinterpret_cast<const __m256i*>(b2 + k)));         \
+          acc3 = DOT(acc3,                                                   \
+                     va,                                                     \
+                     _mm256_loadu_si256(                                     \
+                         reinterpret_cast<const __m256i*>(b3 + k)));         \
+        }                                                                    \
+        int32_t sums[4];                                                     \
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(sums),                   \
+                         Reduce4(acc0, acc1, acc2, acc3));                   \
+        int32_t* c = C + m * ldc + n;                                        \
+        c[0] = sums[0] + DotRef(a + k32, b0 + k32, K - k32);                 \
+        c[1] = sums[1] + DotRef(a + k32, b1 + k32, K - k32);                 \
+        c[2] = sums[2] + DotRef(a + k32, b2 + k32, K - k32);                 \
+        c[3] = sums[3] + DotRef(a + k32, b3 + k32, K - k32);                 \
+      }                                                                      \
+    }                                                                        \
+    for (; n < N; ++n) {                                                     \
+      const int8_t* b = B + n * ldb;                                         \
+      for (int m = m0; m < m1; ++m) {                                        \
+        const int8_t* a = A + m * lda;                                       \
+        __m256i acc = _mm256_setzero_si256();                                \
+        for (int k = 0; k < k32; k += 32) {                                  \
+          acc = DOT(                                                         \
+              acc,                                                           \
+              _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + k)),   \
+              _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + k)));  \
+        }                                                                    \
+        C[m * ldc + n] = Reduce1(acc) + DotRef(a + k32, b + k32, K - k32);   \
+      }                                                                      \
+    }                                                                        \
+  }
+
+GEMM_INT8_TARGET("avx2")
+void GemmAvx2(int M,
+              int N,
+              int K,
+              const int8_t* A,
+              int lda,
+              const int8_t* B,
+              int ldb,
+              int32_t* C,
+              int ldc) {
+  GEMM_S8S8_LOOPS(DotAvx2)
+}
+
+#ifdef GEMM_INT8_WITH_VNNI
+// The same products, without the 16 bits intermediate sums.
+GEMM_INT8_TARGET("avx2,avx512f,avx512vl,avx512vnni")
+inline __m256i DotVnni(__m256i acc, __m256i a, __m256i b) {
+  return _mm256_dpbusd_epi32(acc, _mm256_abs_epi8(a), _mm256_sign_epi8(b, a));
+}
+
+GEMM_INT8_TARGET("avx2,avx512f,avx512vl,avx512vnni")
+void GemmVnni(int M,
+              int N,
+              int K,
+              const int8_t* A,
+              int lda,
+              const int8_t* B,
+              int ldb,
+              int32_t* C,
+              int ldc) {
+  GEMM_S8S8_LOOPS(DotVnni)
+}
+#endif  // GEMM_INT8_WITH_VNNI
+
+#undef GEMM_S8S8_LOOPS
+#endif  // GEMM_INT8_WITH_AVX2
+
+using GemmFunc = void (*)(int,
+                          int,
+                          int,
+                          const int8_t*,
+                          int,
+                          const int8_t*,
+                          int,
+                          int32_t*,
+                          int);
+
+GemmFunc SelectGemm() {
+#ifdef GEMM_INT8_WITH_VNNI
+  if (MayIUse(avx512_core_vnni)) return GemmVnni;
+#endif
+#ifdef GEMM_INT8_WITH_AVX2
+  if (MayIUse(avx2)) return GemmAvx2;
+#endif
+  return GemmRef;
+}
+
+inline int8_t RoundToInt8(float v) {
+  v = std::min(std::max(v, -127.f), 127.f);
+  return static_cast<int8_t>(v >= 0.f ? v + 0.5f : v - 0.5f);
+}
+
+template <typename OutT>
+inline OutT Convert(float v);
+
+template <>
+inline float Convert<float>(float v) {
+  return v;
+}
+
+template <>
+inline int8_t Convert<int8_t>(float v) {
+  return RoundToInt8(v);
+}
+
+template <typename OutT>
+void Int32To(const int32_t* in,
+             int ldi,
+             OutT* out,
+             int ldo,
+             int rows,
+             int cols,
+             const float* scale,
+             const float* bias,
+             bool per_row,
+             bool relu) {
+  for (int i = 0; i < rows; ++i) {
+    const int32_t* x = in + i * ldi;
+    OutT* y = out + i * ldo;
+    for (int j = 0; j < cols; ++j) {
+      int c = per_row ? i : j;
+      float v = x[j] * scale[c] + (bias ? bias[c] : 0.f);
+      if (relu) v = std::max(v, 0.f);
+      y[j] = Convert<OutT>(v);
+    }
+  }
+}
+
+}  // namespace
+
+void gemm_s8s8(int M,
+               int N,
+               int K,
+               const int8_t* A,
+               int lda,
+               const int8_t* B,
+               int ldb,
+               int32_t* C,
+               int ldc) {
+  static const GemmFunc gemm = SelectGemm();
+  gemm(M, N, K, A, lda, B, ldb, C, ldc);
+}
+
+void fp32_to_int8(const float* in, int8_t* out, int64_t n, float scale) {
+  const float inv_scale = 1.f / scale;
+  for (int64_t i = 0; i < n; ++i) {
+    out[i] = RoundToInt8(in[i] * inv_scale);
+  }
+}
+
+void int8_to_fp32(const int8_t* in, float* out, int64_t n, float scale) {
+  for (int64_t i = 0; i < n; ++i) {
+    out[i] = in[i] * scale;
+  }
+}
+
+void dequantize_int32(const int32_t* in,
+                      int ldi,
+                      float* out,
+                      int ldo,
+                      int rows,
+                      int cols,
+                      const float* scale,
+                      const float* bias,
+                      bool per_row,
+                      bool relu) {
+  Int32To(in, ldi, out, ldo, rows, cols, scale, bias, per_row, relu);
+}
+
+void dequantize_int32(const int32_t* in,
+                      int ldi,
+                      int8_t* out,
+                      int ldo,
+                      int rows,
+                      int cols,
+                      const float* scale,
+                      const float* bias,
+                      bool per_row,
+                      bool relu) {
+  Int32To(in, ldi, out, ldo, rows, cols, scale, bias, per_row, relu);
+}
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,82 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+/*
+ * The int8 primitives of the x86 quantized kernels. The values are quantized
+ * symmetrically, i.e. fp32 = int8 * scale, to [-127, 127].
+ */
+
+// C[m][n] = sum_k A[m][k] * B[n][k], i.e. both operands are contiguous along
+// K, as a conv filter and an im2col of [positions, K], or an input and the
+// transposed weights of a fc. B must not hold -128.
+//
+// It runs with AVX512-VNNI or AVX2 integer dot products if the CPU has them,
+// and with scalar code otherwise. It is single-threaded, the callers split
+// M or N over their threads.
+void gemm_s8s8(int M,
+               int N,
+               int K,
+               const int8_t* A,
+               int lda,
+               const int8_t* B,
+               int ldb,
+               int32_t* C,
+               int ldc);
+
+// out = clamp(round(in / scale), -127, 127)
+void fp32_to_int8(const float* in, int8_t* out, int64_t n, float scale);
+
+// out = in * scale
+void int8_to_fp32(const int8_t* in, float* out, int64_t n, float scale);
+
+// The epilogue of gemm_s8s8:
+//   out[i][j] = in[i][j] * scale[i] + bias[i]
+// if per_row, or with scale[j] and bias[j] otherwise, clamped at 0 if relu.
+// bias may be null.
+void dequantize_int32(const int32_t* in,
+                      int ldi,
+                      float* out,
+                      int ldo,
+                      int rows,
+                      int cols,
+                      const float* scale,
+                      const float* bias,
+                      bool per_row,
+                      bool relu);
+
+// The same, rounded to int8, the output scale is folded in scale and bias.
+void dequantize_int32(const int32_t* in,
+                      int ldi,
+                      int8_t* out,
+                      int ldo,
+                      int rows,
+                      int cols,
+                      const float* scale,
+                      const float* bias,
+                      bool per_row,
+                      bool relu);
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
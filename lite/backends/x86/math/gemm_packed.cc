@@ -0,0 +1,239 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/math/gemm_packed.h"
+#include <algorithm>
+#include <map>
+#include <mutex>  // NOLINT
+#include <tuple>
+#include "lite/backends/x86/math/blas.h"
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+namespace {
+
+// The packs in use by the buffer of the weight, B, K, N and ldb. A pack
+// holds its buffer, which is not released and reused for another weight
+// while the pack is found here.
+template <typename T>
+struct PackRegistry {
+  using key_t = std::tuple<const lite::Buffer*, const T*, int, int, int>;
+
+  static PackRegistry& Global() {
+    static auto* x = new PackRegistry;
+    return *x;
+  }
+
+  std::mutex mutex;
+  std::map<key_t, std::weak_ptr<const PackedGemm<T>>> packs;
+};
+
+}  // namespace
+
+template <typename T>
+const int PackedGemm<T>::kPanelCols;
+template <typename T>
+const int PackedGemm<T>::kMaxPanelRows;
+
+template <typename T>
+PackedGemm<T>::PackedGemm(const lite::X86Context& context,
+                          int K,
+                          int N,
+                          const T* B,
+                          int ldb)
+    : K_(K), N_(N), B_(B), ldb_(ldb) {
+  CHECK_GT(K, 0);
+  CHECK_GT(N, 0);
+  CHECK_GE(ldb, N);
+#ifdef PADDLE_WITH_MKLML
+  auto blas = GetBlas<lite::TargetType::kX86, T>(context);
+  mkl_packed_ = blas.GEMM_ALLOC(CblasBMatrix, 1, N, K);
+  CHECK(mkl_packed_);
+  blas.GEMM_PACK(
+      CblasBMatrix, CblasNoTrans, 1, N, K, T(1), B, ldb, mkl_packed_);
+#else
+  const int panels = (N + kPanelCols - 1) / kPanelCols;
+  panels_.assign(static_cast<size_t>(panels) * K * kPanelCols, T(0));
+  context.ParallelFor(panels, [&](int64_t begin, int64_t end) {
+    for (int64_t p = begin; p < end; ++p) {
+      const int n0 = p * kPanelCols;
+      const int cols = std::min(kPanelCols, N - n0);
+      T* panel = panels_.data() + p * K * kPanelCols;
+      for (int k = 0; k < K; ++k) {
+        std::copy(B + k * ldb + n0,
+                  B + k * ldb + n0 + cols,
+                  panel + k * kPanelCols);
+      }
+    }
+  });
+  if (ldb == N && N % 128 == 0 && K % 128 == 0) {
+    const int NN = N + 4;
+    padded_b_.assign(static_cast<size_t>(K) * NN, T(0));
+    context.ParallelFor(K, [&](int64_t begin, int64_t end) {
+      for (int64_t k = begin; k < end; ++k) {
+        std::copy(B + k * N, B + (k + 1) * N, padded_b_.data() + k * NN);
+      }
+    });
+  }
+#endif
+}
+
+template <typename T>
+PackedGemm<T>::~PackedGemm() {
+#ifdef PADDLE_WITH_MKLML
+  CBlas<T>::GEMM_FREE(mkl_packed_);
+#endif
+}
+
+template <typename T>
+std::shared_ptr<const PackedGemm<T>> PackedGemm<T>::Share(
+    const lite::X86Context& context,
+    const lite::Tensor& weight,
+    int K,
+    int N,
+    const T* B,
+    int ldb) {
+  const auto& buffer = weight.buffer();
+  CHECK(buffer);
+  auto& registry = PackRegistry<T>::Global();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto& entry = registry.packs[std::make_tuple(buffer.get(), B, K, N, ldb)];
+  auto pack = entry.lock();
+  if (!pack) {
+    // Drop the packs of the weights released since.
+    for (auto it = registry.packs.begin(); it != registry.packs.end();) {
+      if (it->second.expired() && &it->second != &entry) {
+        it = registry.packs.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    auto new_pack = std::make_shared<PackedGemm<T>>(context, K, N, B, ldb);
+    new_pack->weight_buffer_ = buffer;
+    pack = new_pack;
+    entry = pack;
+  }
+  return pack;
+}
+
+template <typename T>
+bool PackedGemm<T>::Packed(int M) {
+#ifdef PADDLE_WITH_MKLML
+  return true;
+#else
+  return M <= kMaxPanelRows;
+#endif
+}
+
+template <typename T>
+void PackedGemm<T>::Compute(const lite::X86Context& context,
+                            int M,
+                            const T* A,
+                            int lda,
+                            T beta,
+                            T* C,
+                            int ldc) const {
+  if (M <= 0) return;
+#ifdef PADDLE_WITH_MKLML
+  auto blas = GetBlas<lite::TargetType::kX86, T>(context);
+  blas.GEMM_COMPUTE(CblasNoTrans,
+                    CblasPacked,
+                    M,
+                    N_,
+                    K_,
+                    A,
+                    lda,
+                    mkl_packed_,
+                    ldb_,
+                    beta,
+                    C,
+                    ldc);
+#else
+  if (Packed(M)) {
+    ComputePanels(context, M, A, lda, beta, C, ldc);
+  } else {
+    auto blas = GetBlas<lite::TargetType::kX86, T>(context);
+    const bool padded = !padded_b_.empty();
+    blas.GEMM(CblasNoTrans,
+              CblasNoTrans,
+              M,
+              N_,
+              K_,
+              T(1),
+              A,
+              lda,
+              padded ? padded_b_.data() : B_,
+              padded ? N_ + 4 : ldb_,
+              beta,
+              C,
+              ldc);
+  }
+#endif
+}
+
+#ifndef PADDLE_WITH_MKLML
+// The panels are split over the threads, every one multiplied by blocks of
+// kRows rows of A kept in registers, the columns of a panel being contiguous
+// for the compiler to vectorize the inner loop.
+template <typename T>
+void PackedGemm<T>::ComputePanels(const lite::X86Context& context,
+                                  int M,
+                                  const T* A,
+                                  int lda,
+                                  T beta,
+                                  T* C,
+                                  int ldc) const {
+  const int kRows = 4;
+  const int K = K_;
+  const int N = N_;
+  const int panels = (N + kPanelCols - 1) / kPanelCols;
+  context.ParallelFor(panels, [&](int64_t begin, int64_t end) {
+    for (int64_t p = begin; p < end; ++p) {
+      const int n0 = p * kPanelCols;
+      const int cols = std::min(kPanelCols, N - n0);
+      const T* panel = panels_.data() + p * K * kPanelCols;
+      for (int m0 = 0; m0 < M; m0 += kRows) {
+        const int rows = std::min(kRows, M - m0);
+        T acc[kRows][kPanelCols] = {};
+        for (int k = 0; k < K; ++k) {
+          const T* b = panel + k * kPanelCols;
+          for (int r = 0; r < rows; ++r) {
+            const T a = A[(m0 + r) * lda + k];
+            for (int j = 0; j < kPanelCols; ++j) {
+              acc[r][j] += a * b[j];
+            }
+          }
+        }
+        for (int r = 0; r < rows; ++r) {
+          T* c = C + (m0 + r) * ldc + n0;
+          for (int j = 0; j < cols; ++j) {
+            c[j] = beta == T(0) ? acc[r][j] : acc[r][j] + beta * c[j];
+          }
+        }
+      }
+    }
+  });
+}
+#endif
+
+template class PackedGemm<float>;
+template class PackedGemm<double>;
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
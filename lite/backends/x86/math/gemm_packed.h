@@ -0,0 +1,123 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "lite/core/context.h"
+#include "lite/core/tensor.h"
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+/*
+ * PackedGemm holds the B of C = A * B + beta * C packed once, for the GEMMs
+ * which multiply the same weights again and again, e.g. the steps of a GRU or
+ * the runs of a fc.
+ *
+ * B is packed by MKL if PADDLE_WITH_MKLML, and into panels of kPanelCols
+ * columns otherwise, which the rows of A sweep without any packing at run
+ * time. The panels pay off for the few rows of A of a recurrent step or of an
+ * online request, Compute falls back to a plain GEMM for more rows than
+ * kMaxPanelRows. The GEMM runs on B, or on a copy of B with 4 more columns
+ * if K and N are multiples of 128, which would make the rows of B alias in
+ * the cache, so B must outlive the pack, as the weights of a model do.
+ */
+template <typename T>
+class PackedGemm {
+ public:
+  static const int kPanelCols = 16;
+  static const int kMaxPanelRows = 32;
+
+  // Packs B of [K, N] with a leading dimension ldb.
+  PackedGemm(const lite::X86Context& context,
+             int K,
+             int N,
+             const T* B,
+             int ldb);
+  ~PackedGemm();
+
+  PackedGemm(const PackedGemm&) = delete;
+  PackedGemm& operator=(const PackedGemm&) = delete;
+
+  // The pack of B shared with the other callers which packed the same B, e.g.
+  // the kernels of the clones of a predictor, as long as one of them holds it.
+  // B is in the data of `weight`, the pack holds the buffer of `weight` so
+  // that B outlives it, and the packs are found by that buffer: a new weight
+  // allocated where a released one was is packed again.
+  static std::shared_ptr<const PackedGemm<T>> Share(
+      const lite::X86Context& context,
+      const lite::Tensor& weight,
+      int K,
+      int N,
+      const T* B,
+      int ldb);
+
+  // C[M, N] = A[M, K] * B + beta * C, C is not read if beta is 0.
+  void Compute(const lite::X86Context& context,
+               int M,
+               const T* A,
+               int lda,
+               T beta,
+               T* C,
+               int ldc) const;
+
+  // Whether Compute runs on the pack for M rows of A.
+  static bool Packed(int M);
+
+  int K() const { return K_; }
+  int N() const { return N_; }
+
+  // The copy of B with 4 more columns the GEMM for more rows than
+  // kMaxPanelRows runs on, nullptr if it runs on B.
+  const T* padded_b() const {
+#ifdef PADDLE_WITH_MKLML
+    return nullptr;
+#else
+    return padded_b_.empty() ? nullptr : padded_b_.data();
+#endif
+  }
+
+ private:
+  int K_;
+  int N_;
+  const T* B_;
+  int ldb_;
+  // The buffer B is in, if shared.
+  std::shared_ptr<lite::Buffer> weight_buffer_;
+#ifdef PADDLE_WITH_MKLML
+  T* mkl_packed_{nullptr};
+#else
+  void ComputePanels(const lite::X86Context& context,
+                     int M,
+                     const T* A,
+                     int lda,
+                     T beta,
+                     T* C,
+                     int ldc) const;
+
+  // The panels of [K, kPanelCols], the last one padded with zeros.
+  std::vector<T> panels_;
+  // [K, N + 4], only never packed by MKL, which runs on the pack for any M.
+  std::vector<T> padded_b_;
+#endif
+};
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -60,27 +60,29 @@ class MaxSeqPoolFunctor {
 
     int64_t num_seq = out_dims[0];
     int64_t dim = output->numel() / num_seq;
-    for (int64_t i = 0; i < num_seq; ++i) {
-      if (starts[i] == starts[i + 1]) {
-        for (int64_t k = 0; k < dim; ++k) {
-          out_data[i * dim + k] = pad_value;
-          max_index[i * dim + k] = -1;
+    context.ParallelFor(num_seq, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        if (starts[i] == starts[i + 1]) {
+          for (int64_t k = 0; k < dim; ++k) {
+            out_data[i * dim + k] = pad_value;
+            max_index[i * dim + k] = -1;
+          }
+          continue;
         }
-        continue;
-      }
-      for (int64_t k = 0; k < dim; ++k) {
-        out_data[i * dim + k] = in_data[starts[i] * dim + k];
-        max_index[i * dim + k] = starts[i];
-      }
-      for (size_t j = starts[i] + 1; j < starts[i + 1]; ++j) {
         for (int64_t k = 0; k < dim; ++k) {
-          if (in_data[j * dim + k] > out_data[i * dim + k]) {
-            out_data[i * dim + k] = in_data[j * dim + k];
-            max_index[i * dim + k] = j;
+          out_data[i * dim + k] = in_data[starts[i] * dim + k];
+          max_index[i * dim + k] = starts[i];
+        }
+        for (size_t j = starts[i] + 1; j < starts[i + 1]; ++j) {
+          for (int64_t k = 0; k < dim; ++k) {
+            if (in_data[j * dim + k] > out_data[i * dim + k]) {
+              out_data[i * dim + k] = in_data[j * dim + k];
+              max_index[i * dim + k] = j;
+            }
           }
         }
       }
-    }
+    });
   }
 };
 // Instantisation of Max Sequence Pooling for test phase eg. no need to fill
@@ -107,23 +109,25 @@ class MaxSeqPoolFunctor<T, true> {
 
     int64_t num_seq = out_dims[0];
     int64_t dim = output->numel() / num_seq;
-    for (int64_t i = 0; i < num_seq; ++i) {
-      if (starts[i] == starts[i + 1]) {
-        for (int64_t k = 0; k < dim; ++k) {
-          out_data[i * dim + k] = pad_value;
+    context.ParallelFor(num_seq, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        if (starts[i] == starts[i + 1]) {
+          for (int64_t k = 0; k < dim; ++k) {
+            out_data[i * dim + k] = pad_value;
+          }
+          continue;
         }
-        continue;
-      }
-      std::memcpy(
-          &out_data[i * dim], &in_data[starts[i] * dim], dim * sizeof(T));
-      for (size_t j = starts[i] + 1; j < starts[i + 1]; ++j) {
-        for (int64_t k = 0; k < dim; ++k) {
-          if (in_data[j * dim + k] > out_data[i * dim + k]) {
-            out_data[i * dim + k] = in_data[j * dim + k];
+        std::memcpy(
+            &out_data[i * dim], &in_data[starts[i] * dim], dim * sizeof(T));
+        for (size_t j = starts[i] + 1; j < starts[i + 1]; ++j) {
+          for (int64_t k = 0; k < dim; ++k) {
+            if (in_data[j * dim + k] > out_data[i * dim + k]) {
+              out_data[i * dim + k] = in_data[j * dim + k];
+            }
           }
         }
       }
-    }
+    });
   }
 };
 template <typename T>
@@ -295,18 +299,22 @@ class SequencePoolFunctor<TARGET(kX86), T> {
       auto seqpool =
           jit::KernelFuncs<jit::SeqPoolTuple<T>, lite::fluid::CPUPlace>::Cache()
               .At(attr);
-      for (int i = 0; i < static_cast<int>(lod.size()) - 1; ++i) {
-        attr.h = static_cast<int>(lod[i + 1] - lod[i]);
-        if (attr.h == 0) {
-          for (int j = 0; j < attr.w; ++j) {
-            dst[j] = pad_value;
+      int64_t num_seq = static_cast<int64_t>(lod.size()) - 1;
+      context.ParallelFor(num_seq, [&](int64_t begin, int64_t end) {
+        // Each chunk needs its own attr since `h` differs per sequence.
+        jit::seq_pool_attr_t seq_attr(attr.w, jit::SeqPoolType::kSum);
+        for (int64_t i = begin; i < end; ++i) {
+          T* out = dst + i * seq_attr.w;
+          seq_attr.h = static_cast<int>(lod[i + 1] - lod[i]);
+          if (seq_attr.h == 0) {
+            for (int j = 0; j < seq_attr.w; ++j) {
+              out[j] = pad_value;
+            }
+          } else {
+            seqpool(src + lod[i] * seq_attr.w, out, &seq_attr);
           }
-        } else {
-          seqpool(src, dst, &attr);
         }
-        dst += attr.w;
-        src += attr.h * attr.w;
-      }
+      });
       return;
     }
     auto eigen_device = lite::fluid::EigenDeviceType<TARGET(kX86)>();
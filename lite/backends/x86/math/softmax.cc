@@ -13,6 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "lite/backends/x86/math/softmax.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "lite/backends/x86/cpu_info.h"
+#include "lite/backends/x86/math/avx2_exp.h"
 #include "lite/backends/x86/math/softmax_impl.h"
 
 namespace paddle {
@@ -20,6 +25,78 @@ namespace lite {
 namespace x86 {
 namespace math {
 
+namespace {
+
+void SoftmaxRowRef(const float* x, float* y, int n) {
+  const float max = *std::max_element(x, x + n);
+  float sum = 0.f;
+  for (int i = 0; i < n; ++i) {
+    y[i] = std::exp(x[i] - max);
+    sum += y[i];
+  }
+  const float scale = 1.f / sum;
+  for (int i = 0; i < n; ++i) {
+    y[i] *= scale;
+  }
+}
+
+#ifdef X86_MATH_WITH_AVX2
+X86_MATH_TARGET_AVX2
+void SoftmaxRowAvx2(const float* x, float* y, int n) {
+  const int n8 = n / 8 * 8;
+  __m256 vmax = _mm256_set1_ps(-FLT_MAX);
+  for (int i = 0; i < n8; i += 8) {
+    vmax = _mm256_max_ps(vmax, _mm256_loadu_ps(x + i));
+  }
+  float max = ReduceMaxAvx2(vmax);
+  for (int i = n8; i < n; ++i) {
+    max = std::max(max, x[i]);
+  }
+
+  vmax = _mm256_set1_ps(max);
+  __m256 vsum = _mm256_setzero_ps();
+  for (int i = 0; i < n8; i += 8) {
+    __m256 e = ExpAvx2(_mm256_sub_ps(_mm256_loadu_ps(x + i), vmax));
+    _mm256_storeu_ps(y + i, e);
+    vsum = _mm256_add_ps(vsum, e);
+  }
+  float sum = ReduceSumAvx2(vsum);
+  for (int i = n8; i < n; ++i) {
+    y[i] = std::exp(x[i] - max);
+    sum += y[i];
+  }
+
+  const float scale = 1.f / sum;
+  const __m256 vscale = _mm256_set1_ps(scale);
+  for (int i = 0; i < n8; i += 8) {
+    _mm256_storeu_ps(y + i, _mm256_mul_ps(_mm256_loadu_ps(y + i), vscale));
+  }
+  for (int i = n8; i < n; ++i) {
+    y[i] *= scale;
+  }
+}
+#endif  // X86_MATH_WITH_AVX2
+
+using SoftmaxRowFunc = void (*)(const float*, float*, int);
+
+SoftmaxRowFunc SelectSoftmaxRow() {
+#ifdef X86_MATH_WITH_AVX2
+  if (MayIUse(avx2)) return SoftmaxRowAvx2;
+#endif
+  return SoftmaxRowRef;
+}
+
+}  // namespace
+
+void softmax_rows(const float* x, float* y, int rows, int n) {
+  static const SoftmaxRowFunc softmax_row = SelectSoftmaxRow();
+  for (int i = 0; i < rows; ++i) {
+    softmax_row(x + static_cast<int64_t>(i) * n,
+                y + static_cast<int64_t>(i) * n,
+                n);
+  }
+}
+
 template class SoftmaxFunctor<lite::TargetType::kX86, float, true>;
 template class SoftmaxFunctor<lite::TargetType::kX86, float, false>;
 template class SoftmaxFunctor<lite::TargetType::kX86, double, true>;
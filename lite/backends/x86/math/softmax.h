@@ -43,6 +43,12 @@ class SoftmaxGradFunctor {
                   lite::TensorLite* x_grad);
 };
 
+// y[i] = softmax(x[i]) for the `rows` rows of n values. A row is read once for
+// its maximum, then exp(x - max) is written and summed in the same pass, and
+// scaled by 1 / sum. It runs with AVX2 if the CPU has it, and is
+// single-threaded, the callers split the rows over their threads.
+void softmax_rows(const float* x, float* y, int rows, int n);
+
 //#ifdef PADDLE_WITH_CUDA
 // template <typename T>
 // class SoftmaxCUDNNFunctor {
@@ -19,6 +19,7 @@ limitations under the License. */
 #include "lite/backends/x86/jit/kernel_base.h"
 #include "lite/backends/x86/jit/kernels.h"
 #include "lite/backends/x86/math/cpu_vec.h"
+#include "lite/backends/x86/math/softmax.h"
 #include "lite/core/tensor.h"
 #include "lite/fluid/eigen.h"
 
@@ -145,16 +146,30 @@ class SoftmaxFunctor<Target, float, true, enable_if_CPU<Target>> {
     float* out_data = Y->mutable_data<float>();
     const int kBatchDim = 0;
     const int kClassDim = 1;
-    // 2D data. Batch x C
+    // 2D data. Batch x C, the rows are split over the threads.
+    const int batch_size = in_dims[kBatchDim];
+    const int num_classes = in_dims[kClassDim];
+    const int num_remain = num_classes / axis_dim;
+    if (num_remain == 1) {
+      context.ParallelFor(batch_size, [&](int64_t begin, int64_t end) {
+        softmax_rows(in_data + begin * num_classes,
+                     out_data + begin * num_classes,
+                     end - begin,
+                     num_classes);
+      });
+      return;
+    }
     auto compute_softmax =
         lite::jit::KernelFuncs<lite::jit::SoftmaxTuple<float>,
                                fluid::CPUPlace>::Cache()
-            .At(in_dims[kClassDim]);
-    compute_softmax(in_data,
-                    out_data,
-                    in_dims[kClassDim],
-                    in_dims[kBatchDim],
-                    in_dims[kClassDim] / axis_dim);
+            .At(num_classes);
+    context.ParallelFor(batch_size, [&](int64_t begin, int64_t end) {
+      compute_softmax(in_data + begin * num_classes,
+                      out_data + begin * num_classes,
+                      num_classes,
+                      end - begin,
+                      num_remain);
+    });
   }
 };
 
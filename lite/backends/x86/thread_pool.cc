@@ -0,0 +1,149 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/thread_pool.h"
+#include <algorithm>
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+
+namespace {
+// Set while the current thread executes a chunk, so that nested ParallelFor
+// calls do not wait on workers that are busy with the outer loop.
+thread_local bool in_parallel_region = false;
+
+inline void ChunkRange(
+    int64_t n, int chunks, int id, int64_t* begin, int64_t* end) {
+  int64_t step = n / chunks;
+  int64_t rest = n % chunks;
+  *begin = id * step + std::min<int64_t>(id, rest);
+  *end = *begin + step + (id < rest ? 1 : 0);
+}
+}  // namespace
+
+ThreadPool::ThreadPool(int num_threads)
+    : num_threads_(std::max(num_threads, 1)) {
+  // The caller thread takes part in every ParallelFor, so only
+  // num_threads_ - 1 extra workers are needed.
+  for (int i = 1; i < num_threads_; ++i) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  task_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::ParallelFor(int64_t n,
+                             const std::function<void(int64_t, int64_t)>& fn) {
+  if (n <= 0) return;
+  int chunks = static_cast<int>(std::min<int64_t>(num_threads_, n));
+  if (chunks == 1 || in_parallel_region) {
+    fn(0, n);
+    return;
+  }
+
+  std::lock_guard<std::mutex> run_lock(run_mutex_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &fn;
+    task_size_ = n;
+    task_chunks_ = chunks;
+    pending_ = chunks - 1;
+    ++generation_;
+  }
+  task_cv_.notify_all();
+
+  int64_t begin, end;
+  ChunkRange(n, chunks, 0, &begin, &end);
+  in_parallel_region = true;
+  fn(begin, end);
+  in_parallel_region = false;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this] { return pending_ == 0; });
+  task_ = nullptr;
+}
+
+void ThreadPool::WorkerLoop(int worker_id) {
+  uint64_t seen_generation = 0;
+  while (true) {
+    const std::function<void(int64_t, int64_t)>* task = nullptr;
+    int64_t n = 0;
+    int chunks = 0;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      task_cv_.wait(lock, [&] {
+        return stop_ || generation_ != seen_generation;
+      });
+      if (stop_) return;
+      seen_generation = generation_;
+      task = task_;
+      n = task_size_;
+      chunks = task_chunks_;
+    }
+    // Workers beyond the chunk count of this task sit it out.
+    if (worker_id >= chunks) continue;
+
+    int64_t begin, end;
+    ChunkRange(n, chunks, worker_id, &begin, &end);
+    in_parallel_region = true;
+    (*task)(begin, end);
+    in_parallel_region = false;
+
+    bool last = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      last = --pending_ == 0;
+    }
+    if (last) done_cv_.notify_one();
+  }
+}
+
+void SplitByCost(const std::vector<int64_t>& costs,
+                 int chunks,
+                 std::vector<int64_t>* bounds) {
+  const int64_t n = static_cast<int64_t>(costs.size());
+  chunks = std::max(chunks, 1);
+  std::vector<int64_t> prefix(n + 1, 0);
+  for (int64_t i = 0; i < n; ++i) {
+    prefix[i + 1] = prefix[i] + costs[i];
+  }
+  bounds->assign(chunks + 1, n);
+  (*bounds)[0] = 0;
+  for (int c = 1; c < chunks; ++c) {
+    if (prefix[n] == 0) {
+      (*bounds)[c] = n * c / chunks;
+      continue;
+    }
+    // The boundary closest to the c-th share of the total cost.
+    int64_t target = prefix[n] * c / chunks;
+    int64_t i =
+        std::lower_bound(prefix.begin(), prefix.end(), target) - prefix.begin();
+    if (i > 0 && target - prefix[i - 1] < prefix[i] - target) --i;
+    (*bounds)[c] = std::max(i, (*bounds)[c - 1]);
+  }
+}
+
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
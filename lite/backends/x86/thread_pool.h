@@ -0,0 +1,79 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <functional>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+
+/*
+ * A fixed-size pool of worker threads owned by one predictor. Kernels split
+ * their outer loops with ParallelFor, so each predictor uses at most
+ * `num_threads` cores no matter how many predictors share the machine.
+ */
+class ThreadPool {
+ public:
+  explicit ThreadPool(int num_threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  int num_threads() const { return num_threads_; }
+
+  // Split [0, n) into at most num_threads() contiguous chunks and call
+  // fn(begin, end) on each of them. The calling thread runs the first chunk
+  // and returns once all chunks are done. Nested calls from inside fn run
+  // inline on the current thread.
+  void ParallelFor(int64_t n,
+                   const std::function<void(int64_t, int64_t)>& fn);
+
+ private:
+  void WorkerLoop(int worker_id);
+
+  int num_threads_{1};
+  std::vector<std::thread> workers_;
+
+  // Serializes ParallelFor calls from different threads.
+  std::mutex run_mutex_;
+
+  std::mutex mutex_;
+  std::condition_variable task_cv_;
+  std::condition_variable done_cv_;
+  const std::function<void(int64_t, int64_t)>* task_{nullptr};
+  int64_t task_size_{0};
+  int task_chunks_{0};
+  int pending_{0};
+  uint64_t generation_{0};
+  bool stop_{false};
+};
+
+// Split the items [0, costs.size()) into `chunks` contiguous ranges of about
+// the same total cost, the c-th one is [(*bounds)[c], (*bounds)[c + 1]). Some
+// ranges are empty if a few items outweigh the others.
+void SplitByCost(const std::vector<int64_t>& costs,
+                 int chunks,
+                 std::vector<int64_t>* bounds);
+
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -31,7 +31,11 @@
 #ifdef LITE_WITH_XPU
 #include "lite/backends/xpu/runtime.h"
 #endif
+#ifdef LITE_WITH_X86
+#include "lite/backends/x86/thread_pool.h"
+#endif
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <set>
@@ -265,12 +269,61 @@ class Context<TargetType::kX86> {
   // NOTE: InitOnce should only be used by ContextScheduler
   void InitOnce() {}
 
-  void CopySharedTo(X86Context* ctx) {}
+  void CopySharedTo(X86Context* ctx) { ctx->thread_pool_ = thread_pool_; }
+
+  // The thread pool is owned by the predictor and shared by all the x86
+  // kernels of its runtime program.
+  void SetThreadPool(const std::shared_ptr<x86::ThreadPool>& thread_pool) {
+    thread_pool_ = thread_pool;
+  }
+  x86::ThreadPool* thread_pool() const { return thread_pool_.get(); }
+  // The pool itself, e.g. to share it with the programs of the sub-blocks.
+  const std::shared_ptr<x86::ThreadPool>& shared_thread_pool() const {
+    return thread_pool_;
+  }
+
+  int threads() const {
+    return thread_pool_ ? thread_pool_->num_threads() : 1;
+  }
+
+  // Run fn(begin, end) over [0, n) on the predictor's threads, or inline on
+  // the calling thread if no thread pool is set.
+  template <typename Func>
+  void ParallelFor(int64_t n, Func&& fn) const {
+    if (n <= 0) return;
+    if (!thread_pool_ || thread_pool_->num_threads() == 1) {
+      fn(static_cast<int64_t>(0), n);
+      return;
+    }
+    thread_pool_->ParallelFor(n, std::forward<Func>(fn));
+  }
+
+  // The same, but the ranges have about the same total cost instead of the
+  // same number of items, e.g. for the sequences of a LoD tensor.
+  template <typename Func>
+  void ParallelForByCost(const std::vector<int64_t>& costs, Func&& fn) const {
+    int64_t n = static_cast<int64_t>(costs.size());
+    if (n == 0) return;
+    if (!thread_pool_ || thread_pool_->num_threads() == 1) {
+      fn(static_cast<int64_t>(0), n);
+      return;
+    }
+    int chunks =
+        static_cast<int>(std::min<int64_t>(thread_pool_->num_threads(), n));
+    std::vector<int64_t> bounds;
+    x86::SplitByCost(costs, chunks, &bounds);
+    thread_pool_->ParallelFor(chunks, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; ++c) {
+        if (bounds[c] < bounds[c + 1]) fn(bounds[c], bounds[c + 1]);
+      }
+    });
+  }
 
   std::string name() const { return "X86Context"; }
 
  private:
   // overall information
+  std::shared_ptr<x86::ThreadPool> thread_pool_;
   //
   // kernel information
 };
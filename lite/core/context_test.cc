@@ -14,6 +14,8 @@
 
 #include "lite/core/context.h"
 #include <gtest/gtest.h>
+#include <memory>
+#include <vector>
 
 namespace paddle {
 namespace lite {
@@ -47,5 +49,33 @@ namespace lite {
 // }
 // #endif
 
+#ifdef LITE_WITH_X86
+TEST(X86Context, ParallelFor) {
+  X86Context ctx;
+  ASSERT_EQ(ctx.threads(), 1);
+  ctx.SetThreadPool(std::make_shared<x86::ThreadPool>(4));
+  ASSERT_EQ(ctx.threads(), 4);
+
+  // The shared thread pool is copied to the kernel contexts.
+  X86Context kernel_ctx;
+  ctx.CopySharedTo(&kernel_ctx);
+  ASSERT_EQ(kernel_ctx.thread_pool(), ctx.thread_pool());
+
+  for (int64_t n : {0, 1, 3, 4, 1000}) {
+    std::vector<int> hits(n, 0);
+    kernel_ctx.ParallelFor(n, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        hits[i]++;
+      }
+      // Nested loops run inline on the current thread.
+      kernel_ctx.ParallelFor(2, [](int64_t, int64_t) {});
+    });
+    for (int64_t i = 0; i < n; ++i) {
+      ASSERT_EQ(hits[i], 1);
+    }
+  }
+}
+#endif
+
 }  // namespace lite
 }  // namespace paddle
@@ -72,7 +72,9 @@ class KernelBase {
     }
     /// re-init the kernel if needed (input shape should be checked in conv
     /// kernel)
-    ReInitWhenNeeded();
+    if (!shapes_unchanged_) {
+      ReInitWhenNeeded();
+    }
 
     // Reset the workspace to make every kernel in the same thread to share the
     // temporary memory.
@@ -96,6 +98,10 @@ class KernelBase {
 #endif
   }
 
+  /// Skip `ReInitWhenNeeded` at the following launches, the caller has checked
+  /// that the shapes of the inputs and outputs are the same as the last launch.
+  void set_shapes_unchanged(bool x) { shapes_unchanged_ = x; }
+
   void SetContext(std::unique_ptr<KernelContext>&& ctx) {
     ctx_ = std::move(ctx);
   }
@@ -178,6 +184,7 @@ class KernelBase {
   // is the unique ID for the kernel.
   std::string alias_{};
   bool is_first_epoch_{true};
+  bool shapes_unchanged_{false};
 
 #ifdef LITE_WITH_PROFILE
   profile::Profiler* profiler_{nullptr};
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #pragma once
+#include <memory>
 #include "lite/api/paddle_place.h"
 #include "lite/core/target_wrapper.h"
 #include "lite/utils/macros.h"
@@ -80,15 +81,28 @@ class Buffer {
  public:
   Buffer() = default;
   Buffer(TargetType target, size_t size) : space_(size), target_(target) {}
+  // Wrap a memory which is not owned by the buffer, such as a memory-mapped
+  // weight. `holder` keeps the memory alive while the buffer refers to it.
+  Buffer(void* data,
+         TargetType target,
+         size_t size,
+         const std::shared_ptr<void>& holder = nullptr)
+      : space_(size),
+        data_(data),
+        own_data_(false),
+        holder_(holder),
+        target_(target) {}
 
   void* data() const { return data_; }
   TargetType target() const { return target_; }
   size_t space() const { return space_; }
+  bool own_data() const { return own_data_; }
 
   void ResetLazy(TargetType target, size_t size) {
     if (target != target_ || space_ < size) {
       Free();
       data_ = TargetMalloc(target, size);
+      own_data_ = true;
       target_ = target;
       space_ = size;
     }
@@ -107,6 +121,7 @@ class Buffer {
         cl_image2d_height_ < img_h) {
       Free();
       data_ = TargetWrapperCL::MallocImage<T>(img_w, img_h);
+      own_data_ = true;
       target_ = target;
       space_ = size;  // un-used for opencl Image2D
       cl_image2d_width_ = img_w;
@@ -116,9 +131,12 @@ class Buffer {
 #endif
 
   void Free() {
-    if (space_ > 0) {
+    if (space_ > 0 && own_data_) {
       TargetFree(target_, data_);
     }
+    data_ = nullptr;
+    own_data_ = true;
+    holder_.reset();
     target_ = TargetType::kHost;
     space_ = 0;
   }
@@ -138,6 +156,9 @@ class Buffer {
   size_t cl_image2d_width_{0};   // only used for OpenCL Image2D
   size_t cl_image2d_height_{0};  // only used for OpenCL Image2D
   void* data_{nullptr};
+  // False if `data_` is an external memory which should not be freed.
+  bool own_data_{true};
+  std::shared_ptr<void> holder_;
   TargetType target_{TargetType::kHost};
 };
 
@@ -0,0 +1,194 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/memory_planner.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace paddle {
+namespace lite {
+
+namespace {
+// Keep every block aligned as the host allocator does.
+const size_t kBlockAlign = 64;
+
+bool IsHostTarget(TargetType target) {
+  return target == TARGET(kHost) || target == TARGET(kX86) ||
+         target == TARGET(kARM);
+}
+}  // namespace
+
+size_t PlanMemoryOffsets(std::vector<MemoryBlock>* blocks) {
+  CHECK(blocks);
+  std::vector<size_t> order(blocks->size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return blocks->at(a).size > blocks->at(b).size;
+  });
+
+  size_t arena_size = 0;
+  std::vector<const MemoryBlock*> placed;
+  for (size_t idx : order) {
+    auto& block = blocks->at(idx);
+    std::vector<const MemoryBlock*> live;
+    for (auto* other : placed) {
+      if (other->first_use <= block.last_use &&
+          block.first_use <= other->last_use) {
+        live.push_back(other);
+      }
+    }
+    std::sort(live.begin(),
+              live.end(),
+              [](const MemoryBlock* a, const MemoryBlock* b) {
+                return a->offset < b->offset;
+              });
+
+    size_t best_offset = std::numeric_limits<size_t>::max();
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t end = 0;
+    for (auto* other : live) {
+      if (other->offset > end) {
+        size_t gap = other->offset - end;
+        if (gap >= block.size && gap < best_gap) {
+          best_gap = gap;
+          best_offset = end;
+        }
+      }
+      end = std::max(end, other->offset + other->size);
+    }
+    block.offset =
+        best_offset == std::numeric_limits<size_t>::max() ? end : best_offset;
+    arena_size = std::max(arena_size, block.offset + block.size);
+    placed.push_back(&block);
+  }
+  return arena_size;
+}
+
+MemoryPlanner::MemoryPlanner(const std::vector<Step>& steps) {
+  for (size_t i = 0; i < steps.size(); ++i) {
+    int step = static_cast<int>(i);
+    for (auto& name : steps[i].vars) {
+      auto it = lifetimes_.find(name);
+      if (it == lifetimes_.end()) {
+        lifetimes_.emplace(name, std::make_pair(step, step));
+      } else {
+        it->second.second = step;
+      }
+      if (steps[i].pinned) pinned_vars_.insert(name);
+    }
+  }
+}
+
+bool MemoryPlanner::Planned() const {
+  if (!arena_) return false;
+  for (auto& group : groups_) {
+    // A kernel reallocated the buffer, or shared another one.
+    if (group.buffer->own_data() || group.buffer->data() != group.data) {
+      return false;
+    }
+    for (auto* tensor : group.tensors) {
+      if (tensor->buffer() != group.buffer) return false;
+    }
+  }
+  return true;
+}
+
+bool MemoryPlanner::Update(Scope* exec_scope) {
+  if (Planned()) return false;
+  Plan(exec_scope);
+  return true;
+}
+
+void MemoryPlanner::Plan(Scope* exec_scope) {
+  CHECK(exec_scope);
+  struct Member {
+    std::string name;
+    Tensor* tensor;
+  };
+  std::map<const Buffer*, std::vector<Member>> members;
+  std::set<const Buffer*> excluded;
+  for (auto& item : lifetimes_) {
+    auto& name = item.first;
+    auto* var = exec_scope->FindVar(name);
+    if (!var || !var->IsType<Tensor>()) continue;
+    auto* tensor = var->GetMutable<Tensor>();
+    const Buffer* buffer = tensor->buffer().get();
+    if (!buffer || !buffer->data()) continue;
+    members[buffer].push_back({name, tensor});
+    // The weights live in the parent scopes.
+    if (pinned_vars_.count(name) || !exec_scope->FindLocalVar(name) ||
+        tensor->persistable() || !IsHostTarget(buffer->target())) {
+      excluded.insert(buffer);
+    }
+  }
+
+  std::vector<MemoryBlock> blocks;
+  std::vector<std::vector<Member>> block_members;
+  for (auto& item : members) {
+    if (excluded.count(item.first)) continue;
+    MemoryBlock block;
+    block.size = item.first->space();
+    block.first_use = std::numeric_limits<int>::max();
+    block.last_use = -1;
+    for (auto& member : item.second) {
+      auto& max_size = max_sizes_[member.name];
+      auto* tensor = member.tensor;
+      max_size = std::max(max_size, tensor->offset() + tensor->memory_size());
+      block.size = std::max(block.size, max_size);
+      auto& lifetime = lifetimes_.at(member.name);
+      block.first_use = std::min(block.first_use, lifetime.first);
+      block.last_use = std::max(block.last_use, lifetime.second);
+    }
+    block.size = (block.size + kBlockAlign - 1) / kBlockAlign * kBlockAlign;
+    blocks.push_back(block);
+    block_members.push_back(item.second);
+  }
+
+  arena_size_ = PlanMemoryOffsets(&blocks);
+  unshared_size_ = 0;
+  for (auto& block : blocks) {
+    unshared_size_ += block.size;
+  }
+  // The old arena is released with the last buffer referring to it.
+  void* data = arena_size_ ? TargetMalloc(TARGET(kHost), arena_size_) : nullptr;
+  arena_.reset(data, [](void* x) {
+    if (x) TargetFree(TARGET(kHost), x);
+  });
+
+  groups_.clear();
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    Group group;
+    group.data = static_cast<char*>(data) + blocks[i].offset;
+    group.buffer = std::make_shared<Buffer>(
+        group.data,
+        block_members[i].front().tensor->buffer()->target(),
+        blocks[i].size,
+        arena_);
+    for (auto& member : block_members[i]) {
+      // The sliced tensors are shared again by their kernels at the next run.
+      if (member.tensor->offset() != 0) continue;
+      member.tensor->ResetBuffer(group.buffer, member.tensor->memory_size());
+      group.tensors.push_back(member.tensor);
+    }
+    groups_.push_back(std::move(group));
+  }
+  VLOG(4) << "Memory arena planned for " << blocks.size()
+          << " buffers: " << arena_size_ << " bytes, " << unshared_size_
+          << " bytes without sharing";
+}
+
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,98 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "lite/core/memory.h"
+#include "lite/core/scope.h"
+#include "lite/core/tensor.h"
+
+namespace paddle {
+namespace lite {
+
+// A block of memory used from the `first_use`-th to the `last_use`-th step.
+struct MemoryBlock {
+  size_t size{0};
+  int first_use{0};
+  int last_use{0};
+  // Assigned by PlanMemoryOffsets.
+  size_t offset{0};
+};
+
+// Assign every block an offset in one arena, so that the blocks used at the
+// same step never overlap. The blocks are placed from the largest one, each
+// into the smallest gap left by the placed blocks with overlapping lifetimes
+// (best fit), or above all of them. Return the size of the arena.
+size_t PlanMemoryOffsets(std::vector<MemoryBlock>* blocks);
+
+/*
+ * MemoryPlanner places the activations of a program in one host arena by
+ * their sizes and lifetimes.
+ *
+ * The sizes are only known after running, so that the planner works from the
+ * tensors left by the last run: `Update` should be called after every run, it
+ * plans the arena the first time, and again once a kernel has reallocated a
+ * tensor, e.g. for a larger input. The tensors sharing a buffer, such as the
+ * outputs of reshape sharing the data of their inputs, are planned as one
+ * block living as long as all of them. The tensors sharing a buffer with the
+ * weights or the other variables not planned are left untouched.
+ */
+class MemoryPlanner {
+ public:
+  struct Step {
+    // The variables the step reads or writes.
+    std::vector<std::string> vars;
+    // Keep the variables of the step out of the arena, e.g. for the ops run
+    // only once or running sub-blocks.
+    bool pinned{false};
+  };
+
+  explicit MemoryPlanner(const std::vector<Step>& steps);
+
+  // Check the tensors in `exec_scope` after a run and plan the arena if
+  // needed. Return true if the arena is (re)planned.
+  bool Update(Scope* exec_scope);
+
+  // The peak size of the arena in bytes.
+  size_t arena_size() const { return arena_size_; }
+  // The size the planned tensors would take without sharing.
+  size_t unshared_size() const { return unshared_size_; }
+
+ private:
+  struct Group {
+    std::vector<Tensor*> tensors;
+    std::shared_ptr<Buffer> buffer;
+    char* data{nullptr};
+  };
+
+  bool Planned() const;
+  void Plan(Scope* exec_scope);
+
+  std::map<std::string, std::pair<int, int>> lifetimes_;
+  std::set<std::string> pinned_vars_;
+  // The largest size seen for each variable, the arena never shrinks.
+  std::map<std::string, size_t> max_sizes_;
+
+  std::shared_ptr<void> arena_;
+  std::vector<Group> groups_;
+  size_t arena_size_{0};
+  size_t unshared_size_{0};
+};
+
+}  // namespace lite
+}  // namespace paddle
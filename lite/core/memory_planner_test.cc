@@ -0,0 +1,126 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/memory_planner.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace paddle {
+namespace lite {
+
+MemoryBlock MakeBlock(size_t size, int first_use, int last_use) {
+  MemoryBlock block;
+  block.size = size;
+  block.first_use = first_use;
+  block.last_use = last_use;
+  return block;
+}
+
+bool Overlap(const MemoryBlock& a, const MemoryBlock& b) {
+  bool live_together = a.first_use <= b.last_use && b.first_use <= a.last_use;
+  bool share_bytes =
+      a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+  return live_together && share_bytes;
+}
+
+TEST(PlanMemoryOffsets, chain) {
+  // a -> b -> c -> d, only two blocks are alive at any step.
+  std::vector<MemoryBlock> blocks({MakeBlock(256, 0, 1),
+                                   MakeBlock(128, 1, 2),
+                                   MakeBlock(256, 2, 3),
+                                   MakeBlock(64, 3, 4)});
+  size_t arena_size = PlanMemoryOffsets(&blocks);
+  EXPECT_EQ(arena_size, 384);
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    for (size_t j = i + 1; j < blocks.size(); ++j) {
+      EXPECT_FALSE(Overlap(blocks[i], blocks[j])) << i << " " << j;
+    }
+  }
+}
+
+TEST(PlanMemoryOffsets, best_fit) {
+  std::vector<MemoryBlock> blocks({MakeBlock(512, 0, 4),
+                                   MakeBlock(256, 0, 0),
+                                   MakeBlock(256, 0, 4),
+                                   MakeBlock(128, 0, 0),
+                                   MakeBlock(128, 0, 4),
+                                   MakeBlock(128, 2, 2)});
+  size_t arena_size = PlanMemoryOffsets(&blocks);
+  EXPECT_EQ(arena_size, 1280);
+  // The last block takes the smaller of the two gaps freed after step 0.
+  EXPECT_EQ(blocks[5].offset, blocks[3].offset);
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    for (size_t j = i + 1; j < blocks.size(); ++j) {
+      EXPECT_FALSE(Overlap(blocks[i], blocks[j])) << i << " " << j;
+    }
+  }
+}
+
+TEST(MemoryPlanner, update) {
+  Scope scope;
+  auto* exec_scope = &scope.NewScope();
+  auto* weight = scope.Var("w")->GetMutable<Tensor>();
+  weight->Resize({16});
+  weight->mutable_data<float>();
+  weight->set_persistable(true);
+
+  std::vector<MemoryPlanner::Step> steps(3);
+  steps[0].vars = {"x", "w", "y"};
+  steps[1].vars = {"y", "z"};
+  steps[2].vars = {"z", "out"};
+  MemoryPlanner planner(steps);
+
+  auto run = [&](int64_t n) {
+    auto* x = exec_scope->Var("x")->GetMutable<Tensor>();
+    auto* y = exec_scope->Var("y")->GetMutable<Tensor>();
+    auto* z = exec_scope->Var("z")->GetMutable<Tensor>();
+    auto* out = exec_scope->Var("out")->GetMutable<Tensor>();
+    x->Resize({n});
+    x->mutable_data<float>();
+    y->Resize({n});
+    y->mutable_data<float>();
+    // z is a reshape of y.
+    z->ShareDataWith(*y);
+    out->Resize({n});
+    out->mutable_data<float>();
+  };
+
+  run(64);
+  EXPECT_TRUE(planner.Update(exec_scope));
+  // x and y+z overlap, out reuses the space of x.
+  EXPECT_EQ(planner.arena_size(), 2 * 64 * sizeof(float));
+  EXPECT_EQ(planner.unshared_size(), 3 * 64 * sizeof(float));
+  auto* x = exec_scope->FindVar("x")->GetMutable<Tensor>();
+  auto* y = exec_scope->FindVar("y")->GetMutable<Tensor>();
+  auto* out = exec_scope->FindVar("out")->GetMutable<Tensor>();
+  EXPECT_FALSE(x->buffer()->own_data());
+  EXPECT_EQ(x->raw_data(), out->raw_data());
+  EXPECT_NE(x->raw_data(), y->raw_data());
+
+  // Running again with the same shapes keeps the plan.
+  run(64);
+  EXPECT_FALSE(planner.Update(exec_scope));
+  // A larger input reallocates the tensors and replans the arena.
+  run(128);
+  EXPECT_TRUE(planner.Update(exec_scope));
+  EXPECT_EQ(planner.arena_size(), 2 * 128 * sizeof(float));
+  run(32);
+  EXPECT_FALSE(planner.Update(exec_scope));
+
+  // The weights are never moved.
+  EXPECT_TRUE(weight->buffer()->own_data());
+}
+
+}  // namespace lite
+}  // namespace paddle
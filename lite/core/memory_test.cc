@@ -14,6 +14,9 @@
 
 #include "lite/core/memory.h"
 #include <gtest/gtest.h>
+#include <cstdint>
+#include <memory>
+#include "lite/backends/host/allocator.h"
 
 namespace paddle {
 namespace lite {
@@ -30,5 +33,80 @@ TEST(memory, test) {
 #endif
 }
 
+TEST(memory, host_allocator) {
+  auto before = host::GetStats();
+  auto* buf = static_cast<char*>(TargetMalloc(TARGET(kHost), 1000));
+  ASSERT_TRUE(buf);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(buf) % host::kMallocAlign, 0u);
+  auto stats = host::GetStats();
+  EXPECT_EQ(stats.bytes_in_use, before.bytes_in_use + 1000);
+  EXPECT_GE(stats.peak_bytes_in_use, stats.bytes_in_use);
+  EXPECT_EQ(stats.num_allocs, before.num_allocs + 1);
+
+  // A freed block is reused by the next allocation of its size class.
+  TargetFree(TARGET(kHost), buf);
+  EXPECT_EQ(host::GetStats().bytes_in_use, before.bytes_in_use);
+  EXPECT_GT(host::GetStats().bytes_cached, 0u);
+  auto* buf1 = static_cast<char*>(TargetMalloc(TARGET(kX86), 1010));
+  EXPECT_EQ(buf1, buf);
+  TargetFree(TARGET(kX86), buf1);
+
+  host::SetZeroFill(true);
+  buf = static_cast<char*>(TargetMalloc(TARGET(kHost), 1000));
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ(buf[i], 0);
+  }
+  TargetFree(TARGET(kHost), buf);
+  host::SetZeroFill(false);
+
+  uint64_t allocs = host::ThreadAllocCount();
+  Buffer buffer(TARGET(kHost), 0);
+  buffer.ResetLazy(TARGET(kHost), 100);
+  buffer.ResetLazy(TARGET(kHost), 50);
+  EXPECT_EQ(host::ThreadAllocCount(), allocs + 1);
+}
+
+TEST(memory, size_class) {
+  size_t class_size = 0;
+  EXPECT_EQ(host::CachingAllocator::SizeClass(1, &class_size), 0);
+  EXPECT_EQ(class_size, 64u);
+  for (size_t size : {65, 100, 128, 1000, 4097, 1 << 20, (1 << 20) + 1}) {
+    int c = host::CachingAllocator::SizeClass(size, &class_size);
+    EXPECT_GE(class_size, size);
+    EXPECT_LE(class_size, size + size / 4 + 1);
+    EXPECT_EQ(host::CachingAllocator::ClassSize(c), class_size);
+  }
+  EXPECT_EQ(host::CachingAllocator::SizeClass(
+                host::CachingAllocator::kMaxCachedSize, nullptr),
+            host::CachingAllocator::kNumClasses - 1);
+}
+
+class CountingAllocator : public host::SystemAllocator {
+ public:
+  void* Allocate(size_t size) override {
+    ++allocs;
+    return host::SystemAllocator::Allocate(size);
+  }
+  void Free(void* ptr, size_t size) override {
+    ++frees;
+    host::SystemAllocator::Free(ptr, size);
+  }
+  int allocs{0};
+  int frees{0};
+};
+
+TEST(memory, set_allocator) {
+  // Allocated by the previous allocator, freed by it after the switch.
+  auto* old_buf = TargetMalloc(TARGET(kHost), 10);
+  auto allocator = std::make_shared<CountingAllocator>();
+  host::SetAllocator(allocator);
+  auto* buf = TargetMalloc(TARGET(kHost), 10);
+  TargetFree(TARGET(kHost), buf);
+  TargetFree(TARGET(kHost), old_buf);
+  EXPECT_EQ(allocator->allocs, 1);
+  EXPECT_EQ(allocator->frees, 1);
+  host::SetAllocator(std::make_shared<host::CachingAllocator>());
+}
+
 }  // namespace lite
 }  // namespace paddle
@@ -0,0 +1,154 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/mir/fusion/embedding_seq_pool_fuse_pass.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "lite/api/paddle_use_passes.h"
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer.h"
+#include "lite/core/program.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+const int64_t kVocab = 10;
+const int64_t kEmbSize = 4;
+
+// out = sequence_pool(lookup_table(w, ids), SUM), with the MaxIndex output
+// sequence_pool always has in the models saved by fluid.
+void BuildProgram(cpp::ProgramDesc* desc) {
+  auto* block = desc->AddBlock<cpp::BlockDesc>();
+  block->SetIdx(0);
+  block->SetParentIdx(-1);
+  for (auto& name : {"ids", "emb", "out", "max_index"}) {
+    auto* var = block->AddVar<cpp::VarDesc>();
+    var->SetName(name);
+    var->SetType(VarDescAPI::Type::LOD_TENSOR);
+  }
+  auto* w = block->AddVar<cpp::VarDesc>();
+  w->SetName("w");
+  w->SetType(VarDescAPI::Type::LOD_TENSOR);
+  w->SetPersistable(true);
+
+  auto* lookup = block->AddOp<cpp::OpDesc>();
+  lookup->SetType("lookup_table");
+  lookup->SetInput("W", {"w"});
+  lookup->SetInput("Ids", {"ids"});
+  lookup->SetOutput("Out", {"emb"});
+  lookup->SetAttr<int64_t>("padding_idx", -1);
+
+  auto* pool = block->AddOp<cpp::OpDesc>();
+  pool->SetType("sequence_pool");
+  pool->SetInput("X", {"emb"});
+  pool->SetOutput("Out", {"out"});
+  pool->SetOutput("MaxIndex", {"max_index"});
+  pool->SetAttr<std::string>("pooltype", "SUM");
+}
+
+struct Result {
+  std::multiset<std::string> op_types;
+  std::set<std::string> vars;
+  std::vector<float> out;
+};
+
+Result Run(bool fuse) {
+  cpp::ProgramDesc desc;
+  BuildProgram(&desc);
+  std::vector<Place> places{Place{TARGET(kX86), PRECISION(kFloat)},
+                            Place{TARGET(kX86), PRECISION(kInt64)},
+                            Place{TARGET(kHost), PRECISION(kAny)}};
+  auto scope = std::make_shared<Scope>();
+  auto* w = scope->Var("w")->GetMutable<lite::Tensor>();
+  w->Resize({kVocab, kEmbSize});
+  for (int64_t i = 0; i < w->numel(); ++i) {
+    w->mutable_data<float>()[i] = 0.1f * static_cast<float>(i % 13) - 0.5f;
+  }
+  Program program(desc, scope, places);
+  auto* exec_scope = program.exec_scope();
+  // Two sequences of 3 and 2 words.
+  auto* ids = exec_scope->Var("ids")->GetMutable<lite::Tensor>();
+  ids->Resize({5, 1});
+  const std::vector<int64_t> words{1, 7, 3, 9, 0};
+  std::copy(words.begin(), words.end(), ids->mutable_data<int64_t>());
+  ids->set_lod({{0, 3, 5}});
+
+  std::vector<std::string> passes{"static_kernel_pick_pass",
+                                  "variable_place_inference_pass",
+                                  "type_target_cast_pass",
+                                  "variable_place_inference_pass",
+                                  "io_copy_kernel_pick_pass",
+                                  "variable_place_inference_pass",
+                                  "type_precision_cast_pass",
+                                  "variable_place_inference_pass",
+                                  "type_layout_cast_pass",
+                                  "variable_place_inference_pass",
+                                  "runtime_context_assign_pass"};
+  if (fuse) {
+    passes.insert(passes.begin(), "lite_embedding_seq_pool_fuse_pass");
+  }
+  core::KernelPickFactor factor;
+  factor.ConsiderTarget();
+  factor.ConsiderPrecision();
+  Optimizer optimizer;
+  optimizer.Run(std::move(program), places, factor, passes);
+
+  Result result;
+  for (auto& node : optimizer.mutable_ssa_graph()->mutable_nodes()) {
+    if (node.IsStmt()) {
+      result.op_types.insert(node.AsStmt().op_type());
+    } else {
+      result.vars.insert(node.AsArg().name);
+    }
+  }
+  optimizer.GenRuntimeProgram()->Run();
+  auto* out = exec_scope->FindVar("out")->GetMutable<lite::Tensor>();
+  EXPECT_EQ(out->dims(), DDim({2, kEmbSize}));
+  result.out.assign(out->data<float>(), out->data<float>() + out->numel());
+  return result;
+}
+
+}  // namespace
+
+TEST(EmbeddingSeqPoolFusePass, fuse_with_max_index) {
+  auto fused = Run(true);
+  EXPECT_EQ(fused.op_types.size(), 1u);
+  EXPECT_EQ(fused.op_types.count("fused_embedding_seq_pool"), 1u);
+  EXPECT_EQ(fused.vars.count("emb"), 0u);
+  EXPECT_EQ(fused.vars.count("max_index"), 0u);
+
+  auto origin = Run(false);
+  EXPECT_EQ(origin.op_types.count("fused_embedding_seq_pool"), 0u);
+  ASSERT_EQ(fused.out.size(), origin.out.size());
+  for (size_t i = 0; i < origin.out.size(); ++i) {
+    EXPECT_NEAR(fused.out[i], origin.out[i], 1e-5) << i;
+  }
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(lookup_table);
+USE_LITE_OP(sequence_pool);
+USE_LITE_OP(fused_embedding_seq_pool);
+USE_LITE_KERNEL(lookup_table, kX86, kInt64, kNCHW, def);
+USE_LITE_KERNEL(sequence_pool, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(fused_embedding_seq_pool, kX86, kInt64, kNCHW, def);
@@ -0,0 +1,81 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/mir/fusion/embedding_seq_pool_fuser.h"
+#include <memory>
+#include <vector>
+
+namespace paddle {
+namespace lite {
+namespace mir {
+namespace fusion {
+
+void EmbeddingSeqPoolFuser::BuildPattern() {
+  auto* w = VarNode("w")->assert_is_op_input(lookup_type_, "W")->AsInput();
+  auto* ids =
+      VarNode("ids")->assert_is_op_input(lookup_type_, "Ids")->AsInput();
+  auto* lookup = OpNode("lookup", lookup_type_)->AsIntermediate();
+  auto* lookup_out = VarNode("lookup_out")
+                         ->assert_is_op_output(lookup_type_, "Out")
+                         ->assert_is_op_input("sequence_pool", "X")
+                         ->AsIntermediate();
+  auto* pool = OpNode("pool", "sequence_pool")
+                   ->assert_op_attr<std::string>("pooltype", "SUM")
+                   ->AsIntermediate();
+  auto* pool_out = VarNode("pool_out")
+                       ->assert_is_op_output("sequence_pool", "Out")
+                       ->AsOutput();
+  // The sequence_pool of fluid always has a MaxIndex, unused by SUM.
+  auto* max_index = VarNode("max_index")
+                        ->assert_is_op_output("sequence_pool", "MaxIndex")
+                        ->AsIntermediate();
+
+  std::vector<PMNode*> lookup_inputs{w, ids};
+  std::vector<PMNode*> pool_outputs{pool_out, max_index};
+  lookup_inputs >> *lookup >> *lookup_out >> *pool >> pool_outputs;
+}
+
+void EmbeddingSeqPoolFuser::InsertNewNode(SSAGraph* graph,
+                                          const key2nodes_t& matched) {
+  auto op_desc = GenOpDesc(matched);
+  auto fused_op = LiteOpRegistry::Global().Create("fused_embedding_seq_pool");
+  auto lookup = matched.at("lookup")->stmt()->op();
+  auto* scope = lookup->scope();
+  auto& valid_places = lookup->valid_places();
+  fused_op->Attach(op_desc, scope);
+
+  auto* new_op_node = graph->GraphCreateInstructNode(fused_op, valid_places);
+
+  IR_NODE_LINK_TO(matched.at("w"), new_op_node);
+  IR_NODE_LINK_TO(matched.at("ids"), new_op_node);
+  IR_NODE_LINK_TO(new_op_node, matched.at("pool_out"));
+}
+
+cpp::OpDesc EmbeddingSeqPoolFuser::GenOpDesc(const key2nodes_t& matched) {
+  auto* lookup_desc = matched.at("lookup")->stmt()->op_info();
+  cpp::OpDesc op_desc;
+  op_desc.SetType("fused_embedding_seq_pool");
+  op_desc.SetInput("W", {matched.at("w")->arg()->name});
+  op_desc.SetInput("Ids", {matched.at("ids")->arg()->name});
+  op_desc.SetOutput("Out", {matched.at("pool_out")->arg()->name});
+  op_desc.SetAttr<std::string>("combiner", "sum");
+  op_desc.SetAttr<int64_t>("padding_idx",
+                           lookup_desc->GetAttr<int64_t>("padding_idx"));
+  return op_desc;
+}
+
+}  // namespace fusion
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
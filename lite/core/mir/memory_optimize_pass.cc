@@ -81,7 +81,7 @@ void MemoryOptimizePass::CollectLifeCycleByDevice(
       for (Node* node : requires) {
         CHECK(node->IsArg());
         auto& arg = node->AsArg();
-        if (arg.is_weight || arg.is_persist) continue;
+        if (arg.is_weight || arg.is_persist || arg.is_extern) continue;
         if (!valid_var(node)) continue;
         std::string var_name = arg.name;
         TargetType target_type = node->AsArg().type->target();
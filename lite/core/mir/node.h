@@ -100,6 +100,10 @@ class Node {
     // if the need more than one tool operator(eg. io_copy layout calib), the
     // argument between them should be persist to make sure it's only run once
     bool is_persist{false};
+    // is_extern indicate that the argument is also read or written outside the
+    // graph, e.g. by the parent block or the next iteration of a while loop,
+    // so that it should be kept by the fusion and memory reuse passes.
+    bool is_extern{false};
   };
 
   Arg& AsArg(const std::string& name, int id);
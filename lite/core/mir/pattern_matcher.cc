@@ -135,8 +135,8 @@ bool PatternMatcher::MarkPMNodesInGraph(SSAGraph *graph) {
   return !pmnodes2nodes_.empty();
 }
 
-// The intermediate Nodes can only link to the nodes inside the pattern, or this
-// subgraph will be droped.
+// The intermediate Nodes can only link to the nodes inside the pattern, and
+// can not be used outside the graph, or this subgraph will be droped.
 void PatternMatcher::ValidateByNodeRole(
     std::vector<PatternMatcher::subgraph_t> *subgraphs) {
   std::vector<PatternMatcher::subgraph_t> result;
@@ -152,6 +152,10 @@ void PatternMatcher::ValidateByNodeRole(
                        }
                        for (auto &item : subgraph) {
                          if (item.first->IsIntermediate()) {
+                           if (item.second->IsArg() &&
+                               item.second->AsArg().is_extern) {
+                             return true;
+                           }
                            for (auto *x : item.second->inlinks) {
                              if (!ios.count(x)) {
                                return true;
@@ -228,6 +228,50 @@ TEST(PatternMatcher, IntermediateCheck) {
   ASSERT_EQ(count, 1);
 }
 
+TEST(PatternMatcher, ExternIntermediateCheck) {
+  SSAGraph graph;
+  BuildGraph(&graph);
+
+  // o3->v4->o5
+  // check o3+o5 fuse, should fail once v4 is also used outside the graph.
+  PatternMatcher matcher;
+  auto* op3 = matcher.mutable_pattern()->NewNode(
+      [](const Node* x) {
+        return x && x->IsStmt() && x->stmt()->desc == "op3";
+      },
+      "op3");
+  auto* op5 = matcher.mutable_pattern()->NewNode(
+      [](const Node* x) {
+        return x && x->IsStmt() && x->stmt()->desc == "op5";
+      },
+      "op5");
+  auto* v4 = matcher.mutable_pattern()
+                 ->NewNode(
+                     [](const Node* x) {
+                       return x && x->IsArg() && x->arg()->name == "var4";
+                     },
+                     "var4")
+                 ->AsIntermediate();
+  v4->LinksFrom({op3}).LinksTo({op5});
+
+  int count = 0;
+  matcher(&graph, [&](const PatternMatcher::subgraph_t& g, SSAGraph* graph) {
+    ++count;
+  });
+  ASSERT_EQ(count, 1);
+
+  for (auto& node : graph.mutable_nodes()) {
+    if (node.IsArg() && node.AsArg().name == "var4") {
+      node.AsArg().is_extern = true;
+    }
+  }
+  count = 0;
+  matcher(&graph, [&](const PatternMatcher::subgraph_t& g, SSAGraph* graph) {
+    ++count;
+  });
+  EXPECT_EQ(count, 0);
+}
+
 }  // namespace mir
 }  // namespace lite
 }  // namespace paddle
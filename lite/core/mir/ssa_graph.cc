@@ -14,6 +14,7 @@
 
 #include "lite/core/mir/ssa_graph.h"
 #include <algorithm>
+#include <iterator>
 #include <memory>
 #include <set>
 #include <unordered_map>
@@ -43,6 +44,13 @@ bool SSAGraph::CheckBidirectionalConnection() {
 std::map<mir::Node *, std::set<mir::Node *>> SSAGraph::BuildOperationAdjList() {
   std::map<mir::Node *, std::set<mir::Node *>> adj_list;
 
+  // The nodes of the variables written more than once, e.g. the loop variables
+  // of a while block, in the order of the program.
+  std::unordered_map<std::string, std::map<int, mir::Node *>> versions;
+  for (auto &n : mutable_nodes()) {
+    if (n.IsArg()) versions[n.AsArg().name][n.AsArg().id] = &n;
+  }
+
   for (auto &n : mutable_nodes()) {
     if (!n.IsStmt()) continue;
     if (adj_list.find(&n) == adj_list.end()) {
@@ -55,6 +63,16 @@ std::map<mir::Node *, std::set<mir::Node *>> SSAGraph::BuildOperationAdjList() {
         nodes.push_back(adj_n);
       }
     }
+    // An op overwriting a variable runs after the ops reading its former
+    // value.
+    for (auto &var : n.outlinks) {
+      auto &nodes_of_var = versions[var->AsArg().name];
+      auto it = nodes_of_var.find(var->AsArg().id);
+      if (it == nodes_of_var.begin() || it == nodes_of_var.end()) continue;
+      for (auto &adj_n : std::prev(it)->second->outlinks) {
+        if (adj_n != &n) nodes.push_back(adj_n);
+      }
+    }
     std::sort(nodes.begin(),
               nodes.end(),
               [](mir::Node *node1, mir::Node *node2) { return node1 > node2; });
@@ -14,14 +14,20 @@
 
 #include "lite/core/mir/static_kernel_pick_pass.h"
 #include <algorithm>
+#include <cstring>
+#include <limits>
 #include <list>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 #include "lite/core/mir/graph_visualize_pass.h"
 #include "lite/core/mir/pass_registry.h"
+#include "lite/core/profile/timer.h"
+#include "lite/core/type_system.h"
 
 namespace paddle {
 namespace lite {
@@ -32,6 +38,246 @@ bool KernelScoreCmp(const std::pair<float, std::unique_ptr<KernelBase>>& a,
   return a.first > b.first;
 }
 
+namespace {
+
+// The ops can not be launched alone, their kernels are never measured.
+const std::set<std::string> kLatencyPickSkippedOps{
+    "feed", "fetch", "while", "conditional_block"};
+
+const int kLatencyPickWarmup = 1;
+const int kLatencyPickRepeats = 5;
+
+// The kernels of these targets work on the host memory, so that they can be
+// launched on the tensors of the exec scope directly.
+bool IsHostTarget(TargetType target) {
+  return target == TARGET(kHost) || target == TARGET(kX86) ||
+         target == TARGET(kARM);
+}
+
+/*
+ * LatencyPicker measures the candidate kernels of each statement on the
+ * tensors of the exec scope. The statements should be visited in topological
+ * order, so that the inputs of a statement have been computed by the ones
+ * visited before it. The feed variables are filled with zeros of the given
+ * shapes, every value is valid for both the float and the index inputs. The
+ * activations are released when the picker is destroyed.
+ */
+class LatencyPicker {
+ public:
+  using candidate_t = std::pair<float, std::unique_ptr<KernelBase>>;
+
+  LatencyPicker(SSAGraph* graph,
+                const std::map<std::string, std::vector<int64_t>>& shapes) {
+    for (auto& node : graph->mutable_nodes()) {
+      if (node.IsStmt()) {
+        scope_ = node.AsStmt().op()->scope();
+        break;
+      }
+    }
+    CHECK(scope_) << "no statement in the graph";
+    for (auto& item : shapes) {
+      auto* var = scope_->FindVar(item.first);
+      CHECK(var) << "no feed variable " << item.first;
+      CHECK(!item.second.empty()) << "empty shape of " << item.first;
+      auto* tensor = var->GetMutable<lite::Tensor>();
+      tensor->Resize(item.second);
+      // One sequence for the ops taking LoD inputs.
+      tensor->set_lod({{0, static_cast<uint64_t>(item.second.at(0))}});
+      FillZeros(tensor);
+      var_types_[item.first] = Type::GetTensorTy(TARGET(kHost));
+      touched_vars_.insert(item.first);
+    }
+    MeasureCopyCost();
+  }
+
+  ~LatencyPicker() {
+    for (auto& name : touched_vars_) {
+      *scope_->FindVar(name)->GetMutable<lite::Tensor>() = lite::Tensor();
+    }
+  }
+
+  // Return the index of the picked kernel in `candidates`, which are sorted
+  // by the static score.
+  size_t Pick(Node* node, std::vector<candidate_t>* candidates) {
+    auto& instruct = node->AsStmt();
+    if (kLatencyPickSkippedOps.count(instruct.op_type()) ||
+        !InputsReady(node)) {
+      return 0;
+    }
+    auto* op = instruct.op().get();
+    if (!op->CheckShape() || !op->InferShape()) return 0;
+    if (!Measurable(node, *candidates->front().second)) {
+      // Leave zeros in the outputs to keep measuring the following ones.
+      FillOutputs(node);
+      return 0;
+    }
+
+    size_t picked = 0;
+    float picked_cost = std::numeric_limits<float>::max();
+    for (size_t i = 0; i < candidates->size(); ++i) {
+      auto& kernel = *(*candidates)[i].second;
+      if (!Measurable(node, kernel)) continue;
+      // Only one candidate, run it to compute the outputs for the
+      // following statements without measuring it.
+      int repeats = candidates->size() == 1 ? 1 : kLatencyPickRepeats;
+      float cost = MeasureLatency(op, kernel, repeats) + CastCost(node, kernel);
+      VLOG(4) << "latency pick " << kernel.summary() << " cost(ms):" << cost;
+      if (cost < picked_cost) {
+        picked_cost = cost;
+        picked = i;
+      }
+    }
+    VLOG(2) << "latency pick " << (*candidates)[picked].second->summary()
+            << " cost(ms):" << picked_cost;
+    return picked;
+  }
+
+  // Record the declared output types of the picked kernel, the inputs of the
+  // following statements are cast from them.
+  void RecordOutputTypes(Node* node, const KernelBase& picked) {
+    auto& instruct = node->AsStmt();
+    for (auto* out : node->outlinks) {
+      std::string arg_name;
+      if (!instruct.op_info()->GetOutputArgname(out->arg()->name, &arg_name)) {
+        continue;
+      }
+      var_types_[out->arg()->name] = picked.GetOutputDeclType(arg_name);
+    }
+  }
+
+ private:
+  // 8 bytes per element covers the widest float and index types.
+  void FillZeros(lite::Tensor* tensor) {
+    auto* data = tensor->mutable_data<int64_t>();
+    std::fill(data, data + tensor->numel(), 0);
+  }
+
+  lite::Tensor* FindTensor(const std::string& name) {
+    auto* var = scope_->FindVar(name);
+    if (!var || !var->IsType<lite::Tensor>()) return nullptr;
+    return var->GetMutable<lite::Tensor>();
+  }
+
+  bool InputsReady(Node* node) {
+    for (auto* in : node->inlinks) {
+      auto* tensor = FindTensor(in->arg()->name);
+      if (!tensor || tensor->memory_size() == 0) return false;
+    }
+    return true;
+  }
+
+  const Type* VarType(Node* arg_node) {
+    auto it = var_types_.find(arg_node->arg()->name);
+    if (it != var_types_.end()) return it->second;
+    // Weights are loaded to the host.
+    auto precision = FindTensor(arg_node->arg()->name)->precision();
+    if (precision == PRECISION(kUnk)) precision = PRECISION(kFloat);
+    return Type::GetTensorTy(TARGET(kHost), precision);
+  }
+
+  // The kernel reads the input tensors as they are, so that their precision
+  // and layout should be compatible with its declaration.
+  bool Measurable(Node* node, const KernelBase& kernel) {
+    if (!IsHostTarget(kernel.target())) return false;
+    auto& instruct = node->AsStmt();
+    for (auto* in : node->inlinks) {
+      std::string arg_name;
+      if (!instruct.op_info()->GetInputArgname(in->arg()->name, &arg_name)) {
+        continue;
+      }
+      const Type* from = VarType(in);
+      const Type* to = kernel.GetInputDeclType(arg_name);
+      if (!PrecisionCompatibleTo(*from, *to) ||
+          !DataLayoutCompatibleTo(*from, *to)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // The io_copy, layout and calib ops inserted on the inputs each take about
+  // one pass over the tensor. The weights are cast only once, they are free.
+  float CastCost(Node* node, const KernelBase& kernel) {
+    auto& instruct = node->AsStmt();
+    float cost = 0.f;
+    for (auto* in : node->inlinks) {
+      std::string arg_name;
+      if (in->arg()->is_weight || in->arg()->is_persist ||
+          !instruct.op_info()->GetInputArgname(in->arg()->name, &arg_name)) {
+        continue;
+      }
+      const Type* from = VarType(in);
+      const Type* to = kernel.GetInputDeclType(arg_name);
+      int casts = !TargetCompatibleTo(*from, *to) +
+                  !DataLayoutCompatibleTo(*from, *to) +
+                  !PrecisionCompatibleTo(*from, *to);
+      cost += casts * copy_ms_per_byte_ *
+              FindTensor(in->arg()->name)->memory_size();
+    }
+    return cost;
+  }
+
+  // Launch a new instance of the kernel, the candidate itself is kept
+  // untouched for the weights transforms in `PrepareForRun`.
+  float MeasureLatency(OpLite* op, const KernelBase& kernel, int repeats) {
+    std::unique_ptr<KernelBase> instance;
+    for (auto& k : op->CreateKernels({kernel.place()})) {
+      if (k->alias() == kernel.alias() && k->place() == kernel.place()) {
+        instance = std::move(k);
+        break;
+      }
+    }
+    CHECK(instance) << "no kernel " << kernel.summary();
+    instance->SetContext(
+        ContextScheduler::Global().NewContext(instance->target()));
+    for (int i = 0; i < kLatencyPickWarmup; ++i) {
+      instance->Launch();
+    }
+    profile::Timer timer;
+    for (int i = 0; i < repeats; ++i) {
+      timer.Start();
+      instance->Launch();
+      timer.Stop();
+    }
+    MarkOutputs(op);
+    return timer.LapTimes().Min();
+  }
+
+  void FillOutputs(Node* node) {
+    auto* op = node->AsStmt().op().get();
+    for (auto* out : node->outlinks) {
+      auto* tensor = FindTensor(out->arg()->name);
+      if (tensor && tensor->memory_size() == 0) FillZeros(tensor);
+    }
+    MarkOutputs(op);
+  }
+
+  void MarkOutputs(OpLite* op) {
+    for (auto& name : op->op_info()->output_names()) {
+      touched_vars_.insert(name);
+    }
+  }
+
+  void MeasureCopyCost() {
+    const size_t size = 4 << 20;
+    std::vector<char> src(size, 1), dst(size);
+    profile::Timer timer;
+    for (int i = 0; i < kLatencyPickRepeats; ++i) {
+      timer.Start();
+      std::memcpy(dst.data(), src.data(), size);
+      timer.Stop();
+    }
+    copy_ms_per_byte_ = timer.LapTimes().Min() / size;
+  }
+
+  lite::Scope* scope_{nullptr};
+  std::map<std::string, const Type*> var_types_;
+  std::set<std::string> touched_vars_;
+  float copy_ms_per_byte_{0.f};
+};
+
+}  // namespace
+
 void StaticKernelPickPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
   kernel_pick_factors_.ConsiderTarget();
   kernel_pick_factors_.ConsiderPrecision();
@@ -40,10 +286,24 @@ void StaticKernelPickPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
       << "kernel_pick_factors should be specified first";
   CHECK(graph) << "graph not valid";
 
+  // The statements are visited in topological order for picking by latency,
+  // to compute the inputs of each statement before measuring it.
+  std::unique_ptr<LatencyPicker> latency_picker;
+  std::vector<Node*> stmts;
+  if (!latency_pick_input_shapes_.empty()) {
+    latency_picker.reset(
+        new LatencyPicker(graph.get(), latency_pick_input_shapes_));
+    stmts = graph->StmtTopologicalOrder();
+  } else {
+    for (auto& node : graph->mutable_nodes()) {
+      if (node.IsStmt()) stmts.push_back(&node);
+    }
+  }
+
   // sort kernels by the factors.
   VLOG(4) << "graph->mutable_nodes().size():" << graph->mutable_nodes().size();
-  for (auto& node : graph->mutable_nodes()) {
-    if (!node.IsStmt()) continue;
+  for (auto* stmt : stmts) {
+    auto& node = *stmt;
     auto& instruct = node.AsStmt();
 
     std::unordered_map<std::string, PrecisionType> in_types;
@@ -81,10 +341,14 @@ void StaticKernelPickPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
     instruct.kernels().clear();
 
     if (!instruct.op_info()->HasAttr("enable_int8")) {
+      size_t picked = 0;
+      if (latency_picker) {
+        picked = latency_picker->Pick(&node, &scored);
+      }
       // Move kernel back
       // Just keep a single best kernel.
       // TODO(Superjomn) reconsider this.
-      instruct.kernels().emplace_back(std::move(scored.front().second));
+      instruct.kernels().emplace_back(std::move(scored[picked].second));
       VLOG(2) << "pick " << instruct.kernels().front()->name() << "\n\n";
 
     } else {
@@ -162,6 +426,9 @@ void StaticKernelPickPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
       CHECK(!instruct.kernels().empty()) << "No kernels found for "
                                          << instruct.op_type();
     }
+    if (latency_picker) {
+      latency_picker->RecordOutputTypes(&node, *instruct.kernels().front());
+    }
   }
 }
 
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <limits>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -28,13 +29,19 @@ namespace mir {
 
 /*
  * StaticKernelPickPass is a simple strategy for picking the kernel for each
- * Operator using operator developer defined rule, there are many other tactics
- * such as considering IO or kernel execution latency and we will implement them
- * latter.
+ * Operator using operator developer defined rule.
  *
- * There are two argument for this pass:
+ * If the input shapes are set, the candidate kernels running on the host
+ * (kHost, kX86, kARM) are also measured on tensors of the real shapes, and the
+ * one with the lowest latency plus the estimated cost of the io_copy, layout
+ * and precision casts it requires on its inputs is picked. Kernels of the
+ * other targets are not measured, the static pick is kept for the ops whose
+ * best scored kernel is one of them.
+ *
+ * There are three argument for this pass:
  * - place, the target place.
  * - kernel_pick_factors, the factors to consider in picking kernels.
+ * - latency_pick_input_shapes, the shapes of the feed inputs, optional.
  * Set them first before execute the pass.
  */
 class StaticKernelPickPass : public mir::StmtPass {
@@ -48,6 +55,17 @@ class StaticKernelPickPass : public mir::StmtPass {
     return &kernel_pick_factors_;
   }
 
+  // Pick kernels by the measured latency, see above. The keys are the names
+  // of the feed variables, an empty map disables it.
+  void SetLatencyPickInputShapes(
+      const std::map<std::string, std::vector<int64_t>>& shapes) {
+    latency_pick_input_shapes_ = shapes;
+  }
+  const std::map<std::string, std::vector<int64_t>>&
+  latency_pick_input_shapes() const {
+    return latency_pick_input_shapes_;
+  }
+
  private:
   // Score the kernel.
   size_t KernelGrade(
@@ -168,6 +186,7 @@ class StaticKernelPickPass : public mir::StmtPass {
 
  private:
   core::KernelPickFactor kernel_pick_factors_;
+  std::map<std::string, std::vector<int64_t>> latency_pick_input_shapes_;
 };
 
 }  // namespace mir
@@ -0,0 +1,344 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/mir/subgraph/elementwise_chain_fuse_pass.h"
+#include <list>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "lite/core/mir/pass_registry.h"
+#include "lite/core/mir/pattern_matcher.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+namespace subgraph {
+
+constexpr int ElementwiseChainFusePass::kMaxChainOps;
+
+namespace {
+
+const std::set<std::string>& ElementwiseOps() {
+  static const std::set<std::string> ops{"elementwise_add",
+                                         "elementwise_sub",
+                                         "elementwise_mul",
+                                         "elementwise_div",
+                                         "elementwise_max",
+                                         "elementwise_min"};
+  return ops;
+}
+
+const std::set<std::string>& FusedElementwiseOps() {
+  static const std::set<std::string> ops{"fusion_elementwise_add_activation",
+                                         "fusion_elementwise_sub_activation",
+                                         "fusion_elementwise_mul_activation",
+                                         "fusion_elementwise_div_activation",
+                                         "fusion_elementwise_max_activation"};
+  return ops;
+}
+
+// The activations without attributes, which fusion_elementwise_*_activation
+// can end with too.
+const std::set<std::string>& PlainActivations() {
+  static const std::set<std::string> ops{
+      "relu", "sigmoid", "tanh", "exp", "square", "sqrt", "abs"};
+  return ops;
+}
+
+// The argument `name` of an op.
+Node* FindArg(const std::list<Node*>& args, const std::string& name) {
+  for (auto* arg : args) {
+    if (arg->IsArg() && arg->AsArg().name == name) return arg;
+  }
+  return nullptr;
+}
+
+Node* OutArg(Node* node) {
+  return FindArg(node->outlinks,
+                 node->AsStmt().op_info()->Output("Out").front());
+}
+
+// The steps of a chain refer to its inputs by their index, and to the
+// results of the steps by kStepValue + the step index, until the number of
+// inputs is known.
+constexpr int kStepValue = 1 << 20;
+
+struct ChainSteps {
+  std::vector<Node*> inputs;
+  std::unordered_map<Node*, int> values;
+  std::vector<std::string> types;
+  std::vector<int> operands;
+  std::vector<int> axes;
+  std::vector<float> alphas;
+  std::vector<float> betas;
+
+  int Value(Node* arg) {
+    auto it = values.find(arg);
+    if (it != values.end()) return it->second;
+    inputs.push_back(arg);
+    return values[arg] = static_cast<int>(inputs.size()) - 1;
+  }
+
+  // Adds a step and returns its value.
+  int Add(const std::string& type,
+          int a,
+          int b = -1,
+          int axis = -1,
+          float alpha = 0.f,
+          float beta = 0.f) {
+    types.push_back(type);
+    operands.push_back(a);
+    operands.push_back(b);
+    axes.push_back(axis);
+    alphas.push_back(alpha);
+    betas.push_back(beta);
+    return kStepValue + static_cast<int>(types.size()) - 1;
+  }
+
+  int Index(int value) const {
+    return value >= kStepValue
+               ? static_cast<int>(inputs.size()) + value - kStepValue
+               : value;
+  }
+};
+
+}  // namespace
+
+bool ElementwiseChainFusePass::CanFuse(Node* node) const {
+  if (!node->IsStmt()) return false;
+  auto& stmt = node->AsStmt();
+  auto* op_info = stmt.op_info();
+  const std::string& type = op_info->Type();
+  const bool elementwise = ElementwiseOps().count(type) > 0;
+  const bool fused = FusedElementwiseOps().count(type) > 0;
+  if (!elementwise && !fused && !PlainActivations().count(type) &&
+      type != "relu6" && type != "leaky_relu" && type != "scale" &&
+      type != "cast") {
+    return false;
+  }
+  if (fused &&
+      !PlainActivations().count(op_info->GetAttr<std::string>("act_type"))) {
+    return false;
+  }
+  if (stmt.kernels().empty()) return false;
+  auto& kernel = stmt.picked_kernel();
+  if (kernel.target() != TARGET(kX86) && kernel.target() != TARGET(kHost)) {
+    return false;
+  }
+  // The jit kernel runs on float only, the casts fused are the float ones.
+  if (type == "cast") {
+    const int kFP32 = 5;  // framework::proto::VarType::FP32
+    if (op_info->GetAttr<int>("in_dtype") != kFP32 ||
+        op_info->GetAttr<int>("out_dtype") != kFP32) {
+      return false;
+    }
+  } else if (kernel.precision() != PRECISION(kFloat)) {
+    return false;
+  }
+  if (op_info->Input("X").size() != 1 || op_info->Output("Out").size() != 1) {
+    return false;
+  }
+  if ((elementwise || fused) && op_info->Input("Y").size() != 1) {
+    return false;
+  }
+  return OutArg(node) != nullptr;
+}
+
+Node* ElementwiseChainFusePass::NextInChain(
+    Node* tail,
+    int chain_id,
+    int head_order,
+    const std::unordered_map<Node*, int>& order) const {
+  Node* out = OutArg(tail);
+  for (auto* next : out->outlinks) {
+    if (!next->IsStmt() || next->AsStmt().subgraph_id() != 0) continue;
+    if (next->AsStmt().op_info()->Input("X").front() != out->AsArg().name) {
+      continue;
+    }
+    bool single_op = true;
+    for (auto* in : next->inlinks) {
+      if (in == out || in->AsArg().is_weight || in->inlinks.empty()) continue;
+      auto* producer = in->inlinks.front();
+      if (producer->AsStmt().subgraph_id() == chain_id) continue;
+      if (order.at(producer) < head_order) continue;
+      // Produced after the head of the chain, maybe from one of its outputs.
+      single_op = false;
+      break;
+    }
+    if (single_op) return next;
+  }
+  return nullptr;
+}
+
+void ElementwiseChainFusePass::FuseChain(
+    const std::unique_ptr<SSAGraph>& graph, const std::vector<Node*>& chain) {
+  ChainSteps steps;
+  for (auto* node : chain) {
+    auto* op_info = node->AsStmt().op_info();
+    const std::string& type = op_info->Type();
+    const int x = steps.Value(FindArg(node->inlinks, op_info->Input("X")[0]));
+    int value = -1;
+    if (ElementwiseOps().count(type) || FusedElementwiseOps().count(type)) {
+      const int y =
+          steps.Value(FindArg(node->inlinks, op_info->Input("Y").front()));
+      const int axis =
+          op_info->HasAttr("axis") ? op_info->GetAttr<int>("axis") : -1;
+      if (ElementwiseOps().count(type)) {
+        value = steps.Add(type, x, y, axis);
+      } else {
+        // fusion_elementwise_add_activation: elementwise_add, then act_type.
+        const std::string elementwise =
+            "elementwise_" + type.substr(std::string("fusion_elementwise_")
+                                             .size(),
+                                         3);
+        value = steps.Add(elementwise, x, y, axis);
+        value = steps.Add(op_info->GetAttr<std::string>("act_type"), value);
+      }
+    } else if (type == "relu6") {
+      const float threshold = op_info->HasAttr("threshold")
+                                  ? op_info->GetAttr<float>("threshold")
+                                  : 6.f;
+      value = steps.Add(type, x, -1, -1, threshold);
+    } else if (type == "leaky_relu") {
+      value = steps.Add(type, x, -1, -1, op_info->GetAttr<float>("alpha"));
+    } else if (type == "scale") {
+      const float scale = op_info->GetAttr<float>("scale");
+      float bias = op_info->GetAttr<float>("bias");
+      if (!op_info->GetAttr<bool>("bias_after_scale")) {
+        bias *= scale;
+      }
+      value = steps.Add(type, x, -1, -1, scale, bias);
+    } else {
+      value = steps.Add(type, x);
+    }
+    steps.values[OutArg(node)] = value;
+  }
+
+  std::unordered_set<Node*> op_nodes(chain.begin(), chain.end());
+  std::unordered_set<Node*> in_data_vars;
+  std::unordered_set<Node*> in_wgt_vars;
+  std::unordered_set<Node*> out_data_vars;
+  std::unordered_set<Node*> out_unused_vars;
+  FindInputOutputVars(
+      op_nodes, &in_data_vars, &in_wgt_vars, &out_data_vars, &out_unused_vars);
+  CHECK_EQ(in_data_vars.size() + in_wgt_vars.size(), steps.inputs.size());
+
+  // The outputs read by an op out of the chain or out of the graph, and the
+  // last one in any case. out_data_vars misses the ones read in the chain
+  // too.
+  std::vector<Node*> outputs;
+  std::unordered_set<Node*> kept_vars;
+  std::vector<std::string> in_names, out_names;
+  std::vector<int> out_values;
+  for (auto* node : chain) {
+    Node* out = OutArg(node);
+    bool used_after = out->AsArg().is_extern || node == chain.back();
+    for (auto* next : out->outlinks) {
+      used_after = used_after || !op_nodes.count(next);
+    }
+    if (used_after) {
+      outputs.push_back(out);
+      kept_vars.insert(out);
+      out_names.push_back(out->AsArg().name);
+      out_values.push_back(steps.Index(steps.values.at(out)));
+    }
+  }
+  for (auto* in : steps.inputs) {
+    in_names.push_back(in->AsArg().name);
+  }
+  for (auto& operand : steps.operands) {
+    operand = operand < 0 ? operand : steps.Index(operand);
+  }
+
+  cpp::OpDesc op_desc;
+  op_desc.SetType("fusion_elementwise_chain");
+  op_desc.SetInput("X", in_names);
+  op_desc.SetOutput("Out", out_names);
+  op_desc.SetAttr("step_types", steps.types);
+  op_desc.SetAttr("operands", steps.operands);
+  op_desc.SetAttr("axes", steps.axes);
+  op_desc.SetAttr("alphas", steps.alphas);
+  op_desc.SetAttr("betas", steps.betas);
+  op_desc.SetAttr("out_values", out_values);
+
+  auto old_op = chain.front()->AsStmt().op();
+  auto op = LiteOpRegistry::Global().Create("fusion_elementwise_chain");
+  op->Attach(op_desc, old_op->scope());
+  auto* new_op_node =
+      graph->GraphCreateInstructNode(op, old_op->valid_places());
+  for (auto* in : steps.inputs) {
+    IR_NODE_LINK_TO(in, new_op_node);
+  }
+  for (auto* out : outputs) {
+    IR_OP_VAR_LINK(new_op_node, out);
+  }
+
+  auto nodes2rm = GetNode2rm(
+      op_nodes, {in_data_vars, in_wgt_vars, kept_vars});
+  GraphSafeRemoveNodes(graph.get(), nodes2rm);
+  VLOG(3) << "fused " << chain.size() << " ops into fusion_elementwise_chain";
+}
+
+void ElementwiseChainFusePass::Apply(const std::unique_ptr<SSAGraph>& graph) {
+  auto nodes = graph->StmtTopologicalOrder();
+  std::unordered_map<Node*, int> order;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    order[nodes[i]] = static_cast<int>(i);
+    // Like InitSubgraphID, 0 for the ops which can be fused, -1 otherwise.
+    if (CanFuse(nodes[i])) {
+      nodes[i]->AsStmt().SetSubgraphID(0);
+    } else {
+      nodes[i]->AsStmt().ClearSubgraphID();
+    }
+  }
+
+  // Grow a chain from every op not in a chain yet, in topological order.
+  int chain_id = 1;
+  for (auto* head : nodes) {
+    if (head->AsStmt().subgraph_id() != 0) continue;
+    head->AsStmt().SetSubgraphID(chain_id);
+    Node* tail = head;
+    int length = 1;
+    while (length < kMaxChainOps) {
+      Node* next = NextInChain(tail, chain_id, order.at(head), order);
+      if (!next) break;
+      next->AsStmt().SetSubgraphID(chain_id);
+      tail = next;
+      ++length;
+    }
+    if (length > 1) {
+      ++chain_id;
+    } else {
+      head->AsStmt().ClearSubgraphID();
+    }
+  }
+
+  for (auto& chain : ClassifySubgraph(graph)) {
+    FuseChain(graph, GetTopologicalOrder(chain.second));
+  }
+}
+
+}  // namespace subgraph
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(x86_elementwise_chain_fuse_pass,
+                  paddle::lite::mir::subgraph::ElementwiseChainFusePass)
+    .BindTargets({TARGET(kX86)})
+    .BindKernel("fusion_elementwise_chain");
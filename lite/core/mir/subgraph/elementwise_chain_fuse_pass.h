@@ -0,0 +1,68 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "lite/core/mir/pass.h"
+#include "lite/core/mir/subgraph/subgraph_program_pass.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+namespace subgraph {
+
+/*
+ * Fuses the chains of elementwise, activation, scale and float casts on x86
+ * into fusion_elementwise_chain ops, run as a single jit loop which reads
+ * every input and writes every output once, instead of a pass over the data
+ * for every op.
+ *
+ * A chain goes on with an op taking the output of the one before as X. Its
+ * other inputs have to be weights, or come from the chain or from an op
+ * before the first one of the chain, so that the chain can run as a single
+ * op. The outputs of the chain used outside of it are all kept.
+ *
+ * It is not in the default passes of the Optimizer yet, it runs after
+ * static_kernel_pick_pass with CxxConfig::set_fuse_elementwise_chain.
+ */
+class ElementwiseChainFusePass : public SubgraphProgramPass {
+ public:
+  // The most ops fused into a chain.
+  static constexpr int kMaxChainOps = 16;
+
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override;
+
+ protected:
+  // Whether the op runs on float tensors and can join a chain.
+  bool CanFuse(Node* node) const;
+
+  // The op going on with the chain `chain_id` of `tail`, or nullptr.
+  Node* NextInChain(Node* tail,
+                    int chain_id,
+                    int head_order,
+                    const std::unordered_map<Node*, int>& order) const;
+
+  // Replaces the ops of a chain, in order, with a fusion_elementwise_chain.
+  void FuseChain(const std::unique_ptr<SSAGraph>& graph,
+                 const std::vector<Node*>& chain);
+};
+
+}  // namespace subgraph
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
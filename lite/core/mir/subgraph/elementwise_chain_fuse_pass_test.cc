@@ -0,0 +1,298 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/mir/subgraph/elementwise_chain_fuse_pass.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "lite/api/paddle_use_passes.h"
+#include "lite/core/kernel.h"
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer.h"
+#include "lite/core/program.h"
+#include "lite/operators/op_params.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+namespace subgraph {
+
+// An exp with a kernel of any precision, which the pass should not fuse.
+class AnyExpCompute : public KernelLite<TARGET(kX86), PRECISION(kAny)> {
+ public:
+  using param_t = operators::ActivationParam;
+
+  void Run() override {
+    auto& param = Param<param_t>();
+    const float* x = param.X->data<float>();
+    float* out = param.Out->mutable_data<float>();
+    for (int64_t i = 0; i < param.X->numel(); ++i) {
+      out[i] = std::exp(x[i]);
+    }
+  }
+};
+
+namespace {
+
+using args_t = std::map<std::string, std::vector<std::string>>;
+
+const int kFP32 = 5;  // framework::proto::VarType::FP32
+const int kFP64 = 6;
+
+cpp::OpDesc* AddOp(cpp::BlockDesc* block,
+                   const std::string& type,
+                   const args_t& ins,
+                   const args_t& outs) {
+  auto* op = block->AddOp<cpp::OpDesc>();
+  op->SetType(type);
+  for (auto& item : ins) op->SetInput(item.first, item.second);
+  for (auto& item : outs) op->SetOutput(item.first, item.second);
+  return op;
+}
+
+void AddElementwise(cpp::BlockDesc* block,
+                    const std::string& type,
+                    const std::string& x,
+                    const std::string& y,
+                    const std::string& out) {
+  auto* op = AddOp(block, type, {{"X", {x}}, {"Y", {y}}}, {{"Out", {out}}});
+  op->SetAttr<int>("axis", -1);
+}
+
+void AddCast(cpp::BlockDesc* block,
+             const std::string& x,
+             const std::string& out,
+             int out_dtype) {
+  auto* op = AddOp(block, "cast", {{"X", {x}}}, {{"Out", {out}}});
+  op->SetAttr<int>("in_dtype", kFP32);
+  op->SetAttr<int>("out_dtype", out_dtype);
+}
+
+// x and w are [2, 3], w is a weight:
+//   a = scale(x, 2, -1)       the head of a chain, `a` is an extern var
+//   b = relu(a)
+//   p = softsign(b)           not fused, read with b by the add
+//   c = b + p                 cuts the chain, p is produced after its head
+//   g = cast(c, FP32)
+//   d = tanh(g)
+//   e = cast(d, FP64)         not fused
+//   h = exp(d)                not fused, its kernel is not a float one
+//   k = h - w
+//   m = sigmoid(k)
+void BuildProgram(cpp::ProgramDesc* desc) {
+  auto* block = desc->AddBlock<cpp::BlockDesc>();
+  block->SetIdx(0);
+  block->SetParentIdx(-1);
+  for (auto& name : {"x", "a", "b", "p", "c", "g", "d", "e", "h", "k", "m"}) {
+    auto* var = block->AddVar<cpp::VarDesc>();
+    var->SetName(name);
+    var->SetType(VarDescAPI::Type::LOD_TENSOR);
+  }
+  auto* w = block->AddVar<cpp::VarDesc>();
+  w->SetName("w");
+  w->SetType(VarDescAPI::Type::LOD_TENSOR);
+  w->SetPersistable(true);
+
+  auto* scale = AddOp(block, "scale", {{"X", {"x"}}}, {{"Out", {"a"}}});
+  scale->SetAttr<float>("scale", 2.f);
+  scale->SetAttr<float>("bias", -1.f);
+  scale->SetAttr<bool>("bias_after_scale", true);
+  AddOp(block, "relu", {{"X", {"a"}}}, {{"Out", {"b"}}});
+  AddOp(block, "softsign", {{"X", {"b"}}}, {{"Out", {"p"}}});
+  AddElementwise(block, "elementwise_add", "b", "p", "c");
+  AddCast(block, "c", "g", kFP32);
+  AddOp(block, "tanh", {{"X", {"g"}}}, {{"Out", {"d"}}});
+  AddCast(block, "d", "e", kFP64);
+  AddOp(block, "exp", {{"X", {"d"}}}, {{"Out", {"h"}}});
+  AddElementwise(block, "elementwise_sub", "h", "w", "k");
+  AddOp(block, "sigmoid", {{"X", {"k"}}}, {{"Out", {"m"}}});
+}
+
+void SetTensor(Scope* scope, const std::string& name, float start) {
+  auto* tensor = scope->Var(name)->GetMutable<lite::Tensor>();
+  tensor->Resize({2, 3});
+  auto* data = tensor->mutable_data<float>();
+  for (int i = 0; i < 6; ++i) {
+    data[i] = start + 0.4f * static_cast<float>(i);
+  }
+}
+
+struct Result {
+  std::vector<std::string> op_types;
+  // The X and the Out of the fusion_elementwise_chain ops, in order.
+  std::vector<std::vector<std::string>> chain_inputs;
+  std::vector<std::vector<std::string>> chain_outputs;
+  std::set<std::string> vars;
+  std::map<std::string, std::vector<double>> values;
+};
+
+// With `default_passes`, the pass runs with the default ones of the Optimizer
+// instead of the minimal list.
+Result Run(bool fuse, bool default_passes = false) {
+  cpp::ProgramDesc desc;
+  BuildProgram(&desc);
+  std::vector<Place> places{Place{TARGET(kX86), PRECISION(kFloat)},
+                            Place{TARGET(kHost), PRECISION(kFloat)},
+                            Place{TARGET(kHost), PRECISION(kAny)}};
+  auto scope = std::make_shared<Scope>();
+  SetTensor(scope.get(), "w", -0.5f);
+  Program program(desc, scope, places);
+  auto* exec_scope = program.exec_scope();
+  SetTensor(exec_scope, "x", -1.f);
+
+  std::vector<std::string> passes{"static_kernel_pick_pass",
+                                  "variable_place_inference_pass",
+                                  "type_target_cast_pass",
+                                  "variable_place_inference_pass",
+                                  "io_copy_kernel_pick_pass",
+                                  "variable_place_inference_pass",
+                                  "type_precision_cast_pass",
+                                  "variable_place_inference_pass",
+                                  "type_layout_cast_pass",
+                                  "variable_place_inference_pass",
+                                  "runtime_context_assign_pass"};
+  if (fuse && !default_passes) {
+    passes.insert(passes.begin() + 1, "x86_elementwise_chain_fuse_pass");
+  }
+  if (default_passes) passes.clear();
+  core::KernelPickFactor factor;
+  factor.ConsiderTarget();
+  factor.ConsiderPrecision();
+  Optimizer optimizer;
+  optimizer.SetExternVars({"a"});
+  optimizer.SetFuseElementwiseChain(fuse && default_passes);
+  optimizer.Run(std::move(program), places, factor, passes);
+
+  Result result;
+  auto* graph = optimizer.mutable_ssa_graph();
+  for (auto* node : graph->StmtTopologicalOrder()) {
+    auto* op_info = node->AsStmt().op_info();
+    result.op_types.push_back(op_info->Type());
+    if (op_info->Type() == "fusion_elementwise_chain") {
+      result.chain_inputs.push_back(op_info->Input("X"));
+      result.chain_outputs.push_back(op_info->Output("Out"));
+    }
+  }
+  for (auto& node : graph->mutable_nodes()) {
+    if (node.IsArg()) result.vars.insert(node.AsArg().name);
+  }
+
+  optimizer.GenRuntimeProgram()->Run();
+  for (auto& name : {"a", "b", "d", "m"}) {
+    auto* out = exec_scope->FindVar(name)->GetMutable<lite::Tensor>();
+    EXPECT_EQ(out->dims(), DDim({2, 3})) << name;
+    result.values[name].assign(out->data<float>(),
+                               out->data<float>() + out->numel());
+  }
+  auto* e = exec_scope->FindVar("e")->GetMutable<lite::Tensor>();
+  result.values["e"].assign(e->data<double>(), e->data<double>() + e->numel());
+  return result;
+}
+
+}  // namespace
+
+TEST(ElementwiseChainFusePass, fuse) {
+  auto result = Run(true);
+  ASSERT_EQ(result.chain_inputs.size(), 3u);
+
+  // The chain is cut before the add, p being produced after its head. The
+  // extern `a` and `b`, read by the softsign and the add, are kept.
+  EXPECT_EQ(result.chain_inputs[0], std::vector<std::string>({"x"}));
+  EXPECT_EQ(result.chain_outputs[0], std::vector<std::string>({"a", "b"}));
+  // The FP32 cast is fused, the intermediate c and g only read in the chain
+  // are removed, d is read by the FP64 cast and the exp.
+  EXPECT_EQ(result.chain_inputs[1], std::vector<std::string>({"b", "p"}));
+  EXPECT_EQ(result.chain_outputs[1], std::vector<std::string>({"d"}));
+  EXPECT_EQ(result.vars.count("c"), 0u);
+  EXPECT_EQ(result.vars.count("g"), 0u);
+  EXPECT_EQ(result.chain_inputs[2], std::vector<std::string>({"h", "w"}));
+  EXPECT_EQ(result.chain_outputs[2], std::vector<std::string>({"m"}));
+
+  // The FP64 cast and the exp of any precision are not fused.
+  std::multiset<std::string> types(result.op_types.begin(),
+                                   result.op_types.end());
+  EXPECT_EQ(types.count("softsign"), 1u);
+  EXPECT_EQ(types.count("cast"), 1u);
+  EXPECT_EQ(types.count("exp"), 1u);
+  EXPECT_EQ(types.count("fusion_elementwise_chain"), 3u);
+  EXPECT_EQ(types.size(), 6u);
+}
+
+TEST(ElementwiseChainFusePass, same_outputs) {
+  auto fused = Run(true);
+  auto origin = Run(false);
+  EXPECT_EQ(origin.chain_inputs.size(), 0u);
+  for (auto& item : origin.values) {
+    auto& values = fused.values[item.first];
+    ASSERT_EQ(values.size(), item.second.size()) << item.first;
+    for (size_t i = 0; i < values.size(); ++i) {
+      EXPECT_NEAR(values[i], item.second[i], 1e-5) << item.first << " " << i;
+    }
+  }
+}
+
+TEST(ElementwiseChainFusePass, default_passes) {
+  auto fused = Run(true, true);
+  EXPECT_EQ(fused.chain_inputs.size(), 3u);
+  auto origin = Run(false, true);
+  EXPECT_EQ(origin.chain_inputs.size(), 0u);
+  for (auto& item : origin.values) {
+    auto& values = fused.values[item.first];
+    ASSERT_EQ(values.size(), item.second.size()) << item.first;
+    for (size_t i = 0; i < values.size(); ++i) {
+      EXPECT_NEAR(values[i], item.second[i], 1e-5) << item.first << " " << i;
+    }
+  }
+}
+
+}  // namespace subgraph
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_KERNEL(exp,
+                     kX86,
+                     kAny,
+                     kNCHW,
+                     paddle::lite::mir::subgraph::AnyExpCompute,
+                     def)
+    .BindInput("X",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kAny))})
+    .BindOutput("Out",
+                {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kAny))})
+    .Finalize();
+
+USE_LITE_OP(scale);
+USE_LITE_OP(relu);
+USE_LITE_OP(softsign);
+USE_LITE_OP(elementwise_add);
+USE_LITE_OP(elementwise_sub);
+USE_LITE_OP(cast);
+USE_LITE_OP(tanh);
+USE_LITE_OP(exp);
+USE_LITE_OP(sigmoid);
+USE_LITE_OP(fusion_elementwise_chain);
+USE_LITE_KERNEL(scale, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(relu, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(softsign, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(elementwise_add, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(elementwise_sub, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(cast, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(tanh, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(sigmoid, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(fusion_elementwise_chain, kX86, kFloat, kNCHW, def);
@@ -69,6 +69,9 @@ class OpLite : public Registry {
   virtual bool Run();
   // Indicate whether the Op runs only once or not
   virtual bool run_once() const { return false; }
+  // Indicate whether the output shapes are inferred from the data of the
+  // inputs, such ops always run InferShape, see Instruction.
+  virtual bool shape_depends_on_data() const { return false; }
   std::string Type() { return op_type_; }
 
   // Link the external execution environ to internal context.
@@ -88,7 +91,7 @@ class OpLite : public Registry {
   std::vector<std::unique_ptr<KernelBase>> CreateKernels(
       const std::vector<Place> &places, const std::string &kernel_type = "");
 
-  lite::Scope *scope() { return scope_; }
+  lite::Scope *scope() const { return scope_; }
 
   // Assign op param to kernel.
   virtual void AttachKernel(KernelBase *kernel) = 0;
@@ -14,6 +14,8 @@
 
 #include "lite/core/optimizer.h"
 #include <fstream>
+#include <set>
+#include <string>
 #include "lite/core/mir/static_kernel_pick_pass.h"
 #include "lite/core/mir/type_target_cast_pass.h"
 #include "lite/model_parser/model_parser.h"
@@ -28,6 +30,68 @@ void Optimizer::SpecifyKernelPickTactic(core::KernelPickFactor factor) {
   CHECK(pass);
 
   *pass->mutable_kernel_pick_factors() = factor;
+  pass->SetLatencyPickInputShapes(latency_pick_input_shapes_);
+}
+
+namespace {
+
+// The vars of a sub-block also used outside it: the vars of the parent blocks,
+// and the vars read before they are written, which carry the values of the
+// last iteration of a while loop.
+std::set<std::string> SubBlockExternVars(cpp::BlockDesc* block) {
+  std::set<std::string> local_vars;
+  for (size_t i = 0; i < block->VarsSize(); ++i) {
+    local_vars.insert(block->GetVar<cpp::VarDesc>(i)->Name());
+  }
+  std::set<std::string> extern_vars;
+  std::set<std::string> written_vars;
+  for (size_t i = 0; i < block->OpsSize(); ++i) {
+    auto* op = block->GetOp<cpp::OpDesc>(i);
+    for (auto& name : op->input_vars()) {
+      if (!local_vars.count(name) || !written_vars.count(name)) {
+        extern_vars.insert(name);
+      }
+    }
+    for (auto& name : op->output_vars()) {
+      if (!local_vars.count(name)) extern_vars.insert(name);
+      written_vars.insert(name);
+    }
+  }
+  return extern_vars;
+}
+
+}  // namespace
+
+void Optimizer::OptimizeSubBlocks(cpp::ProgramDesc* desc) {
+  CHECK(desc);
+  CHECK(exec_scope_) << "the main block should be optimized first";
+  std::set<int> sub_blocks;
+  for (size_t b = 0; b < desc->BlocksSize(); ++b) {
+    auto* block = desc->GetBlock<cpp::BlockDesc>(b);
+    for (size_t i = 0; i < block->OpsSize(); ++i) {
+      auto* op = block->GetOp<cpp::OpDesc>(i);
+      if (op->Type() == "while" || op->Type() == "conditional_block") {
+        sub_blocks.insert(op->GetAttr<int32_t>("sub_block"));
+      }
+    }
+  }
+  for (int idx : sub_blocks) {
+    auto* block = desc->GetBlock<cpp::BlockDesc>(idx);
+    if (block->OpsSize() == 0) continue;
+    LOG(INFO) << "== Optimizing sub-block " << idx;
+    // The vars of the sub-blocks are created in the exec scope of the main
+    // block, where the sub-blocks run.
+    Program program(*desc, idx, exec_scope_, valid_places_);
+    Optimizer optimizer;
+    optimizer.SetExternVars(SubBlockExternVars(block));
+    optimizer.SetLatencyPickInputShapes(latency_pick_input_shapes_);
+    optimizer.SetMemoryPlannedAtRuntime(memory_planned_at_runtime_);
+    optimizer.Run(
+        std::move(program), valid_places_, kernel_pick_factor_, passes_);
+    auto runtime_program = optimizer.GenRuntimeProgram();
+    runtime_program->SaveOpInfosToProgram(desc, idx);
+    runtime_program->UpdateVarsOfProgram(desc, idx);
+  }
 }
 
 }  // namespace lite
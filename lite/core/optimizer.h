@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #pragma once
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <set>
@@ -49,12 +50,26 @@ class Optimizer {
            const std::vector<std::string>& passes = {}) {
     program_ = &program;
     valid_places_ = valid_places;
+    kernel_pick_factor_ = kernel_pick_factor;
+    passes_ = passes;
     CHECK(!valid_places.empty()) << "At least one valid_place should be set";
     CHECK(!graph_) << "duplicate optimize found";
 
     graph_.reset(new mir::SSAGraph);
     graph_->Build(program, valid_places);
     graph_->SetValidPlaces(valid_places);
+    for (auto& node : graph_->mutable_nodes()) {
+      if (node.IsArg() && extern_vars_.count(node.AsArg().name)) {
+        node.AsArg().is_extern = true;
+      }
+      // The sub-blocks of the while and conditional_block ops read and write
+      // their inputs and outputs by name, which should be kept.
+      if (node.IsStmt() && (node.AsStmt().op_type() == "while" ||
+                            node.AsStmt().op_type() == "conditional_block")) {
+        for (auto* var : node.inlinks) var->AsArg().is_extern = true;
+        for (auto* var : node.outlinks) var->AsArg().is_extern = true;
+      }
+    }
 
     SpecifyKernelPickTactic(kernel_pick_factor);
     InitTargetTypeTransformPass();
@@ -72,6 +87,7 @@ class Optimizer {
            "lite_shuffle_channel_fuse_pass",              //
            "lite_transpose_softmax_transpose_fuse_pass",  //
            "lite_interpolate_fuse_pass",                  //
+           "lite_embedding_seq_pool_fuse_pass",           //
            "identity_scale_eliminate_pass",               //
 #if (defined LITE_WITH_LIGHT_WEIGHT_FRAMEWORK) || (defined LITE_WITH_CUDA)
            "lite_elementwise_add_activation_fuse_pass",  //
@@ -110,6 +126,18 @@ class Optimizer {
            "runtime_context_assign_pass",
            "argument_type_display_pass",
            "memory_optimize_pass"}};
+      if (fuse_elementwise_chain_) {
+        auto pick = std::find(passes_local.begin(),
+                              passes_local.end(),
+                              "static_kernel_pick_pass");
+        passes_local.insert(pick + 1, "x86_elementwise_chain_fuse_pass");
+      }
+      if (memory_planned_at_runtime_) {
+        passes_local.erase(std::remove(passes_local.begin(),
+                                       passes_local.end(),
+                                       "memory_optimize_pass"),
+                           passes_local.end());
+      }
       RunPasses(passes_local);
     } else {
       RunPasses(passes);
@@ -161,6 +189,34 @@ class Optimizer {
 
   lite::Scope* exec_scope() { return exec_scope_; }
 
+  // The activations will be placed by the MemoryPlanner of the runtime
+  // program, the memory_optimize_pass is skipped to keep the variables apart.
+  void SetMemoryPlannedAtRuntime(bool x) { memory_planned_at_runtime_ = x; }
+
+  // Run the x86_elementwise_chain_fuse_pass with the default passes.
+  void SetFuseElementwiseChain(bool x) { fuse_elementwise_chain_ = x; }
+
+  // The vars also used outside the program, e.g. by the parent block of a
+  // sub-block, they are kept by the fusion and memory reuse passes. It should
+  // be set before `Run`.
+  void SetExternVars(const std::set<std::string>& names) {
+    extern_vars_ = names;
+  }
+
+  // Optimize the sub-blocks of the while and conditional_block ops of `desc`
+  // with the passes, the places and the settings of the main block, and write
+  // the picked kernels back to them. Their kernels then run the sub-blocks as
+  // nested runtime programs. It should be called after `Run`, on the desc the
+  // program was built from.
+  void OptimizeSubBlocks(cpp::ProgramDesc* desc);
+
+  // Pick the kernels by their latency on the feed inputs of these shapes, see
+  // StaticKernelPickPass. It should be set before `Run`.
+  void SetLatencyPickInputShapes(
+      const std::map<std::string, std::vector<int64_t>>& shapes) {
+    latency_pick_input_shapes_ = shapes;
+  }
+
  protected:
   void SpecifyKernelPickTactic(core::KernelPickFactor factor);
 
@@ -194,6 +250,12 @@ class Optimizer {
   std::vector<Place> valid_places_;
   lite::Scope* exec_scope_{};
   Program* program_{};
+  std::map<std::string, std::vector<int64_t>> latency_pick_input_shapes_;
+  bool memory_planned_at_runtime_{false};
+  bool fuse_elementwise_chain_{false};
+  core::KernelPickFactor kernel_pick_factor_;
+  std::vector<std::string> passes_;
+  std::set<std::string> extern_vars_;
 };
 
 }  // namespace lite
@@ -0,0 +1,208 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/profile/runtime_profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include "lite/utils/replace_stl/stream.h"
+
+namespace paddle {
+namespace lite {
+namespace profile {
+
+namespace {
+// The buckets cover [kMinLatency, kMinLatency * 2^kOctaves) microseconds, each
+// octave split in kBucketsPerOctave, i.e. a relative error under 5%.
+const double kMinLatency = 0.1;
+const int kOctaves = 32;
+const int kBucketsPerOctave = 16;
+const int kNumBuckets = kOctaves * kBucketsPerOctave;
+
+int BucketOf(double us) {
+  if (us <= kMinLatency) return 0;
+  int bucket =
+      static_cast<int>(std::log2(us / kMinLatency) * kBucketsPerOctave);
+  return std::min(bucket, kNumBuckets - 1);
+}
+
+// The geometric middle of the bucket.
+double BucketValue(int bucket) {
+  return kMinLatency * std::exp2((bucket + 0.5) / kBucketsPerOctave);
+}
+
+void WriteString(STL::stringstream* ss, const std::string& x) {
+  *ss << '"';
+  for (char c : x) {
+    if (c == '"' || c == '\\') {
+      *ss << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      *ss << ' ';
+    } else {
+      *ss << c;
+    }
+  }
+  *ss << '"';
+}
+
+void WriteShapes(STL::stringstream* ss, const OpRecord& op) {
+  *ss << '{';
+  for (size_t i = 0; i < op.input_shapes.size(); ++i) {
+    if (i) *ss << ", ";
+    WriteString(ss, op.input_names[i]);
+    *ss << ": [";
+    for (size_t j = 0; j < op.input_shapes[i].size(); ++j) {
+      if (j) *ss << ", ";
+      *ss << static_cast<long long>(op.input_shapes[i][j]);  // NOLINT
+    }
+    *ss << ']';
+  }
+  *ss << '}';
+}
+}  // namespace
+
+LatencyHistogram::LatencyHistogram() : buckets_(kNumBuckets, 0) {}
+
+void LatencyHistogram::Add(double us) {
+  ++buckets_[BucketOf(us)];
+  min_ = count_ ? std::min(min_, us) : us;
+  max_ = std::max(max_, us);
+  sum_ += us;
+  ++count_;
+}
+
+void LatencyHistogram::Clear() {
+  std::fill(buckets_.begin(), buckets_.end(), 0);
+  count_ = 0;
+  sum_ = 0.;
+  min_ = 0.;
+  max_ = 0.;
+}
+
+double LatencyHistogram::Percentile(double p) const {
+  if (!count_) return 0.;
+  // The rank of the percentile, 1-based.
+  uint64_t rank = static_cast<uint64_t>(std::ceil(p / 100. * count_));
+  rank = std::max<uint64_t>(rank, 1);
+  if (rank >= count_) return max_;
+  uint64_t seen = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      return std::min(std::max(BucketValue(i), min_), max_);
+    }
+  }
+  return max_;
+}
+
+RuntimeProfiler::RuntimeProfiler(size_t max_trace_events)
+    : max_trace_events_(max_trace_events), origin_(clock_t::now()) {}
+
+int RuntimeProfiler::AddOp(const std::string& op_type,
+                           const std::string& kernel_name) {
+  OpRecord op;
+  op.op_type = op_type;
+  op.kernel_name = kernel_name;
+  ops_.push_back(std::move(op));
+  return static_cast<int>(ops_.size()) - 1;
+}
+
+void RuntimeProfiler::Record(int index,
+                             clock_t::time_point begin,
+                             clock_t::time_point end) {
+  using us_t = std::chrono::duration<double, std::micro>;
+  double duration = us_t(end - begin).count();
+  ops_[index].latency.Add(duration);
+  if (!max_trace_events_) return;
+
+  TraceEvent event;
+  event.op = index;
+  event.run = runs_;
+  event.begin = us_t(begin - origin_).count();
+  event.duration = duration;
+  if (trace_.size() < max_trace_events_) {
+    trace_.push_back(event);
+  } else {
+    trace_[trace_next_] = event;
+    trace_next_ = (trace_next_ + 1) % max_trace_events_;
+  }
+}
+
+void RuntimeProfiler::Clear() {
+  for (auto& op : ops_) {
+    op.latency.Clear();
+  }
+  trace_.clear();
+  trace_next_ = 0;
+  runs_ = 0;
+}
+
+std::string RuntimeProfiler::ToJson() const {
+  STL::stringstream ss;
+  ss.precision(15);
+  ss << "{\"runs\": " << static_cast<long long>(runs_)  // NOLINT
+     << ", \"ops\": [";
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    auto& op = ops_[i];
+    if (i) ss << ", ";
+    ss << "{\"index\": " << static_cast<int>(i) << ", \"op_type\": ";
+    WriteString(&ss, op.op_type);
+    ss << ", \"kernel\": ";
+    WriteString(&ss, op.kernel_name);
+    ss << ", \"inputs\": ";
+    WriteShapes(&ss, op);
+    ss << ", \"bytes\": " << static_cast<long long>(op.bytes)  // NOLINT
+       << ", \"flops\": " << static_cast<long long>(op.flops)  // NOLINT
+       << ", \"count\": "
+       << static_cast<unsigned long long>(op.latency.count())  // NOLINT
+       << ", \"avg_us\": " << op.latency.avg()
+       << ", \"min_us\": " << op.latency.min()
+       << ", \"max_us\": " << op.latency.max()
+       << ", \"p50_us\": " << op.latency.Percentile(50)
+       << ", \"p99_us\": " << op.latency.Percentile(99) << '}';
+  }
+  ss << "]}";
+  return ss.str();
+}
+
+std::string RuntimeProfiler::ToChromeTrace() const {
+  STL::stringstream ss;
+  ss.precision(15);
+  ss << "{\"traceEvents\": [";
+  // Start from the oldest event once the trace has wrapped around.
+  for (size_t n = 0; n < trace_.size(); ++n) {
+    auto& event = trace_[(trace_next_ + n) % trace_.size()];
+    auto& op = ops_[event.op];
+    if (n) ss << ", ";
+    ss << "{\"name\": ";
+    WriteString(&ss, op.op_type);
+    ss << ", \"cat\": \"op\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0"
+       << ", \"ts\": " << event.begin << ", \"dur\": " << event.duration
+       << ", \"args\": {\"index\": " << event.op
+       << ", \"run\": " << static_cast<long long>(event.run)  // NOLINT
+       << ", \"kernel\": ";
+    WriteString(&ss, op.kernel_name);
+    ss << ", \"inputs\": ";
+    WriteShapes(&ss, op);
+    ss << ", \"bytes\": " << static_cast<long long>(op.bytes)  // NOLINT
+       << ", \"flops\": " << static_cast<long long>(op.flops)  // NOLINT
+       << "}}";
+  }
+  ss << "], \"displayTimeUnit\": \"ms\"}";
+  return ss.str();
+}
+
+}  // namespace profile
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,116 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+ * This file implements RuntimeProfiler, a profiler built in every release that
+ * can be switched on at runtime. Unlike the Profiler enabled by
+ * LITE_WITH_PROFILE, it keeps a latency histogram, the input shapes, the bytes
+ * moved and the FLOPs of every instruction, and exports them as JSON or as
+ * Chrome trace events.
+ */
+#pragma once
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace lite {
+namespace profile {
+
+// A histogram of latencies in microseconds with logarithmic buckets, so that
+// the percentiles are kept within a few percent without storing the laps.
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+
+  void Add(double us);
+  void Clear();
+
+  uint64_t count() const { return count_; }
+  double sum() const { return sum_; }
+  double min() const { return count_ ? min_ : 0.; }
+  double max() const { return max_; }
+  double avg() const { return count_ ? sum_ / count_ : 0.; }
+  // The `p`-th percentile, `p` in [0, 100].
+  double Percentile(double p) const;
+
+ private:
+  std::vector<uint64_t> buckets_;
+  uint64_t count_{0};
+  double sum_{0.};
+  double min_{0.};
+  double max_{0.};
+};
+
+struct OpRecord {
+  std::string op_type;
+  std::string kernel_name;
+  // The shapes of the inputs at the last run, in the order of the arguments.
+  std::vector<std::string> input_names;
+  std::vector<std::vector<int64_t>> input_shapes;
+  // The bytes of the inputs and outputs, and the estimated FLOPs, at the last
+  // run. The FLOPs are 0 for the ops not estimated.
+  int64_t bytes{0};
+  int64_t flops{0};
+  LatencyHistogram latency;
+};
+
+// A launch of an op in the trace.
+struct TraceEvent {
+  int op{0};
+  int64_t run{0};
+  // In microseconds since the profiler is created.
+  double begin{0.};
+  double duration{0.};
+};
+
+class RuntimeProfiler {
+ public:
+  using clock_t = std::chrono::steady_clock;
+
+  // Keep the last `max_trace_events` launches for the Chrome trace.
+  explicit RuntimeProfiler(size_t max_trace_events = 100000);
+
+  int AddOp(const std::string& op_type, const std::string& kernel_name);
+  OpRecord* mutable_op(int index) { return &ops_[index]; }
+  const std::vector<OpRecord>& ops() const { return ops_; }
+
+  void BeginRun() { ++runs_; }
+  // Record a launch of the `index`-th op.
+  void Record(int index, clock_t::time_point begin, clock_t::time_point end);
+
+  int64_t runs() const { return runs_; }
+  // Drop the latencies and the trace, the ops are kept.
+  void Clear();
+
+  // {"runs": N, "ops": [{"index", "op_type", "kernel", "inputs", "bytes",
+  // "flops", "count", "avg_us", "min_us", "max_us", "p50_us", "p99_us"}]}
+  std::string ToJson() const;
+  // The trace events in the JSON object format of chrome://tracing.
+  std::string ToChromeTrace() const;
+
+ private:
+  std::vector<OpRecord> ops_;
+  std::vector<TraceEvent> trace_;
+  // The slot of the next event once the trace is full.
+  size_t trace_next_{0};
+  size_t max_trace_events_;
+  int64_t runs_{0};
+  clock_t::time_point origin_;
+};
+
+}  // namespace profile
+}  // namespace lite
+}  // namespace paddle
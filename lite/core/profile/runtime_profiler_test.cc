@@ -0,0 +1,89 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/profile/runtime_profiler.h"
+#include <gtest/gtest.h>
+#include <string>
+
+namespace paddle {
+namespace lite {
+namespace profile {
+
+TEST(LatencyHistogram, percentile) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.Percentile(50), 0.);
+  // 1us to 1000us.
+  for (int i = 1; i <= 1000; ++i) {
+    histogram.Add(i);
+  }
+  EXPECT_EQ(histogram.count(), 1000);
+  EXPECT_DOUBLE_EQ(histogram.min(), 1.);
+  EXPECT_DOUBLE_EQ(histogram.max(), 1000.);
+  EXPECT_NEAR(histogram.avg(), 500.5, 1e-6);
+  EXPECT_NEAR(histogram.Percentile(50), 500., 500. * 0.05);
+  EXPECT_NEAR(histogram.Percentile(99), 990., 990. * 0.05);
+  EXPECT_DOUBLE_EQ(histogram.Percentile(100), 1000.);
+
+  histogram.Clear();
+  EXPECT_EQ(histogram.count(), 0);
+  EXPECT_EQ(histogram.Percentile(99), 0.);
+}
+
+TEST(RuntimeProfiler, export) {
+  RuntimeProfiler profiler(3);
+  int conv = profiler.AddOp("conv2d", "conv2d/def");
+  int relu = profiler.AddOp("relu", "relu/def");
+  auto* record = profiler.mutable_op(conv);
+  record->input_names = {"x", "w"};
+  record->input_shapes = {{1, 3, 8, 8}, {4, 3, 3, 3}};
+  record->bytes = 1024;
+  record->flops = 2048;
+
+  auto begin = RuntimeProfiler::clock_t::now();
+  for (int run = 0; run < 2; ++run) {
+    profiler.BeginRun();
+    profiler.Record(conv, begin, begin + std::chrono::microseconds(100));
+    profiler.Record(relu, begin, begin + std::chrono::microseconds(10));
+  }
+  EXPECT_EQ(profiler.runs(), 2);
+  EXPECT_EQ(profiler.ops()[conv].latency.count(), 2);
+
+  std::string json = profiler.ToJson();
+  EXPECT_NE(json.find("\"runs\": 2"), std::string::npos);
+  EXPECT_NE(json.find("\"op_type\": \"conv2d\""), std::string::npos);
+  EXPECT_NE(json.find("\"x\": [1, 3, 8, 8]"), std::string::npos);
+  EXPECT_NE(json.find("\"flops\": 2048"), std::string::npos);
+  EXPECT_NE(json.find("\"p99_us\": 100"), std::string::npos);
+
+  // Only the last 3 launches are kept, the oldest first.
+  std::string trace = profiler.ToChromeTrace();
+  size_t events = 0;
+  for (size_t pos = trace.find("\"ph\": \"X\""); pos != std::string::npos;
+       pos = trace.find("\"ph\": \"X\"", pos + 1)) {
+    ++events;
+  }
+  EXPECT_EQ(events, 3);
+  EXPECT_LT(trace.find("\"name\": \"relu\""),
+            trace.find("\"name\": \"conv2d\""));
+
+  profiler.Clear();
+  EXPECT_EQ(profiler.runs(), 0);
+  EXPECT_EQ(profiler.ops().size(), 2);
+  EXPECT_EQ(profiler.ToChromeTrace(),
+            "{\"traceEvents\": [], \"displayTimeUnit\": \"ms\"}");
+}
+
+}  // namespace profile
+}  // namespace lite
+}  // namespace paddle
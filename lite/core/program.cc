@@ -13,7 +13,11 @@
 // limitations under the License.
 
 #include "lite/core/program.h"
+#include <algorithm>
+#include <cstring>
+#include <set>
 #include <unordered_map>
+#include "lite/backends/host/allocator.h"
 #include "lite/model_parser/cpp/block_desc.h"
 #include "lite/model_parser/cpp/op_desc.h"
 #include "lite/model_parser/cpp/var_desc.h"
@@ -26,12 +30,49 @@
 namespace paddle {
 namespace lite {
 
-void RuntimeProgram::SaveOpInfosToProgram(cpp::ProgramDesc* desc) {
+RuntimeProgram::RuntimeProgram(Program* program) {
+  CHECK(program);
+  for (auto& op : program->ops()) {
+    if (!op->op_info()->HasAttr(kKernelTypeAttr)) {
+      auto kernels = op->CreateKernels(program->valid_places());
+      CHECK(!kernels.empty()) << "no kernel found for "
+                              << op->op_info()->Type();
+      kernels.front()->SetContext(
+          ContextScheduler::Global().NewContext(kernels.front()->target()));
+      instructions_.emplace_back(op, std::move(kernels.front()));
+      continue;
+    }
+    auto kernel_type = op->op_info()->GetAttr<std::string>(kKernelTypeAttr);
+    std::string op_type, alias;
+    Place place;
+    KernelBase::ParseKernelType(kernel_type, &op_type, &alias, &place);
+    auto kernels = op->CreateKernels({place});
+    // filter out a kernel
+    auto it = std::find_if(
+        kernels.begin(), kernels.end(), [&](std::unique_ptr<KernelBase>& it) {
+          return it->alias() == alias;
+        });
+    CHECK(it != kernels.end()) << "no kernel found for " << kernel_type;
+    (*it)->SetContext(ContextScheduler::Global().NewContext((*it)->target()));
+    instructions_.emplace_back(op, std::move(*it));
+  }
+  if (instructions_.empty()) {
+    LOG(FATAL) << "no instructions";
+  }
+  CHECK(program->exec_scope());
+  exec_scope_ = program->exec_scope();
+#ifdef LITE_WITH_PROFILE
+  set_profiler();
+#endif
+}
+
+void RuntimeProgram::SaveOpInfosToProgram(cpp::ProgramDesc* desc,
+                                          int block_idx) {
   CHECK(desc);
   // NOTE: RuntimeProgram do not has all meta info, so save model just update
   // upon origin model
-  CHECK(desc->BlocksSize());
-  auto& main_block = *desc->GetBlock<cpp::BlockDesc>(0);
+  CHECK_LT(static_cast<size_t>(block_idx), desc->BlocksSize());
+  auto& main_block = *desc->GetBlock<cpp::BlockDesc>(block_idx);
   main_block.ClearOps();
   for (auto& node : instructions_) {
     auto* op = main_block.AddOp<cpp::OpDesc>();
@@ -41,21 +82,48 @@ void RuntimeProgram::SaveOpInfosToProgram(cpp::ProgramDesc* desc) {
 }
 
 // `UpdateVarsOfProgram` will remove unused var_descs and add new created
-// vars' descs in the block 0. Now, the type of a new created var can only
-// be LOD_TENSOR.
-void RuntimeProgram::UpdateVarsOfProgram(cpp::ProgramDesc* desc) {
+// vars' descs in the block `block_idx`. Now, the type of a new created var can
+// only be LOD_TENSOR. The vars declared in the other blocks are left to them,
+// and the vars of the block used by the ops of the other blocks, e.g. the
+// weights of a while loop declared in the block 0, are kept.
+void RuntimeProgram::UpdateVarsOfProgram(cpp::ProgramDesc* desc,
+                                         int block_idx) {
   CHECK(desc);
-  CHECK(desc->BlocksSize());
+  CHECK_LT(static_cast<size_t>(block_idx), desc->BlocksSize());
   std::unordered_map<std::string, cpp::VarDesc> origin_var_maps;
-  auto& main_block = *desc->GetBlock<cpp::BlockDesc>(0);
+  std::vector<std::string> origin_var_names;
+  auto& main_block = *desc->GetBlock<cpp::BlockDesc>(block_idx);
   auto var_size = main_block.VarsSize();
   for (int i = 0; i < var_size; i++) {
     auto v = main_block.GetVar<cpp::VarDesc>(i);
     auto name = v->Name();
     origin_var_maps.emplace(name, *v);
+    origin_var_names.push_back(name);
+  }
+  std::set<std::string> other_block_vars;
+  std::set<std::string> used_by_other_blocks;
+  for (int b = 0; b < static_cast<int>(desc->BlocksSize()); ++b) {
+    if (b == block_idx) continue;
+    auto* block = desc->GetBlock<cpp::BlockDesc>(b);
+    for (size_t i = 0; i < block->VarsSize(); ++i) {
+      other_block_vars.insert(block->GetVar<cpp::VarDesc>(i)->Name());
+    }
+    for (size_t i = 0; i < block->OpsSize(); ++i) {
+      auto* op = block->GetOp<cpp::OpDesc>(i);
+      for (auto& name : op->input_vars()) used_by_other_blocks.insert(name);
+      for (auto& name : op->output_vars()) used_by_other_blocks.insert(name);
+    }
   }
 
   main_block.ClearVars();
+  std::set<std::string> added_vars;
+  auto add_origin_var = [&](const cpp::VarDesc& origin) {
+    auto* v = main_block.AddVar<cpp::VarDesc>();
+    v->SetName(origin.Name());
+    v->SetType(origin.GetType());
+    v->SetPersistable(origin.Persistable());
+    added_vars.insert(origin.Name());
+  };
   for (auto& node : instructions_) {
     auto* op = const_cast<lite::OpLite*>(node.op());
     auto* kernel = node.kernel();
@@ -63,13 +131,11 @@ void RuntimeProgram::UpdateVarsOfProgram(cpp::ProgramDesc* desc) {
     auto in_names = op->op_info()->input_names();
     auto out_names = op->op_info()->output_names();
     for (auto& in_name : in_names) {
+      if (added_vars.count(in_name)) continue;
       auto it = origin_var_maps.find(in_name);
       if (it != origin_var_maps.end()) {
-        auto* v = main_block.AddVar<cpp::VarDesc>();
-        v->SetName((it->second).Name());
-        v->SetType((it->second).GetType());
-        v->SetPersistable((it->second).Persistable());
-      } else {
+        add_origin_var(it->second);
+      } else if (!other_block_vars.count(in_name)) {
         // New created vars must be LOD_TENSOR
         auto* v = main_block.AddVar<cpp::VarDesc>();
         v->SetName(in_name);
@@ -83,17 +149,16 @@ void RuntimeProgram::UpdateVarsOfProgram(cpp::ProgramDesc* desc) {
         } else {
           CHECK(false) << "unsupported var type";
         }
+        added_vars.insert(in_name);
       }
     }
 
     for (auto& out_name : out_names) {
+      if (added_vars.count(out_name)) continue;
       auto it = origin_var_maps.find(out_name);
       if (it != origin_var_maps.end()) {
-        auto* v = main_block.AddVar<cpp::VarDesc>();
-        v->SetName((it->second).Name());
-        v->SetType((it->second).GetType());
-        v->SetPersistable((it->second).Persistable());
-      } else {
+        add_origin_var(it->second);
+      } else if (!other_block_vars.count(out_name)) {
         // New created vars must be LOD_TENSOR
         auto* v = main_block.AddVar<cpp::VarDesc>();
         v->SetName(out_name);
@@ -107,16 +172,107 @@ void RuntimeProgram::UpdateVarsOfProgram(cpp::ProgramDesc* desc) {
         } else {
           CHECK(false) << "unsupported var type";
         }
+        added_vars.insert(out_name);
       }
     }
   }
+  for (auto& name : origin_var_names) {
+    if (used_by_other_blocks.count(name) && !added_vars.count(name)) {
+      add_origin_var(origin_var_maps.at(name));
+    }
+  }
 }
 
-void RuntimeProgram::Run() {
+namespace {
+// The bytes of an element of the feed `name` as the kernels taking it read
+// it, 0 if none of them declares a precision.
+size_t FeedElementSize(const std::vector<Instruction>& instructions,
+                       const std::string& name) {
+  for (auto& inst : instructions) {
+    auto* op_info = inst.op()->op_info();
+    std::string arg;
+    if (op_info->Type() == "feed" || !op_info->GetInputArgname(name, &arg)) {
+      continue;
+    }
+    auto* type = inst.kernel()->GetInputDeclType(arg);
+    auto precision = type ? type->precision() : PRECISION(kUnk);
+    if (precision != PRECISION(kAny) && precision != PRECISION(kUnk)) {
+      return lite_api::PrecisionTypeLength(precision);
+    }
+  }
+  return 0;
+}
+}  // namespace
+
+void RuntimeProgram::CheckExternalFeed(const std::string& name,
+                                       const Tensor& tensor) {
+  auto it = feed_element_sizes_.find(name);
+  if (it == feed_element_sizes_.end()) {
+    it = feed_element_sizes_
+             .emplace(name, FeedElementSize(instructions_, name))
+             .first;
+  }
+  size_t data_size = tensor.dims().production() * it->second;
+  CHECK_LE(data_size, tensor.memory_size())
+      << "The feed " << name << " of dims " << tensor.dims() << " needs "
+      << data_size << " bytes, its external memory has "
+      << tensor.memory_size() << " bytes";
+}
+
+bool RuntimeProgram::UpdateFeedShapes() {
+  // Without the exec scope the feeds can not be found, take them as changed.
+  if (!exec_scope_) return true;
+  bool changed = false;
+  size_t idx = 0;
   for (auto& inst : instructions_) {
+    auto* op_info = inst.op()->op_info();
+    if (op_info->Type() != "feed") continue;
+    for (auto& name : op_info->Output("Out")) {
+      auto* var = exec_scope_->FindVar(name);
+      if (!var || !var->IsType<Tensor>()) return true;
+      auto& tensor = var->Get<Tensor>();
+      // The memory given by the caller is not reallocated by the kernels.
+      if (!tensor.buffer()->own_data()) {
+        CheckExternalFeed(name, tensor);
+      }
+      if (idx == feed_dims_.size()) {
+        feed_dims_.push_back(tensor.dims());
+        feed_lods_.push_back(tensor.lod());
+        changed = true;
+      } else if (feed_dims_[idx] != tensor.dims() ||
+                 feed_lods_[idx] != tensor.lod()) {
+        feed_dims_[idx] = tensor.dims();
+        feed_lods_[idx] = tensor.lod();
+        changed = true;
+      }
+      ++idx;
+    }
+  }
+  return changed;
+}
+
+void RuntimeProgram::Run() {
+  const uint64_t host_allocs = host::ThreadAllocCount();
+  bool feed_shapes_changed = UpdateFeedShapes();
+  if (runtime_profiling_) {
+    runtime_profiler_->BeginRun();
+  }
+  for (size_t i = 0; i < instructions_.size(); ++i) {
+    auto& inst = instructions_[i];
     std::string op_type = inst.op()->op_info()->Type();
     if (op_type == "feed" || op_type == "fetch") continue;
-    inst.Run();
+    if (feed_shapes_changed) {
+      inst.InvalidateShapeCache();
+    }
+    if (runtime_profiling_) {
+      auto begin = profile::RuntimeProfiler::clock_t::now();
+      inst.Run();
+      auto end = profile::RuntimeProfiler::clock_t::now();
+      UpdateOpRecord(i);
+      runtime_profiler_->Record(profiled_instructions_[i].id, begin, end);
+    } else {
+      inst.Run();
+    }
 #ifdef LITE_WITH_PROFILE
 #ifdef LITE_WITH_PRECISION_PROFILE
     LITE_PRECISION_PROFILE(inst)
@@ -126,15 +282,237 @@ void RuntimeProgram::Run() {
 #ifdef LITE_WITH_PROFILE
   LOG(INFO) << "\n" << profiler_.Summary();
 #endif  // LITE_WITH_PROFILE
+#ifndef LITE_WITH_FPGA
+  if (memory_planner_) {
+    memory_planner_->Update(exec_scope_);
+  }
+#endif
+  last_run_output_copies_ = 0;
+  if (!output_buffers_.empty()) {
+    SyncOutputBuffers();
+  }
+  last_run_host_allocs_ = host::ThreadAllocCount() - host_allocs;
+}
+
+void RuntimeProgram::BindOutputBuffer(const std::string& name,
+                                      void* data,
+                                      size_t size) {
+  CHECK(exec_scope_);
+  auto* var = exec_scope_->FindVar(name);
+  CHECK(var) << "no output variable " << name << " in exec_scope";
+  OutputBuffer output;
+  output.data = data;
+  output.size = size;
+  output.buffer = std::make_shared<Buffer>(data, TARGET(kHost), size);
+  var->GetMutable<Tensor>()->ResetBuffer(output.buffer, 0);
+  output_buffers_[name] = output;
+}
+
+void RuntimeProgram::SyncOutputBuffers() {
+  for (auto& item : output_buffers_) {
+    auto* tensor = exec_scope_->FindVar(item.first)->GetMutable<Tensor>();
+    auto& output = item.second;
+    if (tensor->buffer() == output.buffer &&
+        output.buffer->data() == output.data) {
+      continue;
+    }
+    // The output is shared from another tensor, or the kernel reallocated it,
+    // e.g. for another target.
+    size_t memory_size = tensor->memory_size();
+    CHECK_LE(memory_size, output.size)
+        << "The output " << item.first << " of " << memory_size
+        << " bytes does not fit in its buffer of " << output.size << " bytes";
+    CHECK(tensor->target() == TARGET(kHost) ||
+          tensor->target() == TARGET(kX86) || tensor->target() == TARGET(kARM))
+        << "The output " << item.first << " is not on the host";
+    std::memcpy(output.data, tensor->raw_data(), memory_size);
+    ++last_run_output_copies_;
+    if (output.buffer->data() != output.data) {
+      output.buffer =
+          std::make_shared<Buffer>(output.data, TARGET(kHost), output.size);
+    }
+    tensor->ResetBuffer(output.buffer, memory_size);
+  }
 }
 
-void Program::Build(const cpp::ProgramDesc& prog) {
+namespace {
+// The ops taking about one FLOP per output element.
+const std::set<std::string> kActivationOps{"relu",
+                                           "relu6",
+                                           "leaky_relu",
+                                           "prelu",
+                                           "sigmoid",
+                                           "tanh",
+                                           "swish",
+                                           "hard_sigmoid",
+                                           "exp",
+                                           "abs",
+                                           "scale"};
+
+// Estimate the FLOPs of the common compute-bound ops from their shapes, return
+// 0 for the others.
+int64_t EstimateFlops(const OpInfo& info, Scope* scope) {
+  auto dims_of = [&](const std::string& arg, bool input) {
+    bool found = input ? info.HasInput(arg) : info.HasOutput(arg);
+    const auto& names =
+        found ? (input ? info.Input(arg) : info.Output(arg))
+              : std::vector<std::string>();
+    auto* var = names.empty() ? nullptr : scope->FindVar(names.front());
+    return var && var->IsType<Tensor>() ? var->Get<Tensor>().dims() : DDim();
+  };
+  auto op_type = info.Type();
+  if (op_type == "conv2d" || op_type == "depthwise_conv2d") {
+    auto filter = dims_of("Filter", true);
+    if (filter.size() < 2 || filter[0] == 0) return 0;
+    return 2 * dims_of("Output", false).production() * filter.production() /
+           filter[0];
+  }
+  if (op_type == "conv2d_transpose") {
+    auto filter = dims_of("Filter", true);
+    if (filter.size() < 2 || filter[0] == 0) return 0;
+    return 2 * dims_of("Input", true).production() * filter.production() /
+           filter[0];
+  }
+  if (op_type == "fc") {
+    auto w = dims_of("W", true);
+    if (w.size() < 1) return 0;
+    return 2 * dims_of("Out", false).production() * w[0];
+  }
+  if (op_type == "mul") {
+    auto y = dims_of("Y", true);
+    auto out = dims_of("Out", false);
+    if (out.size() < 1 || out[out.size() - 1] == 0) return 0;
+    return 2 * out.production() * (y.production() / out[out.size() - 1]);
+  }
+  if (op_type == "matmul") {
+    auto x = dims_of("X", true);
+    if (x.size() < 1) return 0;
+    bool transpose_x =
+        info.HasAttr("transpose_X") && info.GetAttr<bool>("transpose_X");
+    int64_t k = x.size() == 1 || !transpose_x ? x[x.size() - 1]
+                                              : x[x.size() - 2];
+    return 2 * dims_of("Out", false).production() * k;
+  }
+  if (op_type == "pool2d") {
+    auto out = dims_of("Out", false);
+    int64_t window = 1;
+    if (info.HasAttr("global_pooling") &&
+        info.GetAttr<bool>("global_pooling")) {
+      auto x = dims_of("X", true);
+      window = x.size() > 2 ? x.production() / (x[0] * x[1]) : 1;
+    } else if (info.HasAttr("ksize")) {
+      for (auto k : info.GetAttr<std::vector<int>>("ksize")) window *= k;
+    }
+    return out.production() * window;
+  }
+  if (kActivationOps.count(op_type) ||
+      op_type.find("elementwise_") != std::string::npos) {
+    return dims_of("Out", false).production();
+  }
+  return 0;
+}
+}  // namespace
+
+void RuntimeProgram::EnableRuntimeProfiler(bool enable) {
+  runtime_profiling_ = enable;
+  if (!enable || runtime_profiler_) return;
+  runtime_profiler_.reset(new profile::RuntimeProfiler());
+  profiled_instructions_.resize(instructions_.size());
+  for (size_t i = 0; i < instructions_.size(); ++i) {
+    auto& inst = instructions_[i];
+    auto* op_info = inst.op()->op_info();
+    if (op_info->Type() == "feed" || op_info->Type() == "fetch") continue;
+    auto& profiled = profiled_instructions_[i];
+    profiled.id = runtime_profiler_->AddOp(op_info->Type(),
+                                           inst.kernel()->summary());
+    auto* record = runtime_profiler_->mutable_op(profiled.id);
+    auto* scope = inst.op()->scope();
+    for (auto& name : op_info->input_names()) {
+      auto* var = scope ? scope->FindVar(name) : nullptr;
+      if (!var || !var->IsType<Tensor>()) continue;
+      profiled.inputs.push_back(&var->Get<Tensor>());
+      record->input_names.push_back(name);
+      record->input_shapes.emplace_back();
+    }
+    for (auto& name : op_info->output_names()) {
+      auto* var = scope ? scope->FindVar(name) : nullptr;
+      if (!var || !var->IsType<Tensor>()) continue;
+      profiled.outputs.push_back(&var->Get<Tensor>());
+    }
+  }
+}
+
+void RuntimeProgram::UpdateOpRecord(size_t idx) {
+  auto& profiled = profiled_instructions_[idx];
+  auto* record = runtime_profiler_->mutable_op(profiled.id);
+  bool reshaped = record->latency.count() == 0;
+  for (size_t i = 0; i < profiled.inputs.size() && !reshaped; ++i) {
+    const auto& dims = profiled.inputs[i]->dims();
+    const auto& shape = record->input_shapes[i];
+    reshaped = dims.size() != shape.size();
+    for (size_t j = 0; j < shape.size() && !reshaped; ++j) {
+      reshaped = dims[j] != shape[j];
+    }
+  }
+  if (!reshaped) return;
+
+  record->bytes = 0;
+  for (size_t i = 0; i < profiled.inputs.size(); ++i) {
+    record->input_shapes[i] = profiled.inputs[i]->dims().Vectorize();
+    record->bytes += profiled.inputs[i]->memory_size();
+  }
+  for (auto* output : profiled.outputs) {
+    record->bytes += output->memory_size();
+  }
+  auto& inst = instructions_[idx];
+  record->flops = EstimateFlops(*inst.op()->op_info(), inst.op()->scope());
+}
+
+#ifndef LITE_WITH_FPGA
+void RuntimeProgram::EnableMemoryPlanner() {
+  // The sub-blocks and the subgraph engines refer to the variables outside the
+  // instructions, and the outputs of the ops run once should be kept.
+  const std::set<std::string> pinned_ops{"feed",
+                                         "fetch",
+                                         "while",
+                                         "conditional_block",
+                                         "conditional_block_infer",
+                                         "graph_op"};
+  std::vector<MemoryPlanner::Step> steps;
+  for (auto& inst : instructions_) {
+    auto* op_info = inst.op()->op_info();
+    MemoryPlanner::Step step;
+    step.vars = op_info->input_names();
+    auto outputs = op_info->output_names();
+    step.vars.insert(step.vars.end(), outputs.begin(), outputs.end());
+    step.pinned = pinned_ops.count(op_info->Type()) || inst.op()->run_once();
+    steps.push_back(std::move(step));
+  }
+  memory_planner_.reset(new MemoryPlanner(steps));
+}
+#endif
+
+#ifdef LITE_WITH_X86
+void RuntimeProgram::SetX86ThreadPool(
+    const std::shared_ptr<x86::ThreadPool>& thread_pool) {
+  for (auto& inst : instructions_) {
+    auto* kernel = inst.mutable_kernel();
+    if (kernel->target() != TARGET(kX86) || !kernel->mutable_context()) {
+      continue;
+    }
+    kernel->mutable_context()->As<X86Context>().SetThreadPool(thread_pool);
+  }
+}
+#endif
+
+void Program::Build(const cpp::ProgramDesc& prog, int block_idx) {
   CHECK(ops_.empty()) << "Executor duplicate Build found";
 
-  // Create operators.
-  auto program = prog;
-  CHECK(program.BlocksSize());
-  auto& main_block = *program.GetBlock<cpp::BlockDesc>(0);
+  // Create operators. The ops of the while and conditional_block refer to the
+  // blocks of `prog`, which should outlive the program.
+  auto& program = const_cast<cpp::ProgramDesc&>(prog);
+  CHECK_LT(static_cast<size_t>(block_idx), program.BlocksSize());
+  auto& main_block = *program.GetBlock<cpp::BlockDesc>(block_idx);
   for (size_t i = 0; i < main_block.OpsSize(); ++i) {
     auto& op_desc = *main_block.GetOp<cpp::OpDesc>(i);
     auto op_type = op_desc.Type();
@@ -144,14 +522,16 @@ void Program::Build(const cpp::ProgramDesc& prog) {
     CHECK(op) << "no Op found for " << op_type;
     if (op_type == "while" || op_type == "conditional_block") {
       auto sub_block_idx = op_desc.GetAttr<int32_t>("sub_block");
-      auto sub_block =
-          const_cast<cpp::ProgramDesc&>(prog).GetBlock<cpp::BlockDesc>(
-              sub_block_idx);
+      auto sub_block = program.GetBlock<cpp::BlockDesc>(sub_block_idx);
       if (op_type == "while") {
-        static_cast<operators::WhileOpLite*>(op.get())->SetSubBlock(sub_block);
+        auto* while_op = static_cast<operators::WhileOpLite*>(op.get());
+        while_op->SetSubBlock(sub_block);
+        while_op->SetProgramDesc(&program);
       } else if (op_type == "conditional_block") {
-        static_cast<operators::ConditionalBlockOpLite*>(op.get())->SetSubBlock(
-            sub_block);
+        auto* cond_op =
+            static_cast<operators::ConditionalBlockOpLite*>(op.get());
+        cond_op->SetSubBlock(sub_block);
+        cond_op->SetProgramDesc(&program);
       }
     }
     ops_.emplace_back(std::move(op));
@@ -159,14 +539,19 @@ void Program::Build(const cpp::ProgramDesc& prog) {
   }
 }
 
-void Program::PrepareWorkspace(const cpp::ProgramDesc& prog) {
+void Program::PrepareWorkspace(const cpp::ProgramDesc& prog,
+                               lite::Scope* exec_scope) {
   CHECK(!exec_scope_) << "Duplicate PrepareWorkspace found";
-  exec_scope_ = &scope_->NewScope();
-  // Create Feed and Fetch var.
-  scope_->Var("feed")->GetMutable<std::vector<lite::Tensor>>();
-  scope_->Var("fetch")->GetMutable<std::vector<lite::Tensor>>();
-  tmp_vars_.push_back("feed");
-  tmp_vars_.push_back("fetch");
+  if (exec_scope) {
+    exec_scope_ = exec_scope;
+  } else {
+    exec_scope_ = &scope_->NewScope();
+    // Create Feed and Fetch var.
+    scope_->Var("feed")->GetMutable<std::vector<lite::Tensor>>();
+    scope_->Var("fetch")->GetMutable<std::vector<lite::Tensor>>();
+    tmp_vars_.push_back("feed");
+    tmp_vars_.push_back("fetch");
+  }
 
   auto VarPrecision2KernlPrecision =
       [](const lite::VarDescAPI::Type& type) -> PrecisionType {
@@ -189,7 +574,7 @@ void Program::PrepareWorkspace(const cpp::ProgramDesc& prog) {
     }
   };
 
-  auto program = prog;
+  auto& program = const_cast<cpp::ProgramDesc&>(prog);
   CHECK(program.BlocksSize());
   for (size_t b = 0; b < program.BlocksSize(); ++b) {
     auto& main_block = *program.GetBlock<cpp::BlockDesc>(b);
@@ -213,7 +598,7 @@ void Program::PrepareWorkspace(const cpp::ProgramDesc& prog) {
       } else {
         if (var_desc.Name() == "feed" || var_desc.Name() == "fetch") continue;
         weights_.push_back(var_desc.Name());
-        if (var_desc.Persistable()) scope_->Var(var_desc.Name());
+        if (scope_) scope_->Var(var_desc.Name());
       }
     }
   }
@@ -233,15 +618,65 @@ void Instruction::Run() {
 #ifndef LITE_SHUTDOWN_LOG
   VLOG(4) << "kernel launch";
 #endif
-  op_->InferShape();
+  bool shapes_cached = ShapesCached();
+  if (!shapes_cached) {
+    op_->InferShape();
+  }
 #ifndef LITE_SHUTDOWN_LOG
   VLOG(4) << ">> Running kernel: " << op_->op_info()->Repr() << " on Target "
           << TargetToStr(kernel_->target());
 #endif
+  kernel_->set_shapes_unchanged(shapes_cached);
   kernel_->Launch();
+  CacheShapes();
   has_run_ = true;
 }
 
+bool Instruction::ShapesCached() const {
+  if (!shape_cache_valid_) return false;
+  for (size_t i = 0; i < shape_cache_tensors_.size(); ++i) {
+    // Another op may have written the same variable, e.g. after the memory
+    // optimization, or a kernel may have set the output shapes by the data.
+    if (shape_cache_tensors_[i]->dims() != cached_dims_[i] ||
+        shape_cache_tensors_[i]->lod() != cached_lods_[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Instruction::CacheShapes() {
+  if (!shape_cacheable_) return;
+  if (shape_cache_tensors_.empty()) {
+    auto* scope = op_->scope();
+    auto names = op_->op_info()->input_names();
+    auto outputs = op_->op_info()->output_names();
+    names.insert(names.end(), outputs.begin(), outputs.end());
+    for (auto& name : names) {
+      auto* var = scope ? scope->FindVar(name) : nullptr;
+      // The tensor arrays and the other variables are not tracked.
+      if (!var || !var->IsType<Tensor>()) {
+        shape_cacheable_ = false;
+        break;
+      }
+      shape_cache_tensors_.push_back(&var->Get<Tensor>());
+    }
+    if (!shape_cacheable_ || op_->shape_depends_on_data() ||
+        shape_cache_tensors_.empty()) {
+      shape_cacheable_ = false;
+      shape_cache_tensors_.clear();
+      return;
+    }
+    cached_dims_.resize(shape_cache_tensors_.size());
+    cached_lods_.resize(shape_cache_tensors_.size());
+  }
+  for (size_t i = 0; i < shape_cache_tensors_.size(); ++i) {
+    cached_dims_[i] = shape_cache_tensors_[i]->dims();
+    cached_lods_[i] = shape_cache_tensors_[i]->lod();
+  }
+  shape_cache_valid_ = true;
+}
+
 STL::ostream& operator<<(STL::ostream& os, const Instruction& other) {
   os << other.kernel_->summary() << "\t(" << other.kernel_->doc() << ")";
   return os;
@@ -14,14 +14,19 @@
 
 #pragma once
 #include <list>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 #include "lite/core/kernel.h"
+#ifndef LITE_WITH_FPGA
+#include "lite/core/memory_planner.h"
+#endif
 #include "lite/core/op_lite.h"
 #include "lite/core/op_registry.h"
+#include "lite/core/profile/runtime_profiler.h"
 #include "lite/model_parser/cpp/program_desc.h"
 
 namespace paddle {
@@ -48,6 +53,19 @@ struct Program {
     VLOG(4) << "build desc finished";
   }
 
+  // The program of the sub-block `block_idx` of a while or conditional_block
+  // op. It runs in `exec_scope`, the scope of the parent block, where the vars
+  // of all the blocks are created.
+  Program(const cpp::ProgramDesc& desc,
+          int block_idx,
+          lite::Scope* exec_scope,
+          const std::vector<Place>& valid_places)
+      : valid_places_(valid_places) {
+    CHECK(exec_scope);
+    PrepareWorkspace(desc, exec_scope);
+    Build(desc, block_idx);
+  }
+
   std::unique_ptr<Program> Clone() const {
     std::unique_ptr<Program> res(new Program(desc_, scope_, valid_places_));
     return res;
@@ -63,16 +81,18 @@ struct Program {
 
   lite::Scope* exec_scope() { return exec_scope_; }
   lite::Scope* scope() { return scope_.get(); }
+  const std::vector<Place>& valid_places() const { return valid_places_; }
 
   const std::unordered_map<std::string, PrecisionType>& var_data_type() const {
     return var_data_type_;
   }
 
  private:
-  // Build from a program and scope.
-  void Build(const cpp::ProgramDesc& program);
-  // Create temporary variables.
-  void PrepareWorkspace(const cpp::ProgramDesc& program);
+  // Build from the block `block_idx` of a program and scope.
+  void Build(const cpp::ProgramDesc& program, int block_idx = 0);
+  // Create temporary variables, in a new scope or in `exec_scope` if set.
+  void PrepareWorkspace(const cpp::ProgramDesc& program,
+                        lite::Scope* exec_scope = nullptr);
 
  private:
   std::unordered_map<std::string, PrecisionType> var_data_type_;
@@ -92,9 +112,14 @@ struct Instruction {
               std::unique_ptr<KernelBase>&& kernel)
       : op_(op), kernel_(std::move(kernel)) {}
 
-  // Run the instruction.
+  // Run the instruction. The InferShape of the op and the ReInitWhenNeeded of
+  // the kernel are skipped if the dims and LoD of the inputs and outputs are
+  // the same as after the last run.
   void Run();
 
+  // Run InferShape at the next run anyway, e.g. once the feeds are reshaped.
+  void InvalidateShapeCache() { shape_cache_valid_ = false; }
+
   friend STL::ostream& operator<<(STL::ostream& os, const Instruction& other);
 
   const OpLite* op() const { return op_.get(); }
@@ -121,6 +146,17 @@ struct Instruction {
   bool first_epoch_{true};
   bool has_run_{false};
 
+  bool ShapesCached() const;
+  void CacheShapes();
+
+  // The tensors read or written by the op, with their dims and LoD after the
+  // last run.
+  std::vector<const Tensor*> shape_cache_tensors_;
+  std::vector<DDim> cached_dims_;
+  std::vector<LoD> cached_lods_;
+  bool shape_cache_valid_{false};
+  bool shape_cacheable_{true};
+
 #ifdef LITE_WITH_PROFILE
   profile::Profiler* profiler_;
   int profile_id_{-1};
@@ -141,7 +177,15 @@ class LITE_API RuntimeProgram {
     set_profiler();
 #endif
   }
+  // Create the runtime program from an optimized program whose ops carry the
+  // picked kernel type in `kKernelTypeAttr`, no MIR pass will be applied. Each
+  // kernel gets a new context, the weights are shared through the root scope
+  // of `program`. The ops without the attribute, e.g. in a sub-block not
+  // optimized, take their first kernel for the valid places of `program`.
+  explicit RuntimeProgram(Program* program);
 
+  // Run the instructions. The instructions reuse the output shapes of the last
+  // run until the dims or LoD of a feed change.
   void Run();
 
   void set_exec_scope(lite::Scope* x) { exec_scope_ = x; }
@@ -151,19 +195,93 @@ class LITE_API RuntimeProgram {
 
   const std::vector<Instruction>& instructions() const { return instructions_; }
 
-  // `SaveOpInfosToProgram` will update the op list(ops_) of the block 0
-  // in ProgramDesc.
-  void SaveOpInfosToProgram(cpp::ProgramDesc* desc);
+  // `SaveOpInfosToProgram` will update the op list(ops_) of the block
+  // `block_idx` in ProgramDesc.
+  void SaveOpInfosToProgram(cpp::ProgramDesc* desc, int block_idx = 0);
+
+  // `UpdateVarsOfProgram` will update the var list(vars_) of the block
+  // `block_idx` in ProgramDesc. Namely, if a new var created in some passes,
+  // its var_desc will be added in vars_.
+  void UpdateVarsOfProgram(cpp::ProgramDesc* desc, int block_idx = 0);
+
+#ifdef LITE_WITH_X86
+  // Let all the x86 kernels schedule their work on `thread_pool`.
+  void SetX86ThreadPool(const std::shared_ptr<x86::ThreadPool>& thread_pool);
+#endif
+
+#ifndef LITE_WITH_FPGA
+  // Place the host activations in one arena planned by their sizes and
+  // lifetimes after each run, see MemoryPlanner. The activations are
+  // overwritten by the following ops, only the fetched outputs stay valid
+  // after a run.
+  void EnableMemoryPlanner();
+  const MemoryPlanner* memory_planner() const { return memory_planner_.get(); }
+#endif
+
+  // Let the kernels write the output var `name` in the `size` bytes at `data`,
+  // a host memory owned by the caller. The outputs the kernels do not write
+  // in place, e.g. shared from another tensor, are copied there after each
+  // run.
+  void BindOutputBuffer(const std::string& name, void* data, size_t size);
+
+  // Record the latency, the input shapes, the bytes and the FLOPs of every
+  // instruction at the following runs, see profile::RuntimeProfiler. The
+  // records are kept when the profiler is disabled. The latency is taken on
+  // the host, including InferShape.
+  void EnableRuntimeProfiler(bool enable);
+  // Null until the profiler is enabled once.
+  const profile::RuntimeProfiler* runtime_profiler() const {
+    return runtime_profiler_.get();
+  }
+  profile::RuntimeProfiler* mutable_runtime_profiler() {
+    return runtime_profiler_.get();
+  }
 
-  // `UpdateVarsOfProgram` will update the var list(vars_) of the block 0 in
-  // ProgramDesc. Namely, if a new var created in some passes, its var_desc will
-  // be added in vars_.
-  void UpdateVarsOfProgram(cpp::ProgramDesc* desc);
+  // The host allocations made on the calling thread by the last run.
+  uint64_t last_run_host_allocs() const { return last_run_host_allocs_; }
+  // The bound outputs the last run did not write in place, copied to their
+  // buffers after it.
+  size_t last_run_output_copies() const { return last_run_output_copies_; }
 
  private:
   RuntimeProgram(const RuntimeProgram&) = delete;
+  // Check the feeds against their dims and LoD at the last run, return true
+  // if any of them changed.
+  bool UpdateFeedShapes();
+  // Check that the external memory of a feed holds its data, as read by the
+  // kernels taking it.
+  void CheckExternalFeed(const std::string& name, const Tensor& tensor);
+  std::map<std::string, size_t> feed_element_sizes_;
+  // Copy the outputs not written in their bound buffers, and bind them again.
+  void SyncOutputBuffers();
+  struct OutputBuffer {
+    void* data{nullptr};
+    size_t size{0};
+    std::shared_ptr<Buffer> buffer;
+  };
+  std::map<std::string, OutputBuffer> output_buffers_;
+
   std::vector<Instruction> instructions_;
   lite::Scope* exec_scope_{};
+  // The dims and LoD of the feeds at the last run.
+  std::vector<DDim> feed_dims_;
+  std::vector<LoD> feed_lods_;
+
+  struct ProfiledInstruction {
+    // The record in the runtime profiler, -1 for feed and fetch.
+    int id{-1};
+    std::vector<const Tensor*> inputs;
+    std::vector<const Tensor*> outputs;
+  };
+  void UpdateOpRecord(size_t idx);
+  std::unique_ptr<profile::RuntimeProfiler> runtime_profiler_;
+  std::vector<ProfiledInstruction> profiled_instructions_;
+  bool runtime_profiling_{false};
+  uint64_t last_run_host_allocs_{0};
+  size_t last_run_output_copies_{0};
+#ifndef LITE_WITH_FPGA
+  std::unique_ptr<MemoryPlanner> memory_planner_;
+#endif
 
 #ifdef LITE_WITH_PROFILE
   profile::Profiler profiler_;
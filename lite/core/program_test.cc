@@ -0,0 +1,311 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/program.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lite/api/paddle_use_passes.h"
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer.h"
+
+namespace paddle {
+namespace lite {
+
+namespace {
+
+const int kLoops = 3;
+
+using args_t = std::map<std::string, std::vector<std::string>>;
+
+cpp::OpDesc* AddOp(cpp::BlockDesc* block,
+                   const std::string& type,
+                   const args_t& ins,
+                   const args_t& outs) {
+  auto* op = block->AddOp<cpp::OpDesc>();
+  op->SetType(type);
+  for (auto& item : ins) op->SetInput(item.first, item.second);
+  for (auto& item : outs) op->SetOutput(item.first, item.second);
+  return op;
+}
+
+void AddScale(cpp::BlockDesc* block,
+              const std::string& x,
+              const std::string& out,
+              float scale,
+              float bias) {
+  auto* op = AddOp(block, "scale", {{"X", {x}}}, {{"Out", {out}}});
+  op->SetAttr<float>("scale", scale);
+  op->SetAttr<float>("bias", bias);
+  op->SetAttr<bool>("bias_after_scale", true);
+}
+
+void AddVars(cpp::BlockDesc* block,
+             const std::vector<std::string>& names,
+             bool persistable = false) {
+  for (auto& name : names) {
+    auto* var = block->AddVar<cpp::VarDesc>();
+    var->SetName(name);
+    var->SetType(VarDescAPI::Type::LOD_TENSOR);
+    var->SetPersistable(persistable);
+  }
+}
+
+// The body of the loop, or of the branch, in the block 1:
+//   y = relu(2 * y + w)
+// with `w` a weight declared in the block 0 and only read by the block 1.
+// The loop also counts `c` down and stops at zero.
+void BuildBody(cpp::ProgramDesc* desc, bool loop) {
+  auto* block = desc->AddBlock<cpp::BlockDesc>();
+  block->SetIdx(1);
+  block->SetParentIdx(0);
+  AddVars(block, {"t", "u"});
+  AddScale(block, "y", "t", 2.f, 0.f);
+  auto* add = AddOp(
+      block, "elementwise_add", {{"X", {"t"}}, {"Y", {"w"}}}, {{"Out", {"u"}}});
+  add->SetAttr<int>("axis", -1);
+  AddOp(block, "relu", {{"X", {"u"}}}, {{"Out", {"y"}}});
+  if (loop) {
+    AddScale(block, "c", "c", 1.f, -1.f);
+    auto* cast = AddOp(block, "cast", {{"X", {"c"}}}, {{"Out", {"cond"}}});
+    cast->SetAttr<int>("in_dtype", 5);   // FP32
+    cast->SetAttr<int>("out_dtype", 0);  // BOOL
+  }
+}
+
+// y = body(x) repeated by a while loop, or out = body(x) run once by a
+// conditional_block.
+void BuildProgram(cpp::ProgramDesc* desc, bool loop) {
+  auto* block = desc->AddBlock<cpp::BlockDesc>();
+  block->SetIdx(0);
+  block->SetParentIdx(-1);
+  AddVars(block, {"x", "y", "c", "cond", "out", "scopes"});
+  AddVars(block, {"w"}, true);
+  AddScale(block, "x", "y", 1.f, 0.f);
+  cpp::OpDesc* op;
+  if (loop) {
+    op = AddOp(block,
+               "while",
+               {{"X", {"y", "c"}}, {"Condition", {"cond"}}},
+               {{"Out", {"y", "c"}}, {"StepScopes", {"scopes"}}});
+  } else {
+    op = AddOp(block,
+               "conditional_block",
+               {{"Input", {"y"}}, {"Cond", {"cond"}}},
+               {{"Out", {"y"}}, {"Scope", {"scopes"}}});
+    op->SetAttr<bool>("is_scalar_condition", true);
+  }
+  op->SetAttr<int32_t>("sub_block", 1);
+  if (!loop) {
+    // The output of the conditional_block is written by the block 1, this
+    // identity scale should not rename it.
+    AddScale(block, "y", "out", 1.f, 0.f);
+  }
+  BuildBody(desc, loop);
+}
+
+std::vector<float> Input() {
+  std::vector<float> x(6);
+  for (size_t i = 0; i < x.size(); ++i) {
+    x[i] = 0.5f * static_cast<float>(i) - 1.2f;
+  }
+  return x;
+}
+
+std::vector<float> Weight() {
+  std::vector<float> w(6);
+  for (size_t i = 0; i < w.size(); ++i) {
+    w[i] = 0.3f - 0.1f * static_cast<float>(i);
+  }
+  return w;
+}
+
+void SetTensor(Scope* scope,
+               const std::string& name,
+               const DDim& dims,
+               const std::vector<float>& data) {
+  auto* tensor = scope->Var(name)->GetMutable<lite::Tensor>();
+  tensor->Resize(dims);
+  std::copy(data.begin(), data.end(), tensor->mutable_data<float>());
+}
+
+// Build the program on x86, optimize the sub-block too if `optimize_sub_block`
+// and run it.
+std::vector<float> Run(bool loop,
+                       bool optimize_sub_block,
+                       cpp::ProgramDesc* desc) {
+  BuildProgram(desc, loop);
+  std::vector<Place> places{Place{TARGET(kX86), PRECISION(kFloat)},
+                            Place{TARGET(kHost), PRECISION(kFloat)},
+                            Place{TARGET(kHost), PRECISION(kAny)}};
+  auto scope = std::make_shared<Scope>();
+  SetTensor(scope.get(), "w", DDim({2, 3}), Weight());
+  Program program(*desc, scope, places);
+  auto* exec_scope = program.exec_scope();
+  SetTensor(exec_scope, "x", DDim({2, 3}), Input());
+  SetTensor(exec_scope, "c", DDim({1}), {static_cast<float>(kLoops)});
+  auto* cond = exec_scope->Var("cond")->GetMutable<lite::Tensor>();
+  cond->Resize({1});
+  cond->mutable_data<bool>()[0] = true;
+
+  core::KernelPickFactor factor;
+  factor.ConsiderTarget();
+  factor.ConsiderPrecision();
+  Optimizer optimizer;
+  optimizer.Run(std::move(program), places, factor);
+  if (optimize_sub_block) optimizer.OptimizeSubBlocks(desc);
+  auto runtime_program = optimizer.GenRuntimeProgram();
+  runtime_program->Run();
+
+  auto* out = exec_scope->FindVar(loop ? "y" : "out")->GetMutable<Tensor>();
+  EXPECT_EQ(out->dims(), DDim({2, 3}));
+  return std::vector<float>(out->data<float>(),
+                            out->data<float>() + out->numel());
+}
+
+std::vector<float> Reference(int loops) {
+  auto y = Input();
+  auto w = Weight();
+  for (int l = 0; l < loops; ++l) {
+    for (size_t i = 0; i < y.size(); ++i) {
+      y[i] = std::max(2.f * y[i] + w[i], 0.f);
+    }
+  }
+  return y;
+}
+
+void CheckVarsOfBlock(cpp::ProgramDesc* desc,
+                      int block_idx,
+                      const std::vector<std::string>& expected,
+                      const std::vector<std::string>& absent) {
+  auto* block = desc->GetBlock<cpp::BlockDesc>(block_idx);
+  std::map<std::string, int> counts;
+  for (size_t i = 0; i < block->VarsSize(); ++i) {
+    ++counts[block->GetVar<cpp::VarDesc>(i)->Name()];
+  }
+  for (auto& item : counts) {
+    EXPECT_EQ(item.second, 1) << item.first << " of block " << block_idx;
+  }
+  for (auto& name : expected) {
+    EXPECT_EQ(counts.count(name), 1u) << name << " of block " << block_idx;
+  }
+  for (auto& name : absent) {
+    EXPECT_EQ(counts.count(name), 0u) << name << " of block " << block_idx;
+  }
+}
+
+}  // namespace
+
+// The ops of a loop body update the loop variables in place, the op
+// overwriting a variable should run after the ones reading its former value,
+// even if it comes first in the graph, e.g. after a fusion pass recreated the
+// reading op.
+TEST(SSAGraph, overwrite_after_read) {
+  cpp::ProgramDesc desc;
+  auto* block = desc.AddBlock<cpp::BlockDesc>();
+  AddVars(block, {"x", "c", "t"});
+  AddScale(block, "c", "t", 2.f, 0.f);
+  AddScale(block, "x", "c", 1.f, -1.f);
+  std::vector<Place> places{Place{TARGET(kX86), PRECISION(kFloat)}};
+  auto scope = std::make_shared<Scope>();
+  Program program(desc, scope, places);
+  mir::SSAGraph graph;
+  graph.Build(program, places);
+
+  // Recreate the reading op at the end of the graph.
+  mir::Node* reader = nullptr;
+  mir::Node* writer = nullptr;
+  for (auto& node : graph.mutable_nodes()) {
+    if (!node.IsStmt()) continue;
+    auto outs = node.AsStmt().op_info()->output_names();
+    (outs.front() == "t" ? reader : writer) = &node;
+  }
+  ASSERT_TRUE(reader && writer);
+  auto* new_reader =
+      graph.GraphCreateInstructNode(reader->AsStmt().op(), places);
+  auto* c0 = reader->inlinks.front();
+  auto* t = reader->outlinks.front();
+  mir::RemoveDirectedLink(c0, reader);
+  mir::RemoveDirectedLink(reader, t);
+  graph.RemoveNode(reader);
+  mir::DirectedLink(c0, new_reader);
+  mir::DirectedLink(new_reader, t);
+
+  auto order = graph.StmtTopologicalOrder();
+  ASSERT_EQ(order.size(), 2u);
+  EXPECT_EQ(order[0], new_reader);
+  EXPECT_EQ(order[1], writer);
+}
+
+TEST(RuntimeProgram, update_vars_of_sub_block) {
+  cpp::ProgramDesc desc;
+  Run(true, true, &desc);
+  // `w` is only read by the block 1, it is kept in the block 0. The vars read
+  // and written by the while op are declared once.
+  CheckVarsOfBlock(&desc, 0, {"x", "y", "c", "cond", "w"}, {"t", "u"});
+  // The vars of the block 0 are not declared again in the block 1.
+  CheckVarsOfBlock(&desc, 1, {}, {"x", "y", "c", "cond", "w"});
+  auto* body = desc.GetBlock<cpp::BlockDesc>(1);
+  ASSERT_GT(body->OpsSize(), 0u);
+  for (size_t i = 0; i < body->OpsSize(); ++i) {
+    EXPECT_TRUE(body->GetOp<cpp::OpDesc>(i)->HasAttr(kKernelTypeAttr));
+  }
+}
+
+TEST(Program, while_x86) {
+  cpp::ProgramDesc optimized_desc;
+  cpp::ProgramDesc desc;
+  auto optimized = Run(true, true, &optimized_desc);
+  auto origin = Run(true, false, &desc);
+  auto ref = Reference(kLoops);
+  ASSERT_EQ(optimized.size(), ref.size());
+  ASSERT_EQ(origin.size(), ref.size());
+  for (size_t i = 0; i < ref.size(); ++i) {
+    EXPECT_NEAR(optimized[i], origin[i], 1e-5);
+    EXPECT_NEAR(optimized[i], ref[i], 1e-5);
+  }
+}
+
+TEST(Program, conditional_block_x86) {
+  cpp::ProgramDesc optimized_desc;
+  cpp::ProgramDesc desc;
+  auto optimized = Run(false, true, &optimized_desc);
+  auto origin = Run(false, false, &desc);
+  auto ref = Reference(1);
+  ASSERT_EQ(optimized.size(), ref.size());
+  ASSERT_EQ(origin.size(), ref.size());
+  for (size_t i = 0; i < ref.size(); ++i) {
+    EXPECT_NEAR(optimized[i], origin[i], 1e-5);
+    EXPECT_NEAR(optimized[i], ref[i], 1e-5);
+  }
+}
+
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(scale);
+USE_LITE_OP(elementwise_add);
+USE_LITE_OP(relu);
+USE_LITE_OP(cast);
+USE_LITE_OP(while);
+USE_LITE_OP(conditional_block);
+USE_LITE_KERNEL(scale, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(elementwise_add, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(relu, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(cast, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(while, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(conditional_block, kX86, kFloat, kNCHW, def);
@@ -26,6 +26,7 @@ Scope::~Scope() {
 }
 
 Scope &Scope::NewScope() const {
+  std::lock_guard<std::mutex> lock(kids_mutex_);
   kids_.push_back(new Scope);
   kids_.back()->parent_ = this;
   return *kids_.back();
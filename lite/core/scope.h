@@ -15,6 +15,7 @@
 #pragma once
 #include <list>
 #include <memory>
+#include <mutex>  //NOLINT
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -71,6 +72,8 @@ class Scope final {
  private:
   // Scope in `kids_` are owned by this class.
   mutable std::list<Scope*> kids_;
+  // Guard `kids_`, predictors cloned in different threads share a root scope.
+  mutable std::mutex kids_mutex_;
   const Scope* parent_{nullptr};
   std::unordered_map<std::string, std::unique_ptr<Variable>> vars_;
 };
@@ -72,6 +72,7 @@ std::string DDimLite::repr() const {
 }
 
 void TensorLite::ShareDataWith(const TensorLite &other) {
+  precision_ = other.precision_;
   buffer_ = other.buffer_;
   dims_ = other.dims_;
   target_ = other.target_;
@@ -79,7 +80,19 @@ void TensorLite::ShareDataWith(const TensorLite &other) {
   memory_size_ = other.memory_size_;
 }
 
+void TensorLite::ResetBuffer(std::shared_ptr<Buffer> buffer,
+                             size_t memory_size) {
+  CHECK(buffer);
+  CHECK_EQ(offset_, 0u) << "The buffer can't be reset for a sliced tensor.";
+  CHECK_LE(memory_size, buffer->space())
+      << "The buffer is smaller than the memory size of the tensor.";
+  buffer_ = buffer;
+  memory_size_ = memory_size;
+  target_ = buffer->target();
+}
+
 void TensorLite::CopyDataFrom(const TensorLite &other) {
+  precision_ = other.precision_;
   dims_ = other.dims_;
   target_ = other.target_;
   lod_ = other.lod_;
@@ -38,6 +38,27 @@ class TensorLite;
 using DDim = lite::DDimLite;
 using Tensor = lite::TensorLite;
 
+// The precision of the elements of type T, kUnk for the types without one.
+template <typename T>
+struct PrecisionTypeTrait {
+  static constexpr PrecisionType Type() { return PrecisionType::kUnk; }
+};
+
+#define LITE_PRECISION_TYPE_TRAIT(T, precision__) \
+  template <>                                     \
+  struct PrecisionTypeTrait<T> {                  \
+    static constexpr PrecisionType Type() {       \
+      return PrecisionType::precision__;          \
+    }                                             \
+  }
+LITE_PRECISION_TYPE_TRAIT(float, kFloat);
+LITE_PRECISION_TYPE_TRAIT(int8_t, kInt8);
+LITE_PRECISION_TYPE_TRAIT(int16_t, kInt16);
+LITE_PRECISION_TYPE_TRAIT(int32_t, kInt32);
+LITE_PRECISION_TYPE_TRAIT(int64_t, kInt64);
+LITE_PRECISION_TYPE_TRAIT(bool, kBool);
+#undef LITE_PRECISION_TYPE_TRAIT
+
 class DDimLite {
  public:
   using value_type = int64_t;
@@ -139,6 +160,7 @@ class TensorLite {
   // For other devices, T and R may be the same type.
   template <typename T, typename R = T>
   R *mutable_data() {
+    precision_ = PrecisionTypeTrait<T>::Type();
     memory_size_ = dims_.production() * sizeof(T);
     buffer_->ResetLazy(target_, memory_size_);
     return reinterpret_cast<R *>(static_cast<char *>(buffer_->data()) +
@@ -161,6 +183,7 @@ class TensorLite {
   template <typename T, typename R = T>
   R *mutable_data(TargetType target) {
     target_ = target;
+    precision_ = PrecisionTypeTrait<T>::Type();
     memory_size_ = dims_.production() * sizeof(T);
     buffer_->ResetLazy(target, memory_size());
     return reinterpret_cast<R *>(static_cast<char *>(buffer_->data()) +
@@ -185,6 +208,11 @@ class TensorLite {
   // Other share data to this.
   void ShareDataWith(const TensorLite &other);
 
+  // Replace the buffer, e.g. with one wrapping an external memory.
+  void ResetBuffer(std::shared_ptr<Buffer> buffer, size_t memory_size);
+  // The buffer holding the data, shared by the tensors sharing the data.
+  const std::shared_ptr<Buffer> &buffer() const { return buffer_; }
+
   void CopyDataFrom(const TensorLite &other);
 
   TargetType target() const { return target_; }
@@ -204,11 +232,10 @@ class TensorLite {
 
  private:
   TargetType target_{TargetType::kHost};
-  // precision_ and persistable_ are only used for persistable vars.
-  // If your tensor wants to be saved and loaded correctly, you must
-  // set values of precision_ and persistable_ after updating it.
-  // If your tensor is just a temp tensor, such as activations,
-  // you can ignore these two attributes.
+  // precision_ is set by the typed mutable_data, and persistable_ is only
+  // used for persistable vars. If your tensor wants to be saved and loaded
+  // correctly, you must set values of precision_ and persistable_ after
+  // updating it with an untyped mutable_data.
   PrecisionType precision_{PrecisionType::kUnk};
   bool persistable_{false};
 
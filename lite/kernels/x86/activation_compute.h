@@ -16,11 +16,15 @@
 #include <algorithm>
 #include <utility>
 #include <vector>
+#include "lite/backends/x86/jit/helper.h"
+#include "lite/backends/x86/jit/kernel_base.h"
+#include "lite/backends/x86/jit/kernels.h"
 #include "lite/backends/x86/math/blas.h"
 #include "lite/core/kernel.h"
 #include "lite/core/op_lite.h"
 #include "lite/core/op_registry.h"
 #include "lite/fluid/eigen.h"
+#include "lite/kernels/x86/vector_for.h"
 #include "lite/operators/activation_ops.h"
 
 namespace paddle {
@@ -69,6 +73,21 @@ bool Activate(const lite::Tensor* X, lite::Tensor* Out) {
   return true;
 }
 
+// The same with the jit vector kernel of KernelTuple, e.g. VReluTuple, split
+// over the threads if the tensor is large.
+template <typename KernelTuple>
+void ActivateJit(const X86Context& ctx,
+                 const lite::Tensor* X,
+                 lite::Tensor* Out) {
+  using T = typename KernelTuple::data_type;
+  using Funcs = jit::KernelFuncs<KernelTuple, fluid::CPUPlace>;
+  const T* x = X->data<T>();
+  T* out = Out->mutable_data<T>();
+  VectorFor(ctx, 1, X->numel(), [&](int64_t, int64_t i, int len) {
+    Funcs::Cache().At(len)(x + i, out + i, len);
+  });
+}
+
 // square(x) = x^2
 template <typename T>
 struct SquareFunctor : public BaseActivationFunctor<T> {
@@ -85,9 +104,10 @@ class SquareCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
 
   void Run() override {
     auto& param = *param_.get_mutable<operators::ActivationParam>();
+    auto& context = ctx_->As<X86Context>();
 
     param.Out->template mutable_data<T>();
-    Activate<SquareFunctor<T>>(param.X, param.Out);
+    ActivateJit<jit::VSquareTuple<T>>(context, param.X, param.Out);
   }
 
   virtual ~SquareCompute() = default;
@@ -109,9 +129,10 @@ class ReluCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
 
   void Run() override {
     auto& param = *param_.get_mutable<operators::ActivationParam>();
+    auto& context = ctx_->As<X86Context>();
 
     param.Out->template mutable_data<T>();
-    Activate<ReluFunctor<T>>(param.X, param.Out);
+    ActivateJit<jit::VReluTuple<T>>(context, param.X, param.Out);
   }
 
   virtual ~ReluCompute() = default;
@@ -133,9 +154,10 @@ class TanhCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
 
   void Run() override {
     auto& param = *param_.get_mutable<operators::ActivationParam>();
+    auto& context = ctx_->As<X86Context>();
 
     param.Out->template mutable_data<T>();
-    Activate<TanhFunctor<T>>(param.X, param.Out);
+    ActivateJit<jit::VTanhTuple<T>>(context, param.X, param.Out);
   }
 
   virtual ~TanhCompute() = default;
@@ -212,6 +234,51 @@ class SoftsignCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
   virtual ~SoftsignCompute() = default;
 };
 
+// leaky_relu(x) = max(x, alpha * x), alpha <= 1
+template <typename T>
+class LeakyReluCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
+ public:
+  using param_t = operators::ActivationParam;
+
+  void Run() override {
+    auto& param = *param_.get_mutable<operators::ActivationParam>();
+    param.Out->template mutable_data<T>();
+
+    auto place = lite::fluid::EigenDeviceType<TARGET(kX86)>();
+    auto x = lite::fluid::EigenVector<T>::Flatten(*param.X);
+    auto out = lite::fluid::EigenVector<T>::Flatten(*param.Out);
+    const T alpha = param.Leaky_relu_alpha;
+    out.device(place) = x.cwiseMax(x * alpha);
+  }
+
+  virtual ~LeakyReluCompute() = default;
+};
+
+// sigmoid(x) = 1 / (1 + exp(-x))
+template <typename T>
+struct SigmoidFunctor : public BaseActivationFunctor<T> {
+  template <typename Device, typename X, typename Out>
+  void operator()(Device d, X x, Out out) const {
+    out.device(d) = static_cast<T>(1) / (static_cast<T>(1) + (-x).exp());
+  }
+};
+
+template <typename T>
+class SigmoidCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
+ public:
+  using param_t = operators::ActivationParam;
+
+  void Run() override {
+    auto& param = *param_.get_mutable<operators::ActivationParam>();
+    auto& context = ctx_->As<X86Context>();
+
+    param.Out->template mutable_data<T>();
+    ActivateJit<jit::VSigmoidTuple<T>>(context, param.X, param.Out);
+  }
+
+  virtual ~SigmoidCompute() = default;
+};
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
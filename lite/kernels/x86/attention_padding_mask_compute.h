@@ -15,6 +15,7 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <algorithm>
 #include <random>
 #include <string>
 #include "lite/core/kernel.h"
@@ -36,6 +37,7 @@ class AttentionPaddingMaskCompute
 
   void Run() override {
     auto& param = *param_.get_mutable<param_t>();
+    auto& context = ctx_->As<X86Context>();
     auto* bottom0 = param.X;
     auto* bottom1 = param.Y;
     auto* _pad_begin = param.pad_begin;
@@ -55,20 +57,21 @@ class AttentionPaddingMaskCompute
       pad_begin[i] = index + 1;
     }
 
+    // Every row of the attention is copied up to its pad begin and masked
+    // after it in one pass, the rows are split over the threads.
     const auto att_len = static_cast<int64_t>(bottom0->lod()[0][1]);
+    const T* bottom_data = bottom0->data<T>();
     auto* top_data = top->mutable_data<T>();
-    memcpy(top_data,
-           bottom0->data<T>(),
-           bottom0->dims()[0] * bottom0->dims()[1] * sizeof(T));
-    for (int i = 0; i < att_batch; ++i) {
-      for (int j = 0; j < att_len; ++j) {
-        top_data = top->mutable_data<T>() + src_len * (att_len * i + j);
-        int src_idx = i % src_batch;
-        for (int k = pad_begin[src_idx]; k < src_len; ++k) {
-          top_data[k] = _mask;
-        }
+    context.ParallelFor(att_batch * att_len, [&](int64_t begin, int64_t end) {
+      for (int64_t row = begin; row < end; ++row) {
+        const int src_idx = (row / att_len) % src_batch;
+        const int64_t valid = pad_begin[src_idx];
+        const T* in = bottom_data + src_len * row;
+        T* out = top_data + src_len * row;
+        memcpy(out, in, valid * sizeof(T));
+        std::fill(out + valid, out + src_len, static_cast<T>(_mask));
       }
-    }
+    });
   }
 
   virtual ~AttentionPaddingMaskCompute() = default;
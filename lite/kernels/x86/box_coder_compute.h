@@ -0,0 +1,132 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include "lite/core/kernel.h"
+#include "lite/core/op_registry.h"
+#include "lite/operators/box_coder_op.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+/*
+ * BoxCoderCompute encodes the target boxes of [row, 4] against the priors of
+ * [col, 4] into [row, col, 4], or decodes the deltas of [row, col, 4] with
+ * the priors of the column (axis 0) or of the row (axis 1), as the ARM
+ * kernel. The variances are taken from PriorBoxVar, or else from the
+ * variance attr. The rows are split over the threads.
+ */
+template <typename T>
+class BoxCoderCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
+ public:
+  using param_t = operators::BoxCoderParam;
+
+  void Run() override {
+    auto& param = *param_.get_mutable<param_t>();
+    auto& context = ctx_->As<X86Context>();
+    auto* prior_box = param.prior_box;
+    auto* target_box = param.target_box;
+    auto* output_box = param.proposals;
+    const std::string& code_type = param.code_type;
+
+    const int64_t row = target_box->dims()[0];
+    const int64_t col = code_type == "decode_center_size"
+                            ? target_box->dims()[1]
+                            : prior_box->dims()[0];
+    const int64_t len = prior_box->dims()[1];
+    CHECK_EQ(len, 4) << "The boxes should be of [xmin, ymin, xmax, ymax]";
+    output_box->Resize({row, col, len});
+
+    const T* prior = prior_box->data<T>();
+    const T* target = target_box->data<T>();
+    T* output = output_box->mutable_data<T>();
+    // The variances of the priors, of stride var_stride, or the same for all.
+    const T ones[4] = {1, 1, 1, 1};
+    const T* var = ones;
+    int var_stride = 0;
+    if (param.prior_box_var) {
+      var = param.prior_box_var->data<T>();
+      var_stride = len;
+    } else if (!param.variance.empty()) {
+      CHECK_EQ(param.variance.size(), 4UL);
+      var = param.variance.data();
+    }
+    const T norm = param.box_normalized ? 0 : 1;
+
+    if (code_type == "encode_center_size") {
+      context.ParallelFor(row, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          const T* t = target + i * len;
+          T t_w = t[2] - t[0] + norm;
+          T t_h = t[3] - t[1] + norm;
+          T t_cx = (t[2] + t[0]) / 2;
+          T t_cy = (t[3] + t[1]) / 2;
+          for (int64_t j = 0; j < col; ++j) {
+            const T* p = prior + j * len;
+            const T* v = var + j * var_stride;
+            T* out = output + (i * col + j) * len;
+            T p_w = p[2] - p[0] + norm;
+            T p_h = p[3] - p[1] + norm;
+            T p_cx = p[0] + p_w / 2;
+            T p_cy = p[1] + p_h / 2;
+            out[0] = (t_cx - p_cx) / p_w / v[0];
+            out[1] = (t_cy - p_cy) / p_h / v[1];
+            out[2] = std::log(std::fabs(t_w / p_w)) / v[2];
+            out[3] = std::log(std::fabs(t_h / p_h)) / v[3];
+          }
+        }
+      });
+    } else if (code_type == "decode_center_size") {
+      const int axis = param.axis;
+      context.ParallelFor(row, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          for (int64_t j = 0; j < col; ++j) {
+            const int64_t prior_idx = axis == 0 ? j : i;
+            const T* p = prior + prior_idx * len;
+            const T* v = var + prior_idx * var_stride;
+            const T* t = target + (i * col + j) * len;
+            T* out = output + (i * col + j) * len;
+            T p_w = p[2] - p[0] + norm;
+            T p_h = p[3] - p[1] + norm;
+            T p_cx = p[0] + p_w / 2;
+            T p_cy = p[1] + p_h / 2;
+            T cx = v[0] * t[0] * p_w + p_cx;
+            T cy = v[1] * t[1] * p_h + p_cy;
+            T w = std::exp(v[2] * t[2]) * p_w;
+            T h = std::exp(v[3] * t[3]) * p_h;
+            out[0] = cx - w / 2;
+            out[1] = cy - h / 2;
+            out[2] = cx + w / 2 - norm;
+            out[3] = cy + h / 2 - norm;
+          }
+        }
+      });
+    } else {
+      LOG(FATAL) << "Not supported code type: " << code_type;
+    }
+  }
+
+  virtual ~BoxCoderCompute() = default;
+};
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,106 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/calib_compute.h"
+#include <algorithm>
+#include "lite/backends/x86/math/gemm_int8.h"
+#include "lite/core/op_registry.h"
+#include "lite/core/type_system.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+// The elements of a chunk of the threads.
+const int64_t kCalibChunk = 16 * 1024;
+
+void CalibComputeFp32ToInt8::Run() {
+  auto& param = this->Param<operators::CalibParam>();
+  auto& context = ctx_->As<X86Context>();
+  const auto* din = param.input->data<float>();
+  auto* dout = param.output->mutable_data<int8_t>();
+  const int64_t numel = param.input->numel();
+  const int64_t chunks = (numel + kCalibChunk - 1) / kCalibChunk;
+  context.ParallelFor(chunks, [&](int64_t begin, int64_t end) {
+    int64_t offset = begin * kCalibChunk;
+    lite::x86::math::fp32_to_int8(din + offset,
+                                  dout + offset,
+                                  std::min(end * kCalibChunk, numel) - offset,
+                                  param.scale);
+  });
+}
+
+void CalibComputeInt8ToFp32::Run() {
+  auto& param = this->Param<operators::CalibParam>();
+  auto& context = ctx_->As<X86Context>();
+  const auto* din = param.input->data<int8_t>();
+  auto* dout = param.output->mutable_data<float>();
+  const int64_t numel = param.input->numel();
+  const int64_t chunks = (numel + kCalibChunk - 1) / kCalibChunk;
+  context.ParallelFor(chunks, [&](int64_t begin, int64_t end) {
+    int64_t offset = begin * kCalibChunk;
+    lite::x86::math::int8_to_fp32(din + offset,
+                                  dout + offset,
+                                  std::min(end * kCalibChunk, numel) - offset,
+                                  param.scale);
+  });
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_KERNEL(calib,
+                     kX86,
+                     kInt8,
+                     kNCHW,
+                     paddle::lite::kernels::x86::CalibComputeFp32ToInt8,
+                     fp32_to_int8)
+    .BindInput("Input",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(calib,
+                     kX86,
+                     kInt8,
+                     kNCHW,
+                     paddle::lite::kernels::x86::CalibComputeInt8ToFp32,
+                     int8_to_fp32)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(calib_once,
+                     kX86,
+                     kInt8,
+                     kNCHW,
+                     paddle::lite::kernels::x86::CalibComputeFp32ToInt8,
+                     fp32_to_int8)
+    .BindInput("Input",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(calib_once,
+                     kX86,
+                     kInt8,
+                     kNCHW,
+                     paddle::lite::kernels::x86::CalibComputeInt8ToFp32,
+                     int8_to_fp32)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .Finalize();
@@ -0,0 +1,90 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/calib_compute.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "lite/backends/x86/thread_pool.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+TEST(calib_x86, retrive_op) {
+  auto calib =
+      KernelRegistry::Global().Create<TARGET(kX86), PRECISION(kInt8)>("calib");
+  ASSERT_EQ(calib.size(), 2UL);
+}
+
+TEST(calib_x86, run_test) {
+  // More elements than a chunk of the threads.
+  const int64_t numel = 40000;
+  lite::Tensor x, q, y;
+  x.Resize({numel});
+  q.Resize({numel});
+  y.Resize({numel});
+  auto* x_data = x.mutable_data<float>();
+  for (int64_t i = 0; i < numel; i++) {
+    x_data[i] = static_cast<float>(i % 301 - 150) * 0.01f;
+  }
+
+  const float scale = 0.01f;
+  for (int threads : {1, 4}) {
+    CalibComputeFp32ToInt8 quant;
+    operators::CalibParam quant_param;
+    quant_param.input = &x;
+    quant_param.output = &q;
+    quant_param.scale = scale;
+    std::unique_ptr<KernelContext> ctx(new KernelContext);
+    ctx->As<X86Context>().SetThreadPool(
+        std::make_shared<lite::x86::ThreadPool>(threads));
+    quant.SetContext(std::move(ctx));
+    quant.SetParam(quant_param);
+    quant.Launch();
+
+    CalibComputeInt8ToFp32 dequant;
+    operators::CalibParam dequant_param;
+    dequant_param.input = &q;
+    dequant_param.output = &y;
+    dequant_param.scale = scale;
+    ctx.reset(new KernelContext);
+    ctx->As<X86Context>().SetThreadPool(
+        std::make_shared<lite::x86::ThreadPool>(threads));
+    dequant.SetContext(std::move(ctx));
+    dequant.SetParam(dequant_param);
+    dequant.Launch();
+
+    auto* q_data = q.data<int8_t>();
+    auto* y_data = y.data<float>();
+    for (int64_t i = 0; i < numel; i++) {
+      // The values out of [-1.27, 1.27] are clamped.
+      int ref = std::min(std::max(static_cast<int>(i % 301 - 150), -127), 127);
+      ASSERT_EQ(q_data[i], ref);
+      ASSERT_NEAR(y_data[i], ref * scale, 1e-6);
+    }
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(calib, kX86, kInt8, kNCHW, fp32_to_int8);
+USE_LITE_KERNEL(calib, kX86, kInt8, kNCHW, int8_to_fp32);
@@ -0,0 +1,74 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/conditional_block_compute.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+void ConditionalBlockCompute::PrepareForRun() {
+  auto& param = Param<operators::ConditionalBlockParam>();
+  CHECK(param.program_desc)
+      << "the conditional_block op should be built by a Program";
+  auto host_place = place();
+  host_place.target = TARGET(kHost);
+  program_.reset(new Program(*param.program_desc,
+                             param.block_idx,
+                             param.scope,
+                             {place(), host_place}));
+  runtime_program_.reset(new RuntimeProgram(program_.get()));
+  runtime_program_->SetX86ThreadPool(
+      ctx_->As<X86Context>().shared_thread_pool());
+}
+
+void ConditionalBlockCompute::Run() {
+  auto& param = Param<operators::ConditionalBlockParam>();
+  bool need_run = true;
+  if (param.is_scalar_condition) {
+    need_run = param.cond->data<bool>()[0];
+  } else {
+    for (auto* x : param.x) {
+      if (x == nullptr || !x->IsInitialized() || x->dims().empty()) {
+        need_run = false;
+        break;
+      }
+    }
+  }
+  if (need_run) {
+    runtime_program_->Run();
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_KERNEL(conditional_block,
+                     kX86,
+                     kFloat,
+                     kNCHW,
+                     paddle::lite::kernels::x86::ConditionalBlockCompute,
+                     def)
+    .BindInput("Input",
+               {LiteType::GetTensorTy(
+                   TARGET(kX86), PRECISION(kAny), DATALAYOUT(kAny))})
+    .BindInput("Cond", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBool))})
+    .BindOutput("Out",
+                {LiteType::GetTensorTy(
+                    TARGET(kX86), PRECISION(kAny), DATALAYOUT(kAny))})
+    .BindOutput("Scope", {LiteType::GetTensorTy(TARGET(kX86))})
+    .Finalize();
@@ -14,9 +14,12 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <algorithm>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include "lite/backends/x86/math/blas.h"
+#include "lite/backends/x86/math/gemm_int8.h"
 #include "lite/backends/x86/math/im2col.h"
 #include "lite/backends/x86/math/vol2col.h"
 #include "lite/core/kernel.h"
@@ -44,48 +47,84 @@ inline bool IsExpand(const std::vector<int64_t>& filter_dim,
   return !(filter_1 && strides_1 && padding_0 && dilation_1);
 }
 
+/*
+ * Conv2dCompute lowers the convolution to im2col (vol2col for 3-D) and GEMM.
+ *
+ * The col workspace is allocated once per input shape in ReInitWhenNeeded and
+ * reused by the following runs. The batch is split over the threads of the
+ * context, each thread with its own col workspace; a batch smaller than the
+ * threads with several groups splits the groups of every image instead. The
+ * GEMMs of the groups of an image are issued as one batched GEMM.
+ */
 template <typename T>
 class Conv2dCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
  public:
   using param_t = operators::ConvParam;
-  void Run() override {
+
+  void PrepareForRun() override {
+    auto& param = *param_.get_mutable<operators::ConvParam>();
+    std::vector<int64_t> filter_shape_vec(param.filter->dims().Vectorize());
+    data_dim_ = filter_shape_vec.size() - 2;
+    is_expand_ = IsExpand(
+        filter_shape_vec, param.strides, *param.paddings, *param.dilations);
+    ReInitWhenNeeded();
+  }
+
+  void ReInitWhenNeeded() override {
     auto& context = ctx_->As<X86Context>();
     auto& param = *param_.get_mutable<operators::ConvParam>();
-    lite::Tensor filter = *param.filter;
-    param.output->mutable_data<T>();
-    const int batch_size = static_cast<int>(param.x->dims()[0]);
+    auto x_dims = param.x->dims();
+    if (last_shape_ == x_dims) {
+      return;
+    }
 
-    std::vector<int64_t> filter_shape_vec(filter.dims().Vectorize());
+    std::vector<int64_t> filter_shape_vec(param.filter->dims().Vectorize());
     std::vector<int64_t> output_shape_vec(param.output->dims().Vectorize());
-    size_t data_dim = filter_shape_vec.size() - 2;
-    std::vector<int64_t> col_shape_vec(1 + 2 * data_dim);
-    col_shape_vec[0] = param.x->dims()[1] / param.groups;
-    for (size_t j = 0; j < data_dim; ++j) {
+    const int batch_size = static_cast<int>(x_dims[0]);
+    const int groups = param.groups;
+    std::vector<int64_t> col_shape_vec(1 + 2 * data_dim_);
+    col_shape_vec[0] = x_dims[1] / groups;
+    for (size_t j = 0; j < data_dim_; ++j) {
       col_shape_vec[j + 1] = filter_shape_vec[j + 2];
-      col_shape_vec[j + 1 + data_dim] = output_shape_vec[j + 2];
+      col_shape_vec[j + 1 + data_dim_] = output_shape_vec[j + 2];
     }
     lite::DDim col_shape(col_shape_vec);
-    lite::DDim col_matrix_shape = col_shape.Flatten2D(data_dim + 1);
-    bool is_expand = IsExpand(
-        filter_shape_vec, param.strides, *param.paddings, *param.dilations);
-    lite::Tensor col;
-    lite::Tensor col_matrix;
-    if (is_expand) {
-      col.Resize(col_shape);
-      col.mutable_data<T>();
-      col_matrix.ShareDataWith(col);
-      col_matrix.Resize(col_matrix_shape);
+    lite::DDim col_matrix_shape = col_shape.Flatten2D(data_dim_ + 1);
+    col_height_ = col_matrix_shape[0];
+    col_width_ = col_matrix_shape[1];
+
+    // Split the batch if it keeps every thread busy, or if there is nothing
+    // else to split.
+    int threads = context.threads();
+    split_batch_ = batch_size >= threads || groups == 1;
+    num_workspaces_ = split_batch_ ? std::min(batch_size, threads) : 1;
+    if (is_expand_) {
+      // One col for all the groups of an image per workspace.
+      col_shape_vec[0] *= groups * num_workspaces_;
+      col_.Resize(col_shape_vec);
+      col_.mutable_data<T>();
     }
+    last_shape_ = x_dims;
+  }
+
+  void Run() override {
+    auto& context = ctx_->As<X86Context>();
+    auto& param = *param_.get_mutable<operators::ConvParam>();
+    const T* in_data = param.x->data<T>();
+    const T* filter_data = param.filter->data<T>();
+    T* out_data = param.output->mutable_data<T>();
+    const int batch_size = static_cast<int>(param.x->dims()[0]);
+    const int groups = param.groups;
     lite::DDim input_shape = param.x->dims().Slice(1, param.x->dims().size());
-    lite::DDim filter_matrix_shape(std::vector<int64_t>{
-        filter.dims()[0], filter.dims().production() / filter.dims()[0]});
-    filter.Resize(filter_matrix_shape);
-    lite::DDim output_matrix_shape(std::vector<int64_t>{
-        param.output->dims()[1],
-        param.output->dims().production() /
-            (param.output->dims()[0] * param.output->dims()[1])});
-    int in_step = static_cast<int>(param.x->dims()[1]) / param.groups;
-    int out_step = static_cast<int>(param.output->dims()[1]) / param.groups;
+    const int64_t in_step = param.x->dims()[1] / groups;
+    const int64_t out_step = param.output->dims()[1] / groups;
+    const int64_t in_batch_size = input_shape.production();
+    const int64_t out_image_size = param.output->dims().production() /
+                                   (batch_size * param.output->dims()[1]);
+    const int64_t out_batch_size = param.output->dims()[1] * out_image_size;
+    const int64_t filter_step = out_step * col_height_;
+    const int64_t col_step = col_height_ * col_width_;
+
     paddle::lite::x86::math::Vol2ColFunctor<lite::TargetType::kX86, T> vol2col;
     paddle::lite::x86::math::Im2ColFunctor<
         paddle::lite::x86::math::ColFormat::kCFO,
@@ -94,60 +133,258 @@ class Conv2dCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
         im2col;
     auto blas =
         paddle::lite::x86::math::GetBlas<lite::TargetType::kX86, T>(context);
-    for (int i = 0; i < batch_size; i++) {
-      lite::Tensor in_batch = param.x->Slice<T>(i, i + 1);
-      in_batch.Resize(input_shape);
-      lite::Tensor out_batch = param.output->Slice<T>(i, i + 1);
-      out_batch.Resize(output_matrix_shape);
-      for (int g = 0; g < param.groups; g++) {
-        lite::Tensor in_slice =
-            in_batch.Slice<T>(static_cast<int64_t>(g * in_step),
-                              static_cast<int64_t>((g + 1) * in_step));
-        auto paddings = *param.paddings;
-        if (!is_expand) {
-          col.ShareDataWith(in_slice);
-          col_matrix.ShareDataWith(col);
-          col_matrix.Resize(col_matrix_shape);
-        } else if (data_dim == 2U) {
-          // im2col
-          im2col(context,
-                 in_slice,
-                 *param.dilations,
-                 param.strides,
-                 std::vector<int>{
-                     paddings[0], paddings[2], paddings[0], paddings[2]},
-                 &(col));
-        } else if (data_dim == 3U) {
-          // vol2col
-          vol2col(context,
-                  in_slice,
-                  *param.dilations,
-                  param.strides,
-                  *param.paddings,
-                  &(col));
+    auto paddings = *param.paddings;
+    std::vector<int> im2col_paddings{
+        paddings[0], paddings[2], paddings[0], paddings[2]};
+
+    // Convolve the groups [g_begin, g_end) of the i-th image, with the cols
+    // of the `workspace`-th workspace.
+    auto conv_groups = [&](int64_t i, int g_begin, int g_end, int workspace) {
+      const T* col_data = in_data + i * in_batch_size + g_begin * col_step;
+      if (is_expand_) {
+        lite::Tensor in_batch = param.x->Slice<T>(i, i + 1);
+        in_batch.Resize(input_shape);
+        int64_t col_begin = static_cast<int64_t>(workspace) * groups * in_step;
+        for (int g = g_begin; g < g_end; g++) {
+          lite::Tensor in_slice =
+              in_batch.Slice<T>(g * in_step, (g + 1) * in_step);
+          lite::Tensor col = col_.Slice<T>(col_begin + g * in_step,
+                                           col_begin + (g + 1) * in_step);
+          if (data_dim_ == 2U) {
+            im2col(context,
+                   in_slice,
+                   *param.dilations,
+                   param.strides,
+                   im2col_paddings,
+                   &col);
+          } else if (data_dim_ == 3U) {
+            vol2col(context,
+                    in_slice,
+                    *param.dilations,
+                    param.strides,
+                    *param.paddings,
+                    &col);
+          }
         }
+        col_data = col_.data<T>() + (workspace * groups + g_begin) * col_step;
+      }
+      blas.BatchedGEMM(CblasNoTrans,
+                       CblasNoTrans,
+                       static_cast<int>(out_step),
+                       static_cast<int>(col_width_),
+                       static_cast<int>(col_height_),
+                       T(1.0),
+                       filter_data + g_begin * filter_step,
+                       col_data,
+                       T(0.0),
+                       out_data + i * out_batch_size +
+                           g_begin * out_step * out_image_size,
+                       g_end - g_begin,
+                       filter_step,
+                       col_step);
+    };
+
+    // The GEMMs run on the threads of the split are kept single-threaded by
+    // the ScopedSingleThreadedBlas guard, the same as in var_conv_2d and
+    // match_matrix_tensor. It replaces the MKL threads set and restored by
+    // hand around each range, which were not restored if a range threw. The
+    // split over the batch chunks or the group ranges is unchanged.
+    const bool single_threaded_gemm =
+        context.threads() > 1 && (!split_batch_ || num_workspaces_ > 1);
 
-        // gemm
-        lite::Tensor out_slice;
-        out_slice =
-            out_batch.Slice<T>(static_cast<int64_t>(g * out_step),
-                               static_cast<int64_t>((g + 1) * out_step));
-        lite::Tensor filter_slice;
-        filter_slice =
-            filter.Slice<T>(static_cast<int64_t>(g * out_step),
-                            static_cast<int64_t>((g + 1) * out_step));
-        blas.MatMul(filter_slice,
-                    false,
-                    col_matrix,
-                    false,
-                    T(1.0),
-                    &(out_slice),
-                    T(0.0));
+    if (split_batch_) {
+      const int64_t chunks = num_workspaces_;
+      context.ParallelFor(chunks, [&](int64_t begin, int64_t end) {
+        lite::x86::math::ScopedSingleThreadedBlas single_threaded(
+            single_threaded_gemm);
+        for (int64_t c = begin; c < end; c++) {
+          for (int64_t i = c * batch_size / chunks;
+               i < (c + 1) * batch_size / chunks;
+               i++) {
+            conv_groups(i, 0, groups, static_cast<int>(c));
+          }
+        }
+      });
+    } else {
+      // The group ranges write disjoint parts of the single workspace.
+      for (int64_t i = 0; i < batch_size; i++) {
+        context.ParallelFor(groups, [&](int64_t begin, int64_t end) {
+          lite::x86::math::ScopedSingleThreadedBlas single_threaded(
+              single_threaded_gemm);
+          conv_groups(i, static_cast<int>(begin), static_cast<int>(end), 0);
+        });
       }
     }
   }
 
   virtual ~Conv2dCompute() = default;
+
+ private:
+  size_t data_dim_{2};
+  bool is_expand_{true};
+  lite::DDim last_shape_;
+  int64_t col_height_{0};
+  int64_t col_width_{0};
+  bool split_batch_{true};
+  int num_workspaces_{1};
+  // The cols of all the groups of an image, for every workspace.
+  lite::Tensor col_;
+};
+
+/*
+ * Conv2dInt8Compute runs a quantized 2-D convolution: the int8 input is
+ * lowered to an im2col of [positions, K] and multiplied with the int8 filter
+ * of [output channels, K] by integer dot products, the int32 sums are then
+ * dequantized by input_scale * weight_scale[oc] into fp32, or requantized by
+ * output_scale into int8, with the bias and relu.
+ *
+ * The output positions of all the groups of an image are split over the
+ * threads of the context, so depthwise convs split as well as the others.
+ */
+template <PrecisionType Ptype_out>
+class Conv2dInt8Compute : public KernelLite<TARGET(kX86), PRECISION(kInt8)> {
+ public:
+  using param_t = operators::ConvParam;
+  using out_t = typename std::
+      conditional<Ptype_out == PRECISION(kInt8), int8_t, float>::type;
+
+  void PrepareForRun() override {
+    auto& param = *param_.get_mutable<operators::ConvParam>();
+    CHECK_EQ(param.filter->dims().size(), 4UL)
+        << "The int8 conv only supports 2-D convolutions";
+    const int oc = static_cast<int>(param.filter->dims()[0]);
+    const auto& weight_scale = param.weight_scale;
+    const int scales = static_cast<int>(weight_scale.size());
+    CHECK(scales == 1 || scales == oc)
+        << "The weight scales should be per tensor or per output channel";
+    float out_scale = Ptype_out == PRECISION(kInt8) ? param.output_scale : 1.f;
+    scale_.resize(oc);
+    for (int i = 0; i < oc; ++i) {
+      float ws = scales == 1 ? weight_scale[0] : weight_scale[i];
+      scale_[i] = param.input_scale * ws / out_scale;
+    }
+    bias_.clear();
+    if (param.bias) {
+      const float* bias = param.bias->data<float>();
+      bias_.assign(bias, bias + oc);
+      for (auto& b : bias_) {
+        b /= out_scale;
+      }
+    }
+    relu_ = param.activation_param.has_active;
+    if (relu_) {
+      CHECK(param.activation_param.active_type ==
+            lite_api::ActivationType::kRelu)
+          << "The int8 conv only fuses relu";
+    }
+  }
+
+  void Run() override {
+    auto& context = ctx_->As<X86Context>();
+    auto& param = *param_.get_mutable<operators::ConvParam>();
+    const auto& x_dims = param.x->dims();
+    const auto& w_dims = param.filter->dims();
+    const auto& out_dims = param.output->dims();
+    const int batch_size = static_cast<int>(x_dims[0]);
+    const int groups = param.groups;
+    const int ic = static_cast<int>(x_dims[1]) / groups;
+    const int ih = static_cast<int>(x_dims[2]);
+    const int iw = static_cast<int>(x_dims[3]);
+    const int oc = static_cast<int>(out_dims[1]) / groups;
+    const int oh = static_cast<int>(out_dims[2]);
+    const int ow = static_cast<int>(out_dims[3]);
+    const int kh = static_cast<int>(w_dims[2]);
+    const int kw = static_cast<int>(w_dims[3]);
+    const int k = ic * kh * kw;
+    const int positions = oh * ow;
+    const int stride_h = param.strides[0];
+    const int stride_w = param.strides[1];
+    const int pad_h = (*param.paddings)[0];
+    const int pad_w = (*param.paddings)[2];
+    const int dilation_h = (*param.dilations)[0];
+    const int dilation_w = (*param.dilations)[1];
+
+    col_.Resize({groups * positions, k});
+    acc_.Resize({groups * oc, positions});
+    int8_t* col_data = col_.mutable_data<int8_t>();
+    int32_t* acc_data = acc_.mutable_data<int32_t>();
+    const int8_t* filter_data = param.filter->data<int8_t>();
+    out_t* out_data = param.output->mutable_data<out_t>();
+    const float* bias_data = bias_.empty() ? nullptr : bias_.data();
+
+    const int64_t in_group_size = static_cast<int64_t>(ic) * ih * iw;
+    const int64_t col_group_size = static_cast<int64_t>(positions) * k;
+    const int64_t out_group_size = static_cast<int64_t>(oc) * positions;
+    for (int i = 0; i < batch_size; ++i) {
+      const int8_t* in_image =
+          param.x->data<int8_t>() + i * groups * in_group_size;
+      out_t* out_image = out_data + i * groups * out_group_size;
+      // The items are the positions of all the groups, a range may start and
+      // end in the middle of a group.
+      auto conv_positions = [&](int64_t begin, int64_t end) {
+        for (int64_t g = begin / positions; g * positions < end; ++g) {
+          const int p0 =
+              static_cast<int>(std::max<int64_t>(begin - g * positions, 0));
+          const int p1 = static_cast<int>(
+              std::min<int64_t>(end - g * positions, positions));
+          const int8_t* in = in_image + g * in_group_size;
+          int8_t* col = col_data + g * col_group_size;
+          for (int p = p0; p < p1; ++p) {
+            const int h_start = p / ow * stride_h - pad_h;
+            const int w_start = p % ow * stride_w - pad_w;
+            int8_t* col_row = col + static_cast<int64_t>(p) * k;
+            for (int c = 0; c < ic; ++c) {
+              const int8_t* in_channel = in + c * ih * iw;
+              for (int y = 0; y < kh; ++y) {
+                const int h = h_start + y * dilation_h;
+                for (int x = 0; x < kw; ++x) {
+                  const int w = w_start + x * dilation_w;
+                  *col_row++ = (h >= 0 && h < ih && w >= 0 && w < iw)
+                                   ? in_channel[h * iw + w]
+                                   : 0;
+                }
+              }
+            }
+          }
+          int32_t* acc = acc_data + g * out_group_size;
+          lite::x86::math::gemm_s8s8(oc,
+                                     p1 - p0,
+                                     k,
+                                     filter_data + g * oc * k,
+                                     k,
+                                     col + static_cast<int64_t>(p0) * k,
+                                     k,
+                                     acc + p0,
+                                     positions);
+          lite::x86::math::dequantize_int32(
+              acc + p0,
+              positions,
+              out_image + g * out_group_size + p0,
+              positions,
+              oc,
+              p1 - p0,
+              scale_.data() + g * oc,
+              bias_data ? bias_data + g * oc : nullptr,
+              true,
+              relu_);
+        }
+      };
+      context.ParallelFor(static_cast<int64_t>(groups) * positions,
+                          conv_positions);
+    }
+  }
+
+  virtual ~Conv2dInt8Compute() = default;
+
+ private:
+  // The scales and bias of the output channels, with the output scale folded
+  // in for an int8 output.
+  std::vector<float> scale_;
+  std::vector<float> bias_;
+  bool relu_{false};
+  // The im2col of [positions, K] and the int32 sums of every group.
+  lite::Tensor col_;
+  lite::Tensor acc_;
 };
 
 }  // namespace x86
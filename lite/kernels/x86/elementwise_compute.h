@@ -13,10 +13,14 @@
 // limitations under the License.
 #pragma once
 
+#include "lite/backends/x86/jit/helper.h"
+#include "lite/backends/x86/jit/kernel_base.h"
+#include "lite/backends/x86/jit/kernels.h"
 #include "lite/core/kernel.h"
 #include "lite/core/op_registry.h"
 #include "lite/fluid/eigen.h"
 #include "lite/kernels/x86/elementwise_op_function.h"
+#include "lite/kernels/x86/vector_for.h"
 
 namespace paddle {
 namespace lite {
@@ -33,6 +37,77 @@ struct AddFunctor {
   inline HOSTDEVICE T operator()(T a, T b) const { return a + b; }
 };
 
+/*
+ * Out = X + Y, or X - Y if sub, with the jit vector kernels, for the
+ * broadcasts of most models:
+ *   Y of the shape of X, added by VAdd or VSub over the whole tensors;
+ *   Y of a single value, added by VAddBias;
+ *   Y of [n] at axis in X of [pre, n, post], added by VAdd or VSub to the
+ *   rows of X if post is 1, and by VAddBias to its runs of post otherwise.
+ * It returns false for the other broadcasts, left to ElementwiseComputeEx.
+ */
+template <typename T>
+bool ElementwiseAddSubJit(const X86Context& ctx,
+                          const lite::Tensor* x,
+                          const lite::Tensor* y,
+                          int axis,
+                          bool sub,
+                          lite::Tensor* out) {
+  using AddFuncs = jit::KernelFuncs<jit::VAddTuple<T>, fluid::CPUPlace>;
+  using SubFuncs = jit::KernelFuncs<jit::VSubTuple<T>, fluid::CPUPlace>;
+  using BiasFuncs = jit::KernelFuncs<jit::VAddBiasTuple<T>, fluid::CPUPlace>;
+  auto x_dims = x->dims();
+  auto y_dims = y->dims();
+  const T* x_data = x->data<T>();
+  const T* y_data = y->data<T>();
+  T* out_data = out->mutable_data<T>();
+  if (x_dims == y_dims) {
+    VectorFor(ctx, 1, x_dims.production(), [&](int64_t, int64_t i, int len) {
+      auto compute =
+          sub ? SubFuncs::Cache().At(len) : AddFuncs::Cache().At(len);
+      compute(x_data + i, y_data + i, out_data + i, len);
+    });
+    return true;
+  }
+
+  const int rank = static_cast<int>(x_dims.size());
+  if (rank < static_cast<int>(y_dims.size())) return false;
+  axis = axis == -1 ? rank - static_cast<int>(y_dims.size()) : axis;
+  if (axis < 0 || axis >= rank) return false;
+  auto y_trimmed = trim_trailing_singular_dims(y_dims);
+  const int y_rank = static_cast<int>(y_trimmed.size());
+  if (y_rank == 0) axis = rank;
+  if (axis + y_rank > rank) return false;
+  for (int i = 0; i < y_rank; ++i) {
+    if (x_dims[axis + i] != y_trimmed[i]) return false;
+  }
+  const int64_t pre = x_dims.count(0, axis);
+  const int64_t n = x_dims.count(axis, axis + y_rank);
+  const int64_t post = x_dims.count(axis + y_rank, rank);
+
+  if (n == 1) {
+    const T bias = sub ? -y_data[0] : y_data[0];
+    VectorFor(ctx, 1, x_dims.production(), [&](int64_t, int64_t i, int len) {
+      BiasFuncs::Cache().At(len)(&bias, x_data + i, out_data + i, len);
+    });
+  } else if (post == 1) {
+    VectorFor(ctx, pre, n, [&](int64_t row, int64_t i, int len) {
+      auto compute =
+          sub ? SubFuncs::Cache().At(len) : AddFuncs::Cache().At(len);
+      const int64_t offset = row * n + i;
+      compute(x_data + offset, y_data + i, out_data + offset, len);
+    });
+  } else {
+    VectorFor(ctx, pre * n, post, [&](int64_t row, int64_t i, int len) {
+      const T bias = sub ? -y_data[row % n] : y_data[row % n];
+      const int64_t offset = row * post + i;
+      auto compute = BiasFuncs::Cache().At(len);
+      compute(&bias, x_data + offset, out_data + offset, len);
+    });
+  }
+  return true;
+}
+
 template <typename T>
 class ElementwiseSubCompute
     : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
@@ -44,6 +119,10 @@ class ElementwiseSubCompute
     auto& context = ctx_->As<X86Context>();
 
     param.Out->template mutable_data<T>();
+    if (ElementwiseAddSubJit<T>(
+            context, param.X, param.Y, param.axis, true, param.Out)) {
+      return;
+    }
     paddle::lite::kernels::x86::ElementwiseComputeEx<SubFunctor<T>,
                                                      lite::TargetType::kX86,
                                                      T>(
@@ -62,6 +141,10 @@ class ElementwiseAddCompute
     auto& param = *param_.get_mutable<param_t>();
     auto& context = ctx_->As<X86Context>();
     param.Out->template mutable_data<T>();
+    if (ElementwiseAddSubJit<T>(
+            context, param.X, param.Y, param.axis, false, param.Out)) {
+      return;
+    }
     paddle::lite::kernels::x86::ElementwiseComputeEx<AddFunctor<T>,
                                                      lite::TargetType::kX86,
                                                      T>(
@@ -80,9 +80,81 @@ TEST(elementwise_add_x86, run_test) {
   }
 }
 
+TEST(elementwise_add_x86, run_broadcast) {
+  const std::vector<int64_t> x_shape{2, 3, 80, 100};
+  lite::Tensor x, y, out;
+  x.Resize(lite::DDim(x_shape));
+  out.Resize(lite::DDim(x_shape));
+  auto* x_data = x.mutable_data<float>();
+  for (int64_t i = 0; i < x.numel(); i++) {
+    x_data[i] = (i * 7 % 13 - 6) / 4.f;
+  }
+  // The same shape, per channel, rows, a single value, and a broadcast
+  // in the middle of Y, which does not run with the jit kernels.
+  const std::vector<std::pair<std::vector<int64_t>, int>> cases{
+      {x_shape, -1},
+      {{3}, 1},
+      {{2, 3, 1, 1}, 0},
+      {{80, 100}, -1},
+      {{1}, -1},
+      {{2, 1, 80, 100}, 0}};
+
+  for (bool sub : {false, true}) {
+    for (auto& c : cases) {
+      const auto& y_shape = c.first;
+      y.Resize(lite::DDim(y_shape));
+      auto* y_data = y.mutable_data<float>();
+      for (int64_t i = 0; i < y.numel(); i++) {
+        y_data[i] = (i * 5 % 11 - 5) / 8.f;
+      }
+
+      operators::ElementwiseParam param;
+      param.X = &x;
+      param.Y = &y;
+      param.Out = &out;
+      param.axis = c.second;
+      std::unique_ptr<KernelContext> ctx(new KernelContext);
+      ctx->As<X86Context>().SetThreadPool(
+          std::make_shared<lite::x86::ThreadPool>(2));
+      std::unique_ptr<KernelLite<TARGET(kX86), PRECISION(kFloat)>> kernel;
+      if (sub) {
+        kernel.reset(new ElementwiseSubCompute<float>);
+      } else {
+        kernel.reset(new ElementwiseAddCompute<float>);
+      }
+      kernel->SetParam(param);
+      kernel->SetContext(std::move(ctx));
+      kernel->Run();
+
+      // The index of Y of x[i], with Y padded to the rank of X.
+      std::vector<int64_t> y_dims(x_shape.size(), 1);
+      const int axis = c.second == -1 ? 4 - y_shape.size() : c.second;
+      for (size_t d = 0; d < y_shape.size(); d++) {
+        y_dims[axis + d] = y_shape[d];
+      }
+      const float* out_data = out.data<float>();
+      for (int64_t i = 0; i < x.numel(); i++) {
+        int64_t rest = i;
+        int64_t y_index = 0;
+        int64_t y_stride = 1;
+        for (int d = 3; d >= 0; d--) {
+          const int64_t idx = rest % x_shape[d];
+          rest /= x_shape[d];
+          if (y_dims[d] > 1) y_index += idx * y_stride;
+          y_stride *= y_dims[d];
+        }
+        const float ref =
+            sub ? x_data[i] - y_data[y_index] : x_data[i] + y_data[y_index];
+        ASSERT_NEAR(out_data[i], ref, 1e-5) << "case " << y.dims() << " " << i;
+      }
+    }
+  }
+}
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
 }  // namespace paddle
 
 USE_LITE_KERNEL(elementwise_add, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(elementwise_sub, kX86, kFloat, kNCHW, def);
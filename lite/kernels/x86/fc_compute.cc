@@ -21,3 +21,22 @@ REGISTER_LITE_KERNEL(
     .BindInput("W", {LiteType::GetTensorTy(TARGET(kX86))})
     .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86))})
     .Finalize();
+
+typedef paddle::lite::kernels::x86::FcInt8Compute<PRECISION(kInt8)>
+    FcCompute_int8_int8;
+typedef paddle::lite::kernels::x86::FcInt8Compute<PRECISION(kFloat)>
+    FcCompute_int8_fp32;
+
+REGISTER_LITE_KERNEL(fc, kX86, kInt8, kNCHW, FcCompute_int8_int8, int8out)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindInput("Bias", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .BindInput("W", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .Finalize();
+
+REGISTER_LITE_KERNEL(fc, kX86, kInt8, kNCHW, FcCompute_int8_fp32, fp32out)
+    .BindInput("Input", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindInput("Bias", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .BindInput("W", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt8))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kFloat))})
+    .Finalize();
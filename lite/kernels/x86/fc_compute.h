@@ -13,11 +13,17 @@
 // limitations under the License.
 #pragma once
 
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <type_traits>
 #include <vector>
 #include "lite/backends/x86/jit/helper.h"
 #include "lite/backends/x86/jit/kernel_base.h"
 #include "lite/backends/x86/jit/kernels.h"
 #include "lite/backends/x86/math/blas.h"
+#include "lite/backends/x86/math/gemm_int8.h"
+#include "lite/backends/x86/math/gemm_packed.h"
 #include "lite/core/kernel.h"
 #include "lite/core/op_lite.h"
 #include "lite/core/op_registry.h"
@@ -67,23 +73,21 @@ class FCFunctor {
       Y1.Resize({M * (N + 4)});
       T* X1_data = X1.mutable_data<T>();
       Y1_data = Y1.mutable_data<T>();
-#ifdef PADDLE_WITH_MKLML
-#pragma omp parallel for
-#endif
-      for (int i = 0; i < M; i++) {
-        memcpy(X1_data + i * KK, X + i * K, K * sizeof(X[0]));
-      }
+      context.ParallelFor(M, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          memcpy(X1_data + i * KK, X + i * K, K * sizeof(X[0]));
+        }
+      });
       lite::Tensor W1;
       T* W1_data = nullptr;
       if (!padding_weights) {
         W1.Resize({(K + 4) * (N + 4)});
         W1_data = W1.mutable_data<T>();
-#ifdef PADDLE_WITH_MKLML
-#pragma omp parallel for
-#endif
-        for (int i = 0; i < K; i++) {
-          memcpy(W1_data + i * NN, W + i * N, N * sizeof(W[0]));
-        }
+        context.ParallelFor(K, [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; i++) {
+            memcpy(W1_data + i * NN, W + i * N, N * sizeof(W[0]));
+          }
+        });
       }
       blas.GEMM(false,
                 false,
@@ -103,12 +107,11 @@ class FCFunctor {
     }
     if (B == NULL) {
       if (N % 128 == 0 && K % 128 == 0) {
-#ifdef PADDLE_WITH_MKLML
-#pragma omp parallel for
-#endif
-        for (int i = 0; i < M; i++) {
-          memcpy(Y + i * N, Y1_data + i * (N + 4), N * sizeof(Y[0]));
-        }
+        context.ParallelFor(M, [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; i++) {
+            memcpy(Y + i * N, Y1_data + i * (N + 4), N * sizeof(Y[0]));
+          }
+        });
       }
       return;
     }
@@ -117,33 +120,54 @@ class FCFunctor {
           paddle::lite::jit::KernelFuncs<paddle::lite::jit::VAddReluTuple<T>,
                                          lite::fluid::CPUPlace>::Cache()
               .At(N);
-      for (int i = 0; i < M; i++) {
-        T* dst = Y + i * N;
-        T* src = (N % 128 == 0 && K % 128 == 0) ? Y1_data + i * (N + 4) : dst;
-        compute(B, src, dst, N);
-      }
+      context.ParallelFor(M, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          T* dst = Y + i * N;
+          T* src =
+              (N % 128 == 0 && K % 128 == 0) ? Y1_data + i * (N + 4) : dst;
+          compute(B, src, dst, N);
+        }
+      });
     } else {
       auto compute =
           paddle::lite::jit::KernelFuncs<paddle::lite::jit::VAddTuple<T>,
                                          lite::fluid::CPUPlace>::Cache()
               .At(N);
-#ifdef PADDLE_WITH_MKLML
-#pragma omp parallel for
-#endif
-      for (int i = 0; i < M; i++) {
-        T* dst = Y + i * N;
-        T* src = (N % 128 == 0 && K % 128 == 0) ? Y1_data + i * (N + 4) : dst;
-        compute(B, src, dst, N);
-      }
+      context.ParallelFor(M, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          T* dst = Y + i * N;
+          T* src =
+              (N % 128 == 0 && K % 128 == 0) ? Y1_data + i * (N + 4) : dst;
+          compute(B, src, dst, N);
+        }
+      });
     }
   }
 };
 
+/*
+ * FcCompute packs the weights once in PrepareForRun, the packs are shared by
+ * the kernels of the clones of a predictor. The batches the pack pays off for
+ * run on it, the larger ones run on FCFunctor, on the weights padded by the
+ * pack if their dims are multiples of 128.
+ */
 template <typename T>
 class FcCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
  public:
   using param_t = operators::FcParam;
 
+  void PrepareForRun() override {
+    auto& param = *param_.get_mutable<param_t>();
+    auto& context = ctx_->As<X86Context>();
+    auto* w = param.w;
+    auto w_dims = w->dims();
+    bool padding_weights = param.padding_weights;
+    const int K = padding_weights ? w_dims[0] - 4 : w_dims[0];
+    const int N = padding_weights ? w_dims[1] - 4 : w_dims[1];
+    packed_w_ = lite::x86::math::PackedGemm<T>::Share(
+        context, *w, K, N, w->data<T>(), static_cast<int>(w_dims[1]));
+  }
+
   void Run() override {
     auto& param = *param_.get_mutable<param_t>();
     auto* input = param.input;
@@ -172,6 +196,19 @@ class FcCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
     T* output_data = output->mutable_data<T>();
 
     auto& context = ctx_->As<X86Context>();
+    if (lite::x86::math::PackedGemm<T>::Packed(M)) {
+      packed_w_->Compute(
+          context, M, input_data, w_dims0, T(0), output_data, w_dims1);
+      if (bias) {
+        AddBias(context, M, w_dims1, bias->data<T>(), with_relu, output_data);
+      }
+      return;
+    }
+
+    if (packed_w_->padded_b()) {
+      w_data = packed_w_->padded_b();
+      padding_weights = true;
+    }
     FCFunctor<lite::TargetType::kX86, T> fc;
     fc(context,
        M,
@@ -186,6 +223,153 @@ class FcCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
   }
 
   virtual ~FcCompute() = default;
+
+ private:
+  void AddBias(const lite::X86Context& context,
+               int M,
+               int N,
+               const T* B,
+               bool relu,
+               T* Y) {
+    auto compute =
+        relu ? paddle::lite::jit::KernelFuncs<
+                   paddle::lite::jit::VAddReluTuple<T>,
+                   lite::fluid::CPUPlace>::Cache()
+                   .At(N)
+             : paddle::lite::jit::KernelFuncs<paddle::lite::jit::VAddTuple<T>,
+                                              lite::fluid::CPUPlace>::Cache()
+                   .At(N);
+    context.ParallelFor(M, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        compute(B, Y + i * N, Y + i * N, N);
+      }
+    });
+  }
+
+  std::shared_ptr<const lite::x86::math::PackedGemm<T>> packed_w_;
+};
+
+/*
+ * FcInt8Compute runs a quantized fc with integer dot products. The int8
+ * weights of [K, N] are transposed once to [N, K] in PrepareForRun, the int32
+ * sums are dequantized by input_scale * weight_scale[n] into fp32, or
+ * requantized by output_scale into int8, with the bias and relu.
+ */
+template <PrecisionType Ptype_out>
+class FcInt8Compute : public KernelLite<TARGET(kX86), PRECISION(kInt8)> {
+ public:
+  using param_t = operators::FcParam;
+  using out_t = typename std::
+      conditional<Ptype_out == PRECISION(kInt8), int8_t, float>::type;
+
+  void PrepareForRun() override {
+    auto& param = *param_.get_mutable<param_t>();
+    CHECK(!param.padding_weights) << "The int8 fc has no padded weights";
+    const int k = static_cast<int>(param.w->dims()[0]);
+    const int n = static_cast<int>(param.w->dims()[1]);
+    const int8_t* w = param.w->data<int8_t>();
+    // gemm_s8s8 takes no -128 in its second operand, the weights quantized
+    // to [-127, 127] are unchanged.
+    wt_.Resize({n, k});
+    int8_t* wt = wt_.mutable_data<int8_t>();
+    for (int i = 0; i < k; ++i) {
+      for (int j = 0; j < n; ++j) {
+        wt[j * k + i] = std::max<int8_t>(w[i * n + j], -127);
+      }
+    }
+
+    const auto& weight_scale = param.weight_scale;
+    const int scales = static_cast<int>(weight_scale.size());
+    CHECK(scales == 1 || scales == n)
+        << "The weight scales should be per tensor or per output column";
+    float out_scale = Ptype_out == PRECISION(kInt8) ? param.output_scale : 1.f;
+    scale_.resize(n);
+    for (int j = 0; j < n; ++j) {
+      float ws = scales == 1 ? weight_scale[0] : weight_scale[j];
+      scale_[j] = param.input_scale * ws / out_scale;
+    }
+    bias_.clear();
+    if (param.bias) {
+      const float* bias = param.bias->data<float>();
+      bias_.assign(bias, bias + n);
+      for (auto& b : bias_) {
+        b /= out_scale;
+      }
+    }
+  }
+
+  void Run() override {
+    auto& param = *param_.get_mutable<param_t>();
+    auto& context = ctx_->As<X86Context>();
+    auto* input = param.input;
+    auto* output = param.output;
+    bool with_relu = param.activation_type == "relu";
+
+    std::vector<int64_t> output_dims;
+    FCOutputSize(input->dims(),
+                 param.w->dims(),
+                 output_dims,
+                 param.in_num_col_dims,
+                 false);
+    output->Resize(output_dims);
+    output->set_lod(input->lod());
+
+    const int k = static_cast<int>(param.w->dims()[0]);
+    const int n = static_cast<int>(param.w->dims()[1]);
+    const int m = static_cast<int>(output->dims().production() / n);
+    acc_.Resize({m, n});
+    int32_t* acc = acc_.mutable_data<int32_t>();
+    const int8_t* in = input->data<int8_t>();
+    const int8_t* wt = wt_.data<int8_t>();
+    out_t* out = output->mutable_data<out_t>();
+    const float* bias = bias_.empty() ? nullptr : bias_.data();
+
+    // Split the rows of a large batch, or the columns of the weights.
+    if (m >= context.threads() && m >= n) {
+      context.ParallelFor(m, [&](int64_t begin, int64_t end) {
+        const int rows = static_cast<int>(end - begin);
+        lite::x86::math::gemm_s8s8(
+            rows, n, k, in + begin * k, k, wt, k, acc + begin * n, n);
+        lite::x86::math::dequantize_int32(acc + begin * n,
+                                          n,
+                                          out + begin * n,
+                                          n,
+                                          rows,
+                                          n,
+                                          scale_.data(),
+                                          bias,
+                                          false,
+                                          with_relu);
+      });
+    } else {
+      context.ParallelFor(n, [&](int64_t begin, int64_t end) {
+        const int cols = static_cast<int>(end - begin);
+        lite::x86::math::gemm_s8s8(
+            m, cols, k, in, k, wt + begin * k, k, acc + begin, n);
+        lite::x86::math::dequantize_int32(acc + begin,
+                                          n,
+                                          out + begin,
+                                          n,
+                                          m,
+                                          cols,
+                                          scale_.data() + begin,
+                                          bias ? bias + begin : nullptr,
+                                          false,
+                                          with_relu);
+      });
+    }
+  }
+
+  virtual ~FcInt8Compute() = default;
+
+ private:
+  // The weights of [N, K].
+  lite::Tensor wt_;
+  // The scales and bias of the output columns, with the output scale folded
+  // in for an int8 output.
+  std::vector<float> scale_;
+  std::vector<float> bias_;
+  lite::Tensor acc_;
 };
 
 }  // namespace x86
@@ -0,0 +1,115 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include <cstring>
+#include <vector>
+#include "lite/backends/x86/jit/helper.h"
+#include "lite/backends/x86/jit/kernel_base.h"
+#include "lite/backends/x86/jit/kernels.h"
+#include "lite/core/kernel.h"
+#include "lite/core/op_registry.h"
+#include "lite/fluid/eigen.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+/*
+ * FusedEmbeddingSeqPoolCompute sums the embedding rows of the ids of every
+ * sequence straight from the table into the output, without the [ids, width]
+ * activation of a lookup_table followed by a sequence_pool. The sequences are
+ * split over the threads of the context by their lengths.
+ */
+template <typename T>
+class FusedEmbeddingSeqPoolCompute
+    : public KernelLite<TARGET(kX86), PRECISION(kInt64)> {
+ public:
+  using param_t = operators::FusedEmbeddingSeqPoolParam;
+
+  void Run() override {
+    auto& param = *param_.get_mutable<param_t>();
+    auto& context = ctx_->As<X86Context>();
+    const auto& lod = param.Ids->lod();
+    CHECK_EQ(lod.size(), 1UL) << "The ids should have one level of LoD";
+    const auto& offsets = lod[0];
+    const int64_t batch_size = static_cast<int64_t>(offsets.size()) - 1;
+    const int64_t table_height = param.W->dims()[0];
+    const int64_t table_width = param.W->dims()[1];
+    CHECK_EQ(param.Ids->numel(), static_cast<int64_t>(offsets.back()));
+
+    param.Out->Resize({batch_size, table_width});
+    const T* table = param.W->data<T>();
+    const int64_t* ids = param.Ids->data<int64_t>();
+    T* out = param.Out->mutable_data<T>();
+    const int64_t padding_idx = param.padding_idx;
+    auto is_padding = [padding_idx](int64_t id) {
+      return padding_idx != -1 && id == padding_idx;
+    };
+
+    jit::emb_seq_pool_attr_t attr(
+        table_height, table_width, 1, 1, table_width, jit::SeqPoolType::kSum);
+    auto emb_seq_pool =
+        jit::KernelFuncs<jit::EmbSeqPoolTuple<T>, fluid::CPUPlace>::Cache().At(
+            attr);
+    auto vadd =
+        jit::KernelFuncs<jit::VAddTuple<T>, fluid::CPUPlace>::Cache().At(
+            table_width);
+
+    std::vector<int64_t> costs(batch_size);
+    for (int64_t i = 0; i < batch_size; ++i) {
+      costs[i] = static_cast<int64_t>(offsets[i + 1] - offsets[i]) + 1;
+    }
+    context.ParallelForByCost(costs, [&](int64_t begin, int64_t end) {
+      // The height of a sequence is read from the attr by the kernel.
+      jit::emb_seq_pool_attr_t seq_attr = attr;
+      for (int64_t i = begin; i < end; ++i) {
+        const int64_t* seq_ids = ids + offsets[i];
+        const int64_t seq_len = offsets[i + 1] - offsets[i];
+        T* seq_out = out + i * table_width;
+        bool has_padding = false;
+        for (int64_t j = 0; j < seq_len; ++j) {
+          if (is_padding(seq_ids[j])) {
+            has_padding = true;
+            continue;
+          }
+          CHECK_GE(seq_ids[j], 0);
+          CHECK_LT(seq_ids[j], table_height);
+        }
+        if (seq_len > 0 && !has_padding) {
+          seq_attr.index_height = seq_len;
+          emb_seq_pool(table, seq_ids, seq_out, &seq_attr);
+          continue;
+        }
+        // The padding ids and the empty sequences count as zero rows.
+        std::memset(seq_out, 0, table_width * sizeof(T));
+        for (int64_t j = 0; j < seq_len; ++j) {
+          if (is_padding(seq_ids[j])) continue;
+          vadd(table + seq_ids[j] * table_width,
+               seq_out,
+               seq_out,
+               static_cast<int>(table_width));
+        }
+      }
+    });
+  }
+
+  virtual ~FusedEmbeddingSeqPoolCompute() = default;
+};
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,114 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/fused_embedding_seq_pool_compute.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "lite/backends/x86/thread_pool.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+TEST(fused_embedding_seq_pool_x86, retrive_op) {
+  auto kernels =
+      KernelRegistry::Global().Create<TARGET(kX86), PRECISION(kInt64)>(
+          "fused_embedding_seq_pool");
+  ASSERT_FALSE(kernels.empty());
+  ASSERT_TRUE(kernels.front());
+}
+
+// The same as a lookup_table followed by a sum sequence_pool.
+void emb_seq_pool_ref(const std::vector<float>& table,
+                      const std::vector<int64_t>& ids,
+                      const std::vector<uint64_t>& offsets,
+                      int64_t width,
+                      int64_t padding_idx,
+                      std::vector<float>* out) {
+  out->assign((offsets.size() - 1) * width, 0.f);
+  for (size_t i = 0; i + 1 < offsets.size(); i++) {
+    for (uint64_t j = offsets[i]; j < offsets[i + 1]; j++) {
+      if (padding_idx != -1 && ids[j] == padding_idx) continue;
+      for (int64_t k = 0; k < width; k++) {
+        (*out)[i * width + k] += table[ids[j] * width + k];
+      }
+    }
+  }
+}
+
+void test_fused_embedding_seq_pool(int threads,
+                                   int64_t width,
+                                   int64_t padding_idx) {
+  const int64_t vocab_size = 37;
+  // Ragged sequences, with an empty one.
+  std::vector<uint64_t> offsets{0, 3, 3, 10, 11, 30, 34};
+  lite::Tensor w, ids, out;
+  w.Resize({vocab_size, width});
+  ids.Resize({static_cast<int64_t>(offsets.back()), 1});
+  ids.set_lod({offsets});
+  auto* w_data = w.mutable_data<float>();
+  auto* ids_data = ids.mutable_data<int64_t>();
+  std::vector<float> table(vocab_size * width);
+  std::vector<int64_t> id_values(offsets.back());
+  for (int64_t i = 0; i < vocab_size * width; i++) {
+    table[i] = w_data[i] = static_cast<float>(i % 17) / 17.f - 0.5f;
+  }
+  for (size_t i = 0; i < id_values.size(); i++) {
+    id_values[i] = ids_data[i] = (i * 7) % vocab_size;
+  }
+
+  FusedEmbeddingSeqPoolCompute<float> kernel;
+  operators::FusedEmbeddingSeqPoolParam param;
+  param.W = &w;
+  param.Ids = &ids;
+  param.Out = &out;
+  param.padding_idx = padding_idx;
+  std::unique_ptr<KernelContext> ctx(new KernelContext);
+  ctx->As<X86Context>().SetThreadPool(
+      std::make_shared<lite::x86::ThreadPool>(threads));
+  kernel.SetContext(std::move(ctx));
+  kernel.SetParam(param);
+  kernel.Launch();
+
+  std::vector<float> ref;
+  emb_seq_pool_ref(table, id_values, offsets, width, padding_idx, &ref);
+  ASSERT_EQ(out.dims(), DDim({6, width}));
+  auto* out_data = out.data<float>();
+  for (size_t i = 0; i < ref.size(); i++) {
+    ASSERT_NEAR(out_data[i], ref[i], 1e-5)
+        << "threads " << threads << " width " << width << " padding_idx "
+        << padding_idx;
+  }
+}
+
+TEST(fused_embedding_seq_pool_x86, run_test) {
+  for (int threads : {1, 4}) {
+    for (int64_t width : {8, 13, 64}) {
+      for (int64_t padding_idx : {-1, 14}) {
+        test_fused_embedding_seq_pool(threads, width, padding_idx);
+      }
+    }
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(fused_embedding_seq_pool, kX86, kInt64, kNCHW, def);
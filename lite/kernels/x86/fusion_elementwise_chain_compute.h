@@ -0,0 +1,247 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include "lite/backends/x86/jit/helper.h"
+#include "lite/backends/x86/jit/kernel_base.h"
+#include "lite/backends/x86/jit/kernels.h"
+#include "lite/core/kernel.h"
+#include "lite/core/op_registry.h"
+#include "lite/kernels/x86/elementwise_op_function.h"
+#include "lite/kernels/x86/vector_for.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+// The jit op of a step of fusion_elementwise_chain.
+inline jit::ElementwiseChainOp ElementwiseChainStepOp(const std::string& type) {
+  static const std::map<std::string, jit::ElementwiseChainOp> ops{
+      {"elementwise_add", jit::kChainAdd},
+      {"elementwise_sub", jit::kChainSub},
+      {"elementwise_mul", jit::kChainMul},
+      {"elementwise_div", jit::kChainDiv},
+      {"elementwise_max", jit::kChainMax},
+      {"elementwise_min", jit::kChainMin},
+      {"relu", jit::kChainRelu},
+      {"relu6", jit::kChainClip},
+      {"leaky_relu", jit::kChainLeakyRelu},
+      {"sigmoid", jit::kChainSigmoid},
+      {"tanh", jit::kChainTanh},
+      {"exp", jit::kChainExp},
+      {"square", jit::kChainSquare},
+      {"sqrt", jit::kChainSqrt},
+      {"abs", jit::kChainAbs},
+      {"scale", jit::kChainScale},
+      {"cast", jit::kChainIdentity}};
+  auto it = ops.find(type);
+  CHECK(it != ops.end()) << "Unsupported step of fusion_elementwise_chain: "
+                         << type;
+  return it->second;
+}
+
+// The [pre, n, post] of X which Y of [n] at axis is broadcast to, false for
+// the broadcasts in the middle of Y.
+inline bool ElementwiseChainBroadcastDims(const lite::DDim& x_dims,
+                                          const lite::DDim& y_dims,
+                                          int axis,
+                                          int64_t* pre,
+                                          int64_t* n,
+                                          int64_t* post) {
+  const int rank = static_cast<int>(x_dims.size());
+  axis = axis == -1 ? rank - static_cast<int>(y_dims.size()) : axis;
+  auto y_trimmed = trim_trailing_singular_dims(y_dims);
+  const int y_rank = static_cast<int>(y_trimmed.size());
+  if (axis < 0 || axis + y_rank > rank) return false;
+  for (int i = 0; i < y_rank; ++i) {
+    if (x_dims[axis + i] != y_trimmed[i]) return false;
+  }
+  *pre = x_dims.count(0, axis);
+  *n = x_dims.count(axis, axis + y_rank);
+  *post = x_dims.count(axis + y_rank, rank);
+  return true;
+}
+
+// Writes Y broadcast at axis to the shape of X, for any dimension of Y being
+// the one of X or 1.
+template <typename T>
+void ElementwiseChainExpand(const lite::DDim& x_dims,
+                            const lite::Tensor& y,
+                            int axis,
+                            T* out) {
+  const int rank = static_cast<int>(x_dims.size());
+  axis = axis == -1 ? rank - static_cast<int>(y.dims().size()) : axis;
+  auto y_dims = trim_trailing_singular_dims(y.dims());
+  const int y_rank = static_cast<int>(y_dims.size());
+  CHECK(axis >= 0 && axis + y_rank <= rank)
+      << "Broadcast " << y.dims() << " to " << x_dims << " at axis " << axis;
+  // The stride of Y along every dimension of X, 0 where it is broadcast.
+  std::vector<int64_t> strides(rank, 0);
+  int64_t stride = 1;
+  for (int d = y_rank - 1; d >= 0; --d) {
+    CHECK(y_dims[d] == x_dims[axis + d] || y_dims[d] == 1)
+        << "Broadcast " << y.dims() << " to " << x_dims << " at axis " << axis;
+    strides[axis + d] = y_dims[d] == 1 ? 0 : stride;
+    stride *= y_dims[d];
+  }
+  const T* y_data = y.data<T>();
+  std::vector<int64_t> index(rank, 0);
+  int64_t offset = 0;
+  for (int64_t i = 0; i < x_dims.production(); ++i) {
+    out[i] = y_data[offset];
+    for (int d = rank - 1; d >= 0; --d) {
+      offset += strides[d];
+      if (++index[d] < x_dims[d]) break;
+      offset -= strides[d] * x_dims[d];
+      index[d] = 0;
+    }
+  }
+}
+
+/*
+ * Runs all the steps of the chain with a single jit kernel, which reads every
+ * input and writes every output once:
+ *   the inputs of the shape of X[0] and of a single value go to the kernel as
+ *   they are;
+ *   the inputs Y of [n] at axis in X[0] of [pre, n, post] run the kernel on
+ *   the rows of n if post is 1, and on the runs of post with Y as a single
+ *   value otherwise. All of them have to be broadcast the same way;
+ *   the other inputs are expanded to the shape of X[0] first.
+ */
+template <typename T>
+class FusionElementwiseChainCompute
+    : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
+ public:
+  using param_t = operators::FusionElementwiseChainParam;
+  using ChainFuncs =
+      jit::KernelFuncs<jit::ElementwiseChainTuple<T>, fluid::CPUPlace>;
+
+  void PrepareForRun() override {
+    auto& param = *param_.get_mutable<param_t>();
+    const int num_inputs = static_cast<int>(param.X.size());
+    CHECK_LE(num_inputs + param.step_types.size(),
+             static_cast<size_t>(jit::kElementwiseChainMaxValues));
+    attr_.num_inputs = num_inputs;
+    attr_.steps.clear();
+    input_axes_.assign(num_inputs, -1);
+    std::vector<bool> has_axis(num_inputs, false);
+    for (size_t s = 0; s < param.step_types.size(); ++s) {
+      const int b = param.operands[2 * s + 1];
+      attr_.steps.emplace_back(ElementwiseChainStepOp(param.step_types[s]),
+                               param.operands[2 * s],
+                               b,
+                               param.alphas[s],
+                               param.betas[s]);
+      if (b >= 0 && b < num_inputs && !has_axis[b]) {
+        input_axes_[b] = param.axes[s];
+        has_axis[b] = true;
+      }
+    }
+    attr_.outputs = param.out_values;
+    attr_.scalar_inputs.assign(num_inputs, 0);
+    workspaces_.resize(num_inputs);
+  }
+
+  void Run() override {
+    auto& param = *param_.get_mutable<param_t>();
+    auto& context = ctx_->As<X86Context>();
+    const auto& x_dims = param.X[0]->dims();
+    const int64_t numel = x_dims.production();
+    const int num_inputs = attr_.num_inputs;
+
+    enum { kFull, kScalar, kBroadcast };
+    std::vector<int> kinds(num_inputs, kFull);
+    std::vector<const T*> in_data(num_inputs);
+    int64_t pre = 1, n = 1, post = 1;
+    bool broadcast = false;
+    for (int k = 0; k < num_inputs; ++k) {
+      const auto* in = param.X[k];
+      in_data[k] = in->template data<T>();
+      if (in->numel() == numel) continue;
+      if (in->numel() == 1) {
+        kinds[k] = kScalar;
+        continue;
+      }
+      int64_t p, m, q;
+      bool runs = ElementwiseChainBroadcastDims(
+          x_dims, in->dims(), input_axes_[k], &p, &m, &q);
+      // The runs shorter than a ymm go faster expanded.
+      runs = runs && (q == 1 || q >= YMM_FLOAT_BLOCK);
+      if (runs && (!broadcast || (p == pre && m == n && q == post))) {
+        kinds[k] = kBroadcast;
+        pre = p;
+        n = m;
+        post = q;
+        broadcast = true;
+      } else {
+        workspaces_[k].Resize(x_dims);
+        T* expanded = workspaces_[k].template mutable_data<T>();
+        ElementwiseChainExpand<T>(x_dims, *in, input_axes_[k], expanded);
+        in_data[k] = expanded;
+      }
+    }
+    for (int k = 0; k < num_inputs; ++k) {
+      attr_.scalar_inputs[k] =
+          kinds[k] == kScalar || (kinds[k] == kBroadcast && post > 1);
+    }
+    auto compute = ChainFuncs::Cache().At(attr_);
+
+    std::vector<T*> out_data;
+    for (auto* out : param.Out) {
+      out_data.push_back(out->template mutable_data<T>());
+    }
+    const int num_outputs = static_cast<int>(out_data.size());
+    int64_t rows = 1, cols = numel;
+    if (broadcast) {
+      rows = post == 1 ? pre : pre * n;
+      cols = post == 1 ? n : post;
+    }
+    VectorFor(context, rows, cols, [&](int64_t row, int64_t col, int len) {
+      const T* inputs[jit::kElementwiseChainMaxValues];
+      T* outputs[jit::kElementwiseChainMaxValues];
+      const int64_t offset = row * cols + col;
+      for (int k = 0; k < num_inputs; ++k) {
+        if (kinds[k] == kFull) {
+          inputs[k] = in_data[k] + offset;
+        } else if (kinds[k] == kScalar) {
+          inputs[k] = in_data[k];
+        } else {
+          inputs[k] = in_data[k] + (post == 1 ? col : row % n);
+        }
+      }
+      for (int k = 0; k < num_outputs; ++k) {
+        outputs[k] = out_data[k] + offset;
+      }
+      compute(inputs, outputs, len, &attr_);
+    });
+  }
+
+  virtual ~FusionElementwiseChainCompute() = default;
+
+ private:
+  jit::elementwise_chain_attr_t attr_;
+  // The broadcast axis of every input.
+  std::vector<int> input_axes_;
+  std::vector<lite::Tensor> workspaces_;
+};
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,314 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/fusion_elementwise_chain_compute.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lite/backends/x86/cpu_info.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+TEST(fusion_elementwise_chain_x86, retrive_op) {
+  auto chain =
+      KernelRegistry::Global().Create<TARGET(kX86), PRECISION(kFloat)>(
+          "fusion_elementwise_chain");
+  ASSERT_FALSE(chain.empty());
+  ASSERT_TRUE(chain.front());
+}
+
+TEST(fusion_elementwise_chain_x86, init) {
+  FusionElementwiseChainCompute<float> chain;
+  ASSERT_EQ(chain.precision(), PRECISION(kFloat));
+  ASSERT_EQ(chain.target(), TARGET(kX86));
+}
+
+void FillTensor(lite::Tensor* t,
+                const std::vector<int64_t>& shape,
+                int seed) {
+  t->Resize(lite::DDim(shape));
+  auto* data = t->mutable_data<float>();
+  for (int64_t i = 0; i < t->numel(); i++) {
+    data[i] = ((i * 7 + seed) % 13 - 6) / 4.f;
+  }
+}
+
+void RunChain(operators::FusionElementwiseChainParam* param, int threads) {
+  FusionElementwiseChainCompute<float> chain;
+  std::unique_ptr<KernelContext> ctx(new KernelContext);
+  ctx->As<X86Context>().SetThreadPool(
+      std::make_shared<lite::x86::ThreadPool>(threads));
+  for (auto* out : param->Out) {
+    out->Resize(param->X[0]->dims());
+  }
+  chain.SetParam(*param);
+  chain.SetContext(std::move(ctx));
+  chain.PrepareForRun();
+  chain.Run();
+}
+
+// out0 = scale(relu(x + y), 0.5, 1), out1 = x + y, with y of the shape of x.
+TEST(fusion_elementwise_chain_x86, run_same_shape) {
+  for (int64_t size : {1, 7, 8, 100, 40000}) {
+    lite::Tensor x, y, out0, out1;
+    FillTensor(&x, {size}, 0);
+    FillTensor(&y, {size}, 5);
+    operators::FusionElementwiseChainParam param;
+    param.X = {&x, &y};
+    param.Out = {&out0, &out1};
+    param.step_types = {"elementwise_add", "relu", "scale"};
+    param.operands = {0, 1, 2, -1, 3, -1};
+    param.axes = {-1, -1, -1};
+    param.alphas = {0.f, 0.f, 0.5f};
+    param.betas = {0.f, 0.f, 1.f};
+    param.out_values = {4, 2};
+    RunChain(&param, 2);
+
+    const float* x_data = x.data<float>();
+    const float* y_data = y.data<float>();
+    for (int64_t i = 0; i < size; i++) {
+      const float sum = x_data[i] + y_data[i];
+      EXPECT_NEAR(out1.data<float>()[i], sum, 1e-6);
+      EXPECT_NEAR(out0.data<float>()[i], 0.5f * std::max(sum, 0.f) + 1, 1e-6);
+    }
+  }
+}
+
+// out = tanh(sigmoid(x * a + b) - c), with a per channel, b per column and c
+// a single value, so that b is expanded.
+TEST(fusion_elementwise_chain_x86, run_broadcast) {
+  const std::vector<int64_t> x_shape{2, 3, 4, 20};
+  lite::Tensor x, a, b, c, out;
+  FillTensor(&x, x_shape, 0);
+  FillTensor(&a, {3}, 1);
+  FillTensor(&b, {20}, 2);
+  FillTensor(&c, {1}, 3);
+  operators::FusionElementwiseChainParam param;
+  param.X = {&x, &a, &b, &c};
+  param.Out = {&out};
+  param.step_types = {
+      "elementwise_mul", "elementwise_add", "sigmoid", "elementwise_sub",
+      "tanh"};
+  param.operands = {0, 1, 4, 2, 5, -1, 6, 3, 7, -1};
+  param.axes = {1, -1, -1, -1, -1};
+  param.alphas = std::vector<float>(5, 0.f);
+  param.betas = std::vector<float>(5, 0.f);
+  param.out_values = {8};
+  for (int threads : {1, 4}) {
+    RunChain(&param, threads);
+    for (int64_t i = 0; i < x.numel(); i++) {
+      const float v = x.data<float>()[i] * a.data<float>()[i / 80 % 3] +
+                      b.data<float>()[i % 20];
+      const float s = 1.f / (1.f + std::exp(-v));
+      EXPECT_NEAR(out.data<float>()[i], std::tanh(s - c.data<float>()[0]),
+                  1e-5);
+    }
+  }
+}
+
+// The unary steps one after the other, every value written out.
+TEST(fusion_elementwise_chain_x86, run_unary) {
+  lite::Tensor x, y;
+  FillTensor(&x, {3, 37}, 0);
+  FillTensor(&y, {37}, 4);
+  std::vector<lite::Tensor> outs(8);
+  operators::FusionElementwiseChainParam param;
+  param.X = {&x, &y};
+  for (auto& out : outs) {
+    param.Out.push_back(&out);
+  }
+  param.step_types = {"leaky_relu",
+                      "relu6",
+                      "elementwise_max",
+                      "abs",
+                      "sqrt",
+                      "square",
+                      "exp",
+                      "elementwise_div"};
+  // Every step goes on the one before, the max and the div also take y, and
+  // the div takes the leaky_relu again, from the stack of the jit kernel.
+  param.operands = {0, -1, 2, -1, 3, 1, 4, -1, 5, -1, 6, -1, 7, -1, 2, 8};
+  param.axes = std::vector<int>(8, -1);
+  param.alphas = {0.1f, 0.5f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f};
+  param.betas = std::vector<float>(8, 0.f);
+  param.out_values = {2, 3, 4, 5, 6, 7, 8, 9};
+  RunChain(&param, 1);
+
+  for (int64_t i = 0; i < x.numel(); i++) {
+    const float xi = x.data<float>()[i];
+    const float yi = y.data<float>()[i % 37];
+    const float leaky = xi > 0 ? xi : 0.1f * xi;
+    const float clip = std::min(std::max(leaky, 0.f), 0.5f);
+    const float max = std::max(clip, yi);
+    const float sq = std::sqrt(std::abs(max));
+    const float e = std::exp(sq * sq);
+    std::vector<float> expected{
+        leaky, clip, max, std::abs(max), sq, sq * sq, e, leaky / e};
+    for (size_t k = 0; k < outs.size(); k++) {
+      EXPECT_NEAR(outs[k].data<float>()[i], expected[k], 1e-5)
+          << param.step_types[k] << " at " << i;
+    }
+  }
+}
+
+// A random chain of at least `num_steps` steps, taking every op once in each
+// run of kChainIdentity + 1 steps. The operands are often the value of the
+// step before, which the jit code keeps in a register, else older values,
+// which it spills to the stack, or the inputs. The div only divides by an
+// input, and exp and sqrt go on a tanh and an abs, so that the values stay
+// finite.
+jit::elementwise_chain_attr_t RandomChain(int num_inputs,
+                                          int num_steps,
+                                          std::mt19937* rng) {
+  const int num_ops = jit::kChainIdentity + 1;
+  std::vector<jit::ElementwiseChainOp> ops;
+  while (static_cast<int>(ops.size()) < num_steps) {
+    std::vector<jit::ElementwiseChainOp> run;
+    for (int op = 0; op < num_ops; ++op) {
+      run.push_back(static_cast<jit::ElementwiseChainOp>(op));
+    }
+    std::shuffle(run.begin(), run.end(), *rng);
+    ops.insert(ops.end(), run.begin(), run.end());
+  }
+  ops.resize(num_steps);
+
+  jit::elementwise_chain_attr_t attr;
+  attr.num_inputs = num_inputs;
+  for (int i = 0; i < num_inputs; ++i) {
+    attr.scalar_inputs.push_back((*rng)() % 4 == 0);
+  }
+  auto random_value = [&]() {
+    const int num_values = num_inputs + static_cast<int>(attr.steps.size());
+    if (!attr.steps.empty() && (*rng)() % 2 == 0) return num_values - 1;
+    return static_cast<int>((*rng)() % num_values);
+  };
+  auto random_float = [&](float lower, float upper) {
+    return std::uniform_real_distribution<float>(lower, upper)(*rng);
+  };
+  for (auto op : ops) {
+    int a = random_value();
+    int b = -1;
+    if (op <= jit::kChainMin) {
+      b = op == jit::kChainDiv ? static_cast<int>((*rng)() % num_inputs)
+                               : random_value();
+    } else if (op == jit::kChainExp || op == jit::kChainSqrt) {
+      attr.steps.emplace_back(
+          op == jit::kChainExp ? jit::kChainTanh : jit::kChainAbs, a);
+      a = num_inputs + static_cast<int>(attr.steps.size()) - 1;
+    }
+    float alpha = 0.f;
+    float beta = 0.f;
+    if (op == jit::kChainClip) {
+      alpha = random_float(0.5f, 6.f);
+    } else if (op == jit::kChainLeakyRelu) {
+      alpha = random_float(0.01f, 0.5f);
+    } else if (op == jit::kChainScale) {
+      alpha = random_float(-2.f, 2.f);
+      beta = random_float(-1.f, 1.f);
+    }
+    attr.steps.emplace_back(op, a, b, alpha, beta);
+  }
+
+  const int num_values = num_inputs + static_cast<int>(attr.steps.size());
+  for (int v = num_inputs; v < num_values - 1; ++v) {
+    if ((*rng)() % 3 == 0) attr.outputs.push_back(v);
+  }
+  attr.outputs.push_back(num_values - 1);
+  return attr;
+}
+
+// Every implementation of the jit kernel, the Xbyak one if the CPU has avx2,
+// against the refer one, on random chains and on sizes with and without a
+// tail of less than 8 elements.
+TEST(fusion_elementwise_chain_x86, jit_gen_vs_refer) {
+  using Tuple = jit::ElementwiseChainTuple<float>;
+  std::mt19937 rng(100);
+  for (int num_inputs : {1, 2, 5}) {
+    for (int num_steps : {1, 3, 17, 40}) {
+      auto attr = RandomChain(num_inputs, num_steps, &rng);
+      auto funcs =
+          jit::GetAllCandidateFuncsWithTypes<Tuple, fluid::CPUPlace>(attr);
+#if !defined(_WIN32) && !defined(__APPLE__) && !defined(__OSX__)
+      if (lite::x86::MayIUse(lite::x86::avx2)) {
+        bool has_gen = false;
+        for (auto& func : funcs) {
+          has_gen = has_gen || func.first == "JitCode";
+        }
+        EXPECT_TRUE(has_gen);
+      }
+#endif
+      auto refer = jit::GetReferFunc<Tuple>();
+
+      for (int n : {1, 7, 8, 9, 15, 16, 31, 100, 1003}) {
+        std::vector<std::vector<float>> inputs(num_inputs);
+        std::vector<const float*> input_ptrs;
+        for (auto& input : inputs) {
+          input.resize(n);
+          for (auto& x : input) {
+            // Away from 0, they are also the divisors.
+            x = std::uniform_real_distribution<float>(0.5f, 2.f)(rng);
+            x = rng() % 2 ? x : -x;
+          }
+          input_ptrs.push_back(input.data());
+        }
+        const size_t num_outputs = attr.outputs.size();
+        std::vector<std::vector<float>> expected(num_outputs);
+        std::vector<float*> expected_ptrs;
+        for (auto& out : expected) {
+          out.resize(n);
+          expected_ptrs.push_back(out.data());
+        }
+        refer(input_ptrs.data(), expected_ptrs.data(), n, &attr);
+
+        for (auto& func : funcs) {
+          std::vector<std::vector<float>> outputs(num_outputs);
+          std::vector<float*> output_ptrs;
+          for (auto& out : outputs) {
+            out.assign(n, NAN);
+            output_ptrs.push_back(out.data());
+          }
+          func.second(input_ptrs.data(), output_ptrs.data(), n, &attr);
+          for (size_t k = 0; k < num_outputs; ++k) {
+            for (int i = 0; i < n; ++i) {
+              const float ref = expected[k][i];
+              ASSERT_TRUE(std::isfinite(ref));
+              EXPECT_NEAR(outputs[k][i],
+                          ref,
+                          1e-3f * std::max(1.f, std::abs(ref)))
+                  << func.first << ", " << num_inputs << " inputs, "
+                  << attr.steps.size() << " steps, output " << k << " at "
+                  << i << " of " << n;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(fusion_elementwise_chain, kX86, kFloat, kNCHW, def);
@@ -14,10 +14,6 @@
 
 #include "lite/kernels/x86/gru_compute.h"
 
-DEFINE_int32(paddle_num_threads,
-             1,
-             "Number of threads for each paddle instance.");
-
 REGISTER_LITE_KERNEL(gru,
                      kX86,
                      kFloat,
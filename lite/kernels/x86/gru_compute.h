@@ -13,11 +13,13 @@
 // limitations under the License.
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 #include "lite/backends/x86/math/blas.h"
 #include "lite/backends/x86/math/detail/gru_cpu_kernel.h"
 #include "lite/backends/x86/math/detail/gru_kernel.h"
+#include "lite/backends/x86/math/gemm_packed.h"
 #include "lite/backends/x86/math/gru_compute.h"
 #include "lite/backends/x86/math/math_function.h"
 #include "lite/backends/x86/math/sequence2batch.h"
@@ -26,8 +28,6 @@
 #include "lite/core/types.h"
 #include "lite/fluid/eigen.h"
 
-DECLARE_int32(paddle_num_threads);
-
 namespace paddle {
 namespace lite {
 namespace kernels {
@@ -47,9 +47,36 @@ inline void ReorderInitState(const lite::Context<TARGET(kX86)>& context,
   row_shuffle(context, src, index_lod, dst, indexed_src);
 }
 
+/*
+ * GRUCompute packs the gate and state weights once in PrepareForRun, the
+ * packs are shared by the kernels of the clones of a predictor, and the GEMMs
+ * of every step run on them.
+ */
 template <typename T>
 class GRUCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
  public:
+  void PrepareForRun() override {
+    auto& context = ctx_->As<X86Context>();
+    auto& param = *param_.get_mutable<operators::GRUParam>();
+    auto* weight = param.weight;
+    const int frame_size = weight->dims()[0];
+    CHECK_EQ(weight->dims()[1], frame_size * 3);
+    const T* weight_data = weight->data<T>();
+    packed_gate_ = lite::x86::math::PackedGemm<T>::Share(context,
+                                                         *weight,
+                                                         frame_size,
+                                                         frame_size * 2,
+                                                         weight_data,
+                                                         frame_size * 2);
+    packed_state_ = lite::x86::math::PackedGemm<T>::Share(
+        context,
+        *weight,
+        frame_size,
+        frame_size,
+        weight_data + 2 * frame_size * frame_size,
+        frame_size);
+  }
+
   void Run() override {
     auto& context = ctx_->As<X86Context>();
     auto& param = *param_.get_mutable<operators::GRUParam>();
@@ -107,112 +134,64 @@ class GRUCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
     auto active_gate =
         lite::x86::math::detail::GetActivationType(param.gate_activation);
 
-#ifdef PADDLE_WITH_MKLML
-    // use MKL packed to speedup GEMM
-    if (FLAGS_paddle_num_threads >= 4) {
-      auto blas = lite::x86::math::GetBlas<TARGET(kX86), T>(context);
-      T* packed_gate = blas.GEMM_ALLOC(CblasBMatrix,
-                                       1 /*height of C*/,
-                                       frame_size * 2 /*width of weight*/,
-                                       frame_size /*height of height*/);
-      CHECK(packed_gate);
-      blas.GEMM_PACK(CblasBMatrix,
-                     CblasNoTrans,
-                     1 /*cur bs?*/,
-                     frame_size * 2,
-                     frame_size,
-                     T(1.0),
-                     gru_value.gate_weight,
-                     frame_size * 2,
-                     packed_gate);
-      T* packed_state = blas.GEMM_ALLOC(CblasBMatrix,
-                                        1 /*height of C*/,
-                                        frame_size /*width of weight*/,
-                                        frame_size /*height of height*/);
-      CHECK(packed_state);
-      blas.GEMM_PACK(CblasBMatrix,
-                     CblasNoTrans,
-                     1 /*cur bs?*/,
-                     frame_size,
-                     frame_size,
-                     T(1.0),
-                     gru_value.state_weight,
-                     frame_size,
-                     packed_state);
-      for (size_t n = 0; n < seq_len; n++) {
-        int64_t bstart = static_cast<int64_t>(batch_starts[n]);
-        int64_t bend = static_cast<int64_t>(batch_starts[n + 1]);
-        int64_t cur_batch_size = bend - bstart;
-
-        Tensor gate_t = batch_gate->Slice<T>(bstart, bend);
-        Tensor reset_hidden_prev_t =
-            batch_reset_hidden_prev->Slice<T>(bstart, bend);
-        Tensor hidden_t = batch_hidden->Slice<T>(bstart, bend);
-        gru_value.output_value = hidden_t.mutable_data<T>();
-        gru_value.gate_value = gate_t.mutable_data<T>();
-        gru_value.reset_output_value = reset_hidden_prev_t.mutable_data<T>();
-
-        if (gru_value.prev_out_value) {
-          blas.GEMM_COMPUTE(CblasNoTrans,
-                            CblasPacked,
-                            cur_batch_size,
-                            frame_size * 2,
-                            frame_size,
-                            gru_value.prev_out_value,
-                            frame_size,
-                            packed_gate,
-                            frame_size * 2,
-                            T(1),
-                            gru_value.gate_value,
-                            frame_size * 3);
-        }
-
-        lite::x86::math::detail::forward_final_output(
-            lite::x86::math::detail::forward::gru_finalOutput<T>(),
-            gru_value,
-            frame_size,
-            cur_batch_size,
-            active_node,
-            origin_mode);
-
-        gru_value.prev_out_value = gru_value.output_value;
+    for (size_t n = 0; n < seq_len; n++) {
+      int64_t bstart = static_cast<int64_t>(batch_starts[n]);
+      int64_t bend = static_cast<int64_t>(batch_starts[n + 1]);
+      int64_t cur_batch_size = bend - bstart;
+
+      Tensor gate_t = batch_gate->Slice<T>(bstart, bend);
+      Tensor reset_hidden_prev_t =
+          batch_reset_hidden_prev->Slice<T>(bstart, bend);
+      Tensor hidden_t = batch_hidden->Slice<T>(bstart, bend);
+      gru_value.output_value = hidden_t.mutable_data<T>();
+      gru_value.gate_value = gate_t.mutable_data<T>();
+      gru_value.reset_output_value = reset_hidden_prev_t.mutable_data<T>();
+
+      if (gru_value.prev_out_value) {
+        packed_gate_->Compute(context,
+                              cur_batch_size,
+                              gru_value.prev_out_value,
+                              frame_size,
+                              T(1),
+                              gru_value.gate_value,
+                              frame_size * 3);
       }
 
-      blas.GEMM_FREE(packed_gate);
-      blas.GEMM_FREE(packed_state);
-    } else {
-#endif
-      for (size_t n = 0; n < seq_len; n++) {
-        int64_t bstart = static_cast<int64_t>(batch_starts[n]);
-        int64_t bend = static_cast<int64_t>(batch_starts[n + 1]);
-        int64_t cur_batch_size = bend - bstart;
-
-        Tensor gate_t = batch_gate->Slice<T>(bstart, bend);
-        Tensor reset_hidden_prev_t =
-            batch_reset_hidden_prev->Slice<T>(bstart, bend);
-        Tensor hidden_t = batch_hidden->Slice<T>(bstart, bend);
-        gru_value.output_value = hidden_t.mutable_data<T>();
-        gru_value.gate_value = gate_t.mutable_data<T>();
-        gru_value.reset_output_value = reset_hidden_prev_t.mutable_data<T>();
-
-        lite::x86::math::GRUUnitFunctor<TARGET(kX86), T>::compute(
-            context,
-            gru_value,
-            frame_size,
-            cur_batch_size,
-            active_node,
-            active_gate,
-            origin_mode);
-
-        gru_value.prev_out_value = gru_value.output_value;
+      lite::x86::math::detail::forward_reset_output(
+          lite::x86::math::detail::forward::gru_resetOutput<T>(),
+          gru_value,
+          frame_size,
+          cur_batch_size,
+          active_gate);
+
+      if (gru_value.prev_out_value) {
+        packed_state_->Compute(context,
+                               cur_batch_size,
+                               gru_value.reset_output_value,
+                               frame_size,
+                               T(1),
+                               gru_value.gate_value + frame_size * 2,
+                               frame_size * 3);
       }
-#ifdef PADDLE_WITH_MKLML
+
+      lite::x86::math::detail::forward_final_output(
+          lite::x86::math::detail::forward::gru_finalOutput<T>(),
+          gru_value,
+          frame_size,
+          cur_batch_size,
+          active_node,
+          origin_mode);
+
+      gru_value.prev_out_value = gru_value.output_value;
     }
-#endif
     lite::x86::math::Batch2LoDTensorFunctor<TARGET(kX86), T> to_seq;
     batch_hidden->set_lod(batch_gate->lod());
     to_seq(context, *batch_hidden, hidden);
   }
+
+ private:
+  std::shared_ptr<const lite::x86::math::PackedGemm<T>> packed_gate_;
+  std::shared_ptr<const lite::x86::math::PackedGemm<T>> packed_state_;
 };
 
 }  // namespace x86
@@ -14,6 +14,7 @@
 
 #include "lite/kernels/x86/gru_compute.h"
 #include <gtest/gtest.h>
+#include <cmath>
 #include <iostream>
 #include <memory>
 #include <utility>
@@ -100,6 +101,7 @@ TEST(gru_x86, run_test) {
   ctx->As<X86Context>();
   gru.SetContext(std::move(ctx));
   gru.SetParam(param);
+  gru.PrepareForRun();
   gru.Run();
 
   auto batch_gate_data = batch_gate.mutable_data<float>();
@@ -147,6 +149,101 @@ TEST(gru_x86, run_test) {
   }
 }
 
+// The packed weights are reused by the runs, the steps are checked against a
+// GRU of every sequence on its own.
+TEST(gru_x86, run_packed) {
+  const int frame_size = 20;
+  const std::vector<uint64_t> offsets{0, 2, 6, 9};
+  const int seqs = offsets.size() - 1;
+  const int rows = offsets.back();
+
+  lite::Tensor input, h0, weight, bias;
+  lite::Tensor batch_gate, batch_reset_hidden_prev, batch_hidden, hidden;
+  input.Resize({rows, frame_size * 3});
+  input.set_lod({offsets});
+  h0.Resize({seqs, frame_size});
+  weight.Resize({frame_size, frame_size * 3});
+  bias.Resize({1, frame_size * 3});
+  batch_gate.Resize({rows, frame_size * 3});
+  batch_reset_hidden_prev.Resize({rows, frame_size});
+  batch_hidden.Resize({rows, frame_size});
+  hidden.Resize({rows, frame_size});
+
+  auto fill = [](lite::Tensor* t, int seed) {
+    auto* data = t->mutable_data<float>();
+    for (int64_t i = 0; i < t->numel(); ++i) {
+      data[i] = ((i * 7 + seed) % 17 - 8) / 16.f;
+    }
+  };
+  fill(&input, 1);
+  fill(&h0, 2);
+  fill(&weight, 3);
+  fill(&bias, 4);
+
+  auto sigmoid = [](float x) { return 1.f / (1.f + std::exp(-x)); };
+  const float* x = input.data<float>();
+  const float* w = weight.data<float>();
+  const float* b = bias.data<float>();
+  std::vector<float> ref(rows * frame_size);
+  for (int s = 0; s < seqs; ++s) {
+    std::vector<float> h(h0.data<float>() + s * frame_size,
+                         h0.data<float>() + (s + 1) * frame_size);
+    for (uint64_t t = offsets[s]; t < offsets[s + 1]; ++t) {
+      std::vector<float> u(frame_size), r(frame_size);
+      for (int j = 0; j < frame_size; ++j) {
+        float su = x[t * frame_size * 3 + j] + b[j];
+        float sr = x[t * frame_size * 3 + frame_size + j] + b[frame_size + j];
+        for (int k = 0; k < frame_size; ++k) {
+          su += h[k] * w[k * frame_size * 2 + j];
+          sr += h[k] * w[k * frame_size * 2 + frame_size + j];
+        }
+        u[j] = sigmoid(su);
+        r[j] = sigmoid(sr);
+      }
+      const float* state_w = w + 2 * frame_size * frame_size;
+      for (int j = 0; j < frame_size; ++j) {
+        float sc = x[t * frame_size * 3 + 2 * frame_size + j] +
+                   b[2 * frame_size + j];
+        for (int k = 0; k < frame_size; ++k) {
+          sc += r[k] * h[k] * state_w[k * frame_size + j];
+        }
+        ref[t * frame_size + j] = (1 - u[j]) * h[j] + u[j] * std::tanh(sc);
+      }
+      std::copy(ref.begin() + t * frame_size,
+                ref.begin() + (t + 1) * frame_size,
+                h.begin());
+    }
+  }
+
+  GRUCompute<float> gru;
+  operators::GRUParam param;
+  param.input = &input;
+  param.h0 = &h0;
+  param.weight = &weight;
+  param.bias = &bias;
+  param.batch_gate = &batch_gate;
+  param.batch_reset_hidden_prev = &batch_reset_hidden_prev;
+  param.batch_hidden = &batch_hidden;
+  param.hidden = &hidden;
+  param.gate_activation = "sigmoid";
+  param.activation = "tanh";
+  param.is_reverse = false;
+  param.origin_mode = false;
+
+  std::unique_ptr<KernelContext> ctx(new KernelContext);
+  ctx->As<X86Context>();
+  gru.SetContext(std::move(ctx));
+  gru.SetParam(param);
+  gru.PrepareForRun();
+  for (int run = 0; run < 2; ++run) {
+    gru.Run();
+    const float* hidden_data = hidden.data<float>();
+    for (int i = 0; i < rows * frame_size; ++i) {
+      EXPECT_NEAR(hidden_data[i], ref[i], 1e-4);
+    }
+  }
+}
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
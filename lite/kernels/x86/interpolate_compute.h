@@ -0,0 +1,206 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "lite/core/kernel.h"
+#include "lite/core/op_registry.h"
+#include "lite/operators/interpolate_op.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+// The output size, from SizeTensor, OutSize, Scale, the scale attr or the
+// out_h and out_w attrs, in that order.
+inline void InterpolateOutSize(const operators::InterpolateParam& param,
+                               int* out_h,
+                               int* out_w) {
+  const int in_h = param.X->dims()[2];
+  const int in_w = param.X->dims()[3];
+  *out_h = param.out_h;
+  *out_w = param.out_w;
+  if (!param.SizeTensor.empty()) {
+    CHECK_EQ(param.SizeTensor.size(), 2UL);
+    *out_h = param.SizeTensor[0]->data<int>()[0];
+    *out_w = param.SizeTensor[1]->data<int>()[0];
+    return;
+  }
+  if (param.OutSize) {
+    *out_h = param.OutSize->data<int>()[0];
+    *out_w = param.OutSize->data<int>()[1];
+    return;
+  }
+  float scale = param.Scale ? param.Scale->data<float>()[0] : param.scale;
+  if (scale > 0) {
+    *out_h = static_cast<int>(in_h * scale);
+    *out_w = static_cast<int>(in_w * scale);
+  }
+  CHECK(*out_h > 0 && *out_w > 0) << "The output size is not set";
+}
+
+// The ratio of the input to the output coordinates.
+inline float InterpolateRatio(int in, int out, bool align_corners) {
+  if (align_corners) {
+    return out > 1 ? static_cast<float>(in - 1) / (out - 1) : 0.f;
+  }
+  return static_cast<float>(in) / out;
+}
+
+/*
+ * BilinearInterpCompute resizes the planes of NCHW as the ARM kernel: the
+ * source coordinates are (dst + 0.5) * ratio - 0.5 clamped at 0, or
+ * dst * ratio if align_corners, and the pixels past the last one are the last
+ * one. The columns and weights are computed once, the planes are split over
+ * the threads, and every row is interpolated along the width then blended
+ * with the next, two loops the compiler vectorizes.
+ */
+template <typename T>
+class BilinearInterpCompute
+    : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
+ public:
+  using param_t = operators::InterpolateParam;
+
+  void Run() override {
+    auto& param = *param_.get_mutable<param_t>();
+    auto& context = ctx_->As<X86Context>();
+    const int n = param.X->dims()[0];
+    const int c = param.X->dims()[1];
+    const int in_h = param.X->dims()[2];
+    const int in_w = param.X->dims()[3];
+    int out_h, out_w;
+    InterpolateOutSize(param, &out_h, &out_w);
+    param.Out->Resize({n, c, out_h, out_w});
+    const T* x = param.X->data<T>();
+    T* out = param.Out->mutable_data<T>();
+
+    const bool align = param.align_corners;
+    std::vector<int> x0(out_w), x1(out_w), y0(out_h), y1(out_h);
+    std::vector<T> ax0(out_w), ax1(out_w), ay0(out_h), ay1(out_h);
+    Coords(in_w, out_w, align, x0.data(), x1.data(), ax0.data(), ax1.data());
+    Coords(in_h, out_h, align, y0.data(), y1.data(), ay0.data(), ay1.data());
+
+    context.ParallelFor(n * c, [&](int64_t begin, int64_t end) {
+      std::vector<T> row0(out_w), row1(out_w);
+      for (int64_t i = begin; i < end; ++i) {
+        const T* src = x + i * in_h * in_w;
+        T* dst = out + i * out_h * out_w;
+        for (int h = 0; h < out_h; ++h) {
+          const T* s0 = src + y0[h] * in_w;
+          const T* s1 = src + y1[h] * in_w;
+          for (int w = 0; w < out_w; ++w) {
+            row0[w] = s0[x0[w]] * ax0[w] + s0[x1[w]] * ax1[w];
+            row1[w] = s1[x0[w]] * ax0[w] + s1[x1[w]] * ax1[w];
+          }
+          const T b0 = ay0[h];
+          const T b1 = ay1[h];
+          T* d = dst + h * out_w;
+          for (int w = 0; w < out_w; ++w) {
+            d[w] = row0[w] * b0 + row1[w] * b1;
+          }
+        }
+      }
+    });
+  }
+
+  virtual ~BilinearInterpCompute() = default;
+
+ private:
+  // The two source coordinates of every output one and their weights.
+  static void Coords(int in,
+                     int out,
+                     bool align,
+                     int* c0,
+                     int* c1,
+                     T* lambda0,
+                     T* lambda1) {
+    const float ratio = InterpolateRatio(in, out, align);
+    for (int i = 0; i < out; ++i) {
+      float f = align ? i * ratio : std::max(ratio * (i + 0.5f) - 0.5f, 0.f);
+      int s = static_cast<int>(f);
+      f -= s;
+      if (s >= in - 1) {
+        c0[i] = c1[i] = in - 1;
+      } else {
+        c0[i] = s;
+        c1[i] = s + 1;
+      }
+      lambda0[i] = 1.f - f;
+      lambda1[i] = f;
+    }
+  }
+};
+
+/*
+ * NearestInterpCompute resizes the planes of NCHW as the ARM kernel, the
+ * source coordinates are dst * ratio, rounded if align_corners and truncated
+ * otherwise.
+ */
+template <typename T>
+class NearestInterpCompute
+    : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
+ public:
+  using param_t = operators::InterpolateParam;
+
+  void Run() override {
+    auto& param = *param_.get_mutable<param_t>();
+    auto& context = ctx_->As<X86Context>();
+    const int n = param.X->dims()[0];
+    const int c = param.X->dims()[1];
+    const int in_h = param.X->dims()[2];
+    const int in_w = param.X->dims()[3];
+    int out_h, out_w;
+    InterpolateOutSize(param, &out_h, &out_w);
+    param.Out->Resize({n, c, out_h, out_w});
+    const T* x = param.X->data<T>();
+    T* out = param.Out->mutable_data<T>();
+
+    const bool align = param.align_corners;
+    const float ratio_h = InterpolateRatio(in_h, out_h, align);
+    const float ratio_w = InterpolateRatio(in_w, out_w, align);
+    const float offset = align ? 0.5f : 0.f;
+    std::vector<int> xs(out_w), ys(out_h);
+    for (int w = 0; w < out_w; ++w) {
+      xs[w] = std::min(static_cast<int>(ratio_w * w + offset), in_w - 1);
+    }
+    for (int h = 0; h < out_h; ++h) {
+      ys[h] = std::min(static_cast<int>(ratio_h * h + offset), in_h - 1);
+    }
+
+    context.ParallelFor(n * c, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        const T* src = x + i * in_h * in_w;
+        T* dst = out + i * out_h * out_w;
+        for (int h = 0; h < out_h; ++h) {
+          const T* s = src + ys[h] * in_w;
+          T* d = dst + h * out_w;
+          for (int w = 0; w < out_w; ++w) {
+            d[w] = s[xs[w]];
+          }
+        }
+      }
+    });
+  }
+
+  virtual ~NearestInterpCompute() = default;
+};
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
@@ -35,6 +35,7 @@ class LayerNormCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
 
   void Run() override {
     auto &param = *param_.get_mutable<param_t>();
+    auto &context = ctx_->As<X86Context>();
     float epsilon = param.epsilon;
     auto Scale = param.Scale;
     auto Bias = param.Bias;
@@ -71,15 +72,24 @@ class LayerNormCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
     auto ker = paddle::lite::jit::KernelFuncs<jit::LayerNormTuple<T>,
                                               lite::fluid::CPUPlace>::Cache()
                    .At(right);
-    ker(in.mutable_data<T>(),
-        out.mutable_data<T>(),
-        Mean->mutable_data<T>(),
-        Var->mutable_data<T>(),
-        Scale->data<T>(),
-        Bias->data<T>(),
-        static_cast<int>(left),
-        static_cast<const float>(epsilon),
-        right);
+    T* in_data = in.mutable_data<T>();
+    T* out_data = out.mutable_data<T>();
+    T* mean_data = Mean->mutable_data<T>();
+    T* var_data = Var->mutable_data<T>();
+    const T* scale_data = Scale->data<T>();
+    const T* bias_data = Bias->data<T>();
+    // The rows are normalized independently, split over the threads.
+    context.ParallelFor(left, [&](int64_t begin, int64_t end) {
+      ker(in_data + begin * right,
+          out_data + begin * right,
+          mean_data + begin,
+          var_data + begin,
+          scale_data,
+          bias_data,
+          static_cast<int>(end - begin),
+          static_cast<const float>(epsilon),
+          right);
+    });
   }
 
   virtual ~LayerNormCompute() = default;
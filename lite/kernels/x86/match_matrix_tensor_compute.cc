@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "lite/kernels/x86/match_matrix_tensor_compute.h"
+#include <algorithm>
 #include <vector>
 
 namespace paddle {
@@ -50,51 +51,72 @@ void MatchMatrixTensorCompute<T>::Run() {
   auto* t_data = w->template data<T>();
   auto* out_data = out->template mutable_data<T>();
   auto* bottom_l_trans_data = tmp->template mutable_data<T>();
-  memset(out_data, 0.0, out->dims()[0] * out->dims()[1] * sizeof(T));
-  memset(bottom_l_trans_data, 0.0, tmp->dims()[0] * tmp->dims()[1] * sizeof(T));
 
   auto blas = lite::x86::math::GetBlas<TARGET(kX86), T>(context);
-  blas.GEMM(CblasNoTrans,
-            CblasNoTrans,
-            x->dims()[0],
-            dim_t * dim_in,
-            dim_in,
-            1.0f,
-            bottom_l_data,
-            dim_in,
-            t_data,
-            dim_t * dim_in,
-            0.0f,
-            bottom_l_trans_data,
-            dim_t * dim_in);
+  const bool split = context.threads() > 1;
+  // Project the left rows by every channel of w, split by rows.
+  context.ParallelFor(x->dims()[0], [&](int64_t begin, int64_t end) {
+    lite::x86::math::ScopedSingleThreadedBlas single_threaded(split);
+    blas.GEMM(CblasNoTrans,
+              CblasNoTrans,
+              static_cast<int>(end - begin),
+              dim_t * dim_in,
+              dim_in,
+              1.0f,
+              bottom_l_data + begin * dim_in,
+              dim_in,
+              t_data,
+              dim_t * dim_in,
+              0.0f,
+              bottom_l_trans_data + begin * dim_t * dim_in,
+              dim_t * dim_in);
+  });
 
-  for (size_t b = 0; b < x->lod()[0].size() - 1; b++) {
-    for (int t = 0; t < dim_t; t++) {
+  // Match every channel of every sequence pair, i.e. batch * dim_t GEMMs of
+  // len_l * len_r outputs each. They are split by their cost rather than by
+  // their number, since the sequences have very different lengths, and the
+  // channels of a sequence in a split run as one batched GEMM.
+  int batch_size = x->lod()[0].size() - 1;
+  std::vector<int64_t> costs(batch_size * dim_t);
+  for (int b = 0; b < batch_size; b++) {
+    int64_t len_l = offset_l[b + 1] - offset_l[b];
+    int64_t len_r = offset_r[b + 1] - offset_r[b];
+    std::fill(costs.begin() + b * dim_t,
+              costs.begin() + (b + 1) * dim_t,
+              len_l * len_r * dim_in);
+  }
+  context.ParallelForByCost(costs, [&](int64_t begin, int64_t end) {
+    lite::x86::math::ScopedSingleThreadedBlas single_threaded(split);
+    for (int64_t b = begin / dim_t; b * dim_t < end; b++) {
+      int t_begin = static_cast<int>(std::max(begin, b * dim_t) - b * dim_t);
+      int t_end =
+          static_cast<int>(std::min(end, (b + 1) * dim_t) - b * dim_t);
       int len_l = offset_l[b + 1] - offset_l[b];
       int len_r = offset_r[b + 1] - offset_r[b];
-      auto* top_data = out_data + top_offset[b] + t * len_l * len_r;
-      const auto* l_t_data =
-          bottom_l_trans_data + offset_l[b] * dim_t * dim_in + t * dim_in;
-      const auto* r_data = bottom_r_data + offset_r[b] * dim_in;
-
-      auto blas = lite::x86::math::GetBlas<TARGET(kX86), T>(context);
-      blas.GEMM(CblasNoTrans,
-                CblasTrans,
-                len_l,
-                len_r,
-                dim_in,
-                1.0f,
-                l_t_data,
-                dim_t * dim_in,
-                r_data,
-                dim_in,
-                0.0f,
-                top_data,
-                len_r);
+      if (len_l == 0 || len_r == 0) {
+        continue;
+      }
+      blas.BatchedGEMM(CblasNoTrans,
+                       CblasTrans,
+                       len_l,
+                       len_r,
+                       dim_in,
+                       static_cast<T>(1.0),
+                       bottom_l_trans_data + offset_l[b] * dim_t * dim_in +
+                           t_begin * dim_in,
+                       dim_t * dim_in,
+                       dim_in,
+                       bottom_r_data + offset_r[b] * dim_in,
+                       dim_in,
+                       0,
+                       static_cast<T>(0.0),
+                       out_data + top_offset[b] + t_begin * len_l * len_r,
+                       len_r,
+                       len_l * len_r,
+                       t_end - t_begin);
     }
-  }
+  });
 
-  int batch_size = x->lod()[0].size() - 1;
   int lod_lv1_size = batch_size * dim_t;
   int lod_lv2_size = x->lod()[0].back() * dim_t;
   std::vector<size_t> out_lod0(batch_size + 1, 0);
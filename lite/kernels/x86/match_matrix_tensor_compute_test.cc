@@ -17,6 +17,7 @@
 #include <memory>
 #include <utility>
 #include <vector>
+#include "lite/backends/x86/thread_pool.h"
 #include "lite/core/op_registry.h"
 
 namespace paddle {
@@ -108,6 +109,72 @@ TEST(match_matrix_tensor_x86, run_test) {
   }
 }
 
+TEST(match_matrix_tensor_x86, run_threads) {
+  // Sequences of very different lengths, and an empty one.
+  const int dim_in = 3, dim_t = 3;
+  const std::vector<uint64_t> l_lod{0, 1, 9, 9, 12, 30};
+  const std::vector<uint64_t> r_lod{0, 7, 8, 10, 30, 31};
+  const int batch = static_cast<int>(l_lod.size()) - 1;
+  lite::Tensor x, w, y, out, tmp;
+  x.Resize({static_cast<int64_t>(l_lod.back()), dim_in});
+  x.set_lod({l_lod});
+  y.Resize({static_cast<int64_t>(r_lod.back()), dim_in});
+  y.set_lod({r_lod});
+  w.Resize({dim_in, dim_t, dim_in});
+  tmp.Resize({x.dims()[0], dim_t * dim_in});
+  int64_t out_size = 0;
+  for (int b = 0; b < batch; b++) {
+    out_size += dim_t * (l_lod[b + 1] - l_lod[b]) * (r_lod[b + 1] - r_lod[b]);
+  }
+  out.Resize({out_size, 1});
+  for (auto* t : {&x, &y, &w}) {
+    auto* data = t->mutable_data<float>();
+    for (int64_t i = 0; i < t->numel(); i++) {
+      data[i] = static_cast<float>((i * 7) % 11) / 11.f - 0.5f;
+    }
+  }
+
+  std::unique_ptr<KernelContext> ctx(new KernelContext);
+  ctx->As<X86Context>().SetThreadPool(
+      std::make_shared<lite::x86::ThreadPool>(4));
+  MatchMatrixTensorCompute<float> mmtc;
+  mmtc.SetContext(std::move(ctx));
+  operators::MatchMatrixTensorParam param;
+  param.x = &x;
+  param.w = &w;
+  param.y = &y;
+  param.dim_t = dim_t;
+  param.out = &out;
+  param.tmp = &tmp;
+  mmtc.SetParam(param);
+  mmtc.Run();
+
+  // out[b][t][i][j] = x[i] * w[:, t, :] * y[j]
+  const float* x_data = x.data<float>();
+  const float* y_data = y.data<float>();
+  const float* w_data = w.data<float>();
+  const float* out_data = out.data<float>();
+  int64_t top = 0;
+  for (int b = 0; b < batch; b++) {
+    for (int t = 0; t < dim_t; t++) {
+      for (uint64_t i = l_lod[b]; i < l_lod[b + 1]; i++) {
+        for (uint64_t j = r_lod[b]; j < r_lod[b + 1]; j++) {
+          float ref = 0;
+          for (int m = 0; m < dim_in; m++) {
+            for (int k = 0; k < dim_in; k++) {
+              ref += x_data[i * dim_in + m] *
+                     w_data[(m * dim_t + t) * dim_in + k] *
+                     y_data[j * dim_in + k];
+            }
+          }
+          EXPECT_NEAR(out_data[top++], ref, 1e-5);
+        }
+      }
+    }
+  }
+  EXPECT_EQ(top, out_size);
+}
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
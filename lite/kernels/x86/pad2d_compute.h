@@ -0,0 +1,130 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "lite/core/kernel.h"
+#include "lite/core/op_registry.h"
+#include "lite/operators/pad2d_op.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+/*
+ * Pad2dCompute pads the planes of NCHW, split over the threads. The middle of
+ * every row is copied, and the pads are filled through the source columns
+ * computed once.
+ *
+ * The modes are those of the ARM kernel: "reflect" repeats the edge pixels,
+ * and "edge" mirrors the pixels around the edge ones.
+ */
+template <typename T>
+class Pad2dCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
+ public:
+  using param_t = operators::Pad2dParam;
+
+  void Run() override {
+    auto& param = *param_.get_mutable<param_t>();
+    auto& context = ctx_->As<X86Context>();
+    CHECK_EQ(param.data_format, "NCHW");
+    int mode = 0;
+    if (param.mode == "reflect") {
+      mode = 1;
+    } else if (param.mode == "edge") {
+      mode = 2;
+    } else {
+      CHECK_EQ(param.mode, "constant") << "Unknown mode type";
+    }
+
+    auto x_dims = param.X->dims();
+    const int n = x_dims[0];
+    const int c = x_dims[1];
+    const int in_h = x_dims[2];
+    const int in_w = x_dims[3];
+    const int pad_top = param.paddings[0];
+    const int pad_bottom = param.paddings[1];
+    const int pad_left = param.paddings[2];
+    const int pad_right = param.paddings[3];
+    if (mode == 2) {
+      CHECK_LE(std::max(pad_top, pad_bottom), in_h - 1)
+          << "The pads should be less than the height";
+      CHECK_LE(std::max(pad_left, pad_right), in_w - 1)
+          << "The pads should be less than the width";
+    }
+    const int out_h = in_h + pad_top + pad_bottom;
+    const int out_w = in_w + pad_left + pad_right;
+    param.Out->Resize({n, c, out_h, out_w});
+    const T* x = param.X->data<T>();
+    T* out = param.Out->mutable_data<T>();
+    const T pad_value = param.pad_value;
+
+    std::vector<int> rows(out_h);
+    for (int i = 0; i < out_h; ++i) {
+      rows[i] = Source(i - pad_top, in_h, mode);
+    }
+    std::vector<int> cols(out_w);
+    for (int i = 0; i < out_w; ++i) {
+      cols[i] = Source(i - pad_left, in_w, mode);
+    }
+
+    context.ParallelFor(n * c, [&](int64_t begin, int64_t end) {
+      for (int64_t p = begin; p < end; ++p) {
+        const T* src = x + p * in_h * in_w;
+        T* dst = out + p * out_h * out_w;
+        for (int h = 0; h < out_h; ++h, dst += out_w) {
+          if (rows[h] < 0) {
+            std::fill(dst, dst + out_w, pad_value);
+            continue;
+          }
+          const T* s = src + rows[h] * in_w;
+          for (int w = 0; w < pad_left; ++w) {
+            dst[w] = cols[w] < 0 ? pad_value : s[cols[w]];
+          }
+          std::memcpy(dst + pad_left, s, in_w * sizeof(T));
+          for (int w = pad_left + in_w; w < out_w; ++w) {
+            dst[w] = cols[w] < 0 ? pad_value : s[cols[w]];
+          }
+        }
+      }
+    });
+  }
+
+  virtual ~Pad2dCompute() = default;
+
+ private:
+  // The source index of i in [0, in), or -1 for the pad value.
+  static int Source(int i, int in, int mode) {
+    if (i >= 0 && i < in) return i;
+    switch (mode) {
+      case 1:
+        return std::min(std::max(i, 0), in - 1);
+      case 2:
+        i = std::max(i, -i);
+        return std::min(i, 2 * in - i - 2);
+      default:
+        return -1;
+    }
+  }
+};
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
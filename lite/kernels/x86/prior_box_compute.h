@@ -0,0 +1,160 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lite/core/kernel.h"
+#include "lite/core/op_registry.h"
+#include "lite/operators/prior_box_op.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+inline void ExpandAspectRatios(const std::vector<float>& input_aspect_ratior,
+                               bool flip,
+                               std::vector<float>* output_aspect_ratior) {
+  constexpr float epsilon = 1e-6;
+  output_aspect_ratior->clear();
+  output_aspect_ratior->push_back(1.0f);
+  for (size_t i = 0; i < input_aspect_ratior.size(); ++i) {
+    float ar = input_aspect_ratior[i];
+    bool already_exist = false;
+    for (size_t j = 0; j < output_aspect_ratior->size(); ++j) {
+      if (std::fabs(ar - output_aspect_ratior->at(j)) < epsilon) {
+        already_exist = true;
+        break;
+      }
+    }
+    if (!already_exist) {
+      output_aspect_ratior->push_back(ar);
+      if (flip) {
+        output_aspect_ratior->push_back(1.0f / ar);
+      }
+    }
+  }
+}
+
+/*
+ * PriorBoxCompute computes the priors the same way as the ARM kernel, the
+ * sizes of the priors of a location are the same everywhere, they are
+ * computed once and the rows of the feature map are split over the threads.
+ */
+template <typename T>
+class PriorBoxCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
+ public:
+  using param_t = operators::PriorBoxParam;
+
+  void Run() override {
+    auto& param = *param_.get_mutable<param_t>();
+    auto& context = ctx_->As<X86Context>();
+
+    std::vector<float> aspect_ratios;
+    ExpandAspectRatios(param.aspect_ratios, param.flip, &aspect_ratios);
+    const auto& min_sizes = param.min_sizes;
+    const auto& max_sizes = param.max_sizes;
+
+    // The widths and heights of the priors of a location, in order.
+    std::vector<std::pair<T, T>> sizes;
+    for (size_t s = 0; s < min_sizes.size(); ++s) {
+      // The sizes are truncated to integers as by the ARM kernel.
+      int min_size = min_sizes[s];
+      std::vector<std::pair<T, T>> max_box;
+      if (!max_sizes.empty()) {
+        int max_size = max_sizes[s];
+        T size = std::sqrt(static_cast<T>(min_size * max_size));
+        max_box.emplace_back(size, size);
+      }
+      std::vector<std::pair<T, T>> com_boxes;
+      for (float ar : aspect_ratios) {
+        if (std::fabs(ar - 1.) < 1e-6) continue;
+        com_boxes.emplace_back(min_size * std::sqrt(ar),
+                               min_size / std::sqrt(ar));
+      }
+      sizes.emplace_back(min_size, min_size);
+      if (param.min_max_aspect_ratios_order) {
+        sizes.insert(sizes.end(), max_box.begin(), max_box.end());
+        sizes.insert(sizes.end(), com_boxes.begin(), com_boxes.end());
+      } else {
+        sizes.insert(sizes.end(), com_boxes.begin(), com_boxes.end());
+        sizes.insert(sizes.end(), max_box.begin(), max_box.end());
+      }
+    }
+    const int prior_num = sizes.size();
+
+    const int height = param.input->dims()[2];
+    const int width = param.input->dims()[3];
+    int img_width = param.img_w;
+    int img_height = param.img_h;
+    if (img_width == 0 || img_height == 0) {
+      img_width = param.image->dims()[3];
+      img_height = param.image->dims()[2];
+    }
+    T step_w = param.step_w;
+    T step_h = param.step_h;
+    if (step_w == 0 || step_h == 0) {
+      step_w = static_cast<T>(img_width) / width;
+      step_h = static_cast<T>(img_height) / height;
+    }
+    const T offset = param.offset;
+    const bool clip = param.clip;
+    const auto& variances = param.variances_;
+    CHECK_EQ(variances.size(), 4UL);
+
+    param.boxes->Resize({height, width, prior_num, 4});
+    param.variances->Resize({height, width, prior_num, 4});
+    T* boxes = param.boxes->mutable_data<T>();
+    T* vars = param.variances->mutable_data<T>();
+
+    context.ParallelFor(height, [&](int64_t begin, int64_t end) {
+      for (int64_t h = begin; h < end; ++h) {
+        T* box = boxes + h * width * prior_num * 4;
+        T* var = vars + h * width * prior_num * 4;
+        T center_y = (h + offset) * step_h;
+        for (int w = 0; w < width; ++w) {
+          T center_x = (w + offset) * step_w;
+          for (int p = 0; p < prior_num; ++p) {
+            T box_width = sizes[p].first;
+            T box_height = sizes[p].second;
+            box[0] = (center_x - box_width / 2.f) / img_width;
+            box[1] = (center_y - box_height / 2.f) / img_height;
+            box[2] = (center_x + box_width / 2.f) / img_width;
+            box[3] = (center_y + box_height / 2.f) / img_height;
+            for (int k = 0; k < 4; ++k) {
+              if (clip) {
+                box[k] = std::min<T>(std::max<T>(box[k], 0.f), 1.f);
+              }
+              var[k] = variances[k];
+            }
+            box += 4;
+            var += 4;
+          }
+        }
+      }
+    });
+  }
+
+  virtual ~PriorBoxCompute() = default;
+};
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
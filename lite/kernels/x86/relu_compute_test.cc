@@ -14,6 +14,8 @@
 
 #include <gtest/gtest.h>
 #include <iostream>
+#include <memory>
+#include <utility>
 #include <vector>
 #include "lite/core/op_registry.h"
 #include "lite/kernels/x86/activation_compute.h"
@@ -58,6 +60,9 @@ TEST(relu_x86, run_test) {
   param.X = &x;
   param.Out = &out;
 
+  std::unique_ptr<KernelContext> ctx(new KernelContext);
+  ctx->As<X86Context>();
+  relu.SetContext(std::move(ctx));
   relu.SetParam(param);
   relu.Run();
 
@@ -17,6 +17,7 @@
 #include <memory>
 #include <utility>
 #include <vector>
+#include "lite/backends/x86/thread_pool.h"
 #include "lite/core/op_registry.h"
 #include "lite/core/tensor.h"
 namespace paddle {
@@ -210,10 +211,17 @@ TEST(var_conv_2d_x86, init) {
   ASSERT_EQ(var_conv_2d.target(), TARGET(kX86));
 }
 
-TEST(var_conv_2d_x86, run_test) {
+static void test_var_conv_2d(const std::vector<uint64_t>& row_lod_vec,
+                             const std::vector<uint64_t>& column_lod_vec,
+                             int threads) {
   VarConv2DCompute<float> var_conv_2d;
   std::unique_ptr<KernelContext> ctx(new KernelContext);
-  ctx->As<X86Context>();
+  if (threads > 1) {
+    ctx->As<X86Context>().SetThreadPool(
+        std::make_shared<lite::x86::ThreadPool>(threads));
+  } else {
+    ctx->As<X86Context>();
+  }
 
   operators::VarConv2DParam param;
 
@@ -238,12 +246,10 @@ TEST(var_conv_2d_x86, run_test) {
     w_data[i] = i - 1.f;
   }
 
-  std::vector<uint64_t> row_lod_vec{0, 10, 20};
   LoD row_lod;
   row_lod.push_back(row_lod_vec);
   ROW.set_lod(row_lod);
 
-  std::vector<uint64_t> column_lod_vec{0, 10, 20};
   LoD column_lod;
   column_lod.push_back(column_lod_vec);
   COLUMN.set_lod(column_lod);
@@ -299,6 +305,7 @@ TEST(var_conv_2d_x86, run_test) {
                   &top_ref,
                   &col_ref);
 
+  ASSERT_EQ(Out.numel(), top_ref.numel());
   for (int i = 0; i < Out.numel(); ++i) {
     EXPECT_NEAR(Out.data<float>()[i], top_ref.data<float>()[i], 1e-5);
   }
@@ -307,6 +314,16 @@ TEST(var_conv_2d_x86, run_test) {
   }
 }
 
+TEST(var_conv_2d_x86, run_test) {
+  test_var_conv_2d({0, 10, 20}, {0, 10, 20}, 1);
+}
+
+TEST(var_conv_2d_x86, run_threads) {
+  // Images of very different sizes, and an empty one.
+  test_var_conv_2d(
+      {0, 10, 12, 12, 42, 43, 47}, {0, 10, 30, 33, 35, 36, 76}, 4);
+}
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
@@ -0,0 +1,58 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include "lite/core/context.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+// The columns the jit vector kernels run on at a time. Their jit code is
+// generated up to 1024 elements, so a tensor needs at most two of them, for
+// the blocks and for the tail.
+const int kVectorBlock = 1024;
+// Below this number of elements, the threads cost more than they save.
+const int64_t kVectorParallelSize = 32768;
+
+// Runs fn(row, column, len) on the blocks of kVectorBlock columns of a
+// [rows, cols] tensor, split over the threads if the tensor is large.
+template <typename Func>
+void VectorFor(const X86Context& ctx, int64_t rows, int64_t cols, Func&& fn) {
+  if (rows <= 0 || cols <= 0) return;
+  const int64_t blocks = (cols + kVectorBlock - 1) / kVectorBlock;
+  auto run = [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; ++b) {
+      const int64_t row = b / blocks;
+      const int64_t col = b % blocks * kVectorBlock;
+      fn(row,
+         col,
+         static_cast<int>(std::min<int64_t>(kVectorBlock, cols - col)));
+    }
+  };
+  if (rows * cols < kVectorParallelSize) {
+    run(0, rows * blocks);
+  } else {
+    ctx.ParallelFor(rows * blocks, run);
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,60 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/while_compute.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+void WhileCompute::PrepareForRun() {
+  auto& param = Param<operators::WhileParam>();
+  CHECK(param.program_desc) << "the while op should be built by a Program";
+  // The places to pick the kernels of a sub-block not optimized.
+  auto host_place = place();
+  host_place.target = TARGET(kHost);
+  program_.reset(new Program(*param.program_desc,
+                             param.block_idx,
+                             param.scope,
+                             {place(), host_place}));
+  runtime_program_.reset(new RuntimeProgram(program_.get()));
+  runtime_program_->SetX86ThreadPool(
+      ctx_->As<X86Context>().shared_thread_pool());
+}
+
+void WhileCompute::Run() {
+  auto& param = Param<operators::WhileParam>();
+  while (param.cond->data<bool>()[0]) {
+    runtime_program_->Run();
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_KERNEL(
+    while, kX86, kFloat, kNCHW, paddle::lite::kernels::x86::WhileCompute, def)
+    .BindInput("X",
+               {LiteType::GetTensorListTy(
+                   TARGET(kX86), PRECISION(kAny), DATALAYOUT(kAny))})
+    .BindInput("Condition",
+               {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kBool))})
+    .BindOutput("Out",
+                {LiteType::GetTensorListTy(
+                    TARGET(kX86), PRECISION(kAny), DATALAYOUT(kAny))})
+    .BindOutput("StepScopes", {LiteType::GetTensorTy(TARGET(kX86))})
+    .Finalize();
@@ -0,0 +1,107 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "lite/core/kernel.h"
+#include "lite/core/op_registry.h"
+#include "lite/operators/yolo_box_op.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+/*
+ * YoloBoxCompute decodes the boxes and scores of the anchors of a yolo head
+ * as the ARM kernel. The boxes and scores under conf_thresh are zeros. The
+ * rows of the anchors of the images are split over the threads.
+ */
+template <typename T>
+class YoloBoxCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
+ public:
+  using param_t = operators::YoloBoxParam;
+
+  void Run() override {
+    auto& param = *param_.get_mutable<param_t>();
+    auto& context = ctx_->As<X86Context>();
+    auto* X = param.X;
+    const std::vector<int>& anchors = param.anchors;
+    const int class_num = param.class_num;
+    const T conf_thresh = param.conf_thresh;
+
+    const int n = X->dims()[0];
+    const int h = X->dims()[2];
+    const int w = X->dims()[3];
+    const int an_num = anchors.size() / 2;
+    const int input_size = param.downsample_ratio * h;
+    const int box_num = an_num * h * w;
+    const int stride = h * w;
+    const int an_stride = (class_num + 5) * stride;
+    CHECK_EQ(X->dims()[1], an_num * (class_num + 5));
+
+    param.Boxes->Resize({n, box_num, 4});
+    param.Scores->Resize({n, box_num, class_num});
+    const T* x = X->data<T>();
+    const int* img_size = param.ImgSize->data<int>();
+    T* boxes = param.Boxes->mutable_data<T>();
+    T* scores = param.Scores->mutable_data<T>();
+    std::fill(boxes, boxes + param.Boxes->numel(), T(0));
+    std::fill(scores, scores + param.Scores->numel(), T(0));
+
+    auto sigmoid = [](T v) { return 1.f / (1.f + std::exp(-v)); };
+    context.ParallelFor(n * an_num * h, [&](int64_t begin, int64_t end) {
+      for (int64_t r = begin; r < end; ++r) {
+        const int i = r / (an_num * h);
+        const int j = r / h % an_num;
+        const int k = r % h;
+        const int img_height = img_size[2 * i];
+        const int img_width = img_size[2 * i + 1];
+        const T* entry = x + (i * an_num + j) * an_stride + k * w;
+        for (int l = 0; l < w; ++l) {
+          T conf = sigmoid(entry[4 * stride + l]);
+          if (conf < conf_thresh) continue;
+
+          T cx = (l + sigmoid(entry[l])) * img_width / h;
+          T cy = (k + sigmoid(entry[stride + l])) * img_height / h;
+          T bw = std::exp(entry[2 * stride + l]) * anchors[2 * j] * img_width /
+                 input_size;
+          T bh = std::exp(entry[3 * stride + l]) * anchors[2 * j + 1] *
+                 img_height / input_size;
+          const int box_idx = i * box_num + j * stride + k * w + l;
+          T* box = boxes + box_idx * 4;
+          box[0] = std::max<T>(cx - bw / 2, 0);
+          box[1] = std::max<T>(cy - bh / 2, 0);
+          box[2] = std::min<T>(cx + bw / 2, img_width - 1);
+          box[3] = std::min<T>(cy + bh / 2, img_height - 1);
+
+          T* score = scores + box_idx * class_num;
+          for (int c = 0; c < class_num; ++c) {
+            score[c] = conf * sigmoid(entry[(5 + c) * stride + l]);
+          }
+        }
+      }
+    });
+  }
+
+  virtual ~YoloBoxCompute() = default;
+};
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
@@ -14,9 +14,12 @@
 
 #include "lite/model_parser/model_parser.h"
 #include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <limits>
+#include <memory>
 #include <set>
+#include "lite/backends/host/allocator.h"
 #include "lite/core/scope.h"
 #include "lite/core/tensor.h"
 #include "lite/core/variable.h"
@@ -572,18 +575,10 @@ void SaveModelNaive(const std::string &model_dir,
 }
 #endif
 
-template <typename T>
-void SetTensorDataNaive(T *out, size_t size, const std::vector<T> &src) {
-  CHECK(out);
-  CHECK(size == src.size());
-  for (size_t i = 0; i < size; ++i) {
-    out[i] = src[i];
-  }
-}
-
 void GetParamInfoNaive(const naive_buffer::ParamDesc &desc,
                        lite::Scope *scope,
-                       const std::string &name) {
+                       const std::string &name,
+                       const std::shared_ptr<void> &mapping = nullptr) {
   CHECK(scope);
   CHECK_EQ(desc.Name(), name)
       << "Var name not equal: ParamDesc.name=" << desc.Name()
@@ -603,12 +598,12 @@ void GetParamInfoNaive(const naive_buffer::ParamDesc &desc,
   tensor->Resize(lite::DDim(desc.Dim()));
 
   // Load data
+  size_t elem_size = 0;
   switch (desc.GetDataType()) {
-#define SET_TENSOR(data_type__, T, precision)                            \
-  case VarDescAPI::VarDataType::data_type__:                             \
-    SetTensorDataNaive<T>(                                               \
-        tensor->mutable_data<T>(), tensor->data_size(), desc.Data<T>()); \
-    tensor->set_precision(precision);                                    \
+#define SET_TENSOR(data_type__, T, precision) \
+  case VarDescAPI::VarDataType::data_type__:  \
+    elem_size = sizeof(T);                    \
+    tensor->set_precision(precision);         \
     break
 
     // SET_TENSOR(BOOL, bool, PRECISION(kBool));
@@ -621,28 +616,57 @@ void GetParamInfoNaive(const naive_buffer::ParamDesc &desc,
     default:
       LOG(FATAL) << "unknown type";
   }
+  const char *data = desc.RawData();
+  size_t num_bytes = desc.RawDataSize();
+  CHECK_EQ(num_bytes, tensor->data_size() * elem_size)
+      << "The data size of param " << name << " mismatches its dims";
+#ifndef LITE_WITH_FPGA
+  // The kernels expect the alignment of the host allocations, the params
+  // not aligned so in the file are copied.
+  if (mapping && num_bytes > 0 &&
+      reinterpret_cast<uintptr_t>(data) % host::kMallocAlign == 0) {
+    // Zero copy, the tensor refers to the memory-mapped params file.
+    std::shared_ptr<Buffer> buffer(new Buffer(
+        const_cast<char *>(data), TARGET(kHost), num_bytes, mapping));
+    tensor->ResetBuffer(buffer, num_bytes);
+  } else  // NOLINT
+#endif
+  {
+    void *dst = tensor->mutable_data(TARGET(kHost), num_bytes);
+    if (num_bytes > 0) {
+      memcpy(dst, data, num_bytes);
+    }
+  }
   tensor->set_persistable(true);
 }
 
 void LoadParamNaive(const std::string &path,
                     lite::Scope *scope,
-                    const std::string &name) {
+                    const std::string &name,
+                    bool use_mmap) {
   // Load param
   naive_buffer::BinaryTable table;
-  table.LoadFromFile(path);
+  if (use_mmap) {
+    table.MapFromFile(path);
+  } else {
+    table.LoadFromFile(path);
+  }
   naive_buffer::proto::ParamDesc pt_desc(&table);
   pt_desc.Load();
   naive_buffer::ParamDesc desc(&pt_desc);
-  GetParamInfoNaive(desc, scope, name);
+  GetParamInfoNaive(desc, scope, name, table.mapping());
 }
 
 void LoadCombinedParamsNaive(const std::string &path,
                              lite::Scope *scope,
                              const cpp::ProgramDesc &cpp_prog,
-                             bool params_from_memory) {
+                             bool params_from_memory,
+                             bool use_mmap = false) {
   naive_buffer::BinaryTable table;
   if (params_from_memory) {
     table.LoadFromMemory(path.c_str(), path.length());
+  } else if (use_mmap) {
+    table.MapFromFile(path);
   } else {
     table.LoadFromFile(path);
   }
@@ -653,7 +677,7 @@ void LoadCombinedParamsNaive(const std::string &path,
   std::set<std::string> param_names;
   for (size_t i = 0; i < desc.ParamsSize(); ++i) {
     naive_buffer::ParamDesc param_desc(desc.GetParam(i));
-    GetParamInfoNaive(param_desc, scope, param_desc.Name());
+    GetParamInfoNaive(param_desc, scope, param_desc.Name(), table.mapping());
     param_names.insert(param_desc.Name());
   }
 
@@ -672,7 +696,8 @@ void LoadCombinedParamsNaive(const std::string &path,
 void LoadModelNaive(const std::string &model_dir,
                     Scope *scope,
                     cpp::ProgramDesc *cpp_prog,
-                    bool combined) {
+                    bool combined,
+                    bool use_mmap) {
   CHECK(cpp_prog);
   CHECK(scope);
   cpp_prog->ClearBlocks();
@@ -680,7 +705,11 @@ void LoadModelNaive(const std::string &model_dir,
   // Load model
   const std::string prog_path = model_dir + "/__model__.nb";
   naive_buffer::BinaryTable table;
-  table.LoadFromFile(prog_path);
+  if (use_mmap) {
+    table.MapFromFile(prog_path);
+  } else {
+    table.LoadFromFile(prog_path);
+  }
   naive_buffer::proto::ProgramDesc nb_proto_prog(&table);
   nb_proto_prog.Load();
   naive_buffer::ProgramDesc nb_prog(&nb_proto_prog);
@@ -692,7 +721,8 @@ void LoadModelNaive(const std::string &model_dir,
   // NOTE: Only main block be used now.
   if (combined) {
     const std::string combined_params_path = model_dir + "/param.nb";
-    LoadCombinedParamsNaive(combined_params_path, scope, *cpp_prog, false);
+    LoadCombinedParamsNaive(
+        combined_params_path, scope, *cpp_prog, false, use_mmap);
   } else {
     auto &prog = *cpp_prog;
     auto &main_block_desc = *prog.GetBlock<cpp::BlockDesc>(0);
@@ -706,7 +736,7 @@ void LoadModelNaive(const std::string &model_dir,
 
       switch (var.GetType()) {
         case VarDescAPI::Type::LOD_TENSOR:
-          LoadParamNaive(file_path, scope, var.Name());
+          LoadParamNaive(file_path, scope, var.Name(), use_mmap);
           break;
         default:
           CHECK(false) << "unknown weight type";
@@ -92,12 +92,16 @@ void SaveModelNaive(const std::string& model_dir,
 
 void LoadParamNaive(const std::string& path,
                     lite::Scope* scope,
-                    const std::string& name);
+                    const std::string& name,
+                    bool use_mmap = false);
 
+// If `use_mmap` is true, the model files are memory mapped, and the params
+// refer to the mapping directly without copy as far as possible.
 void LoadModelNaive(const std::string& model_dir,
                     lite::Scope* scope,
                     cpp::ProgramDesc* prog,
-                    bool combined = true);
+                    bool combined = true,
+                    bool use_mmap = false);
 
 void LoadModelNaiveFromMemory(const std::string& model_buffer,
                               const std::string& param_buffer,
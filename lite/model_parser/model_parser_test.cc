@@ -15,6 +15,8 @@
 #include "lite/model_parser/model_parser.h"
 #include <gflags/gflags.h>
 #include <gtest/gtest.h>
+#include <string>
+#include "lite/backends/host/allocator.h"
 #include "lite/core/scope.h"
 
 DEFINE_string(model_dir, "", "");
@@ -112,6 +114,49 @@ TEST(ModelParser, LoadParamNaive) {
   }
 }
 
+TEST(ModelParser, LoadParamNaiveMmap) {
+  Scope scope;
+  LoadParamNaive("./fc_0.w", &scope, "xxx", true);
+  auto& tensor = scope.Var("xxx")->Get<lite::Tensor>();
+  std::vector<int64_t> bg_dim({1, 2, 5});
+  size_t size = 10;
+  ASSERT_EQ(bg_dim, tensor.dims().Vectorize());
+  ASSERT_EQ(tensor.data_size(), size);
+  auto* data = tensor.data<float>();
+  for (int i = 0; i < size; ++i) {
+    EXPECT_NEAR(i / static_cast<float>(size), data[i], 1e-6);
+  }
+}
+
+TEST(ModelParser, LoadParamNaiveMmapMisaligned) {
+  // The offset of the data in the file moves with the length of the name,
+  // the params not aligned are copied, the others are not.
+  for (size_t length = 1; length <= host::kMallocAlign; ++length) {
+    const std::string name(length, 'w');
+    {
+      Scope scope;
+      auto* tensor = scope.Var(name)->GetMutable<lite::Tensor>();
+      tensor->set_persistable(true);
+      tensor->Resize({3, 5});
+      auto* data = tensor->mutable_data<float>();
+      for (int i = 0; i < 15; ++i) {
+        data[i] = i * 0.5f;
+      }
+      SaveParamNaive("./misaligned.w", scope, name);
+    }
+    Scope scope;
+    LoadParamNaive("./misaligned.w", &scope, name, true);
+    auto& tensor = scope.Var(name)->Get<lite::Tensor>();
+    ASSERT_EQ(tensor.data_size(), 15u);
+    EXPECT_EQ(
+        reinterpret_cast<uintptr_t>(tensor.raw_data()) % host::kMallocAlign, 0u)
+        << length;
+    for (int i = 0; i < 15; ++i) {
+      EXPECT_EQ(tensor.data<float>()[i], i * 0.5f) << length;
+    }
+  }
+}
+
 TEST(ModelParser, SaveModelNaive) {
   CHECK(!FLAGS_model_dir.empty());
   cpp::ProgramDesc prog;
@@ -134,5 +179,27 @@ TEST(ModelParser, LoadModelNaiveFromMemory) {
   LoadModelNaiveFromMemory(model_buffer, params_buffer, &scope, &prog);
 }
 
+TEST(ModelParser, LoadModelNaiveMmap) {
+  CHECK(!FLAGS_model_dir.empty());
+  cpp::ProgramDesc prog, mapped_prog;
+  Scope scope, mapped_scope;
+  const std::string model_path = FLAGS_model_dir + ".saved.naive";
+  LoadModelNaive(model_path, &scope, &prog);
+  LoadModelNaive(model_path, &mapped_scope, &mapped_prog, true, true);
+
+  auto& main_block = *prog.GetBlock<cpp::BlockDesc>(0);
+  for (size_t i = 0; i < main_block.VarsSize(); ++i) {
+    auto& var = *main_block.GetVar<cpp::VarDesc>(i);
+    if (var.Name() == "feed" || var.Name() == "fetch" || !var.Persistable())
+      continue;
+    auto& tensor = scope.FindVar(var.Name())->Get<lite::Tensor>();
+    auto& mapped = mapped_scope.FindVar(var.Name())->Get<lite::Tensor>();
+    ASSERT_EQ(tensor.dims(), mapped.dims());
+    ASSERT_EQ(tensor.precision(), mapped.precision());
+    ASSERT_EQ(
+        memcmp(tensor.raw_data(), mapped.raw_data(), tensor.memory_size()), 0);
+  }
+}
+
 }  // namespace lite
 }  // namespace paddle
@@ -13,7 +13,11 @@
 // limitations under the License.
 
 #include "lite/model_parser/naive_buffer/naive_buffer.h"
+#include <fcntl.h>
 #include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace paddle {
 namespace lite {
@@ -21,6 +25,7 @@ namespace naive_buffer {
 
 void BinaryTable::Require(size_t size) {
   CHECK(is_mutable_mode_);
+  CHECK(!mapping_) << "A mapped table is readonly";
   if (free_size() < size) {
     bytes_.resize(cursor_ + size);
   }
@@ -66,6 +71,32 @@ void BinaryTable::LoadFromFile(const std::string &filename) {
   is_mutable_mode_ = false;
 }
 
+void BinaryTable::MapFromFile(const std::string &filename) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  CHECK_GE(fd, 0) << "Unable to open file: " << filename;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    LOG(FATAL) << "Unable to get the size of file: " << filename;
+  }
+  size_t file_size = static_cast<size_t>(st.st_size);
+  LOG(INFO) << "map file size " << file_size;
+
+  // A private writable mapping shares the pages with the page cache, only the
+  // pages modified in place later (e.g. by the fusion passes) are copied.
+  void *addr = mmap(
+      nullptr, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  CHECK(addr != MAP_FAILED) << "Unable to map file: " << filename;
+  mapping_.reset(addr, [file_size](void *ptr) { munmap(ptr, file_size); });
+  mapping_size_ = file_size;
+  bytes_.clear();
+  cursor_ = 0;
+
+  // Set readonly.
+  is_mutable_mode_ = false;
+}
+
 void BinaryTable::LoadFromMemory(const char *buffer, size_t buffer_size) {
   // get buffer
   bytes_.resize(buffer_size);
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #pragma once
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -43,9 +44,20 @@ using byte_t = uint8_t;
 struct BinaryTable {
  private:
   std::vector<byte_t> bytes_;
+  // The memory-mapped file, `bytes_` is unused if it is set.
+  std::shared_ptr<void> mapping_;
+  size_t mapping_size_{};
   size_t cursor_{};
   bool is_mutable_mode_{true};  // true for mutable, false for readonly.
 
+  byte_t* base() {
+    return mapping_ ? static_cast<byte_t*>(mapping_.get()) : bytes_.data();
+  }
+  const byte_t* base() const {
+    return mapping_ ? static_cast<const byte_t*>(mapping_.get())
+                    : bytes_.data();
+  }
+
  public:
   /// Require free memory of `size` bytes.
   void Require(size_t size);
@@ -54,16 +66,23 @@ struct BinaryTable {
   void Consume(size_t bytes);
 
   /// The current position of cursor for save or load.
-  byte_t* cursor() { return &bytes_[cursor_]; }
-  const byte_t* data() const { return bytes_.data(); }
-  size_t size() const { return bytes_.size(); }
-  size_t free_size() const { return bytes_.size() - cursor_; }
+  byte_t* cursor() { return base() + cursor_; }
+  const byte_t* data() const { return base(); }
+  size_t size() const { return mapping_ ? mapping_size_ : bytes_.size(); }
+  size_t free_size() const { return size() - cursor_; }
 
   /// Serialize the table to a binary buffer.
   void SaveToFile(const std::string& filename) const;
 
   void LoadFromFile(const std::string& filename);
   void LoadFromMemory(const char* buffer, size_t buffer_size);
+  /// Map the file into memory instead of reading it, the fields loaded from a
+  /// mapped table may point into the mapping directly.
+  void MapFromFile(const std::string& filename);
+
+  bool is_mapped() const { return mapping_ != nullptr; }
+  /// Holder of the mapping, keep it alive to use the pointers into the table.
+  const std::shared_ptr<void>& mapping() const { return mapping_; }
 };
 
 /*
@@ -129,6 +148,8 @@ using Float64Builder = PrimaryBuilder<double>;
 template <typename Primary>
 class PrimaryListBuilder : public FieldBuilder {
   std::vector<Primary> data_;
+  const Primary* external_data_{nullptr};
+  size_t external_size_{0};
 
  public:
   using value_type = Primary;
@@ -138,9 +159,23 @@ class PrimaryListBuilder : public FieldBuilder {
       : FieldBuilder(table), data_(val) {}
 
   /// Set data.
-  void set(const std::vector<Primary>& x) { data_ = x; }
+  void set(const std::vector<Primary>& x) {
+    data_ = x;
+    external_data_ = nullptr;
+    external_size_ = 0;
+  }
 
-  const std::vector<Primary>& data() const { return data_; }
+  const std::vector<Primary>& data() const {
+    CHECK(!external_data_) << "The data is referred from a mapped table, "
+                              "use raw_data() instead";
+    return data_;
+  }
+
+  /// Pointer to the elements. It points into the BinaryTable without copy if
+  /// the list is loaded from a memory-mapped table.
+  const Primary* raw_data() const {
+    return external_data_ ? external_data_ : data_.data();
+  }
 
   /// Save information to the corresponding BinaryTable.
   void Save() override;
@@ -149,14 +184,18 @@ class PrimaryListBuilder : public FieldBuilder {
   void Load() override;
 
   /// Number of elements.
-  size_t size() const { return data_.size(); }
+  size_t size() const { return external_data_ ? external_size_ : data_.size(); }
 
   Type type() const override {
     return core::StdTypeToRepr<std::vector<Primary>>();
   }
 
   /// clear builder
-  void Clear() { data_.clear(); }
+  void Clear() {
+    data_.clear();
+    external_data_ = nullptr;
+    external_size_ = 0;
+  }
 
   ~PrimaryListBuilder() = default;
 };
@@ -381,17 +420,25 @@ void PrimaryBuilder<Primary>::Load() {
 
 template <typename Primary>
 void PrimaryListBuilder<Primary>::Load() {
-  CHECK(data_.empty()) << "Duplicate load";
+  CHECK(data_.empty() && !external_data_) << "Duplicate load";
   // Load number of elements first.
   uint64_t num_elems{};
   memcpy(&num_elems, table()->cursor(), sizeof(uint64_t));
   table()->Consume(sizeof(uint64_t));
 
-  data_.resize(num_elems);
-  for (uint64_t i = 0; i < num_elems; i++) {
-    memcpy(&data_[i], table()->cursor(), sizeof(value_type));
-    table()->Consume(sizeof(value_type));
+  size_t num_bytes = num_elems * sizeof(value_type);
+  if (table()->is_mapped() &&
+      reinterpret_cast<uintptr_t>(table()->cursor()) % alignof(Primary) == 0) {
+    // Refer to the mapped memory directly.
+    external_data_ = reinterpret_cast<const Primary*>(table()->cursor());
+    external_size_ = num_elems;
+  } else {
+    data_.resize(num_elems);
+    if (num_bytes > 0) {
+      memcpy(&data_[0], table()->cursor(), num_bytes);
+    }
   }
+  table()->Consume(num_bytes);
 }
 
 template <typename Primary>
@@ -404,7 +451,7 @@ void PrimaryListBuilder<Primary>::Save() {
 
   table()->Require(num_elems * sizeof(value_type));
   memcpy(table()->cursor(),
-         reinterpret_cast<byte_t*>(&data_[0]),
+         reinterpret_cast<const byte_t*>(raw_data()),
          num_elems * sizeof(value_type));
   table()->Consume(num_elems * sizeof(value_type));
 }
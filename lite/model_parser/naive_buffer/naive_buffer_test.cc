@@ -14,6 +14,7 @@
 
 #include "lite/model_parser/naive_buffer/naive_buffer.h"
 #include <gtest/gtest.h>
+#include <string>
 
 namespace paddle {
 namespace lite {
@@ -52,6 +53,37 @@ TEST(NaiveBuffer, primary) {
   ASSERT_EQ(p2_load.data(), "hello world");
 }
 
+TEST(NaiveBuffer, mmap) {
+  BinaryTable table;
+  PrimaryBuilder<int32_t> p0(&table, 2008);
+  PrimaryListBuilder<char> p1(&table, {'a', 'b', 'c'});
+  StringBuilder p2(&table, "hello world");
+  p0.Save();
+  p1.Save();
+  p2.Save();
+  table.SaveToFile("2.bf");
+
+  BinaryTable table1;
+  table1.MapFromFile("2.bf");
+  ASSERT_TRUE(table1.is_mapped());
+  ASSERT_EQ(table1.size(), table.size());
+  PrimaryBuilder<int32_t> p0_load(&table1);
+  PrimaryListBuilder<char> p1_load(&table1);
+  StringBuilder p2_load(&table1);
+  p0_load.Load();
+  p1_load.Load();
+  p2_load.Load();
+
+  ASSERT_EQ(p0_load.data(), 2008);
+  // The list refers to the mapped memory without copy.
+  ASSERT_EQ(p1_load.size(), 3UL);
+  ASSERT_GE(reinterpret_cast<const byte_t*>(p1_load.raw_data()), table1.data());
+  ASSERT_LT(reinterpret_cast<const byte_t*>(p1_load.raw_data()),
+            table1.data() + table1.size());
+  ASSERT_EQ(std::string(p1_load.raw_data(), p1_load.size()), "abc");
+  ASSERT_EQ(p2_load.data(), "hello world");
+}
+
 // Message structure 0
 class NBTestMsg0 : public StructBuilder {
  public:
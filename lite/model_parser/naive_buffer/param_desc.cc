@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "lite/model_parser/naive_buffer/param_desc.h"
+#include <cstring>
 #include <string>
 #include <vector>
 #include "lite/model_parser/naive_buffer/naive_buffer_wrapper_helper.h"
@@ -143,6 +144,14 @@ void ParamDesc::SetDim(const std::vector<int64_t>& dim) {
   VectorToRepeated<int64_t, Int64Builder>(dim, out_builder);
 }
 
+const char* ParamDesc::RawData() const {
+  return desc_->GetField<PrimaryListBuilder<char>>("data").raw_data();
+}
+
+size_t ParamDesc::RawDataSize() const {
+  return desc_->GetField<PrimaryListBuilder<char>>("data").size();
+}
+
 #define GET_DATA_IMPL(T, type__)                                            \
   template <>                                                               \
   std::vector<T> ParamDesc::Data() const {                                  \
@@ -150,11 +159,10 @@ void ParamDesc::SetDim(const std::vector<int64_t>& dim) {
         << "Data Type mismatch";                                            \
     std::vector<T> res;                                                     \
     auto& data_builder = desc_->GetField<PrimaryListBuilder<char>>("data"); \
-    auto& data = data_builder.data();                                       \
-    size_t size = data.size() / sizeof(T);                                  \
-    auto* data_ptr = reinterpret_cast<const T*>(&data[0]);                  \
-    for (size_t i = 0; i < size; ++i) {                                     \
-      res.push_back(data_ptr[i]);                                           \
+    size_t size = data_builder.size() / sizeof(T);                          \
+    res.resize(size);                                                       \
+    if (size > 0) {                                                         \
+      memcpy(&res[0], data_builder.raw_data(), size * sizeof(T));           \
     }                                                                       \
     return res;                                                             \
   }
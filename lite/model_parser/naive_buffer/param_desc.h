@@ -71,6 +71,11 @@ class ParamDesc {
   template <typename T>
   std::vector<T> Data() const;
 
+  // The raw bytes of the data, they point into the model file directly if the
+  // params are loaded from a memory-mapped table.
+  const char *RawData() const;
+  size_t RawDataSize() const;
+
   template <typename T>
   void SetData(const std::vector<T> &data);
 
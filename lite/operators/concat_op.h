@@ -32,6 +32,10 @@ class ConcatOpLite : public OpLite {
 
   bool InferShape() const override;
 
+  bool shape_depends_on_data() const override {
+    return param_.axis_tensor != nullptr;
+  }
+
   bool AttachImpl(const cpp::OpDesc &opdesc, lite::Scope *scope) override;
 
   void AttachKernel(KernelBase *kernel) override { kernel->SetParam(param_); }
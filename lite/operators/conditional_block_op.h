@@ -40,10 +40,12 @@ class ConditionalBlockOpLite : public OpLite {
   std::string DebugString() const override { return "conditional_block"; }
 
   void SetSubBlock(cpp::BlockDesc *desc) { sub_block_ = desc; }
+  void SetProgramDesc(cpp::ProgramDesc *desc) { program_desc_ = desc; }
 
  private:
   mutable ConditionalBlockParam param_;
   cpp::BlockDesc *sub_block_;
+  cpp::ProgramDesc *program_desc_{};
 };
 
 }  // namespace operators
@@ -0,0 +1,64 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/operators/fused_embedding_seq_pool_op.h"
+#include "lite/core/op_lite.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace operators {
+
+bool FusedEmbeddingSeqPoolOpLite::CheckShape() const {
+  CHECK_OR_FALSE(param_.W);
+  CHECK_OR_FALSE(param_.Ids);
+  CHECK_OR_FALSE(param_.Out);
+  CHECK_EQ_OR_FALSE(param_.W->dims().size(), 2UL);
+  CHECK_EQ_OR_FALSE(param_.Ids->lod().size(), 1UL);
+  CHECK_OR_FALSE(param_.combiner == "sum");
+  return true;
+}
+
+bool FusedEmbeddingSeqPoolOpLite::InferShape() const {
+  const auto& lod = param_.Ids->lod();
+  int64_t batch_size = static_cast<int64_t>(lod[0].size()) - 1;
+  param_.Out->Resize({batch_size, param_.W->dims()[1]});
+  return true;
+}
+
+bool FusedEmbeddingSeqPoolOpLite::AttachImpl(const cpp::OpDesc& op_desc,
+                                             lite::Scope* scope) {
+  auto w = op_desc.Input("W").front();
+  auto ids = op_desc.Input("Ids").front();
+  auto out = op_desc.Output("Out").front();
+
+  param_.W = scope->FindVar(w)->GetMutable<lite::Tensor>();
+  param_.Ids = scope->FindVar(ids)->GetMutable<lite::Tensor>();
+  param_.Out = scope->FindVar(out)->GetMutable<lite::Tensor>();
+
+  if (op_desc.HasAttr("combiner")) {
+    param_.combiner = op_desc.GetAttr<std::string>("combiner");
+  }
+  if (op_desc.HasAttr("padding_idx")) {
+    param_.padding_idx = op_desc.GetAttr<int64_t>("padding_idx");
+  }
+  return true;
+}
+
+}  // namespace operators
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_OP(fused_embedding_seq_pool,
+                 paddle::lite::operators::FusedEmbeddingSeqPoolOpLite);
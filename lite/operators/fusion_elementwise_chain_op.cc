@@ -0,0 +1,88 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/operators/fusion_elementwise_chain_op.h"
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace operators {
+
+bool FusionElementwiseChainOp::CheckShape() const {
+  const size_t num_steps = param_.step_types.size();
+  const size_t num_values = param_.X.size() + num_steps;
+  CHECK_GE_OR_FALSE(param_.X.size(), 1UL);
+  CHECK_GE_OR_FALSE(num_steps, 1UL);
+  CHECK_EQ_OR_FALSE(param_.operands.size(), 2 * num_steps);
+  CHECK_EQ_OR_FALSE(param_.axes.size(), num_steps);
+  CHECK_EQ_OR_FALSE(param_.alphas.size(), num_steps);
+  CHECK_EQ_OR_FALSE(param_.betas.size(), num_steps);
+  CHECK_EQ_OR_FALSE(param_.Out.size(), param_.out_values.size());
+  for (size_t s = 0; s < num_steps; ++s) {
+    const size_t value = param_.X.size() + s;
+    CHECK_GE_OR_FALSE(param_.operands[2 * s], 0);
+    CHECK_GT_OR_FALSE(static_cast<int>(value), param_.operands[2 * s]);
+    CHECK_GT_OR_FALSE(static_cast<int>(value), param_.operands[2 * s + 1]);
+  }
+  for (int v : param_.out_values) {
+    CHECK_GE_OR_FALSE(v, static_cast<int>(param_.X.size()));
+    CHECK_GT_OR_FALSE(static_cast<int>(num_values), v);
+  }
+  return true;
+}
+
+bool FusionElementwiseChainOp::InferShape() const {
+  // Every step keeps the shape of its first operand.
+  std::vector<lite::DDim> value_dims;
+  for (auto* x : param_.X) {
+    value_dims.push_back(x->dims());
+  }
+  for (size_t s = 0; s < param_.step_types.size(); ++s) {
+    value_dims.push_back(value_dims[param_.operands[2 * s]]);
+  }
+  for (size_t k = 0; k < param_.Out.size(); ++k) {
+    param_.Out[k]->Resize(value_dims[param_.out_values[k]]);
+    *param_.Out[k]->mutable_lod() = param_.X[0]->lod();
+  }
+  return true;
+}
+
+bool FusionElementwiseChainOp::AttachImpl(const cpp::OpDesc& opdesc,
+                                          lite::Scope* scope) {
+  param_.X.clear();
+  for (auto& name : opdesc.Input("X")) {
+    param_.X.push_back(GetVar<lite::Tensor>(scope, name));
+  }
+  param_.Out.clear();
+  for (auto& name : opdesc.Output("Out")) {
+    param_.Out.push_back(GetMutableVar<lite::Tensor>(scope, name));
+  }
+  param_.step_types =
+      opdesc.GetAttr<std::vector<std::string>>("step_types");
+  param_.operands = opdesc.GetAttr<std::vector<int>>("operands");
+  param_.axes = opdesc.GetAttr<std::vector<int>>("axes");
+  param_.alphas = opdesc.GetAttr<std::vector<float>>("alphas");
+  param_.betas = opdesc.GetAttr<std::vector<float>>("betas");
+  param_.out_values = opdesc.GetAttr<std::vector<int>>("out_values");
+  return true;
+}
+
+}  // namespace operators
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_OP(fusion_elementwise_chain,
+                 paddle::lite::operators::FusionElementwiseChainOp);
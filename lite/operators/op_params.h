@@ -22,6 +22,7 @@
 #include "lite/core/tensor.h"
 #include "lite/core/types.h"
 #include "lite/model_parser/cpp/block_desc.h"
+#include "lite/model_parser/cpp/program_desc.h"
 #include "lite/model_parser/desc_apis.h"
 #include "lite/utils/all.h"
 /*
@@ -345,7 +346,7 @@ struct DropoutParam {
 struct SplitParam {
   lite::Tensor* x{};
   std::vector<lite::Tensor*> output{};
-  lite::Tensor* axis_tensor;
+  lite::Tensor* axis_tensor{};
   std::vector<lite::Tensor*> sections_tensor_list{};
 
   int axis{-1};
@@ -392,6 +393,20 @@ struct FusionElementwiseActivationGradParam : public ElementwiseGradParam {
   std::string act_type;
 };
 
+// A chain of elementwise and activation ops run as one. The operands and
+// the outputs index the values of the chain, the inputs X, then the results
+// of the steps.
+struct FusionElementwiseChainParam {
+  std::vector<const lite::Tensor*> X{};
+  std::vector<lite::Tensor*> Out{};
+  std::vector<std::string> step_types{};
+  std::vector<int> operands{};  // a and b of every step, b is -1 if unary
+  std::vector<int> axes{};      // the broadcast axis of b
+  std::vector<float> alphas{};
+  std::vector<float> betas{};
+  std::vector<int> out_values{};
+};
+
 /// ----------------------- mean operators ----------------------
 struct MeanParam {
   const lite::Tensor* X{};
@@ -659,6 +674,15 @@ struct LookupTableParam {
   int64_t padding_idx{-1};
 };
 
+// lookup_table followed by a sum sequence_pool over the LoD of Ids.
+struct FusedEmbeddingSeqPoolParam {
+  const lite::Tensor* W{nullptr};
+  const lite::Tensor* Ids{nullptr};
+  lite::Tensor* Out{nullptr};
+  std::string combiner{"sum"};
+  int64_t padding_idx{-1};
+};
+
 struct Im2SequenceParam {
   const lite::Tensor* X{};
   const lite::Tensor* Y{};
@@ -710,6 +734,10 @@ struct WhileParam {
   Scope* scope{};
   Tensor* cond{};
   cpp::BlockDesc* sub_block{};
+  // The program of the sub-block and its index, to build the sub-block as a
+  // program of its own.
+  cpp::ProgramDesc* program_desc{};
+  int block_idx{-1};
   std::vector<Tensor*> x{};
   std::vector<Tensor*> outs{};
 };
@@ -1079,6 +1107,8 @@ struct ConditionalBlockParam {
   std::vector<lite::Tensor*> x{};
   std::vector<lite::Tensor*> outs{};
   cpp::BlockDesc* sub_block{};
+  cpp::ProgramDesc* program_desc{};
+  int block_idx{-1};
   Scope* scope{};
   bool is_scalar_condition{};
 };
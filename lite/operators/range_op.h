@@ -31,6 +31,8 @@ class RangeOpLite : public OpLite {
 
   bool InferShape() const override;
 
+  bool shape_depends_on_data() const override { return true; }
+
   bool AttachImpl(const cpp::OpDesc &opdesc, lite::Scope *scope) override;
 
   void AttachKernel(KernelBase *kernel) override { kernel->SetParam(param_); }
@@ -32,6 +32,10 @@ class ReshapeOp : public OpLite {
 
   bool InferShape() const override;
 
+  bool shape_depends_on_data() const override {
+    return !param_.shape_tensor_vct.empty() || param_.shape_tensor;
+  }
+
   bool AttachImpl(const cpp::OpDesc &opdesc, lite::Scope *scope) override;
 
   void AttachKernel(KernelBase *kernel) override { kernel->SetParam(param_); }
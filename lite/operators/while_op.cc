@@ -40,6 +40,8 @@ bool WhileOpLite::AttachImpl(const cpp::OpDesc &op_desc, lite::Scope *scope) {
     // param_.outs.push_back(scope->FindVar(var)->GetMutable<lite::Tensor>());
   }
   param_.sub_block = sub_block_;
+  param_.program_desc = program_desc_;
+  param_.block_idx = op_desc.GetAttr<int32_t>("sub_block");
 
   auto condition = op_desc.Input("Condition");
   param_.cond = scope->FindVar(condition[0])->GetMutable<lite::Tensor>();
@@ -37,10 +37,12 @@ class WhileOpLite : public OpLite {
   void AttachKernel(KernelBase *kernel) override { kernel->SetParam(param_); }
   std::string DebugString() const override { return "while"; }
   void SetSubBlock(cpp::BlockDesc *desc) { sub_block_ = desc; }
+  void SetProgramDesc(cpp::ProgramDesc *desc) { program_desc_ = desc; }
 
  private:
   mutable WhileParam param_;
   cpp::BlockDesc *sub_block_;
+  cpp::ProgramDesc *program_desc_{};
 };
 
 }  // namespace operators
@@ -243,8 +243,12 @@ class ActivationComputeTester : public arena::TestCase {
 
 TEST(Activation_relu, precision) {
   LOG(INFO) << "test relu op";
+#ifdef LITE_WITH_X86
+  Place place(TARGET(kX86));
+#endif
 #ifdef LITE_WITH_ARM
   Place place(TARGET(kARM));
+#endif
 
   for (auto n : {1, 3}) {
     for (auto c : {3, 6}) {
@@ -268,13 +272,16 @@ TEST(Activation_relu, precision) {
       }
     }
   }
-#endif
 }
 
 TEST(Activation_leaky_relu, precision) {
   LOG(INFO) << "test leaky_relu op";
+#ifdef LITE_WITH_X86
+  Place place(TARGET(kX86));
+#endif
 #ifdef LITE_WITH_ARM
   Place place(TARGET(kARM));
+#endif
 
   for (auto n : {1, 3}) {
     for (auto c : {3, 6}) {
@@ -298,7 +305,6 @@ TEST(Activation_leaky_relu, precision) {
       }
     }
   }
-#endif
 }
 
 TEST(Activation_relu_clipped, precision) {
@@ -363,8 +369,12 @@ TEST(Activation_prelu, precision) {
 
 TEST(Activation_sigmoid, precision) {
   LOG(INFO) << "test sigmoid op";
+#ifdef LITE_WITH_X86
+  Place place(TARGET(kX86));
+#endif
 #ifdef LITE_WITH_ARM
   Place place(TARGET(kARM));
+#endif
 
   for (auto n : {1, 3}) {
     for (auto c : {3, 6}) {
@@ -386,13 +396,16 @@ TEST(Activation_sigmoid, precision) {
       }
     }
   }
-#endif
 }
 
 TEST(Activation_tanh, precision) {
   LOG(INFO) << "test tanh op";
+#ifdef LITE_WITH_X86
+  Place place(TARGET(kX86));
+#endif
 #ifdef LITE_WITH_ARM
   Place place(TARGET(kARM));
+#endif
 
   for (auto n : {1, 3}) {
     for (auto c : {3, 6}) {
@@ -414,7 +427,6 @@ TEST(Activation_tanh, precision) {
       }
     }
   }
-#endif
 }
 
 TEST(Activation_swish, precision) {
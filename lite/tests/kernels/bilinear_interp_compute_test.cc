@@ -361,9 +361,10 @@ void test_bilinear_interp(Place place) {
 }
 
 TEST(BilinearInterp, precision) {
-// #ifdef LITE_WITH_X86
-//   Place place(TARGET(kX86));
-// #endif
+#ifdef LITE_WITH_X86
+  Place place(TARGET(kX86));
+  test_bilinear_interp(place);
+#endif
 #ifdef LITE_WITH_ARM
   Place place(TARGET(kARM));
   test_bilinear_interp(place);
@@ -195,6 +195,7 @@ void test_box_coder(Place place) {
 TEST(BoxCoder, precision) {
 #ifdef LITE_WITH_X86
   Place place(TARGET(kX86));
+  test_box_coder(place);
 #endif
 #ifdef LITE_WITH_ARM
   Place place(TARGET(kARM));
@@ -247,9 +247,10 @@ void test_nearest_interp(Place place) {
 }
 
 TEST(NearestInterp, precision) {
-// #ifdef LITE_WITH_X86
-//   Place place(TARGET(kX86));
-// #endif
+#ifdef LITE_WITH_X86
+  Place place(TARGET(kX86));
+  test_nearest_interp(place);
+#endif
 #ifdef LITE_WITH_ARM
   Place place(TARGET(kARM));
   test_nearest_interp(place);
@@ -171,6 +171,7 @@ void TestPad2d(const Place& place) {
 TEST(Scale, precision) {
 #ifdef LITE_WITH_X86
   Place place(TARGET(kX86));
+  TestPad2d(place);
 #endif
 #ifdef LITE_WITH_ARM
   Place place(TARGET(kARM));
@@ -730,6 +730,7 @@ void test_prior_box(Place place) {
 TEST(PriorBox, precision) {
 #ifdef LITE_WITH_X86
   Place place(TARGET(kX86));
+  test_prior_box(place);
 #endif
 #ifdef LITE_WITH_ARM
   Place place(TARGET(kARM));
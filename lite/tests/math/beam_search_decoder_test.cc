@@ -0,0 +1,215 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <vector>
+#include "lite/backends/x86/math/beam_search_decoder.h"
+#include "lite/backends/x86/thread_pool.h"
+#include "lite/core/profile/timer.h"
+
+DEFINE_int32(threads, 1, "threads num");
+DEFINE_int32(repeats, 1, "repeats times");
+DEFINE_bool(basic_test, true, "do all tests");
+
+DEFINE_int32(batch, 4, "decode requests");
+DEFINE_int32(beam_size, 4, "beam size");
+DEFINE_int32(vocab, 30000, "vocabulary size");
+DEFINE_int32(max_len, 32, "max decoded length");
+
+namespace {
+
+// The logits of a toy decoder, which only depend on the request, the step
+// and the last word. The end word gets likelier along the steps. They are
+// multiples of 1 / 64, so that the sequences of close scores are not ordered
+// by the rounding of their sums.
+void FakeLogits(int request, int step, int64_t last_id, int vocab, float* y) {
+  uint32_t seed = static_cast<uint32_t>(request * 7919 + step * 104729 +
+                                        last_id * 15485863 + 1);
+  for (int i = 0; i < vocab; ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    y[i] = static_cast<float>((seed >> 8) % 384) / 64.f - 3.f;
+  }
+  y[0] += 0.5f * step;
+}
+
+struct Sequence {
+  std::vector<int64_t> ids;
+  float score{0.f};
+  bool ended{false};
+};
+
+// A beam search keeping every candidate, for one request.
+std::vector<Sequence> NaiveBeamSearch(
+    int request, int beam_size, int vocab, int max_len, int end_id) {
+  std::vector<Sequence> beams(1);
+  std::vector<float> logits(vocab);
+  for (int step = 0; step < max_len; ++step) {
+    std::vector<Sequence> candidates;
+    for (auto& beam : beams) {
+      if (beam.ended) {
+        candidates.push_back(beam);
+        continue;
+      }
+      int64_t last_id = beam.ids.empty() ? -1 : beam.ids.back();
+      FakeLogits(request, step, last_id, vocab, logits.data());
+      const float max = *std::max_element(logits.begin(), logits.end());
+      double sum = 0.;
+      for (float x : logits) sum += std::exp(x - max);
+      const float lse = max + std::log(sum);
+      for (int i = 0; i < vocab; ++i) {
+        Sequence next = beam;
+        next.ids.push_back(i);
+        next.score += logits[i] - lse;
+        next.ended = i == end_id;
+        candidates.push_back(next);
+      }
+    }
+    std::stable_sort(candidates.begin(),
+                     candidates.end(),
+                     [](const Sequence& a, const Sequence& b) {
+                       return a.score > b.score;
+                     });
+    candidates.resize(beam_size);
+    beams.swap(candidates);
+    if (std::all_of(beams.begin(), beams.end(), [](const Sequence& s) {
+          return s.ended;
+        })) {
+      break;
+    }
+  }
+  return beams;
+}
+
+}  // namespace
+
+bool test_log_softmax_topk(int n, int k) {
+  std::vector<float> x(n);
+  FakeLogits(n, k, 0, n, x.data());
+  std::vector<float> ref(n);
+  const float max = *std::max_element(x.begin(), x.end());
+  double sum = 0.;
+  for (float v : x) sum += std::exp(v - max);
+  for (int i = 0; i < n; ++i) ref[i] = x[i] - max - std::log(sum);
+  std::vector<int> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return ref[a] > ref[b];
+  });
+
+  std::vector<float> top(k);
+  std::vector<int> ids(k);
+  paddle::lite::x86::math::log_softmax_topk(
+      x.data(), n, k, top.data(), ids.data());
+  for (int i = 0; i < k; ++i) {
+    if (ids[i] != order[i] || std::abs(top[i] - ref[order[i]]) > 1e-4f) {
+      LOG(INFO) << "top " << i << ": " << ids[i] << " " << top[i]
+                << ", expected " << order[i] << " " << ref[order[i]];
+      return false;
+    }
+  }
+  return true;
+}
+
+bool test_decoder(int batch, int beam_size, int vocab, int max_len, int ths) {
+  const int end_id = 0;
+  std::unique_ptr<paddle::lite::x86::ThreadPool> pool(
+      new paddle::lite::x86::ThreadPool(ths));
+  paddle::lite::x86::math::BeamSearchDecoder decoder(
+      batch, beam_size, vocab, max_len, end_id);
+  decoder.SetThreadPool(pool.get());
+  std::vector<float> logits(static_cast<size_t>(batch) * beam_size * vocab);
+
+  paddle::lite::profile::Timer t0;
+  for (int i = 0; i < FLAGS_repeats; ++i) {
+    decoder.Start(batch);
+    while (!decoder.finished()) {
+      const int rows = batch * beam_size;
+      for (int row = 0; row < rows; ++row) {
+        int64_t last_id = decoder.step() > 0 ? decoder.ids()[row] : -1;
+        FakeLogits(row / beam_size,
+                   decoder.step(),
+                   last_id,
+                   vocab,
+                   logits.data() + static_cast<size_t>(row) * vocab);
+      }
+      t0.Start();
+      decoder.Step(logits.data());
+      t0.Stop();
+    }
+  }
+  LOG(INFO) << "beam search decoder: batch: " << batch
+            << ", beam_size: " << beam_size << ", vocab: " << vocab
+            << ", threads: " << ths << ", steps: " << decoder.step()
+            << ", avg step time: " << t0.LapTimes().Avg() << " ms";
+
+  std::vector<std::vector<int64_t>> sentences;
+  std::vector<float> scores;
+  for (int r = 0; r < batch; ++r) {
+    auto expected = NaiveBeamSearch(r, beam_size, vocab, max_len, end_id);
+    decoder.GetResult(r, &sentences, &scores);
+    for (int b = 0; b < beam_size; ++b) {
+      if (sentences[b] != expected[b].ids ||
+          std::abs(scores[b] - expected[b].score) > 1e-3f) {
+        LOG(INFO) << "request " << r << ", beam " << b << ": score "
+                  << scores[b] << ", expected " << expected[b].score;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+TEST(TestBeamSearchDecoder, log_softmax_topk) {
+  if (FLAGS_basic_test) {
+    for (auto& n : {1, 7, 8, 33, 1000}) {
+      for (auto& k : {1, 4, 8}) {
+        if (k > n) continue;
+        if (!test_log_softmax_topk(n, k)) {
+          LOG(FATAL) << "test log_softmax_topk n = " << n << ", k = " << k
+                     << " failed\n";
+        }
+      }
+    }
+  }
+}
+
+TEST(TestBeamSearchDecoder, decode) {
+  if (FLAGS_basic_test) {
+    for (auto& beam_size : {1, 3, 4}) {
+      for (auto& th : {1, 2}) {
+        if (!test_decoder(3, beam_size, 50, 12, th)) {
+          LOG(FATAL) << "test decoder beam_size = " << beam_size
+                     << ", threads: " << th << " failed\n";
+        }
+      }
+    }
+  }
+}
+
+TEST(TestBeamSearchDecoderCustom, decode_custom) {
+  if (!test_decoder(FLAGS_batch,
+                    FLAGS_beam_size,
+                    FLAGS_vocab,
+                    FLAGS_max_len,
+                    FLAGS_threads)) {
+    LOG(FATAL) << "test decoder vocab = " << FLAGS_vocab << " failed!!";
+  }
+  LOG(INFO) << "test decoder vocab = " << FLAGS_vocab << " passed!!";
+}
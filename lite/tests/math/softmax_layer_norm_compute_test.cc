@@ -0,0 +1,219 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gflags/gflags.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include "lite/backends/x86/thread_pool.h"
+#include "lite/core/context.h"
+#include "lite/core/profile/timer.h"
+#include "lite/core/tensor.h"
+#include "lite/kernels/x86/layer_norm_compute.h"
+#include "lite/kernels/x86/softmax_compute.h"
+#include "lite/tests/utils/fill_data.h"
+#include "lite/tests/utils/tensor_utils.h"
+
+typedef paddle::lite::Tensor Tensor;
+
+DEFINE_int32(threads, 1, "threads num");
+DEFINE_int32(warmup, 0, "warmup times");
+DEFINE_int32(repeats, 1, "repeats times");
+DEFINE_bool(basic_test, true, "do all tests");
+DEFINE_bool(check_result, true, "check the result");
+
+DEFINE_int32(batch, 1, "batch size");
+DEFINE_int32(heads, 12, "attention heads");
+DEFINE_int32(seq_len, 128, "sequence length");
+DEFINE_int32(hidden, 768, "hidden size");
+
+std::unique_ptr<paddle::lite::KernelContext> NewX86Context(int threads) {
+  std::unique_ptr<paddle::lite::KernelContext> ctx(
+      new paddle::lite::KernelContext);
+  ctx->As<paddle::lite::X86Context>().SetThreadPool(
+      std::make_shared<paddle::lite::x86::ThreadPool>(threads));
+  return ctx;
+}
+
+void LogTime(const char* name,
+             int batch,
+             int seq_len,
+             int ths,
+             const paddle::lite::profile::Timer& t0) {
+  LOG(INFO) << name << " output: batch: " << batch << ", seq_len: " << seq_len
+            << ", threads: " << ths
+            << ", avg time: " << t0.LapTimes().Avg()
+            << " ms, min time: " << t0.LapTimes().Min() << " ms";
+}
+
+bool CheckResult(const Tensor& basic, const Tensor& out) {
+  double max_ratio = 0;
+  double max_diff = 0;
+  tensor_cmp_host(basic, out, max_ratio, max_diff);
+  LOG(INFO) << "compare result, max diff: " << max_diff
+            << ", max ratio: " << max_ratio;
+  return std::abs(max_ratio) <= 1e-4f || std::abs(max_diff) <= 5e-5f;
+}
+
+// The attention scores of a transformer layer: heads x seq_len rows of
+// seq_len values per sequence, normalized along the last axis.
+bool test_softmax(int batch, int heads, int seq_len, int ths) {
+  Tensor x, out, out_basic;
+  x.Resize({batch, heads, seq_len, seq_len});
+  out.Resize(x.dims());
+  out_basic.Resize(x.dims());
+  x.set_precision(PRECISION(kFloat));
+  out.set_precision(PRECISION(kFloat));
+  out_basic.set_precision(PRECISION(kFloat));
+  fill_tensor_rand(x, -10.f, 10.f);
+
+  if (FLAGS_check_result) {
+    const float* x_data = x.data<float>();
+    float* y_data = out_basic.mutable_data<float>();
+    for (int64_t r = 0; r < x.numel() / seq_len; ++r) {
+      const float* xr = x_data + r * seq_len;
+      float* yr = y_data + r * seq_len;
+      const float max = *std::max_element(xr, xr + seq_len);
+      double sum = 0.;
+      for (int i = 0; i < seq_len; ++i) {
+        yr[i] = std::exp(xr[i] - max);
+        sum += yr[i];
+      }
+      for (int i = 0; i < seq_len; ++i) {
+        yr[i] /= sum;
+      }
+    }
+  }
+
+  paddle::lite::kernels::x86::SoftmaxCompute<float> softmax;
+  paddle::lite::operators::SoftmaxParam param;
+  param.x = &x;
+  param.output = &out;
+  param.axis = -1;
+  softmax.SetContext(NewX86Context(ths));
+  softmax.SetParam(param);
+
+  paddle::lite::profile::Timer t0;
+  for (int j = 0; j < FLAGS_warmup; ++j) {
+    softmax.Run();
+  }
+  for (int i = 0; i < FLAGS_repeats; ++i) {
+    t0.Start();
+    softmax.Run();
+    t0.Stop();
+  }
+  LogTime("softmax", batch, seq_len, ths, t0);
+  return !FLAGS_check_result || CheckResult(out_basic, out);
+}
+
+// The layer norm after an attention or feed-forward block: seq_len rows of
+// hidden values per sequence.
+bool test_layer_norm(int batch, int seq_len, int hidden, int ths) {
+  const float epsilon = 1e-5f;
+  Tensor x, scale, bias, out, mean, var, out_basic;
+  x.Resize({batch, seq_len, hidden});
+  out.Resize(x.dims());
+  out_basic.Resize(x.dims());
+  scale.Resize({hidden});
+  bias.Resize({hidden});
+  mean.Resize({batch * seq_len});
+  var.Resize({batch * seq_len});
+  for (auto* t : {&x, &scale, &bias, &out, &out_basic}) {
+    t->set_precision(PRECISION(kFloat));
+  }
+  fill_tensor_rand(x, -2.f, 2.f);
+  fill_tensor_rand(scale, 0.5f, 1.5f);
+  fill_tensor_rand(bias, -1.f, 1.f);
+
+  if (FLAGS_check_result) {
+    const float* x_data = x.data<float>();
+    const float* scale_data = scale.data<float>();
+    const float* bias_data = bias.data<float>();
+    float* y_data = out_basic.mutable_data<float>();
+    for (int64_t r = 0; r < batch * seq_len; ++r) {
+      const float* xr = x_data + r * hidden;
+      float* yr = y_data + r * hidden;
+      double m = 0., v = 0.;
+      for (int i = 0; i < hidden; ++i) {
+        m += xr[i];
+      }
+      m /= hidden;
+      for (int i = 0; i < hidden; ++i) {
+        v += (xr[i] - m) * (xr[i] - m);
+      }
+      v /= hidden;
+      for (int i = 0; i < hidden; ++i) {
+        yr[i] = (xr[i] - m) / std::sqrt(v + epsilon) * scale_data[i] +
+                bias_data[i];
+      }
+    }
+  }
+
+  paddle::lite::kernels::x86::LayerNormCompute<float> layer_norm;
+  paddle::lite::operators::LayerNormParam param;
+  param.X = &x;
+  param.Y = &out;
+  param.Scale = &scale;
+  param.Bias = &bias;
+  param.Mean = &mean;
+  param.Variance = &var;
+  param.begin_norm_axis = 2;
+  param.epsilon = epsilon;
+  layer_norm.SetContext(NewX86Context(ths));
+  layer_norm.SetParam(param);
+
+  paddle::lite::profile::Timer t0;
+  for (int j = 0; j < FLAGS_warmup; ++j) {
+    layer_norm.Run();
+  }
+  for (int i = 0; i < FLAGS_repeats; ++i) {
+    t0.Start();
+    layer_norm.Run();
+    t0.Stop();
+  }
+  LogTime("layer_norm", batch, seq_len, ths, t0);
+  return !FLAGS_check_result || CheckResult(out_basic, out);
+}
+
+TEST(TestLiteSoftmaxLayerNorm, SeqLen) {
+  if (FLAGS_basic_test) {
+    LOG(INFO) << "run basic softmax and layer_norm test";
+    for (auto& seq_len : {1, 7, 32, 128, 512}) {
+      for (auto& th : {1, 2, 4}) {
+        if (!test_softmax(FLAGS_batch, FLAGS_heads, seq_len, th)) {
+          LOG(FATAL) << "test softmax seq_len = " << seq_len
+                     << ", threads: " << th << " failed\n";
+        }
+        if (!test_layer_norm(FLAGS_batch, seq_len, FLAGS_hidden, th)) {
+          LOG(FATAL) << "test layer_norm seq_len = " << seq_len
+                     << ", threads: " << th << " failed\n";
+        }
+      }
+    }
+  }
+}
+
+TEST(TestSoftmaxLayerNormCustom, SeqLen_custom) {
+  if (!test_softmax(FLAGS_batch, FLAGS_heads, FLAGS_seq_len, FLAGS_threads)) {
+    LOG(FATAL) << "test softmax seq_len = " << FLAGS_seq_len << " failed!!";
+  }
+  if (!test_layer_norm(
+          FLAGS_batch, FLAGS_seq_len, FLAGS_hidden, FLAGS_threads)) {
+    LOG(FATAL) << "test layer_norm seq_len = " << FLAGS_seq_len
+               << " failed!!";
+  }
+  LOG(INFO) << "test seq_len = " << FLAGS_seq_len << " passed!!";
+}